@@ -0,0 +1,22 @@
+#include "micro.h"
+
+int main(int argc, char* argv[]) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  // The engine is initialized in the main thread before any benchmark runs
+  Micro::engine();
+
+  Micro::registerTransformationBenchmarks();
+  Micro::registerOperatorBenchmarks();
+  Micro::registerParserBenchmarks();
+  Micro::registerTransactionBenchmarks();
+  Micro::registerStorageBenchmarks();
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include "micro.h"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include "../test_data/test_data.h"
+
+namespace Micro {
+namespace {
+// Write the phrases of the @pmFromFile rule, they are picked from the restricted files of the CRS
+std::string writePmFromFileData() {
+  std::string file_path =
+      (std::filesystem::temp_directory_path() / "wge_micro_benchmark_pmf.data").string();
+  std::ofstream ofs(file_path, std::ios::trunc);
+  for (auto phrase :
+       {".htaccess", ".htpasswd", ".git/", ".svn/", ".env", ".bash_history", ".ssh/", "id_rsa",
+        "/etc/passwd", "/etc/shadow", "/proc/self/environ", "boot.ini", "web.config",
+        "wp-config.php", "config.php", "phpinfo", "composer.json", "package.json", "docker-compose",
+        "dump.sql", "backup.zip", "server-status", "server-info", "~"}) {
+    ofs << phrase << "\n";
+  }
+
+  return file_path;
+}
+} // namespace
+
+const std::vector<HttpInfo>& httpInfos() {
+  static const std::vector<HttpInfo> http_infos = []() {
+    static TestData white(TestData::Type::White);
+    static TestData black(TestData::Type::Black);
+    std::vector<HttpInfo> http_infos = white.getHttpInfos();
+    http_infos.insert(http_infos.end(), black.getHttpInfos().begin(), black.getHttpInfos().end());
+    if (http_infos.empty()) {
+      std::cout << "Load test data error" << std::endl;
+      std::exit(1);
+    }
+    return http_infos;
+  }();
+
+  return http_infos;
+}
+
+const Wge::Engine& engine() {
+  static const Wge::Engine& engine = []() -> const Wge::Engine& {
+    static Wge::Engine engine(spdlog::level::off);
+    std::string directive = "SecRuleEngine On\n";
+    auto add_rule = [&](RuleId id, std::string_view variables, const std::string& op,
+                        std::string_view actions = "") {
+      directive += std::format(R"(SecRule {} "{}" "id:{},phase:2,pass,nolog{}")", variables, op,
+                               static_cast<uint64_t>(id), actions);
+      directive += "\n";
+    };
+    add_rule(RxLiteral, "ARGS", "@rx select");
+    add_rule(RxRe2, "ARGS", R"(@rx (?i)union\s+(?:all\s+)?select)");
+    add_rule(RxPcre, "ARGS", R"(@rx (?i)union(?=\s+select))");
+    add_rule(Pm, "ARGS", "@pm select union insert update delete script alert onerror");
+    add_rule(PmFromFile, "ARGS", "@pmFromFile " + writePmFromFileData());
+    add_rule(DetectSqli, "ARGS", "@detectSQLi");
+    add_rule(DetectXss, "ARGS", "@detectXSS");
+    add_rule(ValidateByteRange, "ARGS", "@validateByteRange 32-36,38-126");
+
+    // Like the rule 941110 of the CRS, with the transformations
+    add_rule(SingleRule, "REQUEST_HEADERS|ARGS_NAMES|ARGS", R"(@rx (?i)<script[^>]*>[\s\S]*?)",
+             ",t:none,t:urlDecodeUni,t:htmlEntityDecode,t:jsDecode,t:cssDecode,t:removeNulls");
+
+    auto result = engine.load(directive);
+    if (!result.has_value()) {
+      std::cout << "Load rules error: " << result.error() << std::endl;
+      std::exit(1);
+    }
+    engine.init();
+    return engine;
+  }();
+
+  return engine;
+}
+
+const std::vector<std::string_view>& values() {
+  static const std::vector<std::string_view> values = []() {
+    std::vector<std::string_view> values;
+    for (auto& http_info : httpInfos()) {
+      values.emplace_back(http_info.request_uri_);
+      for (auto& [key, value] : http_info.request_headers_) {
+        values.emplace_back(value);
+      }
+      values.emplace_back(http_info.request_body_);
+    }
+    return values;
+  }();
+
+  return values;
+}
+
+const std::vector<std::string_view>& queries() {
+  static const std::vector<std::string_view> queries = []() {
+    std::vector<std::string_view> queries;
+    for (auto& http_info : httpInfos()) {
+      auto pos = http_info.request_uri_.find('?');
+      if (pos != std::string_view::npos) {
+        queries.emplace_back(http_info.request_uri_.substr(pos + 1));
+      }
+
+      auto iter = http_info.request_headers_.find("content-type");
+      if (iter != http_info.request_headers_.end() &&
+          iter->second.find("application/x-www-form-urlencoded") != std::string_view::npos) {
+        queries.emplace_back(http_info.request_body_);
+      }
+    }
+    return queries;
+  }();
+
+  return queries;
+}
+
+const std::vector<std::string_view>& uris() {
+  static const std::vector<std::string_view> uris = []() {
+    std::vector<std::string_view> uris;
+    for (auto& http_info : httpInfos()) {
+      uris.emplace_back(http_info.request_uri_);
+    }
+    return uris;
+  }();
+
+  return uris;
+}
+
+void setProcessed(benchmark::State& state, const std::vector<std::string_view>& values) {
+  int64_t bytes = 0;
+  for (auto value : values) {
+    bytes += value.size();
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+} // namespace Micro
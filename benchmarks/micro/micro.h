@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <wge/engine.h>
+
+#include "../test_data/http_info.h"
+
+namespace Micro {
+// The ids of the rules that are loaded into the shared engine. Each operator benchmark evaluates
+// the operator of one rule, so that the operator is constructed and initialized just like in
+// production.
+enum RuleId : uint64_t {
+  RxLiteral = 101,
+  RxRe2 = 102,
+  RxPcre = 103,
+  Pm = 104,
+  PmFromFile = 105,
+  DetectSqli = 106,
+  DetectXss = 107,
+  ValidateByteRange = 108,
+  SingleRule = 200,
+};
+
+// The engine that is shared by all of the benchmarks. The rules above are loaded and the engine is
+// initialized on the first call, which must be made in the main thread.
+const Wge::Engine& engine();
+
+// The white and black requests.
+const std::vector<HttpInfo>& httpInfos();
+
+// The values that the rules usually inspect: the uris, the header values and the bodies of the
+// white and black requests.
+const std::vector<std::string_view>& values();
+
+// The query strings of the uris and the urlencoded bodies of the white and black requests.
+const std::vector<std::string_view>& queries();
+
+// The uris of the white and black requests.
+const std::vector<std::string_view>& uris();
+
+// Report the throughput of processing all of the values once per iteration.
+void setProcessed(benchmark::State& state, const std::vector<std::string_view>& values);
+
+void registerTransformationBenchmarks();
+void registerOperatorBenchmarks();
+void registerParserBenchmarks();
+void registerTransactionBenchmarks();
+void registerStorageBenchmarks();
+} // namespace Micro
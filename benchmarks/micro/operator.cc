@@ -0,0 +1,50 @@
+#include <format>
+#include <vector>
+
+#include <wge/operator/operator_base.h>
+#include <wge/rule.h>
+
+#include "micro.h"
+
+namespace Micro {
+namespace {
+// Evaluate the operator of the rule over the values directly, without the variables and the
+// transformations of the rule.
+void registerOperator(const char* name, RuleId id) {
+  benchmark::RegisterBenchmark(
+      std::format("operator/{}", name).c_str(), [id](benchmark::State& state) {
+        const Wge::Rule* rule = engine().findRuleById(id);
+        if (!rule || rule->operators().empty()) {
+          state.SkipWithError("The rule is not loaded");
+          return;
+        }
+        const Wge::Operator::OperatorBase& op = *rule->operators().front();
+
+        auto& input = values();
+        std::vector<Wge::Common::Variant> operands(input.begin(), input.end());
+        Wge::TransactionPtr t = engine().makeTransaction();
+        Wge::Operator::OperatorBase::Results results;
+        for (auto _ : state) {
+          for (auto& operand : operands) {
+            results.clear();
+            op.evaluate(*t, operand, results);
+            benchmark::DoNotOptimize(results.data());
+          }
+          benchmark::ClobberMemory();
+        }
+        setProcessed(state, input);
+      });
+}
+} // namespace
+
+void registerOperatorBenchmarks() {
+  registerOperator("rx/literal", RxLiteral);
+  registerOperator("rx/re2", RxRe2);
+  registerOperator("rx/pcre", RxPcre);
+  registerOperator("pm", Pm);
+  registerOperator("pmFromFile", PmFromFile);
+  registerOperator("detectSQLi", DetectSqli);
+  registerOperator("detectXSS", DetectXss);
+  registerOperator("validateByteRange", ValidateByteRange);
+}
+} // namespace Micro
@@ -0,0 +1,144 @@
+#include <format>
+#include <forward_list>
+#include <memory_resource>
+#include <string>
+
+#include <wge/common/ragel/json.h>
+#include <wge/common/ragel/multi_part.h>
+#include <wge/common/ragel/query_param.h>
+#include <wge/common/ragel/uri_parser.h>
+#include <wge/common/ragel/xml.h>
+
+#include "micro.h"
+
+namespace Micro {
+namespace {
+constexpr size_t document_repeat = 64;
+
+std::string makeMultiPart() {
+  std::string multi_part;
+  for (size_t i = 0; i < document_repeat; ++i) {
+    multi_part += std::format("----helloworld\r\n"
+                              "content-disposition: form-data; name=field{0}\r\n"
+                              "\r\n"
+                              "value{0} select * from users where id = {0}\r\n"
+                              "----helloworld\r\n"
+                              "content-disposition: form-data; name=file{0}; "
+                              "filename=hello{0}.txt\r\n"
+                              "content-type: text/plain\r\n"
+                              "\r\n"
+                              "<script>alert({0})</script>\r\n",
+                              i);
+  }
+  multi_part += "----helloworld--";
+  return multi_part;
+}
+
+std::string makeJson() {
+  std::string json = R"({"items":[)";
+  for (size_t i = 0; i < document_repeat; ++i) {
+    json += std::format(R"({}{{"id":{},"name":"item\"{}\"","price":{}.5,"tags":["a","b\n"],)"
+                        R"("owner":{{"name":"Jane","active":true,"note":null}}}})",
+                        i ? "," : "", i, i, i);
+  }
+  json += "]}";
+  return json;
+}
+
+std::string makeXml() {
+  std::string xml = R"(<?xml version="1.0" encoding="UTF-8"?><catalog>)";
+  for (size_t i = 0; i < document_repeat; ++i) {
+    xml += std::format(R"(<book id="{0}" lang="en"><title>XML &amp; Guide {0}</title>)"
+                       R"(<author>John Doe</author><price>{0}.5</price></book>)",
+                       i);
+  }
+  xml += "</catalog>";
+  return xml;
+}
+
+void registerQueryParam() {
+  benchmark::RegisterBenchmark("parser/QueryParam", [](benchmark::State& state) {
+    auto& input = queries();
+    Wge::Common::Ragel::QueryParam parser;
+    std::pmr::forward_list<std::pmr::string> buffer;
+    for (auto _ : state) {
+      for (auto query : input) {
+        parser.clear();
+        buffer.clear();
+        parser.init(query, buffer);
+        benchmark::DoNotOptimize(parser.getLinked().data());
+      }
+    }
+    setProcessed(state, input);
+  });
+}
+
+void registerUriParser() {
+  benchmark::RegisterBenchmark("parser/UriParser", [](benchmark::State& state) {
+    auto& input = uris();
+    Wge::Common::Ragel::UriParser parser;
+    std::pmr::forward_list<std::pmr::string> buffer;
+    for (auto _ : state) {
+      for (auto uri : input) {
+        Wge::Transaction::RequestLineInfo request_line_info;
+        buffer.clear();
+        parser.init(uri, request_line_info, buffer);
+        benchmark::DoNotOptimize(request_line_info.query_params_.getLinked().data());
+      }
+    }
+    setProcessed(state, input);
+  });
+}
+
+void registerMultiPart() {
+  benchmark::RegisterBenchmark("parser/MultiPart", [](benchmark::State& state) {
+    const std::string document = makeMultiPart();
+    Wge::Common::Ragel::MultiPart parser;
+    for (auto _ : state) {
+      parser.clear();
+      parser.init("multipart/form-data; boundary=--helloworld", document);
+      benchmark::DoNotOptimize(parser.getNameValueLinked().data());
+    }
+    setProcessed(state, {document});
+  });
+}
+
+void registerJson() {
+  benchmark::RegisterBenchmark("parser/Json", [](benchmark::State& state) {
+    const std::string document = makeJson();
+    Wge::Common::Ragel::Json parser;
+    std::pmr::forward_list<std::pmr::string> buffer;
+    for (auto _ : state) {
+      parser.clear();
+      buffer.clear();
+      parser.init(document, buffer);
+      benchmark::DoNotOptimize(parser.getKeyValuesLinked().data());
+    }
+    setProcessed(state, {document});
+  });
+}
+
+void registerXml() {
+  benchmark::RegisterBenchmark("parser/Xml", [](benchmark::State& state) {
+    const std::string document = makeXml();
+    Wge::Common::Ragel::Xml parser;
+    std::pmr::forward_list<std::pmr::string> buffer;
+    for (auto _ : state) {
+      parser.clear();
+      buffer.clear();
+      parser.init(document, buffer);
+      benchmark::DoNotOptimize(parser.getTags().data());
+    }
+    setProcessed(state, {document});
+  });
+}
+} // namespace
+
+void registerParserBenchmarks() {
+  registerQueryParam();
+  registerUriParser();
+  registerMultiPart();
+  registerJson();
+  registerXml();
+}
+} // namespace Micro
@@ -0,0 +1,102 @@
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wge/persistent_storage/storage.h>
+
+#include "micro.h"
+
+namespace Micro {
+namespace {
+using Storage = Wge::PersistentStorage::Storage;
+
+// The count of the IP collections, each collection has one value, so there are 1M entries
+constexpr size_t collection_count = 1000000;
+
+const std::string& snapshotFile() {
+  static const std::string file =
+      (std::filesystem::temp_directory_path() / "wge_micro_benchmark_storage.snapshot").string();
+  return file;
+}
+
+const std::vector<std::string>& collectionNames() {
+  static const std::vector<std::string> names = []() {
+    std::vector<std::string> names;
+    names.reserve(collection_count);
+    for (size_t i = 0; i < collection_count; ++i) {
+      names.emplace_back(std::format("10.{}.{}.{}", (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff));
+    }
+    return names;
+  }();
+
+  return names;
+}
+
+std::unique_ptr<Storage> makeStorage() {
+  auto storage = std::make_unique<Storage>();
+  int64_t count = 0;
+  for (auto& name : collectionNames()) {
+    storage->initCollection(Storage::Type::IP, name);
+    storage->collection(Storage::Type::IP, name)->set("counter", ++count);
+  }
+
+  return storage;
+}
+
+void registerStore() {
+  // All of the collections are updated before each snapshot, so every shard is serialized
+  benchmark::RegisterBenchmark("storage/store_full", [](benchmark::State& state) {
+    auto storage = makeStorage();
+    int64_t count = 0;
+    for (auto _ : state) {
+      state.PauseTiming();
+      ++count;
+      for (auto& name : collectionNames()) {
+        storage->collection(Storage::Type::IP, name)->set("counter", count);
+      }
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(storage->storeToFile(snapshotFile()));
+    }
+    state.SetItemsProcessed(state.iterations() * collection_count);
+  })->Unit(benchmark::kMillisecond)->Iterations(5);
+
+  // One collection is updated before each snapshot, so the other shards reuse the last serialized
+  // collections
+  benchmark::RegisterBenchmark("storage/store_incremental", [](benchmark::State& state) {
+    auto storage = makeStorage();
+    benchmark::DoNotOptimize(storage->storeToFile(snapshotFile()));
+    int64_t count = 0;
+    for (auto _ : state) {
+      state.PauseTiming();
+      storage->collection(Storage::Type::IP, collectionNames().front())->set("counter", ++count);
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(storage->storeToFile(snapshotFile()));
+    }
+    state.SetItemsProcessed(state.iterations() * collection_count);
+  })->Unit(benchmark::kMillisecond)->Iterations(5);
+}
+
+void registerLoad() {
+  benchmark::RegisterBenchmark("storage/load", [](benchmark::State& state) {
+    makeStorage()->storeToFile(snapshotFile());
+    for (auto _ : state) {
+      state.PauseTiming();
+      auto storage = std::make_unique<Storage>();
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(storage->loadFromFile(snapshotFile()));
+      state.PauseTiming();
+      storage.reset();
+      state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * collection_count);
+  })->Unit(benchmark::kMillisecond)->Iterations(5);
+}
+} // namespace
+
+void registerStorageBenchmarks() {
+  registerStore();
+  registerLoad();
+}
+} // namespace Micro
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <vector>
+
+#include <wge/rule.h>
+#include <wge/transaction.h>
+
+#include "micro.h"
+
+namespace Micro {
+namespace {
+// The request that has the most arguments, so the single rule has something to inspect
+const HttpInfo& pickRequest() {
+  const HttpInfo* picked = &httpInfos().front();
+  size_t max_count = 0;
+  for (auto& http_info : httpInfos()) {
+    size_t count = std::count(http_info.request_uri_.begin(), http_info.request_uri_.end(), '&') +
+                   http_info.request_headers_.size();
+    if (http_info.request_uri_.find('?') != std::string_view::npos && count > max_count) {
+      picked = &http_info;
+      max_count = count;
+    }
+  }
+
+  return *picked;
+}
+
+// Process the request line and the request headers, so the variables of the phase 2 are ready
+void processRequest(Wge::Transaction& t, const HttpInfo& http_info) {
+  Wge::HeaderFind header_find = [&](const std::string& key) {
+    std::vector<std::string_view> result;
+    auto range = http_info.request_headers_.equal_range(key);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      result.emplace_back(iter->second);
+    }
+
+    return result;
+  };
+
+  Wge::HeaderTraversal header_traversal = [&](Wge::HeaderTraversalCallback callback) {
+    for (auto& [key, value] : http_info.request_headers_) {
+      if (!callback(key, value)) {
+        break;
+      }
+    }
+  };
+
+  t.processConnection("192.168.1.100", 20000, "192.168.1.200", 80);
+  t.processUri(http_info.request_uri_, http_info.request_method_, http_info.request_version_);
+  t.processRequestHeaders(header_find, header_traversal, http_info.request_headers_.size());
+}
+
+void registerMakeTransaction() {
+  benchmark::RegisterBenchmark("transaction/make", [](benchmark::State& state) {
+    const Wge::Engine& e = engine();
+    for (auto _ : state) {
+      Wge::TransactionPtr t = e.makeTransaction();
+      benchmark::DoNotOptimize(t.get());
+    }
+  });
+}
+
+void registerRuleEvaluate() {
+  // The transformation cache of the transaction is warm after the first iteration
+  benchmark::RegisterBenchmark("rule/evaluate", [](benchmark::State& state) {
+    const Wge::Rule* rule = engine().findRuleById(SingleRule);
+    Wge::TransactionPtr t = engine().makeTransaction();
+    processRequest(*t, pickRequest());
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(rule->evaluate(*t));
+    }
+  });
+
+  // Each iteration uses a new transaction, so the transformation cache is cold
+  benchmark::RegisterBenchmark("rule/evaluate_cold", [](benchmark::State& state) {
+    const Wge::Rule* rule = engine().findRuleById(SingleRule);
+    const HttpInfo& http_info = pickRequest();
+    for (auto _ : state) {
+      state.PauseTiming();
+      Wge::TransactionPtr t = engine().makeTransaction();
+      processRequest(*t, http_info);
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(rule->evaluate(*t));
+      state.PauseTiming();
+      t.reset();
+      state.ResumeTiming();
+    }
+  });
+}
+} // namespace
+
+void registerTransactionBenchmarks() {
+  registerMakeTransaction();
+  registerRuleEvaluate();
+}
+} // namespace Micro
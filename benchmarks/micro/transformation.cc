@@ -0,0 +1,69 @@
+#include <format>
+#include <memory>
+#include <string>
+
+#include <wge/transformation/transform_include.h>
+
+#include "micro.h"
+
+namespace Micro {
+namespace {
+// Evaluate the transformation directly, without the transformation cache of the transaction, so
+// that the numbers are of the transformation itself.
+template <class T> void registerTransform() {
+  auto transform = std::make_shared<T>();
+  benchmark::RegisterBenchmark(
+      std::format("transformation/{}", transform->name()).c_str(),
+      [transform](benchmark::State& state) {
+        auto& input = values();
+        std::string result;
+        for (auto _ : state) {
+          for (auto value : input) {
+            result.clear();
+            benchmark::DoNotOptimize(transform->evaluate(value, result));
+          }
+          benchmark::ClobberMemory();
+        }
+        setProcessed(state, input);
+      });
+}
+} // namespace
+
+void registerTransformationBenchmarks() {
+  using namespace Wge::Transformation;
+
+  // The base64DecodeExt, base64Encode, md5, sqlHexDecode and urlEncode are not implemented yet
+  registerTransform<Base64Decode>();
+  registerTransform<CmdLine>();
+  registerTransform<CompressWhiteSpace>();
+  registerTransform<CssDecode>();
+  registerTransform<EscapeSeqDecode>();
+  registerTransform<HexDecode>();
+  registerTransform<HexEncode>();
+  registerTransform<HtmlEntityDecode>();
+  registerTransform<JsDecode>();
+  registerTransform<Length>();
+  registerTransform<LowerCase>();
+  registerTransform<NormalisePath>();
+  registerTransform<NormalisePathWin>();
+  registerTransform<NormalizePath>();
+  registerTransform<NormalizePathWin>();
+  registerTransform<ParityEven7Bit>();
+  registerTransform<ParityOdd7Bit>();
+  registerTransform<ParityZero7Bit>();
+  registerTransform<RemoveComments>();
+  registerTransform<RemoveCommentsChar>();
+  registerTransform<RemoveNulls>();
+  registerTransform<RemoveWhitespace>();
+  registerTransform<ReplaceComments>();
+  registerTransform<ReplaceNulls>();
+  registerTransform<Sha1>();
+  registerTransform<Trim>();
+  registerTransform<TrimLeft>();
+  registerTransform<TrimRight>();
+  registerTransform<UpperCase>();
+  registerTransform<UrlDecode>();
+  registerTransform<UrlDecodeUni>();
+  registerTransform<Utf8ToUnicode>();
+}
+} // namespace Micro
@@ -12,10 +12,15 @@ TestData::TestData(Type type) {
   std::string black_data_path =
       std::filesystem::exists("black.data") ? "black.data" : "benchmarks/test_data/black.data";
 
-  std::ifstream ifs(type == Type::White ? white_data_path : black_data_path);
+  load(type == Type::White ? white_data_path : black_data_path);
+}
+
+TestData::TestData(const std::string& file_path) { load(file_path); }
+
+void TestData::load(const std::string& file_path) {
+  std::ifstream ifs(file_path);
   if (!ifs.is_open()) {
-    std::cerr << "Failed to open file: "
-              << (type == Type::White ? white_data_path : black_data_path) << std::endl;
+    std::cerr << "Failed to open file: " << file_path << std::endl;
     exit(1);
   }
 
@@ -14,9 +14,15 @@ public:
 public:
   TestData(Type type);
 
+  // Load the requests from the file, the format is the same as the white.data and black.data
+  TestData(const std::string& file_path);
+
 public:
   const std::vector<HttpInfo>& getHttpInfos() const { return http_infos_; }
 
+private:
+  void load(const std::string& file_path);
+
 private:
   std::vector<HttpInfo> http_infos_;
   std::string buffer_;
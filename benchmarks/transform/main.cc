@@ -0,0 +1,151 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <wge/common/duration.h>
+#include <wge/engine.h>
+#include <wge/transformation/compress_whitespace.h>
+#include <wge/transformation/fused_transform.h>
+#include <wge/transformation/lowercase.h>
+#include <wge/transformation/remove_nulls.h>
+#include <wge/transformation/remove_whitespace.h>
+#include <wge/transformation/replace_nulls.h>
+#include <wge/transformation/url_decode.h>
+#include <wge/variable/tx.h>
+
+#include "../test_data/test_data.h"
+
+struct Chain {
+  std::string name_;
+  std::vector<const Wge::Transformation::TransformBase*> stepwise_;
+  std::vector<const Wge::Transformation::TransformBase*> fused_;
+  std::vector<std::unique_ptr<Wge::Transformation::TransformBase>> fused_holder_;
+};
+
+// Collect the values that the rules usually transform: the uri, the header values and the body
+std::vector<std::string_view> collectValues(const std::vector<HttpInfo>& http_infos) {
+  std::vector<std::string_view> values;
+  for (auto& http_info : http_infos) {
+    values.emplace_back(http_info.request_uri_);
+    for (auto& [key, value] : http_info.request_headers_) {
+      values.emplace_back(value);
+    }
+    values.emplace_back(http_info.request_body_);
+  }
+
+  return values;
+}
+
+// Evaluate the chain over all of the values and return the elapsed milliseconds. Each round uses
+// a new transaction, so the transformation cache is cold at the beginning of each round.
+uint64_t run(Wge::Engine& engine,
+             const std::vector<const Wge::Transformation::TransformBase*>& chain,
+             const std::vector<std::string_view>& values, uint32_t rounds, size_t& transformed) {
+  Wge::Variable::Tx variable("", std::string("benchmark"), std::nullopt, false, false, "");
+  Wge::Common::Duration duration;
+  for (uint32_t round = 0; round < rounds; ++round) {
+    Wge::TransactionPtr t = engine.makeTransaction();
+    for (auto value : values) {
+      Wge::Common::Variant variant = value;
+      Wge::Common::EvaluateElement input(variant, "");
+      Wge::Common::EvaluateElement output;
+      const Wge::Common::EvaluateElement* p_input = &input;
+      for (auto transform : chain) {
+        if (transform->evaluate(*t, &variable, *p_input, output)) {
+          p_input = &output;
+        }
+      }
+      transformed += p_input != &input;
+    }
+  }
+  duration.stop();
+
+  return duration.milliseconds();
+}
+
+void usage(void) {
+  std::cout << "Usage: transform_benchmark [-n rounds] [-h]" << std::endl;
+  std::cout << "  -n rounds: The rounds of evaluating the test data, default is 100" << std::endl;
+  std::cout << "  -h: Show this help message" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t rounds = 100;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:h")) != -1) {
+    switch (opt) {
+    case 'n':
+      try {
+        rounds = std::stoi(optarg);
+      } catch (...) {
+        std::cout << "Invalid rounds value" << std::endl;
+        usage();
+        return 1;
+      }
+      break;
+    case 'h':
+    default:
+      usage();
+      return 0;
+    }
+  }
+
+  // Load Test data
+  TestData test_data_white(TestData::Type::White);
+  TestData test_data_black(TestData::Type::Black);
+  if (test_data_white.getHttpInfos().empty() || test_data_black.getHttpInfos().empty()) {
+    std::cout << "Load test data error" << std::endl;
+    return 1;
+  }
+  std::vector<std::string_view> values = collectValues(test_data_white.getHttpInfos());
+  std::vector<std::string_view> black_values = collectValues(test_data_black.getHttpInfos());
+  values.insert(values.end(), black_values.begin(), black_values.end());
+
+  Wge::Engine engine(spdlog::level::off);
+  engine.init();
+
+  Wge::Transformation::LowerCase lowercase;
+  Wge::Transformation::RemoveNulls remove_nulls;
+  Wge::Transformation::ReplaceNulls replace_nulls;
+  Wge::Transformation::RemoveWhitespace remove_whitespace;
+  Wge::Transformation::CompressWhiteSpace compress_whitespace;
+  Wge::Transformation::UrlDecode url_decode;
+
+  // The chains that are common in the CRS
+  std::vector<Chain> chains(4);
+  chains[0].name_ = "lowercase,removeNulls";
+  chains[0].stepwise_ = {&lowercase, &remove_nulls};
+  chains[1].name_ = "replaceNulls,compressWhitespace,lowercase";
+  chains[1].stepwise_ = {&replace_nulls, &compress_whitespace, &lowercase};
+  chains[2].name_ = "urlDecode,removeNulls,removeWhitespace,lowercase";
+  chains[2].stepwise_ = {&url_decode, &remove_nulls, &remove_whitespace, &lowercase};
+  chains[3].name_ = "removeNulls,compressWhitespace,lowercase,removeWhitespace";
+  chains[3].stepwise_ = {&remove_nulls, &compress_whitespace, &lowercase, &remove_whitespace};
+  for (auto& chain : chains) {
+    chain.fused_ = Wge::Transformation::FusedTransform::fuse(chain.stepwise_, chain.fused_holder_);
+  }
+
+  std::cout << "Values: " << values.size() << " Rounds: " << rounds << std::endl;
+  for (auto& chain : chains) {
+    size_t stepwise_transformed = 0;
+    size_t fused_transformed = 0;
+    uint64_t stepwise_ms = run(engine, chain.stepwise_, values, rounds, stepwise_transformed);
+    uint64_t fused_ms = run(engine, chain.fused_, values, rounds, fused_transformed);
+    if (stepwise_transformed != fused_transformed) {
+      std::cout << "Mismatched result: " << chain.name_ << std::endl;
+      return 1;
+    }
+
+    std::cout << chain.name_ << std::endl;
+    std::cout << "  stepwise: " << stepwise_ms << "ms" << std::endl;
+    std::cout << "  fused:    " << fused_ms << "ms" << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "  speedup:  "
+              << (fused_ms ? static_cast<double>(stepwise_ms) / fused_ms : 0.0) << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+// The count of the allocations that are made by operator new in the current thread. The global
+// operator new is replaced by the benchmark to count the allocations, and the memory is still
+// allocated by malloc, so it works with and without the tcmalloc.
+uint64_t threadAllocationCount();
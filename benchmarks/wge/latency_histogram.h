@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// A HDR (high dynamic range) histogram of the latencies in nanoseconds. The values are recorded
+// into log-linear buckets: each power of two range is divided into 64 sub-buckets, so any value
+// from 1ns to the max of uint64_t is recorded with a relative error less than 1/64. Recording is
+// a few instructions, and the histograms of the threads are merged after the benchmark.
+class LatencyHistogram {
+public:
+  void record(uint64_t value) {
+    ++counts_[indexOf(value)];
+    ++total_count_;
+    max_ = std::max(max_, value);
+  }
+
+  void merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < bucket_count_; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    total_count_ += other.total_count_;
+    max_ = std::max(max_, other.max_);
+  }
+
+  uint64_t count() const { return total_count_; }
+  uint64_t max() const { return max_; }
+
+  // Get the value at the percentile, e.g. 99.9. The highest value that is equivalent to the
+  // recorded values of the bucket is returned, the same as HdrHistogram does.
+  uint64_t valueAtPercentile(double percentile) const {
+    if (total_count_ == 0) {
+      return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * total_count_ + 0.5);
+    target = std::clamp<uint64_t>(target, 1, total_count_);
+    uint64_t count = 0;
+    for (size_t i = 0; i < bucket_count_; ++i) {
+      count += counts_[i];
+      if (count >= target) {
+        return std::min(highestValueOf(i), max_);
+      }
+    }
+
+    return max_;
+  }
+
+private:
+  static constexpr uint32_t sub_bucket_bits_ = 7;
+  static constexpr uint64_t sub_bucket_count_ = 1ull << sub_bucket_bits_;
+  static constexpr uint64_t sub_bucket_half_count_ = sub_bucket_count_ / 2;
+  static constexpr size_t bucket_count_ =
+      sub_bucket_count_ + (64 - sub_bucket_bits_) * sub_bucket_half_count_;
+
+  // The values less than sub_bucket_count_ are recorded exactly. The larger values are shifted
+  // right until they are in [sub_bucket_half_count_, sub_bucket_count_), and the shift count
+  // selects the range.
+  static size_t indexOf(uint64_t value) {
+    if (value < sub_bucket_count_) {
+      return value;
+    }
+
+    uint32_t shift = std::bit_width(value) - sub_bucket_bits_;
+    uint64_t sub_bucket = (value >> shift) - sub_bucket_half_count_;
+    return sub_bucket_count_ + (shift - 1) * sub_bucket_half_count_ + sub_bucket;
+  }
+
+  static uint64_t highestValueOf(size_t index) {
+    if (index < sub_bucket_count_) {
+      return index;
+    }
+
+    uint32_t shift = (index - sub_bucket_count_) / sub_bucket_half_count_ + 1;
+    uint64_t sub_bucket = (index - sub_bucket_count_) % sub_bucket_half_count_;
+    uint64_t lowest = (sub_bucket + sub_bucket_half_count_) << shift;
+    return lowest + ((1ull << shift) - 1);
+  }
+
+private:
+  std::array<uint64_t, bucket_count_> counts_{};
+  uint64_t total_count_{0};
+  uint64_t max_{0};
+};
@@ -1,7 +1,10 @@
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <map>
-#include <mutex>
+#include <memory>
 #include <set>
 #include <thread>
 #include <vector>
@@ -11,41 +14,68 @@
 #include <wge/engine.h>
 
 #include "../test_data/test_data.h"
-
-uint32_t test_count = 0;
-std::mutex mutex;
+#include "allocation_counter.h"
+#include "latency_histogram.h"
+
+// The phases of a request that are timed separately. The transaction is made in the first one.
+enum Phase { RequestHeaders, RequestBody, ResponseHeaders, ResponseBody, PhaseCount };
+constexpr std::array<const char*, PhaseCount> phase_names = {"request headers", "request body",
+                                                             "response headers", "response body"};
+
+// The statistics of a benchmark thread. Each thread records into its own statistics without any
+// synchronization, and they are merged after the threads are joined.
+struct ThreadStats {
+  LatencyHistogram request_;
+  std::array<LatencyHistogram, PhaseCount> phases_;
+  uint64_t allocation_count_{0};
+
+  void merge(const ThreadStats& other) {
+    request_.merge(other.request_);
+    for (size_t i = 0; i < PhaseCount; ++i) {
+      phases_[i].merge(other.phases_[i]);
+    }
+    allocation_count_ += other.allocation_count_;
+  }
+};
+
+// The requests that are replayed, and the name of each part of them
+struct Corpus {
+  std::vector<std::unique_ptr<TestData>> test_data_;
+  std::vector<std::string> names_;
+};
+
+inline uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
 
 #ifndef NDEBUG
 #define DEBUG
 #endif
 
 #ifdef DEBUG
-std::map<size_t, std::set<size_t>> white_request_hit_rules;
-std::map<size_t, std::set<size_t>> black_request_hit_rules;
-
-void recordRuleHit(size_t request_id, int request_type, const std::vector<size_t>& rule_ids) {
-  if (!rule_ids.empty()) {
-    if (request_type == 0) {
-      for (auto& rule_id : rule_ids) {
-        assert(white_request_hit_rules[request_id].find(rule_id) ==
-               white_request_hit_rules[request_id].end());
-        white_request_hit_rules[request_id].insert(rule_id);
-      }
-    } else {
-      for (auto& rule_id : rule_ids) {
-        assert(black_request_hit_rules[request_id].find(rule_id) ==
-               black_request_hit_rules[request_id].end());
-        black_request_hit_rules[request_id].insert(rule_id);
-      }
-    }
+// The hit rules of each request, indexed by the part of the corpus and the request id
+std::vector<std::map<size_t, std::set<size_t>>> request_hit_rules;
+
+void recordRuleHit(size_t request_id, size_t request_type, const std::vector<size_t>& rule_ids) {
+  if (rule_ids.empty()) {
+    return;
+  }
+
+  auto& hit_rules = request_hit_rules[request_type][request_id];
+  for (auto& rule_id : rule_ids) {
+    assert(hit_rules.find(rule_id) == hit_rules.end());
+    hit_rules.insert(rule_id);
   }
 }
 #endif
 
 #ifdef DEBUG
-void process(Wge::Engine& engine, const HttpInfo& http_info, size_t request_id, int request_type) {
+void process(Wge::Engine& engine, const HttpInfo& http_info, ThreadStats& stats,
+             size_t request_id, size_t request_type) {
 #else
-void process(Wge::Engine& engine, const HttpInfo& http_info) {
+void process(Wge::Engine& engine, const HttpInfo& http_info, ThreadStats& stats) {
 #endif
   Wge::HeaderFind request_header_find = [&](const std::string& key) {
     std::vector<std::string_view> result;
@@ -83,6 +113,7 @@ void process(Wge::Engine& engine, const HttpInfo& http_info) {
     }
   };
 
+  uint64_t begin = now();
   auto t = engine.makeTransaction();
   t->processConnection("192.168.1.100", 20000, "192.168.1.200", 80);
   t->processUri(http_info.request_uri_, http_info.request_method_, http_info.request_version_);
@@ -101,6 +132,9 @@ void process(Wge::Engine& engine, const HttpInfo& http_info) {
   t->processRequestHeaders(request_header_find, request_header_traversal,
                            http_info.request_headers_.size());
 #endif
+  uint64_t end = now();
+  stats.phases_[RequestHeaders].record(end - begin);
+  begin = end;
 
 #ifdef DEBUG
   rule_ids.clear();
@@ -116,6 +150,9 @@ void process(Wge::Engine& engine, const HttpInfo& http_info) {
 #else
   t->processRequestBody(http_info.request_body_);
 #endif
+  end = now();
+  stats.phases_[RequestBody].record(end - begin);
+  begin = end;
 
 #ifdef DEBUG
   rule_ids.clear();
@@ -134,6 +171,9 @@ void process(Wge::Engine& engine, const HttpInfo& http_info) {
                             response_header_find, response_header_traversal,
                             http_info.response_headers_.size());
 #endif
+  end = now();
+  stats.phases_[ResponseHeaders].record(end - begin);
+  begin = end;
 
 #ifdef DEBUG
   rule_ids.clear();
@@ -149,36 +189,44 @@ void process(Wge::Engine& engine, const HttpInfo& http_info) {
 #else
   t->processResponseBody(http_info.response_body_);
 #endif
+  stats.phases_[ResponseBody].record(now() - begin);
 }
 
-void thread_func(Wge::Engine& engine, uint32_t max_test_count, const TestData& test_data_white,
-                 const TestData& test_data_black) {
+void thread_func(Wge::Engine& engine, uint32_t max_test_count, const Corpus& corpus,
+                 std::atomic<uint32_t>& test_count, ThreadStats& stats) {
+  uint64_t allocation_count = threadAllocationCount();
   while (true) {
-    auto& white_data = test_data_white.getHttpInfos();
-    auto& black_data = test_data_black.getHttpInfos();
-
+    uint32_t count = 0;
+    for (size_t request_type = 0; request_type < corpus.test_data_.size(); ++request_type) {
+      auto& http_infos = corpus.test_data_[request_type]->getHttpInfos();
+      for (size_t i = 0; i < http_infos.size(); ++i) {
+        // The destruction of the transaction is included
+        uint64_t begin = now();
 #ifdef DEBUG
-    for (size_t i = 0; i < white_data.size(); ++i) {
-      process(engine, white_data[i], i, 0);
-    }
-    for (size_t i = 0; i < black_data.size(); ++i) {
-      process(engine, black_data[i], i, 1);
-    }
+        process(engine, http_infos[i], stats, i, request_type);
 #else
-    for (auto& http_info : white_data) {
-      process(engine, http_info);
-    }
-    for (auto& http_info : black_data) {
-      process(engine, http_info);
-    }
+        process(engine, http_infos[i], stats);
 #endif
+        stats.request_.record(now() - begin);
+      }
+      count += http_infos.size();
+    }
 
-    std::lock_guard<std::mutex> lock(mutex);
-    test_count += white_data.size() + black_data.size();
-    if (test_count >= max_test_count) {
+    if (test_count.fetch_add(count, std::memory_order_relaxed) + count >= max_test_count) {
       break;
     }
   }
+  stats.allocation_count_ += threadAllocationCount() - allocation_count;
+}
+
+void printLatency(const char* name, const LatencyHistogram& histogram) {
+  auto us = [](uint64_t ns) { return ns / 1000.0; };
+  std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+            << std::setprecision(3) << std::setw(12) << us(histogram.valueAtPercentile(50))
+            << std::setw(12) << us(histogram.valueAtPercentile(90)) << std::setw(12)
+            << us(histogram.valueAtPercentile(99)) << std::setw(12)
+            << us(histogram.valueAtPercentile(99.9)) << std::setw(12) << us(histogram.max())
+            << std::endl;
 }
 
 void usage(void);
@@ -195,7 +243,9 @@ int main(int argc, char* argv[]) {
 
   // Parse command line arguments
   int opt;
-  while ((opt = getopt(argc, argv, "c:n:h")) != -1) {
+  std::vector<std::string> corpus_files;
+  std::string snapshot_file;
+  while ((opt = getopt(argc, argv, "c:n:f:s:h")) != -1) {
     switch (opt) {
     case 'c':
       try {
@@ -215,6 +265,12 @@ int main(int argc, char* argv[]) {
         return 1;
       }
       break;
+    case 'f':
+      corpus_files.emplace_back(optarg);
+      break;
+    case 's':
+      snapshot_file = optarg;
+      break;
     case 'h':
     default:
       usage();
@@ -222,18 +278,31 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  // Load Test data
-  TestData test_data_white(TestData::Type::White);
-  if (test_data_white.getHttpInfos().empty()) {
-    std::cout << "Load white test data error" << std::endl;
-    return 1;
+  // Load Test data. The external corpus replaces the white and black test data if it is specified
+  Corpus corpus;
+  if (corpus_files.empty()) {
+    corpus.test_data_.emplace_back(std::make_unique<TestData>(TestData::Type::White));
+    corpus.names_.emplace_back("White");
+    corpus.test_data_.emplace_back(std::make_unique<TestData>(TestData::Type::Black));
+    corpus.names_.emplace_back("Black");
+  } else {
+    for (auto& corpus_file : corpus_files) {
+      corpus.test_data_.emplace_back(std::make_unique<TestData>(corpus_file));
+      corpus.names_.emplace_back(corpus_file);
+    }
   }
-
-  TestData test_data_black(TestData::Type::Black);
-  if (test_data_black.getHttpInfos().empty()) {
-    std::cout << "Load black test data error" << std::endl;
-    return 1;
+  size_t corpus_size = 0;
+  for (size_t i = 0; i < corpus.test_data_.size(); ++i) {
+    if (corpus.test_data_[i]->getHttpInfos().empty()) {
+      std::cout << "Load " << corpus.names_[i] << " test data error" << std::endl;
+      return 1;
+    }
+    corpus_size += corpus.test_data_[i]->getHttpInfos().size();
   }
+  std::cout << "Corpus: " << corpus_size << " requests" << std::endl;
+#ifdef DEBUG
+  request_hit_rules.resize(corpus.test_data_.size());
+#endif
 
   // Load rules
   Wge::Engine engine(spdlog::level::off);
@@ -277,34 +346,66 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  for (auto& rule_file : rule_files) {
-    result = engine.loadFromFile(rule_file);
-    if (!result.has_value()) {
-      std::cout << "Load rules error: " << result.error() << std::endl;
-      return 1;
+  result = engine.loadFromFiles(rule_files);
+  if (!result.has_value()) {
+    std::cout << "Load rules error: " << result.error() << std::endl;
+    return 1;
+  }
+
+  // Load the snapshot if it exists, otherwise save it after the engine is initialized
+  bool snapshot_loaded = false;
+  if (!snapshot_file.empty()) {
+    result = engine.loadSnapshot(snapshot_file);
+    if (result.has_value()) {
+      snapshot_loaded = true;
+    } else {
+      std::cout << "Load snapshot error: " << result.error() << std::endl;
     }
   }
 
   engine.init();
 
+  if (!snapshot_file.empty() && !snapshot_loaded) {
+    result = engine.saveSnapshot(snapshot_file);
+    if (!result.has_value()) {
+      std::cout << "Save snapshot error: " << result.error() << std::endl;
+    }
+  }
+
+  const Wge::Engine::StartupStats& startup_stats = engine.startupStats();
+  std::cout << "startup: load " << startup_stats.load_ms_ << "ms, init rules "
+            << startup_stats.init_rules_ms_ << "ms, compile " << startup_stats.operator_count_
+            << " operators " << startup_stats.compile_ms_ << "ms by "
+            << startup_stats.compile_concurrency_ << " threads, "
+            << startup_stats.snapshot_database_count_ << " databases in the snapshot"
+            << std::endl;
+
 #ifndef DEBUG
   // CPU warmup
-  std::vector<std::thread> warmup_threads;
-  for (int i = 0; i < concurrency; ++i) {
-    warmup_threads.emplace_back(std::thread(thread_func, std::ref(engine), 1000,
-                                            std::ref(test_data_white), std::ref(test_data_black)));
-  }
-  for (auto& thread : warmup_threads) {
-    thread.join();
+  {
+    std::atomic<uint32_t> warmup_count{0};
+    std::vector<ThreadStats> warmup_stats(concurrency);
+    std::vector<std::thread> warmup_threads;
+    for (int i = 0; i < concurrency; ++i) {
+      warmup_threads.emplace_back(std::thread(thread_func, std::ref(engine), 1000,
+                                              std::cref(corpus), std::ref(warmup_count),
+                                              std::ref(warmup_stats[i])));
+    }
+    for (auto& thread : warmup_threads) {
+      thread.join();
+    }
   }
 #endif
 
   // Start benchmark
+  std::atomic<uint32_t> test_count{0};
+  std::vector<ThreadStats> thread_stats(concurrency);
   std::vector<std::thread> threads;
   Wge::Common::Duration duration;
   for (int i = 0; i < concurrency; ++i) {
     threads.emplace_back(std::thread(thread_func, std::ref(engine), max_test_count,
-                                     std::ref(test_data_white), std::ref(test_data_black)));
+                                     std::cref(corpus), std::ref(test_count),
+                                     std::ref(thread_stats[i])));
   }
 
   // Wait for all threads to finish
@@ -315,23 +416,32 @@ int main(int argc, char* argv[]) {
 // Print benchmark result
 #ifndef DEBUG
   duration.stop();
+  ThreadStats stats;
+  for (auto& thread_stat : thread_stats) {
+    stats.merge(thread_stat);
+  }
+
   std::cout << "Test count: " << test_count << std::endl;
   std::cout << "Total time: " << duration.milliseconds() << "ms" << std::endl;
   std::cout << std::fixed << std::setprecision(3)
             << "QPS:" << 1000.0 * test_count / duration.milliseconds() << std::endl;
+  std::cout << "Allocations per request: "
+            << static_cast<double>(stats.allocation_count_) / stats.request_.count() << std::endl;
+  std::cout << std::left << std::setw(18) << "Latency(us)" << std::right << std::setw(12) << "p50"
+            << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(12) << "p99.9"
+            << std::setw(12) << "max" << std::endl;
+  printLatency("request", stats.request_);
+  for (size_t i = 0; i < PhaseCount; ++i) {
+    printLatency(phase_names[i], stats.phases_[i]);
+  }
 #else
   // In debug mode, print the hit rules for each request
-  for (const auto& [request_id, hit_rules] : white_request_hit_rules) {
-    std::cout << "White: " << request_id << std::endl;
-    for (const auto& rule_id : hit_rules) {
-      std::cout << rule_id << std::endl;
-    }
-  }
-
-  for (const auto& [request_id, hit_rules] : black_request_hit_rules) {
-    std::cout << "Black: " << request_id << std::endl;
-    for (const auto& rule_id : hit_rules) {
-      std::cout << rule_id << std::endl;
+  for (size_t i = 0; i < request_hit_rules.size(); ++i) {
+    for (const auto& [request_id, hit_rules] : request_hit_rules[i]) {
+      std::cout << corpus.names_[i] << ": " << request_id << std::endl;
+      for (const auto& rule_id : hit_rules) {
+        std::cout << rule_id << std::endl;
+      }
     }
   }
 #endif
@@ -340,11 +450,19 @@ int main(int argc, char* argv[]) {
 }
 
 void usage() {
-  std::cout << R"(USAGE: modsecurity_benchmark [-c concurrency] [-n test count]
+  std::cout << R"(USAGE: wge_benchmark [-c concurrency] [-n test count] [-f corpus file]...
+                     [-s snapshot]
        -c concurrency
                thread count, default is the number of CPU cores
        -n test count
-               the maximum requests number of tests, default 10000000
+               the maximum requests number of tests, default 100000
+       -f corpus file
+               replay the requests in the file instead of the white and black test data. The
+               format is the same as benchmarks/test_data/white.data. It can be specified
+               multiple times
+       -s snapshot
+               load the hyperscan databases from the snapshot file to skip compiling them. If
+               the snapshot can't be loaded, it is saved after the engine is initialized
 
 )" << std::endl;
-}
\ No newline at end of file
+}
@@ -23,6 +23,7 @@
 #include "ctl.h"
 #include "initcol.h"
 #include "set_env.h"
+#include "set_persistent_var.h"
 #include "set_rsc.h"
 #include "set_sid.h"
 #include "set_uid.h"
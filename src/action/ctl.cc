@@ -127,14 +127,13 @@ void Ctl::initRules(const Engine& engin) {
 
 void Ctl::evaluate_audit_engine(Transaction& t) const {
   AuditLogConfig::AuditEngine option = std::any_cast<AuditLogConfig::AuditEngine>(value_);
-  UNREACHABLE();
-  throw "Not implemented!";
+  t.setAuditEngine(option);
 }
 
 void Ctl::evaluate_audit_log_parts(Transaction& t) const {
-  const std::string& parts = std::any_cast<std::string>(value_);
-  UNREACHABLE();
-  throw "Not implemented!";
+  const auto& [add, parts] =
+      std::any_cast<const std::pair<bool, AuditLogConfig::AuditLogParts>&>(value_);
+  t.setAuditLogParts(add, parts);
 }
 
 void Ctl::evaluate_parse_xml_into_args(Transaction& t) const {
@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "set_persistent_var.h"
+
+#include "../common/log.h"
+#include "../engine.h"
+
+namespace Wge {
+namespace Action {
+SetPersistentVar::SetPersistentVar(ActionBase::Branch branch, PersistentStorage::Storage::Type type,
+                                   std::string&& key, int64_t delta)
+    : ActionBase(branch), type_(type), key_(std::move(key)), delta_(delta) {}
+
+void SetPersistentVar::evaluate(Transaction& t) const {
+  std::string_view collection_name = t.getPersistentStorageKey(type_);
+  auto collection = t.getEngine().storage().collection(type_, collection_name);
+  if (!collection)
+    [[unlikely]] {
+      WGE_LOG_WARN("setvar: the persistent collection of {} isn't initialized, ignored.", key_);
+      return;
+    }
+
+  WGE_LOG_TRACE("setvar(Increase): {}+={}", key_, delta_);
+  collection->increase(key_, delta_);
+}
+} // namespace Action
+} // namespace Wge
@@ -90,6 +90,7 @@ SecAuditLogRelevantStatus:
 SecAuditLogStorageDir:
 	'SecAuditLogStorageDir' -> pushMode(ModeAuditLogString);
 SecAuditLogType: 'SecAuditLogType' -> pushMode(ModeAuditLog);
+SecBodyStreamOverlap: 'SecBodyStreamOverlap';
 SecCollectionTimeout: 'SecCollectionTimeout';
 SecPmfSerializeDir:
 	'SecPmfSerializeDir' -> pushMode(ModeAuditLogString);
@@ -138,6 +139,8 @@ SecRuleUpdateTargetByMsg:
 SecRuleUpdateTargetByTag:
 	'SecRuleUpdateTargetByTag' -> pushMode(ModeRuleUpdateTargetByMsg);
 SecRule: 'SecRule' -> pushMode(ModeSecRule);
+SecSharedStorage:
+	'SecSharedStorage' -> pushMode(ModeAuditLogString);
 SecStatusEngine: 'SecStatusEngine';
 SecTmpDir: 'SecTmpDir' -> pushMode(ModeAuditLogString);
 SecTmpSaveUploadedFiles: 'SecTmpSaveUploadedFiles';
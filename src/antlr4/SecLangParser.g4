@@ -47,6 +47,8 @@ engine_config:
 	| sec_xml_external_entity
 	| sec_request_body_limit
 	| sec_request_body_no_files_limit
+	| sec_request_body_in_memory_limit
+	| sec_body_stream_overlap
 	| sec_request_body_json_depth_limit
 	| sec_request_body_action
 	| sec_response_body_limit
@@ -62,6 +64,7 @@ engine_config:
 	| sec_pcre_match_limit
 	| sec_pcre_match_limit_recursion
 	| sec_collection_timeout
+	| sec_shared_storage
 	| sec_pmf_serialize_dir;
 sec_reqeust_body_access: SecRequestBodyAccess OPTION;
 sec_response_body_mime_type: SecResponseBodyMimeType MIME_TYPES;
@@ -75,6 +78,9 @@ sec_upload_keep_files: SecUploadKeepFiles OPTION;
 sec_xml_external_entity: SecXmlExternalEntity OPTION;
 sec_request_body_limit: SecRequestBodyLimit INT;
 sec_request_body_no_files_limit: SecRequestBodyNoFilesLimit INT;
+sec_request_body_in_memory_limit:
+	SecRequestBodyInMemoryLimit INT;
+sec_body_stream_overlap: SecBodyStreamOverlap INT;
 sec_request_body_json_depth_limit:
 	SecRequestBodyJsonDepthLimit INT;
 sec_request_body_action:
@@ -93,6 +99,7 @@ sec_parse_xml_into_args: SecParseXmlIntoArgs OPTION;
 sec_pcre_match_limit: SecPcreMatchLimit INT;
 sec_pcre_match_limit_recursion: SecPcreMatchLimitRecursion INT;
 sec_collection_timeout: SecCollectionTimeout INT;
+sec_shared_storage: SecSharedStorage STRING INT;
 sec_pmf_serialize_dir: SecPmfSerializeDir STRING;
 
 engine_action: sec_action | sec_default_action;
@@ -1150,7 +1157,8 @@ action_non_disruptive_setvar:
 	| action_non_disruptive_setvar_create_init
 	| action_non_disruptive_setvar_remove
 	| action_non_disruptive_setvar_increase
-	| action_non_disruptive_setvar_decrease;
+	| action_non_disruptive_setvar_decrease
+	| action_non_disruptive_setvar_persistent_increase;
 action_non_disruptive_setvar_create:
 	(ALWAYS | UNMATCHED)? Setvar COLON (
 		(
@@ -1223,6 +1231,13 @@ action_non_disruptive_setvar_decrease:
 			)
 		)
 	);
+action_non_disruptive_setvar_persistent_increase:
+	(ALWAYS | UNMATCHED)? Setvar COLON (
+		(
+			SINGLE_QUOTE VAR_NAME DOT VAR_NAME ASSIGN (PLUS | MINUS) VAR_VALUE SINGLE_QUOTE
+		)
+		| (VAR_NAME DOT VAR_NAME ASSIGN (PLUS | MINUS) VAR_VALUE)
+	);
 
 action_non_disruptive_setenv:
 	(ALWAYS | UNMATCHED)? Setenv COLON SINGLE_QUOTE VAR_NAME ASSIGN (
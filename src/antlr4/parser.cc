@@ -23,6 +23,7 @@
 #include <array>
 #include <format>
 #include <fstream>
+#include <memory>
 #include <string_view>
 
 #include "antlr4_gen/SecLangLexer.h"
@@ -30,6 +31,8 @@
 #include "visitor.h"
 
 #include "../common/assert.h"
+#include "../common/parallel.h"
+#include "../common/sha1.h"
 #include "../common/try.h"
 #include "../operator/begins_with.h"
 #include "../operator/contains.h"
@@ -75,6 +78,80 @@ public:
   std::string error_msg;
 };
 
+// The parse tree of a configuration and the ANTLR objects that the tree refers to. Lexing and
+// parsing don't touch the state of the Parser, so the different configurations can be parsed
+// concurrently. The tree is visited later by the Parser.
+class ParsedConfiguration {
+public:
+  ParsedConfiguration(const std::string& file_path)
+      : file_path_(file_path), parser_error_listener_(file_path_) {}
+
+public:
+  /**
+   * Lex and parse the configuration file
+   * @result An error string is returned if fails, and returned true otherwise
+   */
+  std::expected<bool, std::string> parseFile() {
+    std::ifstream ifs(file_path_);
+    if (!ifs.is_open()) {
+      return std::unexpected(std::format("open file {} failed", file_path_));
+    }
+    text_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    input_ = std::make_unique<antlr4::ANTLRInputStream>(text_);
+    return parse();
+  }
+
+  /**
+   * Lex and parse the configuration directive
+   * @result An error string is returned if fails, and returned true otherwise
+   */
+  std::expected<bool, std::string> parseDirective(const std::string& directive) {
+    text_ = directive;
+    input_ = std::make_unique<antlr4::ANTLRInputStream>(text_);
+    return parse();
+  }
+
+  const std::string& filePath() const { return file_path_; }
+  const std::string& text() const { return text_; }
+  antlr4::tree::ParseTree* tree() const { return tree_; }
+
+private:
+  std::expected<bool, std::string> parse() {
+    lexer_ = std::make_unique<Antlr4Gen::SecLangLexer>(input_.get());
+    tokens_ = std::make_unique<antlr4::CommonTokenStream>(lexer_.get());
+    parser_ = std::make_unique<Antlr4Gen::SecLangParser>(tokens_.get());
+
+    // Sets error listener
+    // parser_->setBuildParseTree(true);
+    parser_->removeErrorListeners();
+    parser_->addErrorListener(&parser_error_listener_);
+    lexer_->removeErrorListeners();
+    lexer_->addErrorListener(&lexer_error_listener_);
+
+    // Parse
+    tree_ = parser_->configuration();
+    if (!parser_error_listener_.error_msg.empty()) {
+      return std::unexpected(parser_error_listener_.error_msg);
+    }
+    if (!lexer_error_listener_.error_msg.empty()) {
+      return std::unexpected(lexer_error_listener_.error_msg);
+    }
+
+    return true;
+  }
+
+private:
+  std::string file_path_;
+  std::string text_;
+  ParserErrorListener parser_error_listener_;
+  LexerErrorListener lexer_error_listener_;
+  std::unique_ptr<antlr4::ANTLRInputStream> input_;
+  std::unique_ptr<Antlr4Gen::SecLangLexer> lexer_;
+  std::unique_ptr<antlr4::CommonTokenStream> tokens_;
+  std::unique_ptr<Antlr4Gen::SecLangParser> parser_;
+  antlr4::tree::ParseTree* tree_{nullptr};
+};
+
 Parser::Parser() {
   constexpr size_t tx_variable_index_size = 1000;
   auto inserted_iter = tx_variable_index_.emplace("", TxVariableIndex{}).first;
@@ -83,96 +160,82 @@ Parser::Parser() {
 }
 
 std::expected<bool, std::string> Parser::loadFromFile(const std::string& file_path) {
-  // Init
-  std::ifstream ifs(file_path);
-  if (!ifs.is_open()) {
-    return std::unexpected(std::format("open file {} failed", file_path));
-  }
-  antlr4::ANTLRInputStream input(ifs);
-  Antlr4Gen::SecLangLexer lexer(&input);
-  antlr4::CommonTokenStream tokens(&lexer);
-  Antlr4Gen::SecLangParser parser(&tokens);
-
-  // Sets error listener
-  ParserErrorListener parser_error_listener(file_path);
-  LexerErrorListener lexer_error_listener;
-  // parser.setBuildParseTree(true);
-  parser.removeErrorListeners();
-  parser.addErrorListener(&parser_error_listener);
-  lexer.removeErrorListeners();
-  lexer.addErrorListener(&lexer_error_listener);
-
-  // Parse
-  auto tree = parser.configuration();
-  if (!parser_error_listener.error_msg.empty()) {
-    return std::unexpected(parser_error_listener.error_msg);
-  }
-  if (!lexer_error_listener.error_msg.empty()) {
-    return std::unexpected(lexer_error_listener.error_msg);
+  ParsedConfiguration parsed(file_path);
+  auto result = parsed.parseFile();
+  if (!result.has_value()) {
+    return result;
   }
 
-  // Push the file path to the stack
-  const auto& [inserted_file_iter, success] = loaded_file_paths_.emplace(file_path);
-  if (success) {
-    curr_load_file_.push(*inserted_file_iter);
-  } else {
-    auto iter = loaded_file_paths_.find(file_path);
-    if (iter != loaded_file_paths_.end()) {
-      curr_load_file_.push(*iter);
-    }
-  }
+  return visit(parsed);
+}
 
-  // Visit
-  std::string error;
-  Visitor vistor(this);
-  TRY_NOCATCH(error = std::any_cast<std::string>(vistor.visit(tree)));
+std::expected<bool, std::string> Parser::loadFromFiles(const std::vector<std::string>& file_paths,
+                                                       size_t concurrency) {
+  // Lex and parse the files concurrently
+  std::vector<std::unique_ptr<ParsedConfiguration>> parsed(file_paths.size());
+  std::vector<std::expected<bool, std::string>> results(file_paths.size());
+  Common::parallelFor(file_paths.size(), concurrency, [&](size_t i) {
+    parsed[i] = std::make_unique<ParsedConfiguration>(file_paths[i]);
+    results[i] = parsed[i]->parseFile();
+  });
 
-  curr_load_file_.pop();
+  // Visit the parse trees in the order of the files, so the result is the same as loading the
+  // files one by one. The parse tree is released as soon as it is visited.
+  for (size_t i = 0; i < parsed.size(); ++i) {
+    if (!results[i].has_value()) {
+      return results[i];
+    }
 
-  if (!error.empty()) {
-    return std::unexpected(error);
+    auto result = visit(*parsed[i]);
+    if (!result.has_value()) {
+      return result;
+    }
+    parsed[i].reset();
   }
 
   return true;
 }
 
 std::expected<bool, std::string> Parser::load(const std::string& directive) {
-  // init
-  antlr4::ANTLRInputStream input(directive);
-  Antlr4Gen::SecLangLexer lexer(&input);
-  antlr4::CommonTokenStream tokens(&lexer);
-  Antlr4Gen::SecLangParser parser(&tokens);
-
-  // sets error listener
-  ParserErrorListener parser_error_listener("");
-  LexerErrorListener lexer_error_listener;
-  // parser.setBuildParseTree(true);
-  parser.removeErrorListeners();
-  parser.addErrorListener(&parser_error_listener);
-  lexer.removeErrorListeners();
-  lexer.addErrorListener(&lexer_error_listener);
-
-  // parse
-  auto tree = parser.configuration();
-  if (!parser_error_listener.error_msg.empty()) {
-    return std::unexpected(parser_error_listener.error_msg);
-  }
-  if (!lexer_error_listener.error_msg.empty()) {
-    return std::unexpected(lexer_error_listener.error_msg);
-  }
-
-  // visit
+  ParsedConfiguration parsed("");
+  auto result = parsed.parseDirective(directive);
+  if (!result.has_value()) {
+    return result;
+  }
+
+  return visit(parsed);
+}
+
+std::expected<bool, std::string> Parser::visit(const ParsedConfiguration& parsed) {
+  // Push the file path to the stack
+  const std::string& file_path = parsed.filePath();
+  if (!file_path.empty()) {
+    const auto& [inserted_file_iter, success] = loaded_file_paths_.emplace(file_path);
+    curr_load_file_.push(*inserted_file_iter);
+  }
+
+  // Visit
   std::string error;
   Visitor vistor(this);
-  TRY_NOCATCH(error = std::any_cast<std::string>(vistor.visit(tree)));
+  TRY_NOCATCH(error = std::any_cast<std::string>(vistor.visit(parsed.tree())));
+
+  if (!file_path.empty()) {
+    curr_load_file_.pop();
+  }
 
   if (!error.empty()) {
     return std::unexpected(error);
   }
 
+  // The configurations are digested in the order that they are visited completely, so an included
+  // file is digested before the file that includes it.
+  config_digests_ += Common::Sha1::marshal(parsed.text(), true);
+
   return true;
 }
 
+std::string Parser::ruleSetHash() const { return Common::Sha1::marshal(config_digests_, true); }
+
 void Parser::secRuleEngine(EngineConfig::Option option) {
   engine_config_.rule_engine_option_ = option;
 }
@@ -211,6 +274,12 @@ void Parser::secRequestBodyNoFilesLimit(uint64_t limit_bytes) {
   engine_config_.request_body_no_files_limit_ = limit_bytes;
 }
 
+void Parser::secRequestBodyInMemoryLimit(uint64_t limit_bytes) {
+  engine_config_.request_body_in_memory_limit_ = limit_bytes;
+}
+
+void Parser::secBodyStreamOverlap(uint32_t size) { engine_config_.body_stream_overlap_ = size; }
+
 void Parser::secRequestBodyJsonDepthLimit(uint64_t limit) {
   engine_config_.request_body_json_depth_limit_ = limit;
 }
@@ -231,6 +300,17 @@ void Parser::secArgumentsLimit(uint32_t limit_bytes) {
   engine_config_.arguments_limit_ = limit_bytes;
 }
 
+void Parser::secCollectionTimeout(uint32_t timeout) {
+  engine_config_.collection_timeout_ = timeout;
+}
+
+void Parser::secDataDir(std::string&& dir) { engine_config_.data_dir_ = std::move(dir); }
+
+void Parser::secSharedStorage(std::string&& name, uint32_t capacity) {
+  engine_config_.shared_storage_name_ = std::move(name);
+  engine_config_.shared_storage_capacity_ = capacity;
+}
+
 void Parser::secArgumentSeparator(char separator) {
   engine_config_.argument_separator_ = separator;
 }
@@ -403,48 +483,7 @@ void Parser::secAuditLogFormat(AuditLogConfig::AuditFormat format) {
 void Parser::secAuditLogFileMode(int mode) { audit_log_config_.file_mode_ = mode; }
 
 void Parser::secAuditLogParts(const std::string& parts) {
-  for (auto ch : parts) {
-    switch (ch) {
-    case 'A':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::A)] = true;
-      break;
-    case 'B':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::B)] = true;
-      break;
-    case 'C':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::C)] = true;
-      break;
-    case 'D':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::D)] = true;
-      break;
-    case 'E':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::E)] = true;
-      break;
-    case 'F':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::F)] = true;
-      break;
-    case 'G':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::G)] = true;
-      break;
-    case 'H':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::H)] = true;
-      break;
-    case 'I':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::I)] = true;
-      break;
-    case 'J':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::J)] = true;
-      break;
-    case 'K':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::K)] = true;
-      break;
-    case 'Z':
-      audit_log_config_.log_parts_[static_cast<int>(AuditLogConfig::AuditLogPart::Z)] = true;
-      break;
-    default:
-      break;
-    }
-  }
+  audit_log_config_.log_parts_ = AuditLogConfig::parseLogParts(parts);
 }
 
 void Parser::secAuditLogRelevantStatus(std::string&& pattern) {
@@ -31,11 +31,13 @@
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "../config.h"
 #include "../rule.h"
 
 namespace Wge::Antlr4 {
+class ParsedConfiguration;
 
 /**
  * SecLang parser
@@ -52,6 +54,18 @@ public:
    */
   std::expected<bool, std::string> loadFromFile(const std::string& file_path);
 
+  /**
+   * Load the rule set from the files
+   * The files are lexed and parsed concurrently, and then visited in the order of the files, so
+   * the result is the same as calling loadFromFile for each file in order.
+   * @param file_paths supports relative and absolute path
+   * @param concurrency the max count of the threads that parse the files. If it is 0, the hardware
+   * concurrency is used.
+   * @result An error string is returned if fails, and returned true otherwise
+   */
+  std::expected<bool, std::string> loadFromFiles(const std::vector<std::string>& file_paths,
+                                                 size_t concurrency);
+
   /**
    * Load the rule set from a configuration directive
    * @param directive Configuration directive
@@ -73,11 +87,16 @@ public:
   void secXmlExternalEntity(bool value);
   void secRequestBodyLimit(uint64_t limit_bytes);
   void secRequestBodyNoFilesLimit(uint64_t limit_bytes);
+  void secRequestBodyInMemoryLimit(uint64_t limit_bytes);
+  void secBodyStreamOverlap(uint32_t size);
   void secRequestBodyJsonDepthLimit(uint64_t limit);
   void secRequsetBodyLimitAction(EngineConfig::BodyLimitAction action);
   void secResponseBodyLimit(uint64_t limit_bytes);
   void secResponseBodyLimitAction(EngineConfig::BodyLimitAction action);
   void secArgumentsLimit(uint32_t limit_bytes);
+  void secCollectionTimeout(uint32_t timeout);
+  void secDataDir(std::string&& dir);
+  void secSharedStorage(std::string&& name, uint32_t capacity);
   void secArgumentSeparator(char separator);
   void secUnicodeMapFile(std::string&& file_path, uint32_t code_point);
   void secParseXmlIntoArgs(ParseXmlIntoArgsOption option);
@@ -138,6 +157,12 @@ public:
   Rule* findRuleById(uint64_t id);
   std::unordered_set<Rule*> findRuleByMsg(const std::string& msg);
   std::unordered_set<Rule*> findRuleByTag(const std::string& tag);
+  /**
+   * Get the hash of the rule set
+   * @return the hex SHA1 of the all loaded configuration texts in the order of loading
+   */
+  std::string ruleSetHash() const;
+
   std::string_view currLoadFile() const {
     return curr_load_file_.empty() ? "" : curr_load_file_.top();
   }
@@ -151,6 +176,9 @@ public:
   void setCurrentNamespace(const std::string& ns) { curr_namespace_ = ns; }
   const std::string& getCurrentNamespace() const { return curr_namespace_; }
 
+private:
+  std::expected<bool, std::string> visit(const ParsedConfiguration& parsed);
+
 private:
   std::array<std::vector<Rule>, PHASE_TOTAL> rules_;
   std::array<std::optional<Rule>, PHASE_TOTAL> default_actions_rules_;
@@ -165,6 +193,9 @@ private:
   std::set<std::string> loaded_file_paths_;
   std::stack<std::string_view> curr_load_file_;
 
+  // The concatenated SHA1 of the loaded configuration texts
+  std::string config_digests_;
+
   struct TxVariableIndex {
     std::unordered_map<std::string, size_t> index_;
     std::vector<std::string> index_reverse_;
@@ -130,6 +130,18 @@ std::any Visitor::visitSec_request_body_no_files_limit(
   return EMPTY_STRING;
 }
 
+std::any Visitor::visitSec_request_body_in_memory_limit(
+    Antlr4Gen::SecLangParser::Sec_request_body_in_memory_limitContext* ctx) {
+  parser_->secRequestBodyInMemoryLimit(::atoll(ctx->INT()->getText().c_str()));
+  return EMPTY_STRING;
+}
+
+std::any Visitor::visitSec_body_stream_overlap(
+    Antlr4Gen::SecLangParser::Sec_body_stream_overlapContext* ctx) {
+  parser_->secBodyStreamOverlap(::atol(ctx->INT()->getText().c_str()));
+  return EMPTY_STRING;
+}
+
 std::any Visitor::visitSec_request_body_json_depth_limit(
     Antlr4Gen::SecLangParser::Sec_request_body_json_depth_limitContext* ctx) {
   parser_->secRequestBodyJsonDepthLimit(::atoll(ctx->INT()->getText().c_str()));
@@ -169,8 +181,7 @@ std::any Visitor::visitSec_tmp_dir(Antlr4Gen::SecLangParser::Sec_tmp_dirContext*
 }
 
 std::any Visitor::visitSec_data_dir(Antlr4Gen::SecLangParser::Sec_data_dirContext* ctx) {
-  // Not supported in v3
-  WGE_LOG_WARN("SecDataDir is not supported yet.");
+  parser_->secDataDir(ctx->STRING()->getText());
   return EMPTY_STRING;
 }
 
@@ -264,8 +275,13 @@ std::any Visitor::visitSec_pcre_match_limit_recursion(
 
 std::any
 Visitor::visitSec_collection_timeout(Antlr4Gen::SecLangParser::Sec_collection_timeoutContext* ctx) {
-  // Not supported in v3
-  WGE_LOG_WARN("SecCollectionTimeout is not supported yet.");
+  parser_->secCollectionTimeout(::atol(ctx->INT()->getText().c_str()));
+  return EMPTY_STRING;
+}
+
+std::any
+Visitor::visitSec_shared_storage(Antlr4Gen::SecLangParser::Sec_shared_storageContext* ctx) {
+  parser_->secSharedStorage(ctx->STRING()->getText(), ::atol(ctx->INT()->getText().c_str()));
   return EMPTY_STRING;
 }
 
@@ -1610,6 +1626,49 @@ std::any Visitor::visitAction_non_disruptive_setvar_decrease(
   return EMPTY_STRING;
 };
 
+std::any Visitor::visitAction_non_disruptive_setvar_persistent_increase(
+    Antlr4Gen::SecLangParser::Action_non_disruptive_setvar_persistent_increaseContext* ctx) {
+  static const std::unordered_map<std::string, Wge::PersistentStorage::Storage::Type>
+      collection_types = {{"global", Wge::PersistentStorage::Storage::Type::GLOBAL},
+                          {"resource", Wge::PersistentStorage::Storage::Type::RESOURCE},
+                          {"ip", Wge::PersistentStorage::Storage::Type::IP},
+                          {"session", Wge::PersistentStorage::Storage::Type::SESSION},
+                          {"user", Wge::PersistentStorage::Storage::Type::USER}};
+
+  std::string collection = ctx->VAR_NAME(0)->getText();
+  std::transform(collection.begin(), collection.end(), collection.begin(), ::tolower);
+  auto iter = collection_types.find(collection);
+  if (iter == collection_types.end()) {
+    RETURN_ERROR(std::format("Invalid collection of setvar: {}", ctx->VAR_NAME(0)->getText()));
+  }
+
+  // Only the integer is supported, the increment is done by the storage atomically
+  std::string value_string = ctx->VAR_VALUE()->getText();
+  if (value_string.empty() || !std::all_of(value_string.begin(), value_string.end(), ::isdigit)) {
+    RETURN_ERROR(std::format("The value of setvar on the persistent collection must be an integer: "
+                             "{}",
+                             value_string));
+  }
+  int64_t delta = ::atoll(value_string.c_str());
+  if (ctx->MINUS()) {
+    delta = -delta;
+  }
+
+  Action::ActionBase::Branch branch = Action::ActionBase::Branch::Matched;
+  if (ctx->ALWAYS() || ctx->UNMATCHED()) {
+    if (current_rule_->visitActionMode() != CurrentRule::VisitActionMode::SecRule) {
+      RETURN_ERROR("The ALWAYS and UNMATCHED branches are only allowed in SecRule actions.");
+    }
+    branch =
+        ctx->ALWAYS() ? Action::ActionBase::Branch::Always : Action::ActionBase::Branch::Unmatched;
+  }
+
+  current_rule_->get()->appendAction(std::make_unique<Action::SetPersistentVar>(
+      branch, iter->second, ctx->VAR_NAME(1)->getText(), delta));
+
+  return EMPTY_STRING;
+}
+
 std::any Visitor::visitAction_non_disruptive_setenv(
     Antlr4Gen::SecLangParser::Action_non_disruptive_setenvContext* ctx) {
   std::expected<std::unique_ptr<Macro::MacroBase>, std::string> value_macro =
@@ -2021,7 +2080,9 @@ std::any Visitor::visitAction_non_disruptive_ctl_audit_engine(
 
 std::any Visitor::visitAction_non_disruptive_ctl_audit_log_parts(
     Antlr4Gen::SecLangParser::Action_non_disruptive_ctl_audit_log_partsContext* ctx) {
-  std::string parts = ctx->AUDIT_PARTS()->getText();
+  // The first is true if the parts are added, and false if the parts are removed
+  std::pair<bool, AuditLogConfig::AuditLogParts> parts{
+      ctx->PLUS() != nullptr, AuditLogConfig::parseLogParts(ctx->AUDIT_PARTS()->getText())};
 
   Action::ActionBase::Branch branch = Action::ActionBase::Branch::Matched;
   auto* parent_ctx =
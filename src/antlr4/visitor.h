@@ -84,6 +84,12 @@ public:
   std::any visitSec_request_body_no_files_limit(
       Antlr4Gen::SecLangParser::Sec_request_body_no_files_limitContext* ctx) override;
 
+  std::any visitSec_request_body_in_memory_limit(
+      Antlr4Gen::SecLangParser::Sec_request_body_in_memory_limitContext* ctx) override;
+
+  std::any visitSec_body_stream_overlap(
+      Antlr4Gen::SecLangParser::Sec_body_stream_overlapContext* ctx) override;
+
   std::any visitSec_request_body_json_depth_limit(
       Antlr4Gen::SecLangParser::Sec_request_body_json_depth_limitContext* ctx) override;
 
@@ -125,6 +131,9 @@ public:
   std::any visitSec_collection_timeout(
       Antlr4Gen::SecLangParser::Sec_collection_timeoutContext* ctx) override;
 
+  std::any
+  visitSec_shared_storage(Antlr4Gen::SecLangParser::Sec_shared_storageContext* ctx) override;
+
   std::any
   visitSec_pmf_serialize_dir(Antlr4Gen::SecLangParser::Sec_pmf_serialize_dirContext* ctx) override;
 
@@ -593,6 +602,9 @@ public:
       Antlr4Gen::SecLangParser::Action_non_disruptive_setvar_increaseContext* ctx) override;
   std::any visitAction_non_disruptive_setvar_decrease(
       Antlr4Gen::SecLangParser::Action_non_disruptive_setvar_decreaseContext* ctx) override;
+  std::any visitAction_non_disruptive_setvar_persistent_increase(
+      Antlr4Gen::SecLangParser::Action_non_disruptive_setvar_persistent_increaseContext* ctx)
+      override;
 
   // setenv
   std::any visitAction_non_disruptive_setenv(
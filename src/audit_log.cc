@@ -0,0 +1,650 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "audit_log.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <functional>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "common/log.h"
+#include "common/re2/scanner.h"
+#include "rule.h"
+#include "transaction.h"
+
+namespace Wge {
+namespace {
+// The initial size of the buffer of each record, the buffer grows if the record is bigger
+constexpr size_t record_initial_size = 4 * 1024;
+
+// The initial size of the index line of each record
+constexpr size_t index_initial_size = 512;
+
+// The buffer that grows bigger than this is released after it's written, so a few big records
+// don't pin the memory
+constexpr size_t record_max_keep_size = 1024 * 1024;
+
+// The max count of the records that are written by a batch
+constexpr size_t max_batch_size = 256;
+
+constexpr size_t max_iov_count = IOV_MAX;
+
+using AuditLogPart = AuditLogConfig::AuditLogPart;
+
+bool hasPart(AuditLogConfig::AuditLogParts parts, AuditLogPart part) {
+  return parts.test(static_cast<size_t>(part));
+}
+
+void appendInt(std::string& buffer, int64_t value) {
+  char chars[24];
+  auto result = std::to_chars(chars, chars + sizeof(chars), value);
+  buffer.append(chars, result.ptr);
+}
+
+// The time is formatted in UTC, since the conversion to the local time takes a global lock
+void appendTime(std::string& buffer, time_t time, const char* format) {
+  struct tm tm;
+  ::gmtime_r(&time, &tm);
+  char chars[64];
+  size_t size = ::strftime(chars, sizeof(chars), format, &tm);
+  buffer.append(chars, size);
+}
+
+void appendJsonString(std::string& buffer, std::string_view value) {
+  buffer.push_back('"');
+  for (unsigned char ch : value) {
+    switch (ch) {
+    case '"':
+      buffer += "\\\"";
+      break;
+    case '\\':
+      buffer += "\\\\";
+      break;
+    case '\n':
+      buffer += "\\n";
+      break;
+    case '\r':
+      buffer += "\\r";
+      break;
+    case '\t':
+      buffer += "\\t";
+      break;
+    default:
+      if (ch < 0x20)
+        [[unlikely]] {
+          constexpr char hex[] = "0123456789abcdef";
+          buffer += "\\u00";
+          buffer.push_back(hex[ch >> 4]);
+          buffer.push_back(hex[ch & 0xf]);
+        }
+      else {
+        buffer.push_back(ch);
+      }
+      break;
+    }
+  }
+  buffer.push_back('"');
+}
+
+void appendJsonKey(std::string& buffer, std::string_view key) {
+  appendJsonString(buffer, key);
+  buffer.push_back(':');
+}
+
+template <class Headers> void appendJsonHeaders(std::string& buffer, const Headers& headers) {
+  buffer.push_back('{');
+  bool first = true;
+  headers.traverse([&](std::string_view key, std::string_view value) {
+    if (!first) {
+      buffer.push_back(',');
+    }
+    first = false;
+    appendJsonKey(buffer, key);
+    appendJsonString(buffer, value);
+    return true;
+  });
+  buffer.push_back('}');
+}
+
+template <class Headers> void appendNativeHeaders(std::string& buffer, const Headers& headers) {
+  headers.traverse([&](std::string_view key, std::string_view value) {
+    buffer += key;
+    buffer += ": ";
+    buffer += value;
+    buffer.push_back('\n');
+    return true;
+  });
+}
+} // namespace
+
+AuditLog::AuditLog(const AuditLogConfig& config, size_t record_count)
+    : config_(config), free_records_(record_count), pending_records_(record_count) {
+  if (!config_.relevant_status_regex_.empty()) {
+    relevant_status_ =
+        std::make_unique<Common::Re2::Scanner>(config_.relevant_status_regex_, false, false);
+    if (!relevant_status_->ok())
+      [[unlikely]] {
+        WGE_LOG_ERROR("invalid SecAuditLogRelevantStatus {}: {}", config_.relevant_status_regex_,
+                      relevant_status_->error());
+        relevant_status_.reset();
+      }
+  }
+
+  // The capacity of the queues is rounded up, so all of the records can be pushed into the pending
+  // queue at the same time
+  records_.reserve(free_records_.capacity());
+  for (size_t i = 0; i < free_records_.capacity(); ++i) {
+    auto& record = records_.emplace_back(std::make_unique<Record>());
+    record->buffer_.reserve(record_initial_size);
+    record->index_.reserve(index_initial_size);
+    free_records_.push(record.get());
+  }
+}
+
+AuditLog::~AuditLog() { stop(); }
+
+std::expected<bool, std::string> AuditLog::start() {
+  switch (config_.audit_log_type_) {
+  case AuditLogConfig::AuditLogType::Serial:
+    if (config_.log_path_.empty()) {
+      return std::unexpected("the SecAuditLog is required by the serial audit log");
+    }
+    break;
+  case AuditLogConfig::AuditLogType::Concurrent:
+    if (config_.storage_dir_.empty()) {
+      return std::unexpected("the SecAuditLogStorageDir is required by the concurrent audit log");
+    }
+    break;
+  case AuditLogConfig::AuditLogType::Https:
+    return std::unexpected("the https audit log isn't supported");
+  }
+
+  // The index file of the concurrent log is optional
+  if (!config_.log_path_.empty()) {
+    fd_ = ::open(config_.log_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                 config_.file_mode_);
+    if (fd_ == -1) {
+      return std::unexpected(std::format("open audit log {} failed", config_.log_path_));
+    }
+  }
+
+  stop_.store(false, std::memory_order_relaxed);
+  writer_ = std::thread(&AuditLog::writerMain, this);
+  return true;
+}
+
+void AuditLog::stop() {
+  if (writer_.joinable()) {
+    stop_.store(true, std::memory_order_release);
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    writer_.join();
+  }
+
+  if (fd_ != -1) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+void AuditLog::log(const Transaction& t) {
+  if (!isRelevant(t)) {
+    return;
+  }
+
+  Record* record;
+  if (!free_records_.pop(record))
+    [[unlikely]] {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+  record->time_ = ::time(nullptr);
+  std::string_view unique_id = t.getUniqueId();
+  record->unique_id_size_ = std::min(unique_id.size(), record->unique_id_.size());
+  std::copy_n(unique_id.data(), record->unique_id_size_, record->unique_id_.data());
+  record->buffer_.clear();
+  AuditLogConfig::AuditLogParts parts = t.getAuditLogParts();
+  if (config_.format_ == AuditLogConfig::AuditFormat::Json) {
+    serializeJson(t, parts, *record);
+  } else {
+    serializeNative(t, parts, *record);
+  }
+
+  record->index_.clear();
+  if (config_.audit_log_type_ == AuditLogConfig::AuditLogType::Concurrent) {
+    record->index_ += t.getConnectionInfo().downstream_ip_;
+    record->index_ += ' ';
+    appendTime(record->index_, record->time_, "[%d/%b/%Y:%H:%M:%S +0000]");
+    record->index_ += " \"";
+    record->index_ += t.getRequestLine();
+    record->index_ += "\" ";
+    record->index_ += t.getResponseLineInfo().status_code_;
+    record->index_ += ' ';
+    record->index_ += record->uniqueId();
+  }
+
+  // The pending queue never overflows, since it can hold all of the records
+  pending_records_.push(record);
+
+  // Wake up the writer if it's idle. The fence pairs with the fence of the writer, so either the
+  // writer sees the record or the worker sees the writer is idle.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (writer_idle_.load(std::memory_order_relaxed)) {
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+  }
+}
+
+bool AuditLog::isRelevant(const Transaction& t) const {
+  switch (t.getAuditEngine()) {
+  case AuditLogConfig::AuditEngine::On:
+    return true;
+  case AuditLogConfig::AuditEngine::Off:
+    return false;
+  case AuditLogConfig::AuditEngine::RelevantOnly:
+    if (!t.getAuditMessages().empty()) {
+      return true;
+    }
+    return relevant_status_ && relevant_status_->match(t.getResponseLineInfo().status_code_);
+  }
+
+  return false;
+}
+
+void AuditLog::serializeNative(const Transaction& t, AuditLogConfig::AuditLogParts parts,
+                               Record& record) const {
+  std::string& buffer = record.buffer_;
+  // The boundary is the hash of the unique id in the zero padded hex
+  char chars[Record::boundary_size];
+  auto result = std::to_chars(
+      chars, chars + sizeof(chars),
+      static_cast<uint32_t>(std::hash<std::string_view>{}(record.uniqueId())), 16);
+  size_t size = result.ptr - chars;
+  record.boundary_.fill('0');
+  std::copy_n(chars, size, record.boundary_.end() - size);
+  const std::string_view boundary = record.boundary();
+  auto section = [&](char part) {
+    buffer += "--";
+    buffer += boundary;
+    buffer.push_back('-');
+    buffer.push_back(part);
+    buffer += "--\n";
+  };
+
+  // The header of the record is always recorded
+  const auto& connection = t.getConnectionInfo();
+  section('A');
+  appendTime(buffer, record.time_, "[%d/%b/%Y:%H:%M:%S +0000] ");
+  buffer += record.uniqueId();
+  buffer.push_back(' ');
+  buffer += connection.downstream_ip_;
+  buffer.push_back(' ');
+  appendInt(buffer, connection.downstream_port_);
+  buffer.push_back(' ');
+  buffer += connection.upstream_ip_;
+  buffer.push_back(' ');
+  appendInt(buffer, connection.upstream_port_);
+  buffer.push_back('\n');
+
+  if (hasPart(parts, AuditLogPart::RequestHeaders)) {
+    section('B');
+    buffer += t.getRequestLine();
+    buffer.push_back('\n');
+    appendNativeHeaders(buffer, t.httpExtractor().request_headers_);
+  }
+
+  if (hasPart(parts, AuditLogPart::RequestBody) && !t.getRequestBody().empty()) {
+    section('C');
+    buffer += t.getRequestBody();
+    buffer.push_back('\n');
+  }
+
+  if (hasPart(parts, AuditLogPart::IntermediaryResponseBody) && !t.getResponseBody().empty()) {
+    section('E');
+    buffer += t.getResponseBody();
+    buffer.push_back('\n');
+  }
+
+  if (hasPart(parts, AuditLogPart::FinalResponseHeaders)) {
+    const auto& response_line = t.getResponseLineInfo();
+    section('F');
+    buffer += response_line.protocol_;
+    buffer.push_back(' ');
+    buffer += response_line.status_code_;
+    buffer.push_back('\n');
+    appendNativeHeaders(buffer, t.httpExtractor().response_headers_);
+  }
+
+  if (hasPart(parts, AuditLogPart::Trailer)) {
+    section('H');
+    for (const auto& message : t.getAuditMessages()) {
+      const Rule& rule = *message.rule_;
+      buffer += "Message: Matched rule. [file \"";
+      buffer += rule.filePath();
+      buffer += "\"] [line \"";
+      appendInt(buffer, rule.line());
+      buffer += "\"] [id \"";
+      appendInt(buffer, rule.id());
+      buffer += "\"] [msg \"";
+      buffer += message.msg_;
+      buffer += "\"] [data \"";
+      buffer += message.log_data_;
+      buffer += "\"] [severity \"";
+      appendInt(buffer, static_cast<int>(rule.severity()));
+      buffer += "\"] [ver \"";
+      buffer += rule.ver();
+      buffer += "\"]";
+      for (auto tag : rule.tags()) {
+        buffer += " [tag \"";
+        buffer += tag;
+        buffer += "\"]";
+      }
+      buffer.push_back('\n');
+    }
+  }
+
+  if (hasPart(parts, AuditLogPart::K)) {
+    section('K');
+    for (const auto& message : t.getAuditMessages()) {
+      buffer += "id:";
+      appendInt(buffer, message.rule_->id());
+      buffer.push_back('\n');
+    }
+  }
+
+  section('Z');
+  buffer.push_back('\n');
+}
+
+void AuditLog::serializeJson(const Transaction& t, AuditLogConfig::AuditLogParts parts,
+                             Record& record) const {
+  std::string& buffer = record.buffer_;
+  const auto& connection = t.getConnectionInfo();
+  buffer += "{\"transaction\":{";
+  appendJsonKey(buffer, "time_stamp");
+  buffer.push_back('"');
+  appendTime(buffer, record.time_, "%d/%b/%Y:%H:%M:%S +0000");
+  buffer += "\",";
+  appendJsonKey(buffer, "unique_id");
+  appendJsonString(buffer, record.uniqueId());
+  buffer.push_back(',');
+  appendJsonKey(buffer, "client_ip");
+  appendJsonString(buffer, connection.downstream_ip_);
+  buffer.push_back(',');
+  appendJsonKey(buffer, "client_port");
+  appendInt(buffer, connection.downstream_port_);
+  buffer.push_back(',');
+  appendJsonKey(buffer, "host_ip");
+  appendJsonString(buffer, connection.upstream_ip_);
+  buffer.push_back(',');
+  appendJsonKey(buffer, "host_port");
+  appendInt(buffer, connection.upstream_port_);
+
+  const auto& request_line = t.getRequestLineInfo();
+  buffer.push_back(',');
+  appendJsonKey(buffer, "request");
+  buffer.push_back('{');
+  appendJsonKey(buffer, "method");
+  appendJsonString(buffer, request_line.method_);
+  buffer.push_back(',');
+  appendJsonKey(buffer, "uri");
+  appendJsonString(buffer, request_line.uri_raw_);
+  buffer.push_back(',');
+  appendJsonKey(buffer, "http_version");
+  appendJsonString(buffer, request_line.version_);
+  if (hasPart(parts, AuditLogPart::RequestHeaders)) {
+    buffer.push_back(',');
+    appendJsonKey(buffer, "headers");
+    appendJsonHeaders(buffer, t.httpExtractor().request_headers_);
+  }
+  if (hasPart(parts, AuditLogPart::RequestBody)) {
+    buffer.push_back(',');
+    appendJsonKey(buffer, "body");
+    appendJsonString(buffer, t.getRequestBody());
+  }
+  buffer.push_back('}');
+
+  const auto& response_line = t.getResponseLineInfo();
+  buffer.push_back(',');
+  appendJsonKey(buffer, "response");
+  buffer.push_back('{');
+  appendJsonKey(buffer, "http_code");
+  appendJsonString(buffer, response_line.status_code_);
+  if (hasPart(parts, AuditLogPart::FinalResponseHeaders)) {
+    buffer.push_back(',');
+    appendJsonKey(buffer, "headers");
+    appendJsonHeaders(buffer, t.httpExtractor().response_headers_);
+  }
+  if (hasPart(parts, AuditLogPart::IntermediaryResponseBody)) {
+    buffer.push_back(',');
+    appendJsonKey(buffer, "body");
+    appendJsonString(buffer, t.getResponseBody());
+  }
+  buffer.push_back('}');
+
+  if (hasPart(parts, AuditLogPart::Trailer)) {
+    buffer.push_back(',');
+    appendJsonKey(buffer, "messages");
+    buffer.push_back('[');
+    bool first_message = true;
+    for (const auto& message : t.getAuditMessages()) {
+      const Rule& rule = *message.rule_;
+      if (!first_message) {
+        buffer.push_back(',');
+      }
+      first_message = false;
+      buffer.push_back('{');
+      appendJsonKey(buffer, "message");
+      appendJsonString(buffer, message.msg_);
+      buffer.push_back(',');
+      appendJsonKey(buffer, "details");
+      buffer.push_back('{');
+      appendJsonKey(buffer, "ruleId");
+      appendInt(buffer, rule.id());
+      buffer.push_back(',');
+      appendJsonKey(buffer, "file");
+      appendJsonString(buffer, rule.filePath());
+      buffer.push_back(',');
+      appendJsonKey(buffer, "lineNumber");
+      appendInt(buffer, rule.line());
+      buffer.push_back(',');
+      appendJsonKey(buffer, "data");
+      appendJsonString(buffer, message.log_data_);
+      buffer.push_back(',');
+      appendJsonKey(buffer, "severity");
+      appendInt(buffer, static_cast<int>(rule.severity()));
+      buffer.push_back(',');
+      appendJsonKey(buffer, "ver");
+      appendJsonString(buffer, rule.ver());
+      buffer.push_back(',');
+      appendJsonKey(buffer, "tags");
+      buffer.push_back('[');
+      bool first_tag = true;
+      for (auto tag : rule.tags()) {
+        if (!first_tag) {
+          buffer.push_back(',');
+        }
+        first_tag = false;
+        appendJsonString(buffer, tag);
+      }
+      buffer += "]}}";
+    }
+    buffer.push_back(']');
+  }
+
+  buffer += "}}\n";
+}
+
+void AuditLog::writerMain() {
+  std::vector<Record*> batch;
+  batch.reserve(max_batch_size);
+  for (;;) {
+    Record* record;
+    while (batch.size() < max_batch_size && pending_records_.pop(record)) {
+      batch.emplace_back(record);
+    }
+
+    if (!batch.empty()) {
+      if (config_.audit_log_type_ == AuditLogConfig::AuditLogType::Concurrent) {
+        writeConcurrent(batch);
+      } else {
+        writeSerial(batch);
+      }
+      written_count_.fetch_add(batch.size(), std::memory_order_relaxed);
+
+      for (Record* record : batch) {
+        if (record->buffer_.capacity() > record_max_keep_size)
+          [[unlikely]] {
+            std::string().swap(record->buffer_);
+            record->buffer_.reserve(record_initial_size);
+          }
+        free_records_.push(record);
+      }
+      batch.clear();
+      continue;
+    }
+
+    // Check the queue again after the writer is marked idle, so the record that is pushed before
+    // the worker sees the idle flag isn't missed
+    writer_idle_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32_t signal = signal_.load(std::memory_order_acquire);
+    if (pending_records_.pop(record)) {
+      writer_idle_.store(false, std::memory_order_relaxed);
+      batch.emplace_back(record);
+      continue;
+    }
+    if (stop_.load(std::memory_order_acquire)) {
+      break;
+    }
+    signal_.wait(signal, std::memory_order_acquire);
+    writer_idle_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void AuditLog::writeSerial(const std::vector<Record*>& batch) {
+  std::vector<std::string_view> pieces;
+  pieces.reserve(batch.size());
+  for (Record* record : batch) {
+    pieces.emplace_back(record->buffer_);
+  }
+
+  if (!writeAll(fd_, pieces))
+    [[unlikely]] { WGE_LOG_ERROR("write audit log {} failed: {}", config_.log_path_, errno); }
+}
+
+void AuditLog::writeConcurrent(const std::vector<Record*>& batch) {
+  // Each record is written to <storage dir>/YYYYMMDD/YYYYMMDD-HHMM/YYYYMMDD-HHMMSS-<unique id>
+  std::vector<std::string_view> index_pieces;
+  index_pieces.reserve(batch.size());
+  std::string relative_path;
+  for (Record* record : batch) {
+    relative_path.clear();
+    appendTime(relative_path, record->time_, "/%Y%m%d");
+    size_t day_size = relative_path.size();
+    appendTime(relative_path, record->time_, "/%Y%m%d-%H%M");
+    if (relative_path != last_dir_) {
+      std::string day_dir = config_.storage_dir_ + relative_path.substr(0, day_size);
+      std::string minute_dir = config_.storage_dir_ + relative_path;
+      if ((::mkdir(day_dir.c_str(), config_.dir_mode_) == -1 && errno != EEXIST) ||
+          (::mkdir(minute_dir.c_str(), config_.dir_mode_) == -1 && errno != EEXIST))
+        [[unlikely]] {
+          WGE_LOG_ERROR("create audit log directory {} failed: {}", minute_dir, errno);
+          continue;
+        }
+      last_dir_ = relative_path;
+    }
+    appendTime(relative_path, record->time_, "/%Y%m%d-%H%M%S-");
+    relative_path += record->uniqueId();
+
+    std::string file = config_.storage_dir_ + relative_path;
+    int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, config_.file_mode_);
+    if (fd == -1)
+      [[unlikely]] {
+        WGE_LOG_ERROR("open audit log {} failed: {}", file, errno);
+        continue;
+      }
+    std::vector<std::string_view> pieces{record->buffer_};
+    bool ok = writeAll(fd, pieces);
+    ::close(fd);
+    if (!ok)
+      [[unlikely]] {
+        WGE_LOG_ERROR("write audit log {} failed: {}", file, errno);
+        continue;
+      }
+
+    if (fd_ != -1) {
+      record->index_.push_back(' ');
+      record->index_ += relative_path;
+      record->index_ += " 0 ";
+      appendInt(record->index_, record->buffer_.size());
+      record->index_.push_back('\n');
+      index_pieces.emplace_back(record->index_);
+    }
+  }
+
+  if (!index_pieces.empty() && !writeAll(fd_, index_pieces))
+    [[unlikely]] { WGE_LOG_ERROR("write audit log {} failed: {}", config_.log_path_, errno); }
+}
+
+bool AuditLog::writeAll(int fd, std::vector<std::string_view>& pieces) {
+  size_t index = 0;
+  iovec iov[max_iov_count];
+  for (;;) {
+    while (index < pieces.size() && pieces[index].empty()) {
+      ++index;
+    }
+    if (index == pieces.size()) {
+      return true;
+    }
+
+    size_t count = 0;
+    for (size_t i = index; i < pieces.size() && count < max_iov_count; ++i) {
+      iov[count++] = {const_cast<char*>(pieces[i].data()), pieces[i].size()};
+    }
+    ssize_t written = ::writev(fd, iov, count);
+    if (written == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+
+    // The rest of the partially written piece is written by the next writev
+    for (size_t size = written; size > 0;) {
+      size_t n = std::min(size, pieces[index].size());
+      pieces[index].remove_prefix(n);
+      size -= n;
+      if (pieces[index].empty()) {
+        ++index;
+      }
+    }
+  }
+}
+} // namespace Wge
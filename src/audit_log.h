@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+#include "common/bounded_queue.hpp"
+#include "config.h"
+
+namespace Wge {
+namespace Common {
+namespace Re2 {
+class Scanner;
+} // namespace Re2
+} // namespace Common
+
+class Transaction;
+
+/**
+ * The audit log.
+ * The worker thread that processes the transaction only serializes the selected parts of the
+ * transaction into a record that is taken from a preallocated pool, and pushes the record into a
+ * lock-free queue. A dedicated writer thread pops the records in batches and writes them:
+ * - Serial: all of the records are appended to the SecAuditLog file by one writev per batch.
+ * - Concurrent: each record is written to its own file under the SecAuditLogStorageDir, and the
+ * index lines are appended to the SecAuditLog file by one writev per batch.
+ * So neither the file I/O nor a lock is performed on the request path. If the writer can't keep
+ * up and the pool is exhausted, the records are dropped rather than blocking the worker threads,
+ * and they are counted by droppedCount.
+ * The parts D, G, I and J are not recorded.
+ */
+class AuditLog {
+public:
+  /**
+   * Construct an audit log.
+   * @param config the audit log configuration.
+   * @param record_count the count of the preallocated records, it's the max count of the records
+   * that are waiting for being written.
+   */
+  AuditLog(const AuditLogConfig& config, size_t record_count = 1024);
+  AuditLog(const AuditLog&) = delete;
+  ~AuditLog();
+
+public:
+  /**
+   * Open the log file and start the writer thread.
+   * @return an error string is returned if fails, and returned true otherwise.
+   */
+  std::expected<bool, std::string> start();
+
+  /**
+   * Stop the writer thread after all of the pending records are written.
+   */
+  void stop();
+
+  /**
+   * Log the transaction if it's relevant. It's called by the worker threads concurrently.
+   * @param t the transaction.
+   */
+  void log(const Transaction& t);
+
+  /**
+   * @return the count of the records that are written.
+   */
+  uint64_t writtenCount() const { return written_count_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the count of the records that are dropped since the pool is exhausted.
+   */
+  uint64_t droppedCount() const { return dropped_count_.load(std::memory_order_relaxed); }
+
+private:
+  struct Record {
+    // The unique id and the boundary are formatted into the fixed buffers, so that logging a
+    // record doesn't allocate. The unique id that is longer than the buffer is truncated.
+    static constexpr size_t unique_id_max_size = 64;
+    static constexpr size_t boundary_size = 8;
+
+    time_t time_;
+    std::array<char, unique_id_max_size> unique_id_;
+    size_t unique_id_size_{0};
+    std::array<char, boundary_size> boundary_;
+    // The leading fields of the index line of the concurrent log
+    std::string index_;
+    std::string buffer_;
+
+    std::string_view uniqueId() const { return {unique_id_.data(), unique_id_size_}; }
+    std::string_view boundary() const { return {boundary_.data(), boundary_.size()}; }
+  };
+
+  bool isRelevant(const Transaction& t) const;
+  void serializeNative(const Transaction& t, AuditLogConfig::AuditLogParts parts,
+                       Record& record) const;
+  void serializeJson(const Transaction& t, AuditLogConfig::AuditLogParts parts,
+                     Record& record) const;
+  void writerMain();
+  void writeSerial(const std::vector<Record*>& batch);
+  void writeConcurrent(const std::vector<Record*>& batch);
+  bool writeAll(int fd, std::vector<std::string_view>& pieces);
+
+private:
+  const AuditLogConfig config_;
+  std::unique_ptr<Common::Re2::Scanner> relevant_status_;
+
+  std::vector<std::unique_ptr<Record>> records_;
+  Common::BoundedQueue<Record*> free_records_;
+  Common::BoundedQueue<Record*> pending_records_;
+
+  std::thread writer_;
+  std::atomic_bool stop_{false};
+  // The writer waits on the signal when it's idle, and the worker threads change the signal to
+  // wake it up only if it's idle
+  std::atomic_bool writer_idle_{false};
+  std::atomic<uint32_t> signal_{0};
+
+  int fd_{-1};
+  // The last directory of the concurrent log that has been created
+  std::string last_dir_;
+
+  std::atomic<uint64_t> written_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+};
+} // namespace Wge
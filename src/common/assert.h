@@ -26,8 +26,13 @@
 
 extern std::thread::id main_thread_id;
 
+// The thread that builds an engine in the background, e.g. reloads the rules, acts as the main
+// thread of the engine that it builds.
+extern thread_local bool is_engine_builder_thread;
+
 // Asserts that the current thread is the main thread.
-#define ASSERT_IS_MAIN_THREAD() assert(std::this_thread::get_id() == main_thread_id)
+#define ASSERT_IS_MAIN_THREAD()                                                                    \
+  assert(std::this_thread::get_id() == main_thread_id || is_engine_builder_thread)
 
 // Asserts that current line of code should never be reached.
 #define UNREACHABLE() assert(false)
\ No newline at end of file
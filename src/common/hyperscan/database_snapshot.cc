@@ -0,0 +1,266 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "database_snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hs_database.h"
+
+#include "../log.h"
+
+namespace Wge {
+namespace Common {
+namespace Hyperscan {
+namespace {
+constexpr std::string_view snapshot_magic = "WGESNAP2";
+
+// The databases are compiled for the host platform, and a database that is compiled for the other
+// CPU features may fail to deserialize or to scan, so the snapshot records the platform.
+std::string platformName() {
+  hs_platform_info_t platform;
+  if (::hs_populate_platform(&platform) != HS_SUCCESS) {
+    return {};
+  }
+  return std::format("{}:{}", platform.tune, platform.cpu_features);
+}
+
+void writeString(std::ofstream& ofs, std::string_view value) {
+  uint64_t size = value.size();
+  ofs.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  ofs.write(value.data(), value.size());
+}
+
+// Serialize the database to a length-prefixed string. The null database is written as empty.
+bool writeDatabase(std::ofstream& ofs, const hs_database_t* db) {
+  if (!db) {
+    writeString(ofs, {});
+    return true;
+  }
+
+  char* db_data = nullptr;
+  size_t db_data_size = 0;
+  if (::hs_serialize_database(db, &db_data, &db_data_size) != HS_SUCCESS) {
+    return false;
+  }
+  writeString(ofs, {db_data, db_data_size});
+  ::free(db_data);
+  return true;
+}
+
+// Read the length-prefixed strings from the mapped file, the read string refers to the mapped
+// memory.
+class Reader {
+public:
+  Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+public:
+  bool read(uint64_t& value) {
+    if (size_ - pos_ < sizeof(value)) {
+      return false;
+    }
+    ::memcpy(&value, data_ + pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return true;
+  }
+
+  bool read(std::string_view& value) {
+    uint64_t size;
+    if (!read(size) || size_ - pos_ < size) {
+      return false;
+    }
+    value = {data_ + pos_, size};
+    pos_ += size;
+    return true;
+  }
+
+  bool readMagic() {
+    if (size_ < snapshot_magic.size() ||
+        std::string_view(data_, snapshot_magic.size()) != snapshot_magic) {
+      return false;
+    }
+    pos_ = snapshot_magic.size();
+    return true;
+  }
+
+private:
+  const char* data_;
+  size_t size_;
+  size_t pos_{0};
+};
+} // namespace
+
+DatabaseSnapshot::~DatabaseSnapshot() {
+  if (data_) {
+    ::munmap(data_, size_);
+  }
+}
+
+std::expected<bool, std::string>
+DatabaseSnapshot::save(const std::string& file_path, const std::string& rule_set_hash,
+                       const std::vector<const HsDataBase*>& databases) {
+  std::string tmp_file_path = std::format("{}.{}.tmp", file_path, ::getpid());
+  std::ofstream ofs(tmp_file_path, std::ios::binary | std::ios::trunc);
+  if (!ofs.is_open()) {
+    return std::unexpected(std::format("open file {} failed", tmp_file_path));
+  }
+
+  ofs.write(snapshot_magic.data(), snapshot_magic.size());
+  writeString(ofs, ::hs_version());
+  writeString(ofs, platformName());
+  writeString(ofs, rule_set_hash);
+
+  // The databases that have the same expressions are saved once
+  std::unordered_map<std::string_view, const HsDataBase*> unique_databases;
+  for (const HsDataBase* hs_db : databases) {
+    if (hs_db->blockNative()) {
+      unique_databases.emplace(hs_db->sha1(), hs_db);
+    }
+  }
+
+  uint64_t count = unique_databases.size();
+  ofs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (auto& [sha1, hs_db] : unique_databases) {
+    writeString(ofs, sha1);
+    if (!writeDatabase(ofs, hs_db->blockNative()) || !writeDatabase(ofs, hs_db->streamNative())) {
+      ofs.close();
+      std::filesystem::remove(tmp_file_path);
+      return std::unexpected(std::format("serialize the hyperscan database {} failed", sha1));
+    }
+  }
+
+  ofs.close();
+  if (!ofs) {
+    std::filesystem::remove(tmp_file_path);
+    return std::unexpected(std::format("write file {} failed", tmp_file_path));
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_file_path, file_path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_file_path);
+    return std::unexpected(std::format("rename {} to {} failed: {}", tmp_file_path, file_path,
+                                       ec.message()));
+  }
+
+  WGE_LOG_INFO("Saved {} hyperscan databases to the snapshot {}", count, file_path);
+  return true;
+}
+
+std::expected<std::shared_ptr<DatabaseSnapshot>, std::string>
+DatabaseSnapshot::load(const std::string& file_path, const std::string& rule_set_hash) {
+  int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return std::unexpected(std::format("open file {} failed", file_path));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) == -1 || st.st_size == 0) {
+    ::close(fd);
+    return std::unexpected(std::format("the snapshot {} is empty", file_path));
+  }
+
+  void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return std::unexpected(std::format("map file {} failed", file_path));
+  }
+
+  std::shared_ptr<DatabaseSnapshot> snapshot = std::make_shared<DatabaseSnapshot>();
+  snapshot->data_ = data;
+  snapshot->size_ = st.st_size;
+
+  Reader reader(static_cast<const char*>(data), st.st_size);
+  std::string_view hs_version;
+  std::string_view platform;
+  std::string_view snapshot_rule_set_hash;
+  uint64_t count;
+  if (!reader.readMagic() || !reader.read(hs_version) || !reader.read(platform) ||
+      !reader.read(snapshot_rule_set_hash) || !reader.read(count)) {
+    return std::unexpected(std::format("the snapshot {} is corrupted", file_path));
+  }
+  if (hs_version != ::hs_version()) {
+    return std::unexpected(
+        std::format("the snapshot {} is saved by the other hyperscan version: {}", file_path,
+                    hs_version));
+  }
+  if (platform.empty() || platform != platformName()) {
+    return std::unexpected(
+        std::format("the snapshot {} is saved on the other platform: {}", file_path, platform));
+  }
+  if (snapshot_rule_set_hash != rule_set_hash) {
+    return std::unexpected(
+        std::format("the snapshot {} is saved from the other rule set", file_path));
+  }
+
+  // Each database takes 3 length prefixes at least, don't trust the count of a corrupted file
+  snapshot->databases_.reserve(std::min<uint64_t>(count, st.st_size / (3 * sizeof(uint64_t))));
+  for (uint64_t i = 0; i < count; ++i) {
+    std::string_view sha1;
+    Database database;
+    if (!reader.read(sha1) || !reader.read(database.block_) || !reader.read(database.stream_)) {
+      return std::unexpected(std::format("the snapshot {} is corrupted", file_path));
+    }
+    snapshot->databases_.emplace(sha1, database);
+  }
+
+  WGE_LOG_INFO("Loaded {} hyperscan databases from the snapshot {}", count, file_path);
+  return snapshot;
+}
+
+bool DatabaseSnapshot::deserialize(const std::string& sha1, bool support_stream,
+                                   hs_database_t** block_db, hs_database_t** stream_db) const {
+  auto iter = databases_.find(sha1);
+  if (iter == databases_.end()) {
+    return false;
+  }
+
+  const Database& database = iter->second;
+  if (support_stream && database.stream_.empty()) {
+    return false;
+  }
+
+  if (::hs_deserialize_database(database.block_.data(), database.block_.size(), block_db) !=
+      HS_SUCCESS) {
+    return false;
+  }
+
+  if (support_stream && ::hs_deserialize_database(database.stream_.data(),
+                                                  database.stream_.size(),
+                                                  stream_db) != HS_SUCCESS) {
+    ::hs_free_database(*block_db);
+    *block_db = nullptr;
+    return false;
+  }
+
+  return true;
+}
+} // namespace Hyperscan
+} // namespace Common
+} // namespace Wge
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <hs/hs.h>
+
+namespace Wge {
+namespace Common {
+namespace Hyperscan {
+class HsDataBase;
+
+/**
+ * A snapshot of the compiled hyperscan databases.
+ * The snapshot file holds the serialized databases that are used by an engine, and each database
+ * is keyed by the SHA1 of its expression list. The file is memory-mapped read-only when
+ * loading, so the worker processes that load the same snapshot share the page cache of the file,
+ * and a database is deserialized from the mapped memory instead of being compiled.
+ *
+ * The file format (native byte order):
+ * - magic "WGESNAP2"
+ * - the hyperscan version, the platform (the tune and the CPU features that the databases are
+ *   compiled for), the rule set hash: each is a length-prefixed string
+ * - the count of the databases
+ * - each database: the SHA1, the block database and the stream database, each is a
+ *   length-prefixed string. The stream database is empty if the database doesn't support the
+ *   stream mode.
+ */
+class DatabaseSnapshot {
+public:
+  DatabaseSnapshot() = default;
+  DatabaseSnapshot(const DatabaseSnapshot&) = delete;
+  ~DatabaseSnapshot();
+
+public:
+  /**
+   * Save the databases to the file.
+   * The file is written to a temporary file and then renamed, so that the other processes never
+   * map a partial file.
+   * @param file_path the snapshot file path
+   * @param rule_set_hash the hash of the rule set that the databases are compiled from
+   * @param databases the databases to save, the databases that have the same SHA1 are saved once
+   * @return an error string is returned if fails, and returned true otherwise
+   */
+  static std::expected<bool, std::string>
+  save(const std::string& file_path, const std::string& rule_set_hash,
+       const std::vector<const HsDataBase*>& databases);
+
+  /**
+   * Map the snapshot file and index the databases.
+   * @param file_path the snapshot file path
+   * @param rule_set_hash the hash of the current rule set. The snapshot of the other rule set, the
+   * other hyperscan version or the other platform is rejected.
+   * @return the snapshot, or an error string if fails
+   */
+  static std::expected<std::shared_ptr<DatabaseSnapshot>, std::string>
+  load(const std::string& file_path, const std::string& rule_set_hash);
+
+public:
+  /**
+   * Deserialize the database of the expression list from the snapshot.
+   * @param sha1 the SHA1 of the expression list
+   * @param support_stream whether the stream database is needed
+   * @param block_db the deserialized block database
+   * @param stream_db the deserialized stream database
+   * @return true if the database is found and deserialized, false otherwise
+   */
+  bool deserialize(const std::string& sha1, bool support_stream, hs_database_t** block_db,
+                   hs_database_t** stream_db) const;
+
+  /**
+   * Get the count of the databases in the snapshot.
+   * @return the count of the databases
+   */
+  size_t size() const { return databases_.size(); }
+
+private:
+  struct Database {
+    std::string_view block_;
+    std::string_view stream_;
+  };
+
+private:
+  void* data_{nullptr};
+  size_t size_{0};
+  std::unordered_map<std::string_view, Database> databases_;
+};
+} // namespace Hyperscan
+} // namespace Common
+} // namespace Wge
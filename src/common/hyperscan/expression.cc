@@ -20,6 +20,7 @@
  */
 #include "expression.h"
 
+#include <algorithm>
 #include <fstream>
 #include <regex>
 
@@ -162,6 +163,12 @@ void ExpressionList::add(Expression&& exp, bool prefilter, bool init_raw_data) {
 
 size_t ExpressionList::size() const { return exprs_.size(); }
 
+bool ExpressionList::containsChar(char ch) const {
+  return std::any_of(exprs_.begin(), exprs_.end(), [ch](const std::string& expr) {
+    return expr.find(ch) != std::string::npos;
+  });
+}
+
 void ExpressionList::clear() {
   expr_pointers_.clear();
   expr_lens_.clear();
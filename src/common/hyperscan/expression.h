@@ -104,6 +104,13 @@ public:
   void clear();
   bool literal() const { return literal_; }
 
+  /**
+   * Check whether any expression of the list contains the specified character.
+   * @param ch the character
+   * @return true if any expression contains the character, false otherwise.
+   */
+  bool containsChar(char ch) const;
+
   // Get raw data of array
   const char** exprRawData() { return expr_pointers_.data(); }
   const size_t* exprLenRawData() { return expr_lens_.data(); }
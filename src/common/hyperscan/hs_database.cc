@@ -26,6 +26,8 @@
 
 #include <boost/interprocess/sync/file_lock.hpp>
 
+#include "database_snapshot.h"
+
 #include "../assert.h"
 #include "../log.h"
 
@@ -34,6 +36,7 @@ namespace Common {
 namespace Hyperscan {
 Scratch HsDataBase::main_scratch_;
 std::mutex HsDataBase::serialize_mutex_;
+std::atomic<std::shared_ptr<const DatabaseSnapshot>> HsDataBase::snapshot_;
 
 HsDataBase::HsDataBase(const std::string& pattern, bool literal, bool case_less, bool som_leftmost,
                        bool prefilter, bool support_stream, const char* serialize_dir)
@@ -184,8 +187,8 @@ void HsDataBase::compile(bool support_stream) {
 
     // realloc the main scratch space
     if (db_.block_db_ && db_.stream_db_) {
-      main_scratch_.addBlock(db_.block_db_);
-      main_scratch_.addStream(db_.stream_db_);
+      scratch_generation_ = main_scratch_.addBlock(db_.block_db_);
+      scratch_generation_ = main_scratch_.addStream(db_.stream_db_);
     }
   } else {
     hs_compile_error_t* compile_err;
@@ -211,7 +214,7 @@ void HsDataBase::compile(bool support_stream) {
 
     // realloc the main scratch space
     if (db_.block_db_) {
-      main_scratch_.addBlock(db_.block_db_);
+      scratch_generation_ = main_scratch_.addBlock(db_.block_db_);
     }
   }
 }
@@ -240,7 +243,7 @@ bool HsDataBase::loadFromSerialize(const char* serialize_dir, bool support_strea
 
   std::string serialize_block_file = makeBlockSerializeFilePath(serialize_dir);
   if (load(serialize_block_file, &db_.block_db_)) {
-    main_scratch_.addBlock(db_.block_db_);
+    scratch_generation_ = main_scratch_.addBlock(db_.block_db_);
   } else {
     return false;
   }
@@ -248,7 +251,7 @@ bool HsDataBase::loadFromSerialize(const char* serialize_dir, bool support_strea
   if (support_stream) {
     std::string serialize_steam_file = makeStreamSerializeFilePath(serialize_dir);
     if (load(serialize_steam_file, &db_.stream_db_)) {
-      main_scratch_.addStream(db_.stream_db_);
+      scratch_generation_ = main_scratch_.addStream(db_.stream_db_);
     } else {
       return false;
     }
@@ -300,7 +303,30 @@ std::string HsDataBase::makeStreamSerializeFilePath(const char* serialize_dir) c
   return std::string(serialize_dir) + "/" + expressions_sha1_ + ".sdb";
 }
 
+bool HsDataBase::loadFromSnapshot(bool support_stream) {
+  std::shared_ptr<const DatabaseSnapshot> snapshot = snapshot_.load();
+  if (!snapshot ||
+      !snapshot->deserialize(expressions_sha1_, support_stream, &db_.block_db_, &db_.stream_db_)) {
+    return false;
+  }
+
+  scratch_generation_ = main_scratch_.addBlock(db_.block_db_);
+  if (support_stream) {
+    scratch_generation_ = main_scratch_.addStream(db_.stream_db_);
+  }
+
+  from_snapshot_ = true;
+  return true;
+}
+
 void HsDataBase::loadOrCompile(const char* serialize_dir, bool support_stream) {
+  // The SHA1 identifies the database in the serialize directory and in the snapshot
+  expressions_sha1_ = db_.expressions_.sha1();
+
+  if (loadFromSnapshot(support_stream)) {
+    return;
+  }
+
   bool load_from_serialize = false;
 
   if (serialize_dir) {
@@ -320,7 +346,6 @@ void HsDataBase::loadOrCompile(const char* serialize_dir, bool support_stream) {
       // Lock the serialize mutex to prevent concurrent access in this process
       std::lock_guard<std::mutex> locker(serialize_mutex_);
 
-      expressions_sha1_ = db_.expressions_.sha1();
       load_from_serialize = loadFromSerialize(serialize_dir, support_stream);
 
       flock.unlock();
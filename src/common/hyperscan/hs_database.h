@@ -21,7 +21,9 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -35,6 +37,8 @@
 namespace Wge {
 namespace Common {
 namespace Hyperscan {
+class DatabaseSnapshot;
+
 /**
  * Hyperscan database
  */
@@ -116,6 +120,8 @@ public:
   HsDataBase(ExpressionList&& expression_list, bool support_stream,
              const char* serialize_dir = nullptr);
 
+  HsDataBase(const HsDataBase&) = delete;
+
 public:
   const hs_database_t* blockNative() const { return db_.block_db_; }
   const hs_database_t* streamNative() const { return db_.stream_db_; }
@@ -126,10 +132,32 @@ public:
     return db_.expressions_.getPcrePatternList();
   }
 
+  const ExpressionList& expressions() const { return db_.expressions_; }
+
   static Scratch& mainScratch() { return main_scratch_; }
 
+  /**
+   * @return the generation of the main scratch space that fits the database.
+   */
+  uint64_t scratchGeneration() const { return scratch_generation_; }
+
   const std::string& sha1() const { return expressions_sha1_; }
 
+  /**
+   * @return true if the database is deserialized from the attached snapshot rather than compiled.
+   */
+  bool fromSnapshot() const { return from_snapshot_; }
+
+public:
+  /**
+   * Attach the snapshot of the databases. The databases that are constructed after attaching are
+   * deserialized from the snapshot if found, rather than compiled.
+   * @param snapshot the snapshot, nullptr to detach.
+   */
+  static void attachSnapshot(std::shared_ptr<const DatabaseSnapshot> snapshot) {
+    snapshot_.store(std::move(snapshot));
+  }
+
 private:
   struct Database {
     hs_database_t* block_db_{nullptr};
@@ -153,12 +181,16 @@ private:
   std::string makeBlockSerializeFilePath(const char* serialize_dir) const;
   std::string makeStreamSerializeFilePath(const char* serialize_dir) const;
   void loadOrCompile(const char* serialize_dir, bool support_stream);
+  bool loadFromSnapshot(bool support_stream);
 
 private:
   Database db_;
   std::string expressions_sha1_;
+  bool from_snapshot_{false};
+  uint64_t scratch_generation_{0};
   static Scratch main_scratch_;
   static std::mutex serialize_mutex_;
+  static std::atomic<std::shared_ptr<const DatabaseSnapshot>> snapshot_;
 };
 } // namespace Hyperscan
 } // namespace Common
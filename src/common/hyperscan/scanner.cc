@@ -20,6 +20,8 @@
  */
 #include "scanner.h"
 
+#include <algorithm>
+
 #include "../log.h"
 
 namespace Wge {
@@ -27,14 +29,31 @@ namespace Common {
 namespace Hyperscan {
 thread_local std::unique_ptr<Scratch> Scanner::worker_scratch_;
 
+namespace {
+// The joined buffer of the vector scan that grows bigger than this is released after the scan, so
+// a huge collection doesn't pin the memory of the worker thread
+constexpr size_t vector_scan_max_keep_size = 64 * 1024;
+} // namespace
+
 Scanner::Scanner(const std::shared_ptr<HsDataBase> hs_db) : hs_db_(hs_db) {
   pcre_ = std::make_unique<Pcre::Scanner>(&hs_db_->getPcrePatternList());
+
+  const ExpressionList& expressions = hs_db_->expressions();
+  vector_scan_supported_ = hs_db_->blockNative() && expressions.literal() &&
+                           expressions.size() > 0 && !expressions.containsChar(vector_delimiter_);
 }
 
-void Scanner::registMatchCallback(Scratch::MatchCallback cb, void* user_data) const {
-  // Clone the main scratch space
+void Scanner::updateWorkerScratch() const {
+  // Clone the main scratch space, or clone it again if it's older than the database
   if (!worker_scratch_)
     [[unlikely]] { worker_scratch_ = std::make_unique<Scratch>(hs_db_->mainScratch()); }
+  else {
+    worker_scratch_->update(hs_db_->mainScratch(), hs_db_->scratchGeneration());
+  }
+}
+
+void Scanner::registMatchCallback(Scratch::MatchCallback cb, void* user_data) const {
+  updateWorkerScratch();
 
   worker_scratch_->match_cb_ = cb;
   worker_scratch_->match_cb_user_data_ = user_data;
@@ -42,9 +61,7 @@ void Scanner::registMatchCallback(Scratch::MatchCallback cb, void* user_data) co
 
 void Scanner::registPcreRemoveDuplicateCallback(Scratch::PcreRemoveDuplicateCallbak cb,
                                                 void* user_data) const {
-  // Clone the main scratch space
-  if (!worker_scratch_)
-    [[unlikely]] { worker_scratch_ = std::make_unique<Scratch>(hs_db_->mainScratch()); }
+  updateWorkerScratch();
 
   worker_scratch_->pcre_remove_duplicate_cb_ = cb;
   worker_scratch_->pcre_remove_duplicate_cb_user_data_ = user_data;
@@ -52,9 +69,7 @@ void Scanner::registPcreRemoveDuplicateCallback(Scratch::PcreRemoveDuplicateCall
 
 void Scanner::blockScan(std::string_view data, ScanMode mode, Scratch::MatchCallback cb,
                         void* user_data) const {
-  // Clone the main scratch space
-  if (!worker_scratch_)
-    [[unlikely]] { worker_scratch_ = std::make_unique<Scratch>(hs_db_->mainScratch()); }
+  updateWorkerScratch();
 
   // Overwrite the match callback and user data
   if (cb) {
@@ -117,10 +132,78 @@ void Scanner::blockScan(std::string_view data, ScanMode mode, Scratch::MatchCall
   }
 }
 
+void Scanner::vectorScan(std::span<const std::string_view> data, VectorMatchCallback cb,
+                         void* user_data) const {
+  assert(vector_scan_supported_);
+
+  // Join the elements with the delimiter. The literal expressions don't contain the delimiter, so
+  // a match never spans two elements.
+  static thread_local std::string joined;
+  static thread_local std::vector<size_t> offsets;
+  joined.clear();
+  offsets.clear();
+  for (auto element : data) {
+    offsets.emplace_back(joined.size());
+    joined.append(element);
+    joined.push_back(vector_delimiter_);
+  }
+
+  struct FirstMatch {
+    bool matched_;
+    uint64_t id_;
+    unsigned long long from_;
+    unsigned long long to_;
+  };
+
+  // The expressions are compiled with HS_FLAG_SINGLEMATCH, so an expression that matched an
+  // element is not reported again for the following elements. Therefore each scan ceases at the
+  // first match, which belongs to the first matched element of the scanned range, and the next scan
+  // starts from the element that follows it. The clean elements before the first match are not
+  // matched by any expression.
+  std::string_view joined_view = joined;
+  size_t begin = 0;
+  while (begin < offsets.size()) {
+    const size_t base = offsets[begin];
+    FirstMatch first_match{false, 0, 0, 0};
+    blockScan(
+        joined_view.substr(base), ScanMode::Normal,
+        [](uint64_t id, unsigned long long from, unsigned long long to, unsigned int flags,
+           void* user_data) -> int {
+          FirstMatch* first_match = static_cast<FirstMatch*>(user_data);
+          *first_match = {true, id, from, to};
+          return 1;
+        },
+        &first_match);
+    if (!first_match.matched_) {
+      break;
+    }
+
+    // Locate the element by the last byte of the match
+    const unsigned long long from = base + first_match.from_;
+    const unsigned long long to = base + first_match.to_;
+    const unsigned long long last = to > from ? to - 1 : to;
+    const size_t index =
+        std::upper_bound(offsets.begin() + begin, offsets.end(), last) - offsets.begin() - 1;
+    const size_t element_offset = offsets[index];
+
+    // The start of match is zero if the expression is compiled without HS_FLAG_SOM_LEFTMOST
+    if (cb(index, first_match.id_, from > element_offset ? from - element_offset : 0,
+           to - element_offset, user_data)) {
+      break;
+    }
+
+    begin = index + 1;
+  }
+
+  if (joined.capacity() > vector_scan_max_keep_size)
+    [[unlikely]] {
+      std::string().swap(joined);
+      std::vector<size_t>().swap(offsets);
+    }
+}
+
 void Scanner::streamScanStart() const {
-  // clone the main scratch space
-  if (!worker_scratch_)
-    [[unlikely]] { worker_scratch_ = std::make_unique<Scratch>(hs_db_->mainScratch()); }
+  updateWorkerScratch();
 
   assert(worker_scratch_->stream_id_ == nullptr);
   ::hs_open_stream(hs_db_->streamNative(), 0, &worker_scratch_->stream_id_);
@@ -22,6 +22,7 @@
 
 #include <array>
 #include <memory>
+#include <span>
 #include <string_view>
 
 #include "hs_database.h"
@@ -52,10 +53,37 @@ public:
 
   void blockScan(std::string_view data, ScanMode mode = ScanMode::Normal,
                  Scratch::MatchCallback cb = nullptr, void* user_data = nullptr) const;
+
+  using VectorMatchCallback = int (*)(size_t index, uint64_t id, unsigned long long from,
+                                      unsigned long long to, void* user_data);
+
+  /**
+   * Scan the elements of a vector, such as the values of a collection, and report the first match
+   * of each matched element. The results are the same as calling blockScan() for each element and
+   * ceasing at the first match, but the elements are joined into one block so that the clean
+   * elements are scanned by a single hyperscan call.
+   * @param data the elements to scan.
+   * @param cb the callback that is called with the index of the matched element. The offsets are
+   * relative to the element. Returns non-zero to cease the scan.
+   * @param user_data the user data of the callback.
+   * @note it must be called only if vectorScanSupported() returns true.
+   */
+  void vectorScan(std::span<const std::string_view> data, VectorMatchCallback cb,
+                  void* user_data) const;
+
+  /**
+   * Check whether the database can be scanned by vectorScan(). It requires that no expression can
+   * match across the delimiter of the joined elements, that is all the expressions are literal and
+   * don't contain the delimiter.
+   * @return true if the vectorScan() is supported, false otherwise.
+   */
+  bool vectorScanSupported() const { return vector_scan_supported_; }
+
   void streamScanStart() const;
   void streamScan(std::string_view data) const;
   void streamScanStop() const;
   const std::string& databaseSha1() const { return hs_db_->sha1(); }
+  const HsDataBase& database() const { return *hs_db_; }
 
 private:
   using GreedyMatchCache = std::unordered_map<unsigned int,                          // id
@@ -64,15 +92,19 @@ private:
                                                                  >>;
 
 private:
+  void updateWorkerScratch() const;
   static int matchCallback(unsigned int id, unsigned long long from, unsigned long long to,
                            unsigned int flags, void* user_data);
   static int greedyMatchCallback(unsigned int id, unsigned long long from, unsigned long long to,
                                  unsigned int flags, void* user_data);
 
 private:
+  // The delimiter of the joined elements of the vector scan
+  static constexpr char vector_delimiter_ = '\0';
   static thread_local std::unique_ptr<Scratch> worker_scratch_;
   const std::shared_ptr<HsDataBase> hs_db_;
   std::unique_ptr<Pcre::Scanner> pcre_;
+  bool vector_scan_supported_{false};
   unsigned long long max_pcre_scan_front_len_{std::numeric_limits<unsigned int>::max()};
   unsigned long long max_pcre_scan_back_len_{std::numeric_limits<unsigned int>::max()};
 };
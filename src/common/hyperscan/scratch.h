@@ -20,7 +20,10 @@
  */
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
+#include <string_view>
 
 #include <hs/hs.h>
 
@@ -43,10 +46,7 @@ public:
    * thread(rather than forcing us to pass all the databases through addBlock/addStream multiple
    * times).
    */
-  Scratch(const Scratch& scratch) {
-    ::hs_clone_scratch(scratch.block_scratch_, &block_scratch_);
-    ::hs_clone_scratch(scratch.stream_scratch_, &stream_scratch_);
-  }
+  Scratch(const Scratch& scratch) { clone(scratch); }
 
 public:
   /**
@@ -54,10 +54,12 @@ public:
    * If we uses multiple databases, only a single scratch space is needed: in this case, call this
    * function for each database.
    * @param block_db: block mode database
+   * @return the generation of the scratch space that fits the database.
    */
-  void addBlock(const hs_database_t* block_db) {
+  uint64_t addBlock(const hs_database_t* block_db) {
     std::lock_guard<std::mutex> locker(block_scratch_mutex_);
     ::hs_alloc_scratch(block_db, &block_scratch_);
+    return ++generation_;
   }
 
   /**
@@ -65,10 +67,25 @@ public:
    * If we uses multiple databases, only a single scratch space is needed: in this case, call this
    * function for each database.
    * @param stream_db: stream mode database
+   * @return the generation of the scratch space that fits the database.
    */
-  void addStream(const hs_database_t* stream_db) {
+  uint64_t addStream(const hs_database_t* stream_db) {
     std::lock_guard<std::mutex> locker(stream_scratch_mutex_);
     ::hs_alloc_scratch(stream_db, &stream_scratch_);
+    return ++generation_;
+  }
+
+  /**
+   * Clone the scratch space again if it's older than the generation that a database requires.
+   * The main scratch space is grown (and reallocated) when a database is added after the worker
+   * thread cloned it, e.g. by a reload, and the stale scratch space is too small to scan the new
+   * database.
+   * @param scratch the main scratch space
+   * @param generation the generation that is returned by addBlock/addStream for the database.
+   */
+  void update(const Scratch& scratch, uint64_t generation) {
+    if (generation_ < generation)
+      [[unlikely]] { clone(scratch); }
   }
 
   /**
@@ -79,12 +96,14 @@ public:
       std::lock_guard<std::mutex> locker(block_scratch_mutex_);
       if (block_scratch_) {
         ::hs_free_scratch(block_scratch_);
+        block_scratch_ = nullptr;
       }
     }
     {
       std::lock_guard<std::mutex> locker(stream_scratch_mutex_);
       if (stream_scratch_) {
         ::hs_free_scratch(stream_scratch_);
+        stream_scratch_ = nullptr;
       }
     }
   }
@@ -115,8 +134,31 @@ public:
   void* pcre_remove_duplicate_cb_user_data_;
 
 private:
-  std::mutex block_scratch_mutex_;
-  std::mutex stream_scratch_mutex_;
+  // The main scratch space may be reallocated by addBlock/addStream on the other thread, so it's
+  // cloned with the locks held.
+  void clone(const Scratch& scratch) {
+    std::scoped_lock locker(scratch.block_scratch_mutex_, scratch.stream_scratch_mutex_);
+    hs_scratch_t* block_scratch = nullptr;
+    hs_scratch_t* stream_scratch = nullptr;
+    if (scratch.block_scratch_) {
+      ::hs_clone_scratch(scratch.block_scratch_, &block_scratch);
+    }
+    if (scratch.stream_scratch_) {
+      ::hs_clone_scratch(scratch.stream_scratch_, &stream_scratch);
+    }
+
+    free();
+    block_scratch_ = block_scratch;
+    stream_scratch_ = stream_scratch;
+    generation_ = scratch.generation_.load();
+  }
+
+private:
+  mutable std::mutex block_scratch_mutex_;
+  mutable std::mutex stream_scratch_mutex_;
+
+  // Increased each time the scratch space is grown
+  std::atomic<uint64_t> generation_{0};
 };
 } // namespace Hyperscan
 } // namespace Common
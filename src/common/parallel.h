@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wge {
+namespace Common {
+/**
+ * Call the function with each index in [0, count) by a group of the worker threads, and wait for
+ * all of the calls to finish. The indexes are handed out one at a time, so the slow tasks don't
+ * hold up the others. The calling thread is one of the workers.
+ * @param count the count of the tasks.
+ * @param concurrency the max count of the threads. If it is 0, the hardware concurrency is used.
+ * @param func the task function. It is called concurrently, so it must be thread-safe.
+ * @note the first exception thrown by the tasks is rethrown after all of the workers are joined.
+ */
+inline void parallelFor(size_t count, size_t concurrency, const std::function<void(size_t)>& func) {
+  if (concurrency == 0) {
+    concurrency = std::max(1u, std::thread::hardware_concurrency());
+  }
+  concurrency = std::min(concurrency, count);
+
+  if (concurrency <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_index{0};
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < count; i = next_index++) {
+      try {
+        func(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(concurrency - 1);
+  for (size_t i = 1; i < concurrency; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+} // namespace Common
+} // namespace Wge
@@ -25,10 +25,84 @@
 namespace Wge {
 namespace Common {
 namespace Ragel {
-void Json::init(std::string_view json_str, std::forward_list<std::string>& escape_buffer) {
+void Json::init(std::string_view json_str, std::pmr::forward_list<std::pmr::string>& escape_buffer,
+                size_t max_count) {
   key_value_map_.reserve(32);
   key_value_linked_.reserve(32);
   parseJson(json_str, key_value_map_, key_value_linked_, escape_buffer);
+  truncate(max_count);
+}
+
+Transformation::StreamResult Json::initStream(std::string_view json_str, bool end_stream,
+                                              size_t max_count) {
+  if (!stream_)
+    [[unlikely]] {
+      stream_ = std::make_unique<Stream>();
+      stream_->state_ = parseJsonNewStream();
+      key_value_map_.reserve(32);
+      key_value_linked_.reserve(32);
+    }
+
+  key_value_map_.clear();
+  key_value_linked_.clear();
+  stream_->linked_.clear();
+  stream_->joined_buffer_.clear();
+
+  auto result = parseJsonStream(json_str, key_value_map_, stream_->linked_, *stream_->state_,
+                                end_stream);
+
+  for (auto& kv : stream_->linked_) {
+    // The fragments of the partial key-value pair have the same index, so a different index means
+    // that the partial key-value pair is complete.
+    if (stream_->has_partial_ && stream_->partial_index_ != kv.index_) {
+      flushPartial();
+    }
+
+    if (kv.partial_) {
+      stream_->has_partial_ = true;
+      stream_->partial_index_ = kv.index_;
+      stream_->partial_key_.append(kv.key_);
+      stream_->partial_value_.append(kv.value_);
+    } else {
+      // The complete key-value pairs were inserted into the map by the parser already
+      key_value_linked_.emplace_back(kv.key_, kv.value_);
+    }
+  }
+
+  if (end_stream && stream_->has_partial_) {
+    flushPartial();
+  }
+
+  truncate(max_count);
+
+  return result;
+}
+
+void Json::flushPartial() {
+  stream_->joined_buffer_.emplace_front(std::move(stream_->partial_key_));
+  std::string_view key = stream_->joined_buffer_.front();
+  stream_->joined_buffer_.emplace_front(std::move(stream_->partial_value_));
+  std::string_view value = stream_->joined_buffer_.front();
+  key_value_map_.insert({key, value});
+  key_value_linked_.emplace_back(key, value);
+
+  stream_->has_partial_ = false;
+  stream_->partial_key_.clear();
+  stream_->partial_value_.clear();
+}
+
+void Json::truncate(size_t max_count) {
+  truncated_ = max_count && key_value_linked_.size() > max_count;
+  if (!truncated_)
+    [[likely]] { return; }
+
+  // The parser inserts the key-value pairs into the map and the linked list at the same time, so
+  // we rebuild the map from the truncated linked list.
+  key_value_linked_.resize(max_count);
+  key_value_map_.clear();
+  for (auto& [key, value] : key_value_linked_) {
+    key_value_map_.insert({key, value});
+  }
 }
 
 std::unique_ptr<Transformation::StreamState, std::function<void(Transformation::StreamState*)>>
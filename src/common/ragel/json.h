@@ -22,6 +22,7 @@
 
 #include <forward_list>
 #include <list>
+#include <memory_resource>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -35,7 +36,21 @@ namespace Common {
 namespace Ragel {
 class Json {
 public:
-  void init(std::string_view json_str, std::forward_list<std::string>& escape_buffer);
+  /**
+   * Parse the JSON string.
+   * @param json_str the JSON string.
+   * @param escape_buffer the buffer to store the escaped strings.
+   * @param max_count the max count of the key-value pairs, the rest will be ignored. 0 means
+   * unlimited.
+   */
+  void init(std::string_view json_str, std::pmr::forward_list<std::pmr::string>& escape_buffer,
+            size_t max_count = 0);
+
+  /**
+   * @return true if some key-value pairs were ignored because the count of the key-value pairs
+   * reached the max count.
+   */
+  bool truncated() const { return truncated_; }
 
 public:
   const std::unordered_multimap<std::string_view, std::string_view>& getKeyValues() const {
@@ -48,6 +63,34 @@ public:
   void clear() {
     key_value_map_.clear();
     key_value_linked_.clear();
+    truncated_ = false;
+    stream_.reset();
+  }
+
+  /**
+   * Parse a chunk of the JSON string incrementally.
+   * The complete key-value pairs that were parsed from the chunk replace the key-value pairs of the
+   * previous chunk, so the memory usage is bounded by the chunk size rather than the size of the
+   * whole JSON string. A key-value pair that spans multiple chunks is reported once it is complete.
+   * @param json_str the chunk of the JSON string.
+   * @param end_stream indicates if this is the last chunk.
+   * @param max_count the max count of the key-value pairs of this chunk, the rest will be ignored.
+   * 0 means unlimited.
+   * @return the result of the stream parsing.
+   * @note The views of keys and values are valid until the next call.
+   */
+  Transformation::StreamResult initStream(std::string_view json_str, bool end_stream,
+                                          size_t max_count = 0);
+
+  /**
+   * @return the size of the data that is held by the incremental parsing until the next chunk,
+   * that is the incomplete token and the incomplete key-value pair.
+   */
+  size_t partialSize() const {
+    if (!stream_)
+      [[unlikely]] { return 0; }
+    return stream_->state_->buffer_.size() + stream_->partial_key_.size() +
+           stream_->partial_value_.size();
   }
 
 public:
@@ -81,9 +124,32 @@ public:
               std::list<KeyValuePair>& key_value_linked, Transformation::StreamState& state,
               bool end_stream);
 
+private:
+  void flushPartial();
+  void truncate(size_t max_count);
+
 private:
   std::unordered_multimap<std::string_view, std::string_view> key_value_map_;
   std::vector<std::pair<std::string_view, std::string_view>> key_value_linked_;
+  bool truncated_{false};
+
+  // The state of the incremental parsing
+  struct Stream {
+    std::unique_ptr<Transformation::StreamState, std::function<void(Transformation::StreamState*)>>
+        state_;
+    std::list<KeyValuePair> linked_;
+
+    // The key-value pair that spans multiple chunks. The fragments are joined until the pair is
+    // complete.
+    bool has_partial_{false};
+    uint32_t partial_index_{0};
+    std::string partial_key_;
+    std::string partial_value_;
+
+    // The joined key-value pairs that were reported in the current chunk.
+    std::forward_list<std::string> joined_buffer_;
+  };
+  std::unique_ptr<Stream> stream_;
 };
 } // namespace Ragel
 } // namespace Common
@@ -22,6 +22,7 @@
 
 #include <forward_list>
 #include <list>
+#include <memory_resource>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -238,7 +239,7 @@ static std::string_view trimRight(const char* start, size_t size) {
 static bool parseJson(std::string_view input,
                       std::unordered_multimap<std::string_view, std::string_view>& key_value_map,
                       std::vector<std::pair<std::string_view, std::string_view>>& key_value_linked,
-                      std::forward_list<std::string>& escape_buffer) {
+                      std::pmr::forward_list<std::pmr::string>& escape_buffer) {
   key_value_map.clear();
   key_value_linked.clear();
 
@@ -658,6 +659,14 @@ parseJsonStream(std::string_view input,
   %% write exec;
       // clang-format on
 
+      // The rest of the stream is not parsed once the input is invalid
+      if (error)
+        [[unlikely]] {
+          state.buffer_.clear();
+          state.state_.set(static_cast<size_t>(StreamState::State::INVALID));
+          return StreamResult::INVALID_INPUT;
+        }
+
       std::string_view partial_key_view;
       std::string_view partial_value_view;
       if (partial_pks && partial_pke) {
@@ -26,7 +26,7 @@ namespace Wge {
 namespace Common {
 namespace Ragel {
 void MultiPart::init(std::string_view content_type, std::string_view multi_part,
-                     uint32_t max_file_count) {
+                     uint32_t max_file_count, size_t max_arg_count) {
   std::string_view boundary = ::parseContentType(content_type, multipart_strict_error_);
   if (boundary.empty()) {
     return;
@@ -35,9 +35,10 @@ void MultiPart::init(std::string_view content_type, std::string_view multi_part,
   name_value_linked_.reserve(5);
   name_filename_map_.reserve(5);
   name_filename_linked_.reserve(5);
-  ::parseMultiPart(multi_part, boundary, name_value_map_, name_value_linked_, name_filename_map_,
-                   name_filename_linked_, headers_map_, headers_linked_, multipart_strict_error_,
-                   max_file_count);
+  truncated_ = ::parseMultiPart(multi_part, boundary, name_value_map_, name_value_linked_,
+                                name_filename_map_, name_filename_linked_, headers_map_,
+                                headers_linked_, multipart_strict_error_, max_file_count,
+                                max_arg_count);
 }
 
 } // namespace Ragel
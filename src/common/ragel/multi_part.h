@@ -34,8 +34,22 @@ namespace Ragel {
  */
 class MultiPart {
 public:
+  /**
+   * Parse the multipart/form-data content.
+   * @param content_type the value of the content-type header that contains the boundary.
+   * @param multi_part the multipart/form-data content.
+   * @param max_file_count the max count of the files. 0 means unlimited.
+   * @param max_arg_count the max count of the name-value pairs, the rest will be ignored. 0 means
+   * unlimited.
+   */
   void init(std::string_view content_type, std::string_view multi_part,
-            uint32_t max_file_count = 0);
+            uint32_t max_file_count = 0, size_t max_arg_count = 0);
+
+  /**
+   * @return true if some name-value pairs were ignored because the count of the name-value pairs
+   * reached the max count.
+   */
+  bool truncated() const { return truncated_; }
 
 public:
   const std::unordered_multimap<std::string_view, std::string_view>& getNameValue() const {
@@ -64,6 +78,17 @@ public:
 
   const MultipartStrictError& getError() const { return multipart_strict_error_; }
 
+  void clear() {
+    name_value_map_.clear();
+    name_value_linked_.clear();
+    name_filename_map_.clear();
+    name_filename_linked_.clear();
+    headers_map_.clear();
+    headers_linked_.clear();
+    multipart_strict_error_.reset();
+    truncated_ = false;
+  }
+
 private:
   std::unordered_multimap<std::string_view, std::string_view> name_value_map_;
   std::vector<std::pair<std::string_view, std::string_view>> name_value_linked_;
@@ -72,6 +97,7 @@ private:
   std::unordered_multimap<std::string_view, std::string_view> headers_map_;
   std::vector<std::pair<std::string_view, std::string_view>> headers_linked_;
   MultipartStrictError multipart_strict_error_;
+  bool truncated_{false};
 };
 } // namespace Ragel
 } // namespace Common
@@ -303,9 +303,14 @@ static std::string_view parseContentType(std::string_view input,
       if(token.starts_with(boundary)) {
         if(filename.empty()) {
           if(value_len > 0) {
-            MULTI_PART_LOG(std::format("add name:{}, value:{}", name, std::string_view(p_value_start, value_len)));
-            auto result = name_value_map.insert({name, std::string_view(p_value_start, value_len)});
-            name_value_linked.emplace_back(name, std::string_view(p_value_start, value_len));
+            if(max_arg_count && name_value_linked.size() >= max_arg_count) {
+              MULTI_PART_LOG("skip name-value: the count of arguments reaches the max count");
+              truncated = true;
+            } else {
+              MULTI_PART_LOG(std::format("add name:{}, value:{}", name, std::string_view(p_value_start, value_len)));
+              auto result = name_value_map.insert({name, std::string_view(p_value_start, value_len)});
+              name_value_linked.emplace_back(name, std::string_view(p_value_start, value_len));
+            }
           }
         }else{
           MULTI_PART_LOG(std::format("add name:{}, filename:{}", name, filename));
@@ -364,7 +369,7 @@ static std::string_view parseContentType(std::string_view input,
       return std::string_view(start, end - start);
     }
 
-    static void
+    static bool
     parseMultiPart(std::string_view input, std::string_view boundary,
                    std::unordered_multimap<std::string_view, std::string_view>& name_value_map,
                    std::vector<std::pair<std::string_view, std::string_view>>& name_value_linked,
@@ -372,7 +377,8 @@ static std::string_view parseContentType(std::string_view input,
                    std::vector<std::pair<std::string_view, std::string_view>>& name_filename_linked,
                    std::unordered_multimap<std::string_view, std::string_view>& headers_map,
                    std::vector<std::pair<std::string_view, std::string_view>>& headers_linked,
-                   Wge::MultipartStrictError& error_code, uint32_t max_file_count) {
+                   Wge::MultipartStrictError& error_code, uint32_t max_file_count,
+                   size_t max_arg_count = 0) {
       using namespace Wge;
 
       name_value_map.clear();
@@ -398,6 +404,7 @@ static std::string_view parseContentType(std::string_view input,
       uint32_t file_count = 0;
       bool parse_complete = false;
       std::string_view header_name;
+      bool truncated = false;
 
       // clang-format off
 	%% write init;
@@ -407,11 +414,16 @@ static std::string_view parseContentType(std::string_view input,
       // If there is no end boundary, process the last part
       if (filename.empty()) {
         if (p_value_start && value_len > 0) {
-          MULTI_PART_LOG("no end boundary, process last part");
-          MULTI_PART_LOG(std::format("add name:{}, value:{}", name,
-                                     std::string_view(p_value_start, value_len)));
-          auto result = name_value_map.insert({name, std::string_view(p_value_start, value_len)});
-          name_value_linked.emplace_back(name, std::string_view(p_value_start, value_len));
+          if (max_arg_count && name_value_linked.size() >= max_arg_count) {
+            MULTI_PART_LOG("skip name-value: the count of arguments reaches the max count");
+            truncated = true;
+          } else {
+            MULTI_PART_LOG("no end boundary, process last part");
+            MULTI_PART_LOG(std::format("add name:{}, value:{}", name,
+                                       std::string_view(p_value_start, value_len)));
+            auto result = name_value_map.insert({name, std::string_view(p_value_start, value_len)});
+            name_value_linked.emplace_back(name, std::string_view(p_value_start, value_len));
+          }
         }
       } else {
         MULTI_PART_LOG("no end boundary, process last part");
@@ -433,6 +445,8 @@ static std::string_view parseContentType(std::string_view input,
       //   name_filename_map.clear();
       //   name_filename_linked.clear();
       // }
+
+      return truncated;
     }
 
 #undef MULTI_PART_LOG
\ No newline at end of file
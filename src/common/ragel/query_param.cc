@@ -26,10 +26,12 @@ namespace Wge {
 namespace Common {
 namespace Ragel {
 void QueryParam::init(std::string_view query_param_str,
-                      std::forward_list<std::string>& urldecoded_buffer) {
+                      std::pmr::forward_list<std::pmr::string>& urldecoded_buffer,
+                      size_t max_count) {
   query_param_map_.reserve(5);
   query_param_linked_.reserve(5);
-  ::parseQueryParam(query_param_str, query_param_map_, query_param_linked_, urldecoded_buffer);
+  truncated_ = ::parseQueryParam(query_param_str, query_param_map_, query_param_linked_,
+                                 urldecoded_buffer, max_count);
 }
 
 } // namespace Ragel
@@ -22,6 +22,7 @@
 
 #include <forward_list>
 #include <list>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -32,7 +33,21 @@ namespace Common {
 namespace Ragel {
 class QueryParam {
 public:
-  void init(std::string_view query_param_str, std::forward_list<std::string>& urldecoded_buffer);
+  /**
+   * Parse the query parameters.
+   * @param query_param_str the query parameters string.
+   * @param urldecoded_buffer the buffer to store the url decoded strings.
+   * @param max_count the max count of the query parameters, the rest will be ignored. 0 means
+   * unlimited.
+   */
+  void init(std::string_view query_param_str,
+            std::pmr::forward_list<std::pmr::string>& urldecoded_buffer, size_t max_count = 0);
+
+  /**
+   * @return true if the parsing was stopped because the count of the query parameters reached the
+   * max count.
+   */
+  bool truncated() const { return truncated_; }
 
 public:
   const std::unordered_multimap<std::string_view, std::string_view>& get() const {
@@ -43,14 +58,23 @@ public:
     return query_param_linked_;
   }
 
+  void clear() {
+    query_param_map_.clear();
+    query_param_linked_.clear();
+    truncated_ = false;
+  }
+
   /**
    * Merge the query parameters.
    * @param query_params the query parameters to be merged.
+   * @param max_count the max count of the query parameters after merged, the rest will be ignored
+   * and truncated() returns true. 0 means unlimited.
    * @note Please ensure that the lifetime of the key and value in the query_params is longer than
    * the lifetime of this object. If not, we should call the overload method with the
    * html_decode_buffer parameter to ensure the lifetime of the key and value.
    */
-  void merge(const std::vector<std::pair<std::string_view, std::string_view>>& query_params) {
+  void merge(const std::vector<std::pair<std::string_view, std::string_view>>& query_params,
+             size_t max_count = 0) {
     query_param_linked_.reserve(query_param_linked_.size() + query_params.size());
     for (const auto& [key, value] : query_params) {
       // Skip empty values
@@ -58,6 +82,12 @@ public:
         continue;
       }
 
+      if (max_count && query_param_linked_.size() >= max_count)
+        [[unlikely]] {
+          truncated_ = true;
+          break;
+        }
+
       query_param_linked_.emplace_back(key, value);
       query_param_map_.emplace(key, value);
     }
@@ -66,6 +96,7 @@ public:
 private:
   std::unordered_multimap<std::string_view, std::string_view> query_param_map_;
   std::vector<std::pair<std::string_view, std::string_view>> query_param_linked_;
+  bool truncated_{false};
 };
 } // namespace Ragel
 } // namespace Common
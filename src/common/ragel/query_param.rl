@@ -22,6 +22,7 @@
 
 #include <cstring>
 #include <forward_list>
+#include <memory_resource>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -69,6 +70,12 @@
       p_start_value = nullptr;
       key_len = 0;
       value_len = 0;
+
+      // Stop parsing if the count of the query params reaches the max count
+      if (max_count && query_params_linked.size() >= max_count) [[unlikely]] {
+        truncated = p < pe;
+        fbreak;
+      }
     }
   }
 
@@ -82,11 +89,12 @@
 %% write data;
 // clang-format on
 
-static void
+static bool
 parseQueryParam(std::string_view input,
                 std::unordered_multimap<std::string_view, std::string_view>& query_params,
                 std::vector<std::pair<std::string_view, std::string_view>>& query_params_linked,
-                std::forward_list<std::string>& urldecoded_storage) {
+                std::pmr::forward_list<std::pmr::string>& urldecoded_storage,
+                size_t max_count = 0) {
   query_params.clear();
   query_params_linked.clear();
 
@@ -99,9 +107,12 @@ parseQueryParam(std::string_view input,
   const char* p_start_value = nullptr;
   size_t key_len = 0;
   size_t value_len = 0;
+  bool truncated = false;
 
   // clang-format off
 	%% write init;
   %% write exec;
   // clang-format on
+
+  return truncated;
 }
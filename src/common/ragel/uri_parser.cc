@@ -26,7 +26,7 @@ namespace Wge {
 namespace Common {
 namespace Ragel {
 void UriParser::init(std::string_view uri, Transaction::RequestLineInfo& req_line_info,
-                     std::forward_list<std::string>& parser_buffer) {
+                     std::pmr::forward_list<std::pmr::string>& parser_buffer) {
   ::uriParser(uri, req_line_info.uri_, req_line_info.relative_uri_, req_line_info.query_,
               req_line_info.base_name_, parser_buffer);
 }
@@ -30,7 +30,7 @@ namespace Ragel {
 class UriParser {
 public:
   void init(std::string_view uri, Transaction::RequestLineInfo& req_line_info,
-            std::forward_list<std::string>& parser_buffer);
+            std::pmr::forward_list<std::pmr::string>& parser_buffer);
 };
 } // namespace Ragel
 } // namespace Common
@@ -22,6 +22,7 @@
 
 #include <cstring>
 #include <forward_list>
+#include <memory_resource>
 #include <string_view>
 
 #include <url_decode.h>
@@ -72,7 +73,7 @@
 
 static void uriParser(std::string_view input, std::string_view& uri, std::string_view& relative_uri,
                       std::string_view& query, std::string_view& base_name,
-                      std::forward_list<std::string>& parser_buffer) {
+                      std::pmr::forward_list<std::pmr::string>& parser_buffer) {
 
   const char* p = input.data();
   const char* pe = p + input.size();
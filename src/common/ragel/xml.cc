@@ -25,7 +25,8 @@
 namespace Wge {
 namespace Common {
 namespace Ragel {
-void Xml::init(std::string_view xml_str, std::forward_list<std::string>& html_decode_buffer) {
+void Xml::init(std::string_view xml_str,
+               std::pmr::forward_list<std::pmr::string>& html_decode_buffer) {
   attributes_.reserve(20);
   tags_.reserve(20);
   tag_values_str_.reserve(xml_str.size() / 2 + 1);
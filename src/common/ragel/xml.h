@@ -21,6 +21,7 @@
 #pragma once
 
 #include <forward_list>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -30,7 +31,7 @@ namespace Common {
 namespace Ragel {
 class Xml {
 public:
-  void init(std::string_view xml_str, std::forward_list<std::string>& html_decode_buffer);
+  void init(std::string_view xml_str, std::pmr::forward_list<std::pmr::string>& html_decode_buffer);
 
 public:
   const std::vector<std::pair<std::string_view, std::string_view>>& getAttributes() const {
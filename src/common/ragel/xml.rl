@@ -21,6 +21,7 @@
 #pragma once
 
 #include <forward_list>
+#include <memory_resource>
 #include <stack>
 #include <string_view>
 #include <utility>
@@ -229,7 +230,7 @@
                            std::vector<std::pair<std::string_view, std::string_view>>& attributes,
                            std::vector<std::pair<std::string_view, std::string_view>>& tags,
                            std::string& tag_values_str,
-                           std::forward_list<std::string>& html_decode_buffer) {
+                           std::pmr::forward_list<std::pmr::string>& html_decode_buffer) {
 
         const char* p = input.data();
         const char* pe = p + input.size();
@@ -0,0 +1,436 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "byte_kernel.h"
+
+#include <array>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WGE_SIMD_X86
+#endif
+
+namespace Wge {
+namespace Common {
+namespace Simd {
+namespace {
+constexpr char hex_table[] = "0123456789abcdef";
+
+// The parity of the 4 bits
+constexpr char nibble_parity_table[] = {0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0};
+
+inline bool inRange(unsigned char c, unsigned char low, unsigned char high) {
+  return static_cast<unsigned char>(c - low) <= static_cast<unsigned char>(high - low);
+}
+
+inline unsigned char parityOf(unsigned char c, Parity parity) {
+  unsigned char low7 = c & 0x7f;
+  switch (parity) {
+  case Parity::Even:
+    return low7 | ((nibble_parity_table[low7 & 0x0f] ^ nibble_parity_table[low7 >> 4]) << 7);
+  case Parity::Odd:
+    return low7 | ((nibble_parity_table[low7 & 0x0f] ^ nibble_parity_table[low7 >> 4] ^ 1) << 7);
+  default:
+    return low7;
+  }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Scalar
+
+size_t findInRangeScalar(const char* data, size_t size, unsigned char low, unsigned char high) {
+  for (size_t i = 0; i < size; ++i) {
+    if (inRange(data[i], low, high)) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+size_t findWhitespaceScalar(const char* data, size_t size, bool with_nbsp) {
+  for (size_t i = 0; i < size; ++i) {
+    if (isWhitespace(data[i], with_nbsp)) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+void flipCaseScalar(const char* src, size_t size, char* dst, unsigned char low,
+                    unsigned char high) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = inRange(src[i], low, high) ? src[i] ^ 0x20 : src[i];
+  }
+}
+
+void hexEncodeScalar(const char* src, size_t size, char* dst) {
+  for (size_t i = 0; i < size; ++i) {
+    unsigned char c = src[i];
+    dst[i * 2] = hex_table[c >> 4];
+    dst[i * 2 + 1] = hex_table[c & 0x0f];
+  }
+}
+
+bool parity7BitScalar(const char* src, size_t size, char* dst, Parity parity) {
+  bool changed = false;
+  for (size_t i = 0; i < size; ++i) {
+    unsigned char c = parityOf(src[i], parity);
+    changed |= c != static_cast<unsigned char>(src[i]);
+    dst[i] = c;
+  }
+  return changed;
+}
+
+size_t findNotInSetScalar(const char* data, size_t size, const ByteSet& set, const uint8_t*,
+                          const uint8_t*) {
+  for (size_t i = 0; i < size; ++i) {
+    if (!set.test(data[i])) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+#ifdef WGE_SIMD_X86
+// ---------------------------------------------------------------------------------------------
+// SSE4.2
+
+#define WGE_TARGET_SSE __attribute__((target("sse4.2")))
+
+WGE_TARGET_SSE inline __m128i inRangeSse(__m128i v, unsigned char low, unsigned char high) {
+  __m128i d = _mm_sub_epi8(v, _mm_set1_epi8(low));
+  return _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(high - low)), d);
+}
+
+WGE_TARGET_SSE inline __m128i whitespaceSse(__m128i v, bool with_nbsp) {
+  __m128i m = _mm_or_si128(inRangeSse(v, '\t', '\r'), _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+  if (with_nbsp) {
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(0xa0))));
+  }
+  return m;
+}
+
+WGE_TARGET_SSE size_t findInRangeSse(const char* data, size_t size, unsigned char low,
+                                     unsigned char high) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int mask = _mm_movemask_epi8(inRangeSse(v, low, high));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  size_t pos = findInRangeScalar(data + i, size - i, low, high);
+  return pos == std::string_view::npos ? pos : i + pos;
+}
+
+WGE_TARGET_SSE size_t findWhitespaceSse(const char* data, size_t size, bool with_nbsp) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int mask = _mm_movemask_epi8(whitespaceSse(v, with_nbsp));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  size_t pos = findWhitespaceScalar(data + i, size - i, with_nbsp);
+  return pos == std::string_view::npos ? pos : i + pos;
+}
+
+WGE_TARGET_SSE void flipCaseSse(const char* src, size_t size, char* dst, unsigned char low,
+                                unsigned char high) {
+  size_t i = 0;
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    v = _mm_xor_si128(v, _mm_and_si128(inRangeSse(v, low, high), case_bit));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+  }
+  flipCaseScalar(src + i, size - i, dst + i, low, high);
+}
+
+WGE_TARGET_SSE void hexEncodeSse(const char* src, size_t size, char* dst) {
+  size_t i = 0;
+  const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_table));
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble_mask));
+    __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(v, nibble_mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+  }
+  hexEncodeScalar(src + i, size - i, dst + i * 2);
+}
+
+WGE_TARGET_SSE bool parity7BitSse(const char* src, size_t size, char* dst, Parity parity) {
+  size_t i = 0;
+  bool changed = false;
+  const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_parity_table));
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  const __m128i low7_mask = _mm_set1_epi8(0x7f);
+  const __m128i odd = _mm_set1_epi8(parity == Parity::Odd ? 1 : 0);
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i result = _mm_and_si128(v, low7_mask);
+    if (parity != Parity::Zero) {
+      __m128i bits = _mm_xor_si128(
+          _mm_shuffle_epi8(table, _mm_and_si128(result, nibble_mask)),
+          _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(result, 4), nibble_mask)));
+      result = _mm_or_si128(result, _mm_slli_epi16(_mm_xor_si128(bits, odd), 7));
+    }
+    changed |= _mm_movemask_epi8(_mm_cmpeq_epi8(result, v)) != 0xffff;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+  }
+  return parity7BitScalar(src + i, size - i, dst + i, parity) || changed;
+}
+
+WGE_TARGET_SSE size_t findNotInSetSse(const char* data, size_t size, const ByteSet& set,
+                                      const uint8_t* low_rows, const uint8_t* high_rows) {
+  size_t i = 0;
+  const __m128i low_table = _mm_load_si128(reinterpret_cast<const __m128i*>(low_rows));
+  const __m128i high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(high_rows));
+  const __m128i row_bit_table = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32,
+                                              64, -128);
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i column = _mm_and_si128(v, nibble_mask);
+    __m128i row = _mm_and_si128(_mm_srli_epi16(v, 4), nibble_mask);
+
+    // Select the row bitmap by the high bit of the byte, and test the bit of the row
+    __m128i rows = _mm_blendv_epi8(_mm_shuffle_epi8(low_table, column),
+                                   _mm_shuffle_epi8(high_table, column), v);
+    __m128i row_bit = _mm_shuffle_epi8(row_bit_table, row);
+    __m128i in_set = _mm_cmpeq_epi8(_mm_and_si128(rows, row_bit), row_bit);
+    int mask = _mm_movemask_epi8(in_set) ^ 0xffff;
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  size_t pos = findNotInSetScalar(data + i, size - i, set, low_rows, high_rows);
+  return pos == std::string_view::npos ? pos : i + pos;
+}
+
+// ---------------------------------------------------------------------------------------------
+// AVX2
+
+#define WGE_TARGET_AVX2 __attribute__((target("avx2")))
+
+WGE_TARGET_AVX2 inline __m256i inRangeAvx2(__m256i v, unsigned char low, unsigned char high) {
+  __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(high - low)), d);
+}
+
+WGE_TARGET_AVX2 inline __m256i whitespaceAvx2(__m256i v, bool with_nbsp) {
+  __m256i m =
+      _mm256_or_si256(inRangeAvx2(v, '\t', '\r'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+  if (with_nbsp) {
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(0xa0))));
+  }
+  return m;
+}
+
+WGE_TARGET_AVX2 size_t findInRangeAvx2(const char* data, size_t size, unsigned char low,
+                                       unsigned char high) {
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    uint32_t mask = _mm256_movemask_epi8(inRangeAvx2(v, low, high));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  size_t pos = findInRangeSse(data + i, size - i, low, high);
+  return pos == std::string_view::npos ? pos : i + pos;
+}
+
+WGE_TARGET_AVX2 size_t findWhitespaceAvx2(const char* data, size_t size, bool with_nbsp) {
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    uint32_t mask = _mm256_movemask_epi8(whitespaceAvx2(v, with_nbsp));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  size_t pos = findWhitespaceSse(data + i, size - i, with_nbsp);
+  return pos == std::string_view::npos ? pos : i + pos;
+}
+
+WGE_TARGET_AVX2 void flipCaseAvx2(const char* src, size_t size, char* dst, unsigned char low,
+                                  unsigned char high) {
+  size_t i = 0;
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    v = _mm256_xor_si256(v, _mm256_and_si256(inRangeAvx2(v, low, high), case_bit));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+  }
+  flipCaseSse(src + i, size - i, dst + i, low, high);
+}
+
+WGE_TARGET_AVX2 void hexEncodeAvx2(const char* src, size_t size, char* dst) {
+  size_t i = 0;
+  const __m256i table =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_table)));
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i high =
+        _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble_mask));
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble_mask));
+
+    // The unpack works in each 128-bit lane, so the lanes are reordered before storing
+    __m256i unpack_low = _mm256_unpacklo_epi8(high, low);
+    __m256i unpack_high = _mm256_unpackhi_epi8(high, low);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2),
+                        _mm256_permute2x128_si256(unpack_low, unpack_high, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2 + 32),
+                        _mm256_permute2x128_si256(unpack_low, unpack_high, 0x31));
+  }
+  hexEncodeSse(src + i, size - i, dst + i * 2);
+}
+
+WGE_TARGET_AVX2 bool parity7BitAvx2(const char* src, size_t size, char* dst, Parity parity) {
+  size_t i = 0;
+  bool changed = false;
+  const __m256i table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_parity_table)));
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  const __m256i low7_mask = _mm256_set1_epi8(0x7f);
+  const __m256i odd = _mm256_set1_epi8(parity == Parity::Odd ? 1 : 0);
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i result = _mm256_and_si256(v, low7_mask);
+    if (parity != Parity::Zero) {
+      __m256i bits = _mm256_xor_si256(
+          _mm256_shuffle_epi8(table, _mm256_and_si256(result, nibble_mask)),
+          _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(result, 4), nibble_mask)));
+      result = _mm256_or_si256(result, _mm256_slli_epi16(_mm256_xor_si256(bits, odd), 7));
+    }
+    changed |= static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(result, v))) !=
+               0xffffffff;
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+  }
+  return parity7BitSse(src + i, size - i, dst + i, parity) || changed;
+}
+
+WGE_TARGET_AVX2 size_t findNotInSetAvx2(const char* data, size_t size, const ByteSet& set,
+                                        const uint8_t* low_rows, const uint8_t* high_rows) {
+  size_t i = 0;
+  const __m256i low_table = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(low_rows)));
+  const __m256i high_table = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(high_rows)));
+  const __m256i row_bit_table =
+      _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16,
+                       32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    __m256i column = _mm256_and_si256(v, nibble_mask);
+    __m256i row = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble_mask);
+    __m256i rows = _mm256_blendv_epi8(_mm256_shuffle_epi8(low_table, column),
+                                      _mm256_shuffle_epi8(high_table, column), v);
+    __m256i row_bit = _mm256_shuffle_epi8(row_bit_table, row);
+    __m256i in_set = _mm256_cmpeq_epi8(_mm256_and_si256(rows, row_bit), row_bit);
+    uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(in_set));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  size_t pos = findNotInSetSse(data + i, size - i, set, low_rows, high_rows);
+  return pos == std::string_view::npos ? pos : i + pos;
+}
+#endif
+
+// ---------------------------------------------------------------------------------------------
+// Dispatch
+
+struct Kernels {
+  size_t (*find_in_range_)(const char*, size_t, unsigned char, unsigned char);
+  size_t (*find_whitespace_)(const char*, size_t, bool);
+  void (*flip_case_)(const char*, size_t, char*, unsigned char, unsigned char);
+  void (*hex_encode_)(const char*, size_t, char*);
+  bool (*parity_7bit_)(const char*, size_t, char*, Parity);
+  size_t (*find_not_in_set_)(const char*, size_t, const ByteSet&, const uint8_t*, const uint8_t*);
+};
+
+Kernels selectKernels() {
+#ifdef WGE_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {findInRangeAvx2, findWhitespaceAvx2, flipCaseAvx2,
+            hexEncodeAvx2,   parity7BitAvx2,     findNotInSetAvx2};
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return {findInRangeSse, findWhitespaceSse, flipCaseSse,
+            hexEncodeSse,   parity7BitSse,     findNotInSetSse};
+  }
+#endif
+  return {findInRangeScalar, findWhitespaceScalar, flipCaseScalar,
+          hexEncodeScalar,   parity7BitScalar,     findNotInSetScalar};
+}
+
+// The kernels are selected by the first call rather than a dynamic initializer, so the
+// transformations that are evaluated by the static initializers of the other translation units
+// never see the table before it's initialized
+const Kernels& kernels() {
+  static const Kernels selected_kernels = selectKernels();
+  return selected_kernels;
+}
+} // namespace
+
+size_t findInRange(std::string_view data, unsigned char low, unsigned char high) {
+  return kernels().find_in_range_(data.data(), data.size(), low, high);
+}
+
+size_t findWhitespace(std::string_view data, bool with_nbsp) {
+  return kernels().find_whitespace_(data.data(), data.size(), with_nbsp);
+}
+
+void flipCase(const char* src, size_t size, char* dst, unsigned char low, unsigned char high) {
+  kernels().flip_case_(src, size, dst, low, high);
+}
+
+void hexEncode(const char* src, size_t size, char* dst) { kernels().hex_encode_(src, size, dst); }
+
+bool parity7Bit(const char* src, size_t size, char* dst, Parity parity) {
+  return kernels().parity_7bit_(src, size, dst, parity);
+}
+
+ByteSet::ByteSet(const std::bitset<256>& bits) {
+  for (size_t c = 0; c < bits.size(); ++c) {
+    if (bits.test(c)) {
+      auto& rows = c & 0x80 ? high_rows_ : low_rows_;
+      rows[c & 0x0f] |= 1 << ((c >> 4) & 0x07);
+    }
+  }
+}
+
+size_t ByteSet::findNotIn(std::string_view data) const {
+  return kernels().find_not_in_set_(data.data(), data.size(), *this, low_rows_.data(),
+                                    high_rows_.data());
+}
+} // namespace Simd
+} // namespace Common
+} // namespace Wge
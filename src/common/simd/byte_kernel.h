@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Wge {
+namespace Common {
+namespace Simd {
+/**
+ * The byte-wise kernels with the AVX2 and the SSE4.2 implementation. The implementation is selected
+ * once at runtime by the CPU features, and the scalar implementation is used if neither of them is
+ * supported.
+ */
+
+/**
+ * Check whether the byte is the whitespace [ \t\n\v\f\r].
+ * @param c the byte to be checked.
+ * @param with_nbsp whether the non-breaking space (0xA0) is treated as the whitespace.
+ * @return true if the byte is the whitespace, otherwise false.
+ */
+inline bool isWhitespace(unsigned char c, bool with_nbsp) {
+  return c == ' ' || (c >= '\t' && c <= '\r') || (with_nbsp && c == 0xa0);
+}
+
+/**
+ * Find the first byte that is in the range [low, high].
+ * @param data the data to be searched.
+ * @param low the lower bound of the range.
+ * @param high the upper bound of the range.
+ * @return the position of the first byte that is in the range. std::string_view::npos if not found.
+ */
+size_t findInRange(std::string_view data, unsigned char low, unsigned char high);
+
+/**
+ * Find the first whitespace [ \t\n\v\f\r].
+ * @param data the data to be searched.
+ * @param with_nbsp whether the non-breaking space (0xA0) is treated as the whitespace.
+ * @return the position of the first whitespace. std::string_view::npos if not found.
+ */
+size_t findWhitespace(std::string_view data, bool with_nbsp);
+
+/**
+ * Flip the case bit (0x20) of the bytes that are in the range [low, high], and copy the others.
+ * [A-Z] converts the data to lower case, and [a-z] converts the data to upper case.
+ * @param src the source data.
+ * @param size the size of the source data.
+ * @param dst the destination buffer that is at least size bytes. It may be the same as src.
+ * @param low the lower bound of the range.
+ * @param high the upper bound of the range.
+ */
+void flipCase(const char* src, size_t size, char* dst, unsigned char low, unsigned char high);
+
+/**
+ * Encode the data to the lower case hex string.
+ * @param src the source data.
+ * @param size the size of the source data.
+ * @param dst the destination buffer that is at least size * 2 bytes.
+ */
+void hexEncode(const char* src, size_t size, char* dst);
+
+/**
+ * The set of bytes that is represented by the nibble tables, so that the membership of 16 or 32
+ * bytes is tested by a few shuffles. The low nibble of the byte indexes the tables, and each entry
+ * is the bitmap of the high nibbles: the low_rows_ for 0x0-0x7 and the high_rows_ for 0x8-0xF.
+ */
+class ByteSet {
+public:
+  ByteSet() = default;
+  explicit ByteSet(const std::bitset<256>& bits);
+
+public:
+  bool test(unsigned char c) const {
+    const auto& rows = c & 0x80 ? high_rows_ : low_rows_;
+    return rows[c & 0x0f] & (1 << ((c >> 4) & 0x07));
+  }
+
+  /**
+   * Find the first byte that is not in the set.
+   * @param data the data to be searched.
+   * @return the position of the first byte that is not in the set. std::string_view::npos if all
+   * of the bytes are in the set.
+   */
+  size_t findNotIn(std::string_view data) const;
+
+private:
+  alignas(16) std::array<uint8_t, 16> low_rows_{};
+  alignas(16) std::array<uint8_t, 16> high_rows_{};
+};
+
+enum class Parity {
+  Even, // Set the 8th bit to make the parity of the byte even
+  Odd,  // Set the 8th bit to make the parity of the byte odd
+  Zero, // Clear the 8th bit
+};
+
+/**
+ * Calculate the 7-bit parity of each byte and store the parity in the 8th bit.
+ * @param src the source data.
+ * @param size the size of the source data.
+ * @param dst the destination buffer that is at least size bytes. It may be the same as src.
+ * @param parity the parity type.
+ * @return true if any byte is changed, otherwise false.
+ */
+bool parity7Bit(const char* src, size_t size, char* dst, Parity parity);
+} // namespace Simd
+} // namespace Common
+} // namespace Wge
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace Wge {
+namespace Common {
+/**
+ * The memory resource that remembers the blocks that it allocates from the upstream resource, so
+ * that it can tell whether a memory is allocated from it. It's used as the upstream resource of a
+ * monotonic arena, whose blocks are few since they grow geometrically.
+ */
+class TrackedResource final : public std::pmr::memory_resource {
+public:
+  explicit TrackedResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream_(upstream) {}
+
+  TrackedResource(const TrackedResource&) = delete;
+  TrackedResource& operator=(const TrackedResource&) = delete;
+
+public:
+  /**
+   * Check whether the memory is within a block that is allocated from this resource.
+   * @param data the start of the memory.
+   * @param size the size of the memory.
+   * @return true if the whole memory is within a block, false otherwise.
+   */
+  bool owns(const void* data, size_t size) const {
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    return std::any_of(blocks_.begin(), blocks_.end(), [&](const Block& block) {
+      return begin >= block.begin_ && begin + size <= block.begin_ + block.size_;
+    });
+  }
+
+  /**
+   * @return the total size of the blocks that are allocated from the upstream resource.
+   */
+  size_t allocatedSize() const { return allocated_size_; }
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    void* data = upstream_->allocate(bytes, alignment);
+    blocks_.emplace_back(reinterpret_cast<uintptr_t>(data), bytes);
+    allocated_size_ += bytes;
+    return data;
+  }
+
+  void do_deallocate(void* data, size_t bytes, size_t alignment) override {
+    std::erase_if(blocks_, [&](const Block& block) {
+      return block.begin_ == reinterpret_cast<uintptr_t>(data);
+    });
+    allocated_size_ -= bytes;
+    upstream_->deallocate(data, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  struct Block {
+    uintptr_t begin_;
+    size_t size_;
+  };
+
+  std::pmr::memory_resource* upstream_;
+  std::vector<Block> blocks_;
+  size_t allocated_size_{0};
+};
+} // namespace Common
+} // namespace Wge
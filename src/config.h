@@ -23,6 +23,7 @@
 #include <bitset>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <stdint.h>
@@ -90,6 +91,21 @@ struct EngineConfig {
   // Default: 1MB
   uint64_t request_body_no_files_limit_{1048576};
 
+  // SecRequestBodyInMemoryLimit
+  // Configures the maximum size of the request body that will be buffered in memory. In the stream
+  // mode, it limits the incomplete argument that is carried over to the next chunk and the buffered
+  // body of the processors that don't support the stream mode. REQBODY_ERROR is set once it's
+  // exceeded, and the rest of the body is ignored.
+  // Default: 128KB
+  uint64_t request_body_in_memory_limit_{131072};
+
+  // SecBodyStreamOverlap
+  // Configures the size of the tail of the inspected body that is prepended to the next chunk in
+  // the stream mode, so that REQUEST_BODY and RESPONSE_BODY match the patterns that span the
+  // chunks. It should not be less than the length of the longest pattern of the body rules.
+  // Default: 4KB
+  uint32_t body_stream_overlap_{4096};
+
   // Configures the maximum parsing depth that is allowed when parsing a JSON object.
   // Default: 0 (unlimited)
   uint64_t request_body_json_depth_limit_{0};
@@ -129,6 +145,24 @@ struct EngineConfig {
   // Sets the PCRE match limit for executions of the @rx and @rxGlobal operators.
   uint32_t pcre_match_limit_{0};
 
+  // SecCollectionTimeout
+  // Specifies the collections timeout. The collection expires if it isn't updated in the timeout
+  // seconds. Default: 3600
+  uint32_t collection_timeout_{3600};
+
+  // SecDataDir
+  // Path where persistent data (e.g., IP address data, session data, and so on) is to be stored.
+  // The persistent storage is loaded from the snapshot in the directory at the startup, and saved
+  // to it periodically.
+  std::string data_dir_;
+
+  // SecSharedStorage
+  // Stores the persistent collections in the named shared memory segment with the capacity of the
+  // collections, so that the processes of a multi-process deployment share the collections. The
+  // SecDataDir is ignored if it's set.
+  std::string shared_storage_name_;
+  uint32_t shared_storage_capacity_{0};
+
   // SecPmfSerializeDir
   // Configures the directory where the PMF files will be serialized.
   // This is used to persist the PMF files across restarts to improve the initialization time.
@@ -179,14 +213,32 @@ struct AuditLogConfig {
     FinalBoundary = Z,
     End = 12
   };
+  using AuditLogParts = std::bitset<16>;
+
+  /**
+   * Parse the letters of the audit log parts, the unknown letters are ignored.
+   * @param parts the letters of the parts, e.g. ABCFHZ.
+   * @return the parts.
+   */
+  static AuditLogParts parseLogParts(std::string_view parts) {
+    AuditLogParts result;
+    for (char ch : parts) {
+      if (ch >= 'A' && ch <= 'K') {
+        result.set(ch - 'A');
+      } else if (ch == 'Z') {
+        result.set(static_cast<size_t>(AuditLogPart::Z));
+      }
+    }
+    return result;
+  }
 
   // SecAuditEngine
   // Configures the audit logging engine.
-  AuditEngine audit_engine_;
+  AuditEngine audit_engine_{AuditEngine::Off};
 
   // SecAuditLogType
   // Configures the type of audit logging mechanism to be used.
-  AuditLogType audit_log_type_;
+  AuditLogType audit_log_type_{AuditLogType::Serial};
 
   // SecAuditLog
   // Defines the path to the main audit log file (serial logging format), or the concurrent
@@ -205,24 +257,24 @@ struct AuditLogConfig {
   // SecAuditLogDirMode
   // Configures the mode (permissions) of any directories created for the concurrent audit logs,
   // using an octal mode value as parameter (as used in chmod).
-  int dir_mode_;
+  int dir_mode_{0700};
 
   // SecAuditLogFileMode
   // Configures the mode (permissions) of any files created for concurrent audit logs using an
   // octal mode (as used in chmod). See SecAuditLogDirMode for controlling the mode of created
   // audit log directories.
-  int file_mode_;
+  int file_mode_{0600};
 
   // SecAuditLogFormat
   // Select the output format of the AuditLogs. The format can be either the native AuditLogs
   // format or JSON.
-  AuditFormat format_;
+  AuditFormat format_{AuditFormat::Native};
 
   // SecAuditLogParts
   // Defines which parts of each transaction are going to be recorded in the audit log. Each part
   // is assigned a single letter; when a letter appears in the list then the equivalent part will
-  // be recorded. See below for the list of all parts.
-  std::bitset<16> log_parts_;
+  // be recorded. See below for the list of all parts. Default: ABCFHZ
+  AuditLogParts log_parts_{parseLogParts("ABCFHZ")};
 
   // SecAuditLogRelevantStatus
   // Configures which response status code is to be considered relevant for the purpose of audit
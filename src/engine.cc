@@ -20,16 +20,32 @@
  */
 #include "engine.h"
 
+#include <filesystem>
+#include <unordered_set>
+
 #include "action/ctl.h"
+#include "audit_log.h"
 #include "antlr4/parser.h"
 #include "common/assert.h"
+#include "common/duration.h"
+#include "common/hyperscan/database_snapshot.h"
+#include "common/hyperscan/hs_database.h"
 #include "common/log.h"
+#include "common/parallel.h"
+#include "operator/operator_base.h"
 
 std::thread::id main_thread_id;
+thread_local bool is_engine_builder_thread = false;
 
 namespace Wge {
+namespace {
+constexpr std::string_view storage_snapshot_file_name = "persistent_storage.snapshot";
+constexpr std::chrono::seconds storage_snapshot_interval{60};
+} // namespace
+
 Engine::Engine(spdlog::level::level_enum level, const std::string& log_file)
-    : parser_(std::make_unique<Antlr4::Parser>()) {
+    : parser_(std::make_unique<Antlr4::Parser>()),
+      storage_(std::make_shared<PersistentStorage::Storage>()) {
   // We assume that it can only be constructed in the main thread
   main_thread_id = std::this_thread::get_id();
 
@@ -40,6 +56,9 @@ Engine::Engine(spdlog::level::level_enum level, const std::string& log_file)
   ::srand(::time(nullptr));
 }
 
+Engine::Engine(std::shared_ptr<PersistentStorage::Storage> storage)
+    : parser_(std::make_unique<Antlr4::Parser>()), storage_(std::move(storage)) {}
+
 Engine::~Engine() = default;
 
 std::expected<bool, std::string> Engine::loadFromFile(const std::string& file_path) {
@@ -47,7 +66,22 @@ std::expected<bool, std::string> Engine::loadFromFile(const std::string& file_pa
   // This assert check that this method can only be called in the main thread
   ASSERT_IS_MAIN_THREAD();
 
-  return parser_->loadFromFile(file_path);
+  Common::Duration duration;
+  auto result = parser_->loadFromFile(file_path);
+  startup_stats_.load_ms_ += duration.milliseconds();
+  return result;
+}
+
+std::expected<bool, std::string> Engine::loadFromFiles(const std::vector<std::string>& file_paths,
+                                                       size_t concurrency) {
+  // An efficient and rational design should not call this method in the worker thread.
+  // This assert check that this method can only be called in the main thread
+  ASSERT_IS_MAIN_THREAD();
+
+  Common::Duration duration;
+  auto result = parser_->loadFromFiles(file_paths, concurrency);
+  startup_stats_.load_ms_ += duration.milliseconds();
+  return result;
 }
 
 std::expected<bool, std::string> Engine::load(const std::string& directive) {
@@ -55,7 +89,10 @@ std::expected<bool, std::string> Engine::load(const std::string& directive) {
   // This assert check that this method can only be called in the main thread
   ASSERT_IS_MAIN_THREAD();
 
-  return parser_->load(directive);
+  Common::Duration duration;
+  auto result = parser_->load(directive);
+  startup_stats_.load_ms_ += duration.milliseconds();
+  return result;
 }
 
 std::expected<bool, std::string> Engine::updatePropertyStore(const std::string& json_string) {
@@ -70,16 +107,78 @@ std::expected<bool, std::string> Engine::updatePropertyStore(const std::string&
   return true;
 }
 
-void Engine::init() {
+void Engine::init(size_t concurrency) {
   // An efficient and rational design should not call this method in the worker thread.
   // This assert check that this method can only be called in the main thread
   ASSERT_IS_MAIN_THREAD();
 
+  Common::Duration init_rules_duration;
   initRules();
+  startup_stats_.init_rules_ms_ = init_rules_duration.milliseconds();
+
+  // Compile after the rules are initialized, since the flags of the rules (e.g. capture) affect
+  // the compilation.
+  Common::Duration compile_duration;
+  compile(concurrency);
+  startup_stats_.compile_ms_ = compile_duration.milliseconds();
+
+  // The databases that are shared with the predecessor (e.g. by the cache of the operators) aren't
+  // deserialized, only the databases that are constructed by this engine are.
+  std::vector<const Common::Hyperscan::HsDataBase*> databases;
+  collectDatabases(databases);
+  std::unordered_set<const Common::Hyperscan::HsDataBase*> deserialized_databases;
+  for (auto hs_db : databases) {
+    if (hs_db->fromSnapshot()) {
+      deserialized_databases.emplace(hs_db);
+    }
+  }
+  startup_stats_.snapshot_deserialized_count_ = deserialized_databases.size();
+
+  profiler_.init(parser_->rules());
+
+  // The storage may be shared with the predecessor, the new timeout applies to the collections that
+  // are created later.
+  storage_->collectionTimeout(parser_->engineConfig().collection_timeout_);
+  initStorage();
+  initAuditLog();
+
+  // The snapshot isn't needed after the databases are deserialized
+  Common::Hyperscan::HsDataBase::attachSnapshot(nullptr);
+
+  WGE_LOG_INFO("startup: load {}ms, init rules {}ms, compile {} operators and the prefilters {}ms "
+               "by {} threads",
+               startup_stats_.load_ms_, startup_stats_.init_rules_ms_,
+               startup_stats_.operator_count_, startup_stats_.compile_ms_,
+               startup_stats_.compile_concurrency_);
 
   is_init_ = true;
 }
 
+std::expected<bool, std::string> Engine::saveSnapshot(const std::string& file_path) const {
+  ASSERT_IS_MAIN_THREAD();
+  assert(is_init_);
+
+  // Only the databases of this engine are saved, the databases of the other engines (e.g. the
+  // predecessor that is still serving during a reload) don't belong to the rule set
+  std::vector<const Common::Hyperscan::HsDataBase*> databases;
+  collectDatabases(databases);
+  return Common::Hyperscan::DatabaseSnapshot::save(file_path, parser_->ruleSetHash(), databases);
+}
+
+std::expected<bool, std::string> Engine::loadSnapshot(const std::string& file_path) {
+  ASSERT_IS_MAIN_THREAD();
+  assert(!is_init_);
+
+  auto snapshot = Common::Hyperscan::DatabaseSnapshot::load(file_path, parser_->ruleSetHash());
+  if (!snapshot.has_value()) {
+    return std::unexpected(snapshot.error());
+  }
+
+  startup_stats_.snapshot_database_count_ = snapshot.value()->size();
+  Common::Hyperscan::HsDataBase::attachSnapshot(std::move(snapshot.value()));
+  return true;
+}
+
 const Rule* Engine::defaultActions(RulePhaseType phase) const {
   assert(phase >= 1 && phase <= PHASE_TOTAL);
   auto& default_action_rule = parser_->defaultActions()[phase - 1];
@@ -91,6 +190,16 @@ const std::vector<Rule>& Engine::rules(RulePhaseType phase) const {
   return parser_->rules()[phase - 1];
 }
 
+const RulePrefilter& Engine::rulePrefilter(RulePhaseType phase) const {
+  assert(phase >= 1 && phase <= PHASE_TOTAL);
+  return rule_prefilters_[phase - 1];
+}
+
+const RuleInputFilter& Engine::ruleInputFilter(RulePhaseType phase) const {
+  assert(phase >= 1 && phase <= PHASE_TOTAL);
+  return rule_input_filters_[phase - 1];
+}
+
 TransactionPtr Engine::makeTransaction() const {
   assert(is_init_);
 
@@ -99,6 +208,16 @@ TransactionPtr Engine::makeTransaction() const {
   return std::unique_ptr<Transaction>(new Transaction(*this, property_store_.load()));
 }
 
+std::vector<bool> Engine::processBatch(std::span<Transaction* const> transactions,
+                                       RulePhaseType phase) const {
+  assert(is_init_);
+  assert(phase >= 1 && phase <= PHASE_TOTAL);
+
+  std::vector<bool> results;
+  Transaction::evaluateBatch(*this, transactions, phase, results);
+  return results;
+}
+
 const EngineConfig& Engine::config() const { return parser_->engineConfig(); }
 
 const AuditLogConfig& Engine::auditLogConfig() const { return parser_->auditLogConfig(); }
@@ -160,11 +279,6 @@ void Engine::initRules() {
       rule.initExceptVariables();
     }
 
-    // Initialize the Pmf operator
-    for (auto& rule : rules) {
-      rule.initPmfOperator(parser_->engineConfig().pmf_serialize_dir_);
-    }
-
     // Initialize the flags according to the default action rule
     for (auto& rule : rules) {
       auto default_action_rule = defaultActions(phase);
@@ -173,6 +287,11 @@ void Engine::initRules() {
       }
     }
 
+    // Initialize the fused transformations
+    for (auto& rule : rules) {
+      rule.initFusedTransforms(defaultActions(phase));
+    }
+
     // Initialize the rules ctl
     for (auto& rule : rules) {
       auto& actions = rule.actions();
@@ -199,6 +318,99 @@ void Engine::initRules() {
         }
       }
     }
+
+    // Initialize the input filter after the flags are initialized, since the unmatched chain flags
+    // affect whether the rule can be skipped.
+    rule_input_filters_[phase - 1].init(rules);
+  }
+}
+
+void Engine::initStorage() {
+  // The storage that is shared with the predecessor may have attached the segment
+  const EngineConfig& config = parser_->engineConfig();
+  if (!config.shared_storage_name_.empty()) {
+    if (storage_->sharedMemoryName() != config.shared_storage_name_) {
+      auto result = storage_->useSharedMemory(config.shared_storage_name_,
+                                              config.shared_storage_capacity_);
+      if (!result.has_value()) {
+        WGE_LOG_ERROR("attach the shared memory storage failed: {}", result.error());
+      }
+    }
+    return;
+  }
+
+  const std::string& data_dir = config.data_dir_;
+  if (data_dir.empty()) {
+    return;
+  }
+
+  // The storage that is shared with the predecessor has been loaded and is being saved
+  std::string file = (std::filesystem::path(data_dir) / storage_snapshot_file_name).string();
+  if (storage_->snapshotFile() == file) {
+    return;
+  }
+
+  if (std::filesystem::exists(file)) {
+    auto result = storage_->loadFromFile(file);
+    if (!result.has_value()) {
+      WGE_LOG_ERROR("load the persistent storage failed: {}", result.error());
+    }
+  }
+  storage_->startSnapshot(file, storage_snapshot_interval);
+}
+
+void Engine::initAuditLog() {
+  const AuditLogConfig& config = parser_->auditLogConfig();
+  if (config.audit_engine_ == AuditLogConfig::AuditEngine::Off) {
+    return;
+  }
+
+  audit_log_ = std::make_shared<AuditLog>(config);
+  auto result = audit_log_->start();
+  if (!result.has_value()) {
+    WGE_LOG_ERROR("start the audit log failed: {}", result.error());
+    audit_log_.reset();
+  }
+}
+
+void Engine::compile(size_t concurrency) {
+  std::vector<Operator::OperatorBase*> operators;
+  for (auto& rules : parser_->rules()) {
+    for (auto& rule : rules) {
+      rule.collectOperators(operators);
+    }
+  }
+
+  // The tasks are the rule prefilters of each phase and the operators. The prefilters are the
+  // biggest tasks, so they are started first.
+  const std::string& serialize_dir = parser_->engineConfig().pmf_serialize_dir_;
+  const size_t task_count = PHASE_TOTAL + operators.size();
+  if (concurrency == 0) {
+    concurrency = std::max(1u, std::thread::hardware_concurrency());
+  }
+  concurrency = std::min(concurrency, task_count);
+  Common::parallelFor(task_count, concurrency, [&](size_t i) {
+    if (i < PHASE_TOTAL) {
+      RulePhaseType phase = i + 1;
+      rule_prefilters_[i].init(parser_->rules()[i], defaultActions(phase));
+    } else {
+      operators[i - PHASE_TOTAL]->compile(serialize_dir);
+    }
+  });
+
+  startup_stats_.operator_count_ = operators.size();
+  startup_stats_.compile_concurrency_ = concurrency;
+}
+
+void Engine::collectDatabases(std::vector<const Common::Hyperscan::HsDataBase*>& databases) const {
+  for (auto& rules : parser_->rules()) {
+    for (auto& rule : rules) {
+      rule.collectDatabases(databases);
+    }
+  }
+
+  for (auto& rule_prefilter : rule_prefilters_) {
+    rule_prefilter.collectDatabases(databases);
   }
 }
-} // namespace Wge
\ No newline at end of file
+} // namespace Wge
@@ -20,10 +20,12 @@
  */
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <expected>
 #include <memory>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -31,6 +33,9 @@
 #include "common/property_store.h"
 #include "persistent_storage/storage.h"
 #include "rule.h"
+#include "rule_input_filter.h"
+#include "rule_prefilter.h"
+#include "rule_profiler.h"
 #include "transaction.h"
 
 namespace Wge::Antlr4 {
@@ -38,14 +43,19 @@ class Parser;
 }
 
 namespace Wge {
+class AuditLog;
 
 /**
  * The engine is the core of the WAF.
  * It is responsible for loading the rule set, parsing the rule set, and make a transaction to
  * evaluate the rules. The engine is a singleton, and only one instance of the engine exists in the
- * life of the program.
+ * life of the program. The rule set of an initialized engine is immutable, to change the rules at
+ * runtime use the ReloadableEngine, which builds a successor engine and swaps it in.
  */
 class Engine final {
+  friend class TransactionPool;
+  friend class ReloadableEngine;
+
 public:
   /**
    * Construct the engine
@@ -64,6 +74,18 @@ public:
    */
   std::expected<bool, std::string> loadFromFile(const std::string& file_path);
 
+  /**
+   * Load the rule set from the files
+   * The files are parsed concurrently, and the result is the same as calling loadFromFile for each
+   * file in order. The files are usually the rule files of a rule set, such as the CRS.
+   * @param file_paths the rule(SecLang) file paths. support absolute path and relative path
+   * @param concurrency the max count of the parsing threads. If it is 0, the hardware concurrency
+   * is used.
+   * @result an error string is returned if fails, and returned true otherwise
+   */
+  std::expected<bool, std::string> loadFromFiles(const std::vector<std::string>& file_paths,
+                                                 size_t concurrency = 0);
+
   /**
    * Load the rule set from a configuration directive
    * @param directive configuration directive. such as "SecRuleEngine On"
@@ -81,10 +103,70 @@ public:
 
   /**
    * Initialize the engine
+   * The regexes and the hyperscan databases of the operators, and the rule prefilters are compiled
+   * here by a group of the threads rather than while loading the rules.
+   * @param concurrency the max count of the compiling threads. If it is 0, the hardware
+   * concurrency is used.
    * @note must call once before call makeTransaction, and only once in the life of the engine
    * instance.
    */
-  void init();
+  void init(size_t concurrency = 0);
+
+  /**
+   * Save the compiled hyperscan databases of the engine to a snapshot file
+   * The snapshot is keyed by the hash of the loaded rule set, and it can be loaded by the other
+   * processes that load the same rule set to skip compiling the hyperscan databases.
+   * @param file_path the snapshot file path
+   * @return an error string is returned if fails, and returned true otherwise
+   * @note must call after the init method.
+   */
+  std::expected<bool, std::string> saveSnapshot(const std::string& file_path) const;
+
+  /**
+   * Load a snapshot file that is saved by saveSnapshot
+   * The snapshot file is memory-mapped read-only, and the hyperscan databases that are compiled
+   * by the init method are deserialized from it if found. The snapshot that is saved from the
+   * other rule set, by the other hyperscan version or on the other platform is rejected, and the
+   * engine compiles the databases as usual.
+   * @param file_path the snapshot file path
+   * @return an error string is returned if fails, and returned true otherwise
+   * @note must call after the rules are loaded and before the init method.
+   */
+  std::expected<bool, std::string> loadSnapshot(const std::string& file_path);
+
+  /**
+   * The time breakdown of the startup
+   */
+  struct StartupStats {
+    // The milliseconds of loading(parsing and visiting) the rule set
+    uint64_t load_ms_{0};
+
+    // The milliseconds of initializing the rules: the flags, the fused transformations, the skips
+    // and so on
+    uint64_t init_rules_ms_{0};
+
+    // The milliseconds of compiling the operators and the rule prefilters
+    uint64_t compile_ms_{0};
+
+    // The count of the compiled operators
+    size_t operator_count_{0};
+
+    // The count of the compiling threads
+    size_t compile_concurrency_{0};
+
+    // The count of the hyperscan databases in the loaded snapshot
+    size_t snapshot_database_count_{0};
+
+    // The count of the hyperscan databases of the engine that are deserialized from the loaded
+    // snapshot rather than compiled
+    size_t snapshot_deserialized_count_{0};
+  };
+
+  /**
+   * Get the time breakdown of the startup
+   * @return reference of the startup stats. It's completed after the init method is called.
+   */
+  const StartupStats& startupStats() const { return startup_stats_; }
 
   /**
    * Get default actions
@@ -100,6 +182,20 @@ public:
    */
   const std::vector<Rule>& rules(RulePhaseType phase) const;
 
+  /**
+   * Get the rule prefilter
+   * @param phase specify the phase of rule, the valid range is 1-5.
+   * @return the rule prefilter of the phase
+   */
+  const RulePrefilter& rulePrefilter(RulePhaseType phase) const;
+
+  /**
+   * Get the rule input filter
+   * @param phase specify the phase of rule, the valid range is 1-5.
+   * @return the rule input filter of the phase
+   */
+  const RuleInputFilter& ruleInputFilter(RulePhaseType phase) const;
+
 public:
   /**
    * Make a transaction to evaluate rules.
@@ -108,6 +204,23 @@ public:
    */
   TransactionPtr makeTransaction() const;
 
+  /**
+   * Evaluate a phase of a batch of transactions rule by rule. Each rule is evaluated for all the
+   * transactions before the next rule, so the data of the rule, such as the compiled patterns,
+   * stays in the CPU cache instead of being reloaded for each transaction. The rules of each
+   * transaction are evaluated in the same order as Transaction::process methods.
+   * The data of the phase is prepared by the process method of each transaction whose evaluation
+   * is deferred by Transaction::deferEvaluation().
+   * @param transactions the transactions to evaluate. The transactions whose evaluation isn't
+   * suspended in the phase, or that are made by the other engine, are ignored.
+   * @param phase the phase to evaluate.
+   * @return the results of the transactions in the same order. true if the request is safe, false
+   * otherwise that means need to deny the request. The ignored transactions are true.
+   * @note the transactions must be accessed by the calling thread only.
+   */
+  std::vector<bool> processBatch(std::span<Transaction* const> transactions,
+                                 RulePhaseType phase) const;
+
   /**
    * Get the engine configuration
    * @return reference of engine configuration
@@ -120,6 +233,12 @@ public:
    */
   const AuditLogConfig& auditLogConfig() const;
 
+  /**
+   * Get the audit log
+   * @return pointer of the audit log if the audit engine is enabled, and nullptr otherwise
+   */
+  AuditLog* auditLog() const { return audit_log_.get(); }
+
   /**
    * Get the Parse xml into args option
    * @return the Parse xml into args option
@@ -168,10 +287,55 @@ public:
    * Get persistent storage
    * @return reference of persistent storage
    */
-  PersistentStorage::Storage& storage() const { return storage_; }
+  PersistentStorage::Storage& storage() const { return *storage_; }
+
+public:
+  /**
+   * Enable or disable the per-rule profiling. It can be switched at runtime, and the switch takes
+   * effect from the next phase of the transactions.
+   * @param enable true to enable the profiling, and false to disable it.
+   */
+  void enableProfile(bool enable) { profile_enabled_.store(enable, std::memory_order_relaxed); }
+
+  /**
+   * Check whether the per-rule profiling is enabled
+   * @return true if the profiling is enabled, and false otherwise
+   */
+  bool isProfileEnabled() const { return profile_enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * Merge the profiling counters of all threads and dump them.
+   * @return the profile in JSON. Each rule has the evaluate count, the matched count and the
+   * cumulative nanoseconds split into the variable, transformation and operator time. The
+   * operator time is also aggregated by the operator name.
+   */
+  std::string dumpProfile() const { return profiler_.dump(); }
+
+  /**
+   * Reset the profiling counters of all threads
+   */
+  void resetProfile() { profiler_.reset(); }
+
+  /**
+   * Get the rule profiler
+   * @return reference of the rule profiler
+   */
+  const RuleProfiler& profiler() const { return profiler_; }
 
 private:
+  /**
+   * Construct the successor of an engine for the hot reload. The successor shares the persistent
+   * storage of the predecessor, and it neither takes the current thread as the main thread nor
+   * initializes the log again.
+   * @param storage the persistent storage of the predecessor.
+   */
+  Engine(std::shared_ptr<PersistentStorage::Storage> storage);
+
   void initRules();
+  void initStorage();
+  void initAuditLog();
+  void compile(size_t concurrency);
+  void collectDatabases(std::vector<const Common::Hyperscan::HsDataBase*>& databases) const;
 
 private:
   // Is the engine initialized
@@ -180,8 +344,26 @@ private:
   // The parser is used to parse the SecLang rule set.
   std::unique_ptr<Antlr4::Parser> parser_;
 
-  mutable PersistentStorage::Storage storage_;
+  // The persistent storage is shared by the successors of the hot reload
+  std::shared_ptr<PersistentStorage::Storage> storage_;
+
+  // The rule prefilter of each phase, it's built at the init method.
+  std::array<RulePrefilter, PHASE_TOTAL> rule_prefilters_;
+
+  // The rule input filter of each phase, it's built at the init method.
+  std::array<RuleInputFilter, PHASE_TOTAL> rule_input_filters_;
+
+  // The audit log is started at the init method if the audit engine is enabled. Each engine of
+  // the hot reload has its own audit log, and the pending records are written when it's destroyed.
+  // Shared with the ReloadableEngine, which stops it after this engine is retired
+  std::shared_ptr<AuditLog> audit_log_;
+
+  // The per-rule profiling counters, which are only written when the profiling is enabled
+  RuleProfiler profiler_;
+  std::atomic_bool profile_enabled_{false};
 
   std::atomic<std::shared_ptr<Common::PropertyStore>> property_store_;
+
+  StartupStats startup_stats_;
 };
 } // namespace Wge
\ No newline at end of file
@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "http_extractor.h"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+namespace Wge {
+void HttpHeaders::set(HeaderFind find, HeaderTraversal traversal, size_t count) {
+  clear();
+  find_ = std::move(find);
+  traversal_ = std::move(traversal);
+  size_ = count;
+}
+
+void HttpHeaders::set(std::span<const Header> headers) {
+  clear();
+  headers_ = headers;
+  use_span_ = true;
+  size_ = headers.size();
+}
+
+void HttpHeaders::clear() {
+  find_ = nullptr;
+  traversal_ = nullptr;
+  headers_ = {};
+  use_span_ = false;
+  size_ = 0;
+  indexed_ = false;
+  order_.clear();
+  slots_.clear();
+}
+
+size_t HttpHeaders::count(std::string_view lower_case_key) const {
+  if (use_span_)
+    [[likely]] {
+      auto [begin, end] = lookup(lower_case_key);
+      return end - begin;
+    }
+
+  size_t count = 0;
+  find(lower_case_key, [&](std::string_view) { ++count; });
+  return count;
+}
+
+std::string_view HttpHeaders::front(std::string_view lower_case_key) const {
+  if (use_span_)
+    [[likely]] {
+      auto [begin, end] = lookup(lower_case_key);
+      return begin != end ? headers_[order_[begin]].second : std::string_view();
+    }
+
+  std::string_view value;
+  bool found = false;
+  find(lower_case_key, [&](std::string_view v) {
+    if (!found) {
+      value = v;
+      found = true;
+    }
+  });
+  return value;
+}
+
+std::pair<uint32_t, uint32_t> HttpHeaders::lookup(std::string_view lower_case_key) const {
+  if (!indexed_)
+    [[unlikely]] { buildIndex(); }
+
+  if (slots_.empty())
+    [[unlikely]] { return {0, 0}; }
+
+  const size_t hash = std::hash<std::string_view>{}(lower_case_key);
+  const size_t mask = slots_.size() - 1;
+  for (size_t i = hash & mask; slots_[i].end_ != 0; i = (i + 1) & mask) {
+    const Slot& slot = slots_[i];
+    if (slot.hash_ == hash && headers_[order_[slot.begin_]].first == lower_case_key) {
+      return {slot.begin_, slot.end_};
+    }
+  }
+
+  return {0, 0};
+}
+
+void HttpHeaders::buildIndex() const {
+  indexed_ = true;
+  if (headers_.empty()) {
+    return;
+  }
+
+  // Group the headers by the key. The stable sort keeps the values of a key in the order that they
+  // are provided.
+  order_.resize(headers_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  std::stable_sort(order_.begin(), order_.end(), [this](uint32_t lhs, uint32_t rhs) {
+    return headers_[lhs].first < headers_[rhs].first;
+  });
+
+  // The load factor is at most 0.5, so the probe sequences are short
+  slots_.assign(std::bit_ceil(headers_.size() * 2), Slot{0, 0, 0});
+  const size_t mask = slots_.size() - 1;
+  for (uint32_t begin = 0; begin < order_.size();) {
+    std::string_view key = headers_[order_[begin]].first;
+    uint32_t end = begin + 1;
+    while (end < order_.size() && headers_[order_[end]].first == key) {
+      ++end;
+    }
+
+    const size_t hash = std::hash<std::string_view>{}(key);
+    size_t i = hash & mask;
+    while (slots_[i].end_ != 0) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = Slot{hash, begin, end};
+    begin = end;
+  }
+}
+} // namespace Wge
@@ -21,7 +21,10 @@
 #pragma once
 
 #include <functional>
+#include <span>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace Wge {
 
@@ -47,15 +50,143 @@ using HeaderTraversalCallback =
  */
 using HeaderTraversal = std::function<void(HeaderTraversalCallback call)>;
 
+/**
+ * The header that is handed over by the host directly. The first is the header key with lower
+ * case, and the second is the header value.
+ */
+using Header = std::pair<std::string_view, std::string_view>;
+
+/**
+ * The headers of a http message.
+ * The headers are provided either by the find and traversal functions, or by a span of the headers
+ * directly. With the span, no function is called, nothing is copied and the lookups don't allocate:
+ * a flat hash index of the header keys is built on the first lookup, and reused by the lookups of
+ * the transaction.
+ */
+class HttpHeaders {
+public:
+  /**
+   * Set the headers by the find and traversal functions.
+   * @param find the header find function.
+   * @param traversal the header traversal function.
+   * @param count the count of the headers.
+   */
+  void set(HeaderFind find, HeaderTraversal traversal, size_t count);
+
+  /**
+   * Set the headers by the span of the headers.
+   * @param headers the headers, the keys must be lower case. The memory of the headers must be kept
+   * valid until the transaction is destroyed.
+   */
+  void set(std::span<const Header> headers);
+
+  /**
+   * Clear the headers. The memory of the index is kept for reusing.
+   */
+  void clear();
+
+public:
+  /**
+   * Check whether the headers are provided.
+   * @return true if the headers are provided by the functions or by the span.
+   */
+  bool provided() const { return use_span_ || find_; }
+
+  /**
+   * Get the count of the headers.
+   * @return the count of the headers.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * Find the values of the header.
+   * @param lower_case_key the header key with lower case.
+   * @param callback the callback that is called with each value of the header.
+   */
+  template <class Callback> void find(std::string_view lower_case_key, Callback&& callback) const {
+    if (use_span_)
+      [[likely]] {
+        auto [begin, end] = lookup(lower_case_key);
+        for (uint32_t i = begin; i < end; ++i) {
+          callback(headers_[order_[i]].second);
+        }
+      }
+    else if (find_) {
+      for (auto value : find_(std::string(lower_case_key))) {
+        callback(value);
+      }
+    }
+  }
+
+  /**
+   * Get the count of the values of the header.
+   * @param lower_case_key the header key with lower case.
+   * @return the count of the values of the header.
+   */
+  size_t count(std::string_view lower_case_key) const;
+
+  /**
+   * Get the first value of the header.
+   * @param lower_case_key the header key with lower case.
+   * @return the first value of the header. Empty if the header does not exist.
+   */
+  std::string_view front(std::string_view lower_case_key) const;
+
+  /**
+   * Traverse the headers in the order that they are provided.
+   * @param callback the callback that is called with the key and the value of each header, return
+   * false to stop the traversal.
+   */
+  template <class Callback> void traverse(Callback&& callback) const {
+    if (use_span_)
+      [[likely]] {
+        for (auto& [key, value] : headers_) {
+          if (!callback(key, value)) {
+            break;
+          }
+        }
+      }
+    else if (traversal_) {
+      traversal_(HeaderTraversalCallback(std::forward<Callback>(callback)));
+    }
+  }
+
+private:
+  // The slot of the flat hash index. The values of a header key are order_[begin_, end_), and the
+  // slot is empty if end_ is 0.
+  struct Slot {
+    size_t hash_;
+    uint32_t begin_;
+    uint32_t end_;
+  };
+
+  std::pair<uint32_t, uint32_t> lookup(std::string_view lower_case_key) const;
+  void buildIndex() const;
+
+private:
+  HeaderFind find_;
+  HeaderTraversal traversal_;
+  std::span<const Header> headers_;
+  bool use_span_{false};
+  size_t size_{0};
+
+  // The index is built on the first lookup
+  mutable bool indexed_{false};
+  // The indexes of the headers_ that are grouped by the key, in the order that they are provided
+  mutable std::vector<uint32_t> order_;
+  mutable std::vector<Slot> slots_;
+};
+
 /**
  * Http message info extractor
  */
 struct HttpExtractor {
-  HeaderFind request_header_find_;
-  HeaderTraversal request_header_traversal_;
-  HeaderFind response_header_find_;
-  HeaderTraversal response_header_traversal_;
-  size_t request_header_count_;
-  size_t response_header_count_;
+  HttpHeaders request_headers_;
+  HttpHeaders response_headers_;
+
+  void clear() {
+    request_headers_.clear();
+    response_headers_.clear();
+  }
 };
-} // namespace Wge
\ No newline at end of file
+} // namespace Wge
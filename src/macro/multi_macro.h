@@ -73,8 +73,7 @@ public:
         result.clear();
       }
     }
-    result.emplace_back(t.internString(std::move(eval)));
-    assert(eval.empty());
+    result.emplace_back(t.internString(eval));
 
     WGE_LOG_TRACE("macro {} expanded: {}", literal_value_,
                   VISTIT_VARIANT_AS_STRING(result.front().variant_));
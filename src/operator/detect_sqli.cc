@@ -20,6 +20,8 @@
  */
 #include "detect_sqli.h"
 
+#include <string.h>
+
 #include <libinjection.h>
 
 #include "../common/evaluate_result.h"
@@ -30,13 +32,32 @@ void DetectSqli::evaluate(Transaction& t, const Common::Variant& operand, Result
   performComparison<std::string_view, std::string_view>(
       t, operand, "", results,
       [](Transaction& t, std::string_view left_operand, std::string_view right_operand,
-         Results& results, void*) {
-        char fingerprint[8];
+         Results& results, void* user_data) {
+        const DetectSqli* obj = static_cast<const DetectSqli*>(user_data);
+
+        // The same value is usually checked by several rules, so the result is cached
+        auto& libinjection_cache = t.getLibinjectionCache();
+        auto& libinjection_cache_statistics = t.getLibinjectionCacheStatistics();
+        Transaction::LibinjectionCacheKey cache_key(left_operand, obj->name());
+        auto iter = libinjection_cache.find(cache_key);
+        if (iter != libinjection_cache.end()) {
+          ++libinjection_cache_statistics.hit_count_;
+          results.emplace_back(iter->second.detected_, iter->second.fingerprint_);
+          return;
+        }
+
+        ++libinjection_cache_statistics.miss_count_;
+        char fingerprint[8]{};
         bool is_sqli =
             libinjection_sqli(left_operand.data(), left_operand.size(), fingerprint) != 0;
+        std::string_view fingerprint_view =
+            t.internString({fingerprint, ::strnlen(fingerprint, sizeof(fingerprint))});
+        libinjection_cache.emplace(cache_key.stored(t),
+                                   Transaction::LibinjectionResult{is_sqli, fingerprint_view});
 
-        results.emplace_back(is_sqli, t.internString({fingerprint, sizeof(fingerprint)}));
-      });
+        results.emplace_back(is_sqli, fingerprint_view);
+      },
+      const_cast<DetectSqli*>(this));
 }
 } // namespace Operator
 } // namespace Wge
\ No newline at end of file
@@ -28,10 +28,28 @@ void DetectXSS::evaluate(Transaction& t, const Common::Variant& operand, Results
   performComparison<std::string_view, std::string_view>(
       t, operand, "", results,
       [](Transaction& t, std::string_view left_operand, std::string_view right_operand,
-         Results& results, void*) {
+         Results& results, void* user_data) {
+        const DetectXSS* obj = static_cast<const DetectXSS*>(user_data);
+
+        // The same value is usually checked by several rules, so the result is cached
+        auto& libinjection_cache = t.getLibinjectionCache();
+        auto& libinjection_cache_statistics = t.getLibinjectionCacheStatistics();
+        Transaction::LibinjectionCacheKey cache_key(left_operand, obj->name());
+        auto iter = libinjection_cache.find(cache_key);
+        if (iter != libinjection_cache.end()) {
+          ++libinjection_cache_statistics.hit_count_;
+          results.emplace_back(iter->second.detected_, left_operand);
+          return;
+        }
+
+        ++libinjection_cache_statistics.miss_count_;
         bool is_xss = libinjection_xss(left_operand.data(), left_operand.size()) != 0;
+        libinjection_cache.emplace(cache_key.stored(t),
+                                   Transaction::LibinjectionResult{is_xss, {}});
+
         results.emplace_back(is_xss, left_operand);
-      });
+      },
+      const_cast<DetectXSS*>(this));
 }
 } // namespace Operator
 } // namespace Wge
\ No newline at end of file
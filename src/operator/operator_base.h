@@ -20,6 +20,7 @@
  */
 #pragma once
 
+#include <span>
 #include <string>
 
 #include <absl/container/inlined_vector.h>
@@ -38,6 +39,10 @@ private:
   static constexpr char name_[] = #n;
 
 namespace Wge {
+namespace Common::Hyperscan {
+class HsDataBase;
+}
+
 namespace Operator {
 /**
  * Base class for all operators.
@@ -100,12 +105,50 @@ public:
    */
   virtual void evaluate(Transaction& t, const Common::Variant& operand, Results& results) const = 0;
 
+  /**
+   * Check whether the operator supports evaluateBatch().
+   * @return true if the operator can evaluate a batch of operands faster than evaluating the
+   * operands one by one, false otherwise.
+   */
+  virtual bool batchSupported() const { return false; }
+
+  /**
+   * Evaluate the operator with a batch of operands, such as all the values of a collection, at
+   * once. It is called only if batchSupported() returns true.
+   * @param t the transaction.
+   * @param operands the operands to evaluate.
+   * @param results the results of the evaluation, one result per operand. The results are
+   * initialized as not matched, and the NOT flag of the operator is not applied.
+   */
+  virtual void evaluateBatch(Transaction& t, std::span<const std::string_view> operands,
+                             std::span<Result> results) const {}
+
   /**
    * Get the name of the operator.
    * @return the name of the operator.
    */
   virtual const char* name() const = 0;
 
+  /**
+   * Compile the pattern of the operator, such as the regex and the hyperscan database.
+   * The compilation is deferred from the parsing to the engine initialization, so that the
+   * operators can be compiled concurrently. The operator that has nothing to compile doesn't need
+   * to override this method.
+   * @param serialize_dir the directory of the serialized hyperscan databases. Empty if the
+   * serialization is disabled.
+   * @note it is called by the worker threads of the engine initialization, so the implementation
+   * must be thread-safe among the different operators.
+   */
+  virtual void compile(const std::string& serialize_dir) {}
+
+  /**
+   * Collect the hyperscan databases that are used by the operator, e.g. to save them to a snapshot.
+   * It's called after the operator is compiled.
+   * @param databases the collected databases are appended to it.
+   */
+  virtual void
+  collectDatabases(std::vector<const Common::Hyperscan::HsDataBase*>& databases) const {}
+
 protected:
   template <class LeftOperandT, class RightOperandT>
   void performComparison(Transaction& t, const Common::Variant& left_operand,
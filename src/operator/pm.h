@@ -45,6 +45,13 @@ public:
     return within_.evaluate(t, operand, results);
   }
 
+  void compile(const std::string& serialize_dir) override { within_.compile(serialize_dir); }
+
+  void collectDatabases(
+      std::vector<const Common::Hyperscan::HsDataBase*>& databases) const override {
+    within_.collectDatabases(databases);
+  }
+
 private:
   Within within_;
 };
@@ -22,28 +22,51 @@
 
 namespace Wge {
 namespace Operator {
-std::unordered_map<std::string, std::shared_ptr<Common::Hyperscan::HsDataBase>>
+std::unordered_map<std::string, std::shared_future<std::shared_ptr<Common::Hyperscan::HsDataBase>>>
     PmFromFile::database_cache_;
 std::mutex PmFromFile::database_cache_mutex_;
 
-void PmFromFile::init(const std::string& serialize_dir) {
-  // Make the file path absolute.
-  std::string file_path = Common::File::makeFilePath(curr_rule_file_path_, literal_value_);
-
+void PmFromFile::compile(const std::string& serialize_dir) {
   // Load the hyperscan database and create a scanner.
   // We cache the hyperscan database to avoid loading(complie) the same database multiple times.
+  // The cache is keyed by the content rather than the path of the file, so the changed file is
+  // compiled again when the rule set is reloaded.
+  std::string key = expression_list_.sha1();
   std::unique_lock<std::mutex> locker(database_cache_mutex_);
-  auto iter = database_cache_.find(file_path);
+  auto iter = database_cache_.find(key);
   if (iter == database_cache_.end()) {
+    // Publish the future before compiling, so the other operators of the same file wait for it
+    // rather than compile it again.
+    // The databases of the files that were changed and reloaded are only held by the cache
+    std::erase_if(database_cache_, [](const auto& item) {
+      auto& future = item.second;
+      return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+             future.get().use_count() == 1;
+    });
+
+    std::promise<std::shared_ptr<Common::Hyperscan::HsDataBase>> promise;
+    database_cache_.emplace(key, promise.get_future().share());
     locker.unlock();
+
     const char* serialize_dir_cstr = serialize_dir.empty() ? nullptr : serialize_dir.c_str();
-    auto hs_db = std::make_shared<Common::Hyperscan::HsDataBase>(std::move(expression_list_), false,
-                                                                 serialize_dir_cstr);
+    std::shared_ptr<Common::Hyperscan::HsDataBase> hs_db;
+    try {
+      hs_db = std::make_shared<Common::Hyperscan::HsDataBase>(std::move(expression_list_), false,
+                                                              serialize_dir_cstr);
+    } catch (...) {
+      // The operators that wait for the database get the same exception, and the failed database
+      // is removed from the cache so that it's compiled again by the next load
+      promise.set_exception(std::current_exception());
+      locker.lock();
+      database_cache_.erase(key);
+      throw;
+    }
+    promise.set_value(hs_db);
     scanner_ = std::make_unique<Common::Hyperscan::Scanner>(hs_db);
-    locker.lock();
-    database_cache_.emplace(file_path, hs_db);
   } else {
-    scanner_ = std::make_unique<Common::Hyperscan::Scanner>(iter->second);
+    auto hs_db_future = iter->second;
+    locker.unlock();
+    scanner_ = std::make_unique<Common::Hyperscan::Scanner>(hs_db_future.get());
   }
 }
 } // namespace Operator
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <fstream>
+#include <future>
 #include <mutex>
 #include <string_view>
 #include <unordered_map>
@@ -61,8 +62,7 @@ class PmFromFile final : public OperatorBase {
 
 public:
   PmFromFile(std::string&& literal_value, bool is_not, std::string_view curr_rule_file_path)
-      : OperatorBase(std::move(literal_value), is_not), curr_rule_file_path_(curr_rule_file_path),
-        expression_list_(true) {
+      : OperatorBase(std::move(literal_value), is_not), expression_list_(true) {
     // Make the file path absolute.
     std::string file_path = Common::File::makeFilePath(curr_rule_file_path, literal_value_);
 
@@ -83,8 +83,15 @@ public:
   }
 
 public:
-  // The PmFromFile operator must be called init before call the evaluate function
-  void init(const std::string& serialize_dir);
+  // The PmFromFile operator must be compiled before call the evaluate function
+  void compile(const std::string& serialize_dir) override;
+
+  void collectDatabases(
+      std::vector<const Common::Hyperscan::HsDataBase*>& databases) const override {
+    if (scanner_) {
+      databases.emplace_back(&scanner_->database());
+    }
+  }
 
 public:
   void evaluate(Transaction& t, const Common::Variant& operand, Results& results) const override {
@@ -126,15 +133,43 @@ public:
         const_cast<PmFromFile*>(this));
   }
 
+  bool batchSupported() const override { return scanner_ && scanner_->vectorScanSupported(); }
+
+  void evaluateBatch(Transaction& t, std::span<const std::string_view> operands,
+                     std::span<Result> results) const override {
+    struct BatchResults {
+      std::span<const std::string_view> operands_;
+      std::span<Result> results_;
+    } batch_results{operands, results};
+
+    // Scan all the operands by as few hyperscan calls as possible. Same as evaluate(), only the
+    // first match of each operand is recorded.
+    scanner_->vectorScan(
+        operands,
+        [](size_t index, uint64_t id, unsigned long long from, unsigned long long to,
+           void* user_data) -> int {
+          BatchResults* batch_results = static_cast<BatchResults*>(user_data);
+          if (from != to) {
+            batch_results->results_[index].matched_ = true;
+            batch_results->results_[index].capture_ =
+                batch_results->operands_[index].substr(from, to - from);
+          }
+          return 0;
+        },
+        &batch_results);
+  }
+
 private:
   std::unique_ptr<Common::Hyperscan::Scanner> scanner_;
 
-  // Cache the hyperscan database
-  static std::unordered_map<std::string, std::shared_ptr<Common::Hyperscan::HsDataBase>>
+  // Cache the hyperscan database. The operators are compiled concurrently, and the same file may
+  // be used by several rules, so the cache holds the future of the database that is compiled (or
+  // being compiled) by the first operator of the file.
+  static std::unordered_map<std::string,
+                            std::shared_future<std::shared_ptr<Common::Hyperscan::HsDataBase>>>
       database_cache_;
   static std::mutex database_cache_mutex_;
 
-  std::string_view curr_rule_file_path_;
   Common::Hyperscan::ExpressionList expression_list_;
 };
 } // namespace Operator
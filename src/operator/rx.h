@@ -46,7 +46,7 @@ class Rx final : public OperatorBase {
 
 public:
   Rx(std::string&& literal_value, bool is_not, std::string_view curr_rule_file_path)
-      : OperatorBase(std::move(literal_value), is_not), scanner_(createScanner(literalValue())) {}
+      : OperatorBase(std::move(literal_value), is_not) {}
 
   Rx(std::unique_ptr<Macro::MacroBase>&& macro, bool is_not, std::string_view curr_rule_file_path)
       : OperatorBase(std::move(macro), is_not) {}
@@ -61,9 +61,7 @@ public:
           const Scanner* scanner = &obj->scanner_;
 
           // If there is a macro, expand it and create or reuse a scanner.
-          if (std::holds_alternative<std::unique_ptr<Wge::Common::Re2::Scanner>>(obj->scanner_) &&
-              std::get<std::unique_ptr<Wge::Common::Re2::Scanner>>(obj->scanner_).get() ==
-                  nullptr) {
+          if (obj->macro_) {
             // All the threads will try to access the macro_pcre_cache_ at the same time, so we
             // need to
             // lock the macro_chche_mutex_.
@@ -110,6 +108,13 @@ public:
         const_cast<Rx*>(this));
   }
 
+  void compile(const std::string& serialize_dir) override {
+    // The scanner of the macro is created when the macro is expanded
+    if (!macro_) {
+      scanner_ = createScanner(literalValue());
+    }
+  }
+
 public:
   /**
    * Set whether to capture the matched string.
@@ -120,7 +125,11 @@ public:
 
     if (capture != capture_) {
       capture_ = capture;
-      scanner_ = createScanner(literalValue());
+
+      // Recompile only if it was compiled, otherwise the scanner is created by the compile method
+      if (compiled()) {
+        scanner_ = createScanner(literalValue());
+      }
     }
   }
 
@@ -153,6 +162,10 @@ private:
     return scanner;
   }
 
+  bool compiled() const {
+    return std::visit([](auto&& arg) { return arg != nullptr; }, scanner_);
+  }
+
 private:
   Scanner scanner_;
   bool capture_{false};
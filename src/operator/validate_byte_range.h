@@ -21,9 +21,13 @@
 #pragma once
 
 #include <bitset>
+#include <charconv>
 
 #include "operator_base.h"
 
+#include "../common/simd/byte_kernel.h"
+#include "../common/string.h"
+
 namespace Wge {
 namespace Operator {
 class ValidateByteRange final : public OperatorBase {
@@ -36,6 +40,7 @@ public:
     std::vector<std::string_view> tokens = Common::SplitTokens(literal_value_, ',');
 
     // Fill the byte range.
+    std::bitset<256> byte_range;
     for (auto& token : tokens) {
       // Trim left space
       size_t left_space_count = 0;
@@ -55,19 +60,20 @@ public:
         uint32_t start_value = 0, end_value = 0;
         std::from_chars(start.data(), start.data() + start.size(), start_value);
         std::from_chars(end.data(), end.data() + end.size(), end_value);
-        if (start_value < byte_range_.size() && end_value < byte_range_.size()) {
+        if (start_value < byte_range.size() && end_value < byte_range.size()) {
           for (uint32_t i = start_value; i <= end_value; ++i) {
-            byte_range_.set(i);
+            byte_range.set(i);
           }
         }
       } else {
         uint32_t value = 0;
         std::from_chars(token.data(), token.data() + token.size(), value);
-        if (value < byte_range_.size()) {
-          byte_range_.set(value);
+        if (value < byte_range.size()) {
+          byte_range.set(value);
         }
       }
     }
+    byte_range_ = Common::Simd::ByteSet(byte_range);
   }
 
   ValidateByteRange(std::unique_ptr<Macro::MacroBase>&& macro, bool is_not,
@@ -84,20 +90,15 @@ public:
         [](Transaction& t, std::string_view left_operand, std::string_view right_operand,
            Results& results, void* user_data) {
           const ValidateByteRange* obj = reinterpret_cast<const ValidateByteRange*>(user_data);
-          for (auto& c : left_operand) {
-            if (!obj->byte_range_.test(static_cast<uint8_t>(c))) {
-              results.emplace_back(true);
-              return;
-            }
-          }
-
-          results.emplace_back(false);
+          results.emplace_back(obj->byte_range_.findNotIn(left_operand) !=
+                               std::string_view::npos);
         },
         const_cast<ValidateByteRange*>(this));
   }
 
 private:
-  std::bitset<256> byte_range_;
+  // The allowed bytes, which are tested by the nibble tables 16 or 32 bytes at a time
+  Common::Simd::ByteSet byte_range_;
 };
 } // namespace Operator
 } // namespace Wge
\ No newline at end of file
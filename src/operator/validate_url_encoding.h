@@ -20,6 +20,8 @@
  */
 #pragma once
 
+#include <cstring>
+
 #include "operator_base.h"
 
 namespace Wge {
@@ -45,25 +47,25 @@ public:
         t, operand, "", results,
         [](Transaction& t, std::string_view left_operand, std::string_view right_operand,
            Results& results, void*) {
-          // Check that after percent character must be two hexadecimal characters.
-          size_t len = left_operand.size();
-          for (size_t i = 0; i < len; ++i) {
-            if (left_operand[i] == '%') {
-
-              // If there are less than two characters after '%', it is not a valid URL encoding
-              // (for example, it ends with "%2" or "%") and is considered illegal.
-              if (i + 2 >= len) {
-                results.emplace_back(true);
-                return;
-              }
-
-              if (!::isxdigit(left_operand[i + 1]) || !::isxdigit(left_operand[i + 2])) {
-                results.emplace_back(true);
-                return;
-              }
+          // Check that after percent character must be two hexadecimal characters. Most of the
+          // values have no percent character, so jump between them by the vectorized memchr.
+          const char* p = left_operand.data();
+          const char* pe = p + left_operand.size();
+          while ((p = static_cast<const char*>(::memchr(p, '%', pe - p))) != nullptr) {
+            // If there are less than two characters after '%', it is not a valid URL encoding
+            // (for example, it ends with "%2" or "%") and is considered illegal.
+            if (pe - p <= 2) {
+              results.emplace_back(true);
+              return;
+            }
 
-              i += 2;
+            if (!::isxdigit(static_cast<unsigned char>(p[1])) ||
+                !::isxdigit(static_cast<unsigned char>(p[2]))) {
+              results.emplace_back(true);
+              return;
             }
+
+            p += 3;
           }
 
           results.emplace_back(false);
@@ -22,8 +22,15 @@
 
 #include "operator_base.h"
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Operator {
+/**
+ * Checks whether the input is a valid UTF-8 encoded string. The not enough bytes, the invalid
+ * continuation bytes, the overlong encodings, the surrogates and the code points beyond U+10FFFF
+ * are considered invalid.
+ */
 class ValidateUtf8Encoding final : public OperatorBase {
   DECLARE_OPERATOR_NAME(validateUtf8Encoding);
 
@@ -38,8 +45,65 @@ public:
 
 public:
   void evaluate(Transaction& t, const Common::Variant& operand, Results& results) const override {
-    assert(false);
-    throw "Not implemented!";
+    performComparison<std::string_view, std::string_view>(
+        t, operand, "", results,
+        [](Transaction& t, std::string_view left_operand, std::string_view right_operand,
+           Results& results, void*) { results.emplace_back(!isValidUtf8(left_operand)); });
+  }
+
+private:
+  static bool isValidUtf8(std::string_view data) {
+    while (true) {
+      // Skip the ASCII bytes, which are the most of the data, 16 or 32 bytes at a time
+      size_t pos = Common::Simd::findInRange(data, 0x80, 0xff);
+      if (pos == std::string_view::npos) {
+        return true;
+      }
+      data.remove_prefix(pos);
+
+      // The well-formed sequences (The Unicode Standard, Table 3-7). The second byte has its own
+      // range, and the other continuation bytes are in 0x80-0xBF.
+      unsigned char c = data[0];
+      size_t size;
+      unsigned char second_low = 0x80, second_high = 0xbf;
+      if (c >= 0xc2 && c <= 0xdf) {
+        size = 2;
+      } else if (c >= 0xe0 && c <= 0xef) {
+        size = 3;
+        if (c == 0xe0) {
+          second_low = 0xa0;
+        } else if (c == 0xed) {
+          second_high = 0x9f;
+        }
+      } else if (c >= 0xf0 && c <= 0xf4) {
+        size = 4;
+        if (c == 0xf0) {
+          second_low = 0x90;
+        } else if (c == 0xf4) {
+          second_high = 0x8f;
+        }
+      } else {
+        return false;
+      }
+
+      if (data.size() < size) {
+        return false;
+      }
+
+      unsigned char second = data[1];
+      if (second < second_low || second > second_high) {
+        return false;
+      }
+
+      for (size_t i = 2; i < size; ++i) {
+        unsigned char continuation = data[i];
+        if (continuation < 0x80 || continuation > 0xbf) {
+          return false;
+        }
+      }
+
+      data.remove_prefix(size);
+    }
   }
 };
 } // namespace Operator
@@ -39,27 +39,7 @@ class Within final : public OperatorBase {
 
 public:
   Within(std::string&& literal_value, bool is_not, std::string_view curr_rule_file_path)
-      : OperatorBase(std::move(literal_value), is_not) {
-    // Split the literal value into tokens.
-    std::vector<std::string_view> tokens = Common::SplitTokens(literal_value_);
-
-    // Calculate the order independent hash value of all tokens.
-    int64_t hash = calcOrderIndependentHash(tokens);
-
-    // Load the hyperscan database and create a scanner.
-    // We cache the hyperscan database to avoid loading(complie) the same database multiple times.
-    database_cache_.access(
-        hash,
-        [&](const std::shared_ptr<Common::Hyperscan::HsDataBase>& hs_db) {
-          scanner_ = std::make_unique<Common::Hyperscan::Scanner>(hs_db);
-        },
-        [&]() {
-          auto hs_db = std::make_shared<Common::Hyperscan::HsDataBase>(tokens, true, true, true,
-                                                                       false, false);
-          scanner_ = std::make_unique<Common::Hyperscan::Scanner>(hs_db);
-          return hs_db;
-        });
-  }
+      : OperatorBase(std::move(literal_value), is_not) {}
 
   Within(std::unique_ptr<Macro::MacroBase>&& macro, bool is_not,
          std::string_view curr_rule_file_path)
@@ -126,6 +106,77 @@ public:
         const_cast<Within*>(this));
   }
 
+  bool batchSupported() const override {
+    return !macro_ && scanner_ && scanner_->vectorScanSupported();
+  }
+
+  void evaluateBatch(Transaction& t, std::span<const std::string_view> operands,
+                     std::span<Result> results) const override {
+    struct BatchResults {
+      std::span<const std::string_view> operands_;
+      std::span<Result> results_;
+    } batch_results{operands, results};
+
+    // Scan all the operands by as few hyperscan calls as possible. Same as evaluate(), only the
+    // first match of each operand is recorded.
+    scanner_->vectorScan(
+        operands,
+        [](size_t index, uint64_t id, unsigned long long from, unsigned long long to,
+           void* user_data) -> int {
+          BatchResults* batch_results = static_cast<BatchResults*>(user_data);
+          if (from != to) {
+            batch_results->results_[index].matched_ = true;
+            batch_results->results_[index].capture_ =
+                batch_results->operands_[index].substr(from, to - from);
+          }
+          return 0;
+        },
+        &batch_results);
+  }
+
+  void compile(const std::string& serialize_dir) override {
+    // The scanner of the macro is created when the macro is expanded
+    if (macro_) {
+      return;
+    }
+
+    // Split the literal value into tokens.
+    std::vector<std::string_view> tokens = Common::SplitTokens(literal_value_);
+
+    // Calculate the order independent hash value of all tokens.
+    int64_t hash = calcOrderIndependentHash(tokens);
+
+    // Load the hyperscan database and create a scanner.
+    // We cache the hyperscan database to avoid loading(complie) the same database multiple times.
+    std::shared_ptr<Common::Hyperscan::HsDataBase> hs_db;
+    database_cache_.peek(hash, [&](const std::shared_ptr<Common::Hyperscan::HsDataBase>* cached) {
+      if (cached) {
+        hs_db = *cached;
+      }
+    });
+
+    // The cache holds its lock while the value is created, so the database is compiled outside of
+    // the cache to let the operators be compiled concurrently. If the same tokens are compiled by
+    // the other thread at the same time, the first inserted database is used.
+    if (!hs_db) {
+      auto compiled_db = std::make_shared<Common::Hyperscan::HsDataBase>(tokens, true, true, true,
+                                                                         false, false);
+      database_cache_.access(
+          hash,
+          [&](const std::shared_ptr<Common::Hyperscan::HsDataBase>& cached) { hs_db = cached; },
+          [&]() { return compiled_db; });
+    }
+
+    scanner_ = std::make_unique<Common::Hyperscan::Scanner>(hs_db);
+  }
+
+  void collectDatabases(
+      std::vector<const Common::Hyperscan::HsDataBase*>& databases) const override {
+    if (scanner_) {
+      databases.emplace_back(&scanner_->database());
+    }
+  }
+
 private:
   static int64_t calcOrderIndependentHash(const std::vector<std::string_view>& tokens) {
     int64_t hash = 0;
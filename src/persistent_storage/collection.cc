@@ -20,26 +20,72 @@
  */
 #include "collection.h"
 
-#include <time.h>
+#include <algorithm>
+#include <optional>
+
+#include "shared_memory_table.h"
 
 namespace Wge {
 namespace PersistentStorage {
-Collection::Collection() { create_time_ = ::time(nullptr); }
+Collection::Collection(std::string_view key, uint32_t timeout)
+    : key_(key), create_time_(::time(nullptr)), last_update_time_(create_time_),
+      timeout_(timeout) {}
 
 void Collection::set(const std::string& key, const Common::Variant& value) {
+  if (shared_table_) {
+    shared_table_->set(type_, key_, timeout_, key, value);
+  }
+
+  std::lock_guard<std::mutex> lock(kv_mutex_);
+
+  auto iter = kv_.try_emplace(key).first;
+  assign(iter->second, value);
+  last_update_time_.store(::time(nullptr), std::memory_order_relaxed);
+  update_counter_.fetch_add(1, std::memory_order_relaxed);
+  if (dirty_) {
+    dirty_->store(true, std::memory_order_relaxed);
+  }
+}
+
+void Collection::increase(const std::string& key, int64_t delta) {
+  std::optional<int64_t> shared_value;
+  if (shared_table_) {
+    shared_value = shared_table_->increase(type_, key_, timeout_, key, delta);
+  }
+
   std::lock_guard<std::mutex> lock(kv_mutex_);
 
   auto iter = kv_.try_emplace(key).first;
-  iter->second.variant_ = value;
-  last_update_time_ = ::time(nullptr);
-  ++update_counter_;
+  const Common::Variant& value = iter->second.variant_;
+  if (shared_value) {
+    // The shared memory holds the value that is increased by all of the processes
+    assign(iter->second, shared_value.value());
+  } else if (IS_INT_VARIANT(value)) {
+    assign(iter->second, std::get<int64_t>(value) + delta);
+  } else if (IS_EMPTY_VARIANT(value)) {
+    assign(iter->second, delta);
+  } else {
+    return;
+  }
+
+  last_update_time_.store(::time(nullptr), std::memory_order_relaxed);
+  update_counter_.fetch_add(1, std::memory_order_relaxed);
+  if (dirty_) {
+    dirty_->store(true, std::memory_order_relaxed);
+  }
 }
 
-const Common::Variant& Collection::get(const std::string& key) const {
+Common::Variant
+Collection::get(const std::string& key,
+                const std::function<std::string_view(std::string_view)>& copy_string) const {
   std::lock_guard<std::mutex> lock(kv_mutex_);
   auto iter = kv_.find(key);
   if (iter != kv_.end()) {
-    return iter->second.variant_;
+    const Common::Variant& value = iter->second.variant_;
+    if (IS_STRING_VIEW_VARIANT(value)) {
+      return copy_string(std::get<std::string_view>(value));
+    }
+    return value;
   }
 
   return EMPTY_VARIANT;
@@ -54,5 +100,20 @@ void Collection::travel(
     }
   }
 }
+
+void Collection::assign(Value& value, const Common::Variant& variant) {
+  if (IS_STRING_VIEW_VARIANT(variant)) {
+    value.buffer_ = std::get<std::string_view>(variant);
+    value.variant_ = std::string_view(value.buffer_);
+  } else {
+    value.buffer_.clear();
+    value.variant_ = variant;
+  }
+}
+
+uint64_t Collection::updateRate() const {
+  time_t minutes = std::max<time_t>(1, (::time(nullptr) - create_time_) / 60);
+  return updateCounter() / minutes;
+}
 } // namespace PersistentStorage
-} // namespace Wge
\ No newline at end of file
+} // namespace Wge
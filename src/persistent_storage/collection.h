@@ -20,20 +20,33 @@
  */
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 
 #include <stdint.h>
+#include <time.h>
 
 #include "../common/evaluate_result.h"
 
 namespace Wge {
 namespace PersistentStorage {
+class Storage;
+class SharedMemoryTable;
+
 class Collection {
+  friend class Storage;
+  friend class SharedMemoryTable;
+
 public:
-  Collection();
+  /**
+   * Construct a collection.
+   * @param key the value of the initcol variable.
+   * @param timeout the seconds that the collection expires after the last update.
+   */
+  Collection(std::string_view key, uint32_t timeout);
 
 public:
   /**
@@ -43,50 +56,74 @@ public:
    */
   void set(const std::string& key, const Common::Variant& value);
 
+  /**
+   * Increase an integer value of the collection. The value is read, increased and written back
+   * atomically (in the shared memory too if the collection is shared), so the concurrent increments
+   * aren't lost. The string value isn't increased.
+   * @param key The key of the value, the value is created with the delta if it doesn't exist.
+   * @param delta The delta, negative to decrease.
+   */
+  void increase(const std::string& key, int64_t delta);
+
   /**
    * Get a value from the collection by key.
+   * The string value is copied with the lock held, since it may be reassigned by the other thread
+   * once the lock is released.
    * @param key Specifies the key to get
-   * @return The value associated with the key
+   * @param copy_string the function that copies the string value to the storage of the caller
+   * @return The copy of the value associated with the key
    */
-  const Common::Variant& get(const std::string& key) const;
+  Common::Variant get(const std::string& key,
+                      const std::function<std::string_view(std::string_view)>& copy_string) const;
 
   /**
    * Get the number of key/value pairs in the collection.
    * @return The number of key/value pairs in the collection.
    */
-  size_t size() const { return kv_.size(); }
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(kv_mutex_);
+    return kv_.size();
+  }
 
   /**
    * Iterate over all key/value pairs in the collection.
    * @param func A function to call for each key/value pair. The function should return true to
-   * continue iterating, or false to stop.
+   * continue iterating, or false to stop. It's called with the lock held, so the value must be
+   * copied if it's referenced after the function returns.
    */
   void travel(std::function<bool(const std::string&, const Common::Variant&)> func) const;
 
+  /**
+   * Check whether the collection is expired.
+   * @param now The number of seconds since 1970/1/1
+   * @return True if the collection isn't updated in the timeout seconds.
+   */
+  bool isExpired(time_t now) const { return now >= lastUpdateTime() + timeout(); }
+
   // Built-in attributes
 public:
   /**
    * Get timestamp of the creation of the collection.
    * @return The number of seconds since 1970/1/1
    */
-  time_t createTime() const;
+  time_t createTime() const { return create_time_; }
 
   /**
    * Check whether the collection is new.
    * @return Ture if the collection is new (not yet persisted) otherwise returns false.
    */
-  bool isNew() const;
+  bool isNew() const { return is_new_; }
 
   /**
    * @return The value of the initcol variable
    */
-  const std::string& key() const;
+  const std::string& key() const { return key_; }
 
   /**
    * Get timestamp of the last update to the collection.
    * @return The number of seconds since 1970/1/1
    */
-  time_t lastUpdateTime() const;
+  time_t lastUpdateTime() const { return last_update_time_.load(std::memory_order_relaxed); }
 
   /**
    * date/time in seconds when the collection will be updated on disk from memory (if no other
@@ -94,12 +131,12 @@ public:
    * (default is 3600 seconds). The TIMEOUT is updated every time that the values of an entry is
    * changed.
    */
-  uint32_t timeout() const;
+  uint32_t timeout() const { return timeout_; }
 
   /**
    * @return How many times the collection has been updated since creation.
    */
-  uint64_t updateCounter() const;
+  uint64_t updateCounter() const { return update_counter_.load(std::memory_order_relaxed); }
 
   /**
    * @return The average rate updates per minute since creation.
@@ -107,14 +144,33 @@ public:
   uint64_t updateRate() const;
 
 private:
+  // The collection owns the string value, since the value may outlive the transaction that sets it
+  struct Value {
+    Common::Variant variant_;
+    std::string buffer_;
+  };
+
+  void assign(Value& value, const Common::Variant& variant);
+
+private:
+  const std::string key_;
   time_t create_time_;
-  bool is_new_{false};
-  time_t last_update_time_;
-  uint32_t timeout_{3600};
-  uint64_t update_counter_;
+  bool is_new_{true};
+  std::atomic<time_t> last_update_time_;
+  uint32_t timeout_;
+  std::atomic<uint64_t> update_counter_{0};
+
+  // The dirty flag of the shard that the collection belongs to, it's set when the collection is
+  // updated so that the shard is serialized again by the next snapshot
+  std::atomic_bool* dirty_{nullptr};
+
+  // The shared memory table that the collection is copied from, the updates are written through
+  // to the table so that the other processes can see them
+  SharedMemoryTable* shared_table_{nullptr};
+  size_t type_{0};
 
-  std::unordered_map<std::string, Common::EvaluateElement> kv_;
+  std::unordered_map<std::string, Value> kv_;
   mutable std::mutex kv_mutex_;
 };
 } // namespace PersistentStorage
-} // namespace Wge
\ No newline at end of file
+} // namespace Wge
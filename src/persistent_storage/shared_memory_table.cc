@@ -0,0 +1,482 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "shared_memory_table.h"
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <new>
+#include <thread>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "collection.h"
+
+#include "../common/log.h"
+
+namespace Wge {
+namespace PersistentStorage {
+namespace {
+constexpr std::string_view table_magic = "WGESHMT1";
+constexpr uint64_t table_layout_version = 2;
+
+// The time that the process waits for the other process to initialize the segment
+constexpr std::chrono::seconds table_init_timeout{5};
+
+// The hash must be the same in all of the processes, so the std::hash isn't used.
+uint64_t hash(size_t type, std::string_view name) {
+  uint64_t hash = 0xcbf29ce484222325 ^ type;
+  for (unsigned char c : name) {
+    hash ^= c;
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+// The process that doesn't exist, e.g. the creator of the segment that died
+bool isProcessGone(pid_t pid) { return ::kill(pid, 0) == -1 && errno == ESRCH; }
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<int32_t>::is_always_lock_free);
+} // namespace
+
+struct SharedMemoryTable::Header {
+  char magic_[table_magic.size()];
+  uint64_t layout_version_;
+  uint64_t bucket_count_;
+  std::atomic<uint64_t> live_count_;
+  std::atomic<uint64_t> eviction_count_;
+
+  // The process that initializes the segment. If it dies before the segment is initialized, the
+  // process that attaches the segment takes over the initialization.
+  std::atomic<int32_t> creator_pid_;
+
+  // It's set after the segment is initialized by the creator
+  std::atomic<uint32_t> initialized_;
+};
+
+struct SharedMemoryTable::Slot {
+  struct Value {
+    uint8_t key_size_;
+    // The index of the Common::Variant
+    uint8_t type_;
+    uint8_t string_size_;
+    int64_t int_value_;
+    char key_[max_key_size_];
+    char string_[max_string_value_size_];
+  };
+
+  bool used_;
+  uint8_t type_;
+  uint8_t name_size_;
+  uint8_t value_count_;
+  uint32_t timeout_;
+  int64_t create_time_;
+  int64_t last_update_time_;
+  uint64_t update_counter_;
+  char name_[max_name_size_];
+  Value values_[max_value_count_];
+
+  std::string_view name() const { return {name_, name_size_}; }
+  bool isExpired(time_t now) const { return now >= last_update_time_ + timeout_; }
+
+  // Find the value of the key, or add it if the slot isn't full
+  Value* emplaceValue(std::string_view key) {
+    for (size_t i = 0; i < value_count_; ++i) {
+      if (std::string_view(values_[i].key_, values_[i].key_size_) == key) {
+        return &values_[i];
+      }
+    }
+    if (value_count_ == max_value_count_) {
+      return nullptr;
+    }
+
+    Value* value = &values_[value_count_++];
+    value->key_size_ = key.size();
+    value->type_ = 0;
+    ::memcpy(value->key_, key.data(), key.size());
+    return value;
+  }
+};
+
+struct SharedMemoryTable::Bucket {
+  pthread_mutex_t mutex_;
+  Slot slots_[bucket_size_];
+};
+
+SharedMemoryTable::~SharedMemoryTable() = default;
+
+std::expected<std::unique_ptr<SharedMemoryTable>, std::string>
+SharedMemoryTable::attach(const std::string& name, size_t capacity) {
+  using namespace boost::interprocess;
+
+  std::unique_ptr<SharedMemoryTable> table(new SharedMemoryTable());
+  table->name_ = name;
+  const uint64_t bucket_count = std::max<size_t>(1, (capacity + bucket_size_ - 1) / bucket_size_);
+  const size_t table_size = sizeof(Header) + bucket_count * sizeof(Bucket);
+  try {
+    // Create and initialize the segment
+    shared_memory_object shm(create_only, name.c_str(), read_write);
+    shm.truncate(table_size);
+    table->region_ = std::make_unique<mapped_region>(shm, read_write);
+
+    char* address = static_cast<char*>(table->region_->get_address());
+    table->header_ = new (address) Header{};
+    table->header_->creator_pid_.store(::getpid(), std::memory_order_relaxed);
+    table->buckets_ = reinterpret_cast<Bucket*>(address + sizeof(Header));
+    table->initialize(bucket_count);
+    WGE_LOG_INFO("Created the shared memory storage {} with {} buckets", name, bucket_count);
+    return table;
+  } catch (const interprocess_exception& e) {
+    if (e.get_error_code() != already_exists_error) {
+      return std::unexpected(std::format("create shared memory {} failed: {}", name, e.what()));
+    }
+  }
+
+  // The segment has been created by the other process, wait until it's initialized
+  try {
+    shared_memory_object shm(open_only, name.c_str(), read_write);
+    auto deadline = std::chrono::steady_clock::now() + table_init_timeout;
+    offset_t size = 0;
+    while (shm.get_size(size), static_cast<size_t>(size) < sizeof(Header)) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        // The creator died before sizing the segment, the zero-filled segment is initialized below
+        // by the process that takes over
+        shm.truncate(table_size);
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    table->region_ = std::make_unique<mapped_region>(shm, read_write);
+    char* address = static_cast<char*>(table->region_->get_address());
+    table->header_ = reinterpret_cast<Header*>(address);
+    table->buckets_ = reinterpret_cast<Bucket*>(address + sizeof(Header));
+    while (!table->header_->initialized_.load(std::memory_order_acquire)) {
+      // Take over the initialization if the creator is gone. The creator that died before
+      // recording its pid is detected by the timeout.
+      int32_t creator_pid = table->header_->creator_pid_.load(std::memory_order_relaxed);
+      bool timeout = std::chrono::steady_clock::now() > deadline;
+      bool creator_gone = creator_pid ? isProcessGone(creator_pid) : timeout;
+      if (creator_gone) {
+        if (table->header_->creator_pid_.compare_exchange_strong(creator_pid, ::getpid())) {
+          WGE_LOG_WARN("the creator of the shared memory storage {} died before initializing it, "
+                       "initialize it again",
+                       name);
+          table->initialize((table->region_->get_size() - sizeof(Header)) / sizeof(Bucket));
+          break;
+        }
+
+        // The other process takes over the initialization
+        deadline = std::chrono::steady_clock::now() + table_init_timeout;
+      } else if (timeout) {
+        return std::unexpected(std::format("shared memory {} isn't initialized", name));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (std::string_view(table->header_->magic_, table_magic.size()) != table_magic ||
+        table->header_->layout_version_ != table_layout_version ||
+        table->region_->get_size() <
+            sizeof(Header) + table->header_->bucket_count_ * sizeof(Bucket)) {
+      return std::unexpected(
+          std::format("shared memory {} is created by the other version", name));
+    }
+  } catch (const interprocess_exception& e) {
+    return std::unexpected(std::format("open shared memory {} failed: {}", name, e.what()));
+  }
+
+  return table;
+}
+
+void SharedMemoryTable::initialize(uint64_t bucket_count) {
+  ::memcpy(header_->magic_, table_magic.data(), table_magic.size());
+  header_->layout_version_ = table_layout_version;
+  header_->bucket_count_ = bucket_count;
+  header_->live_count_.store(0, std::memory_order_relaxed);
+  header_->eviction_count_.store(0, std::memory_order_relaxed);
+
+  pthread_mutexattr_t attr;
+  ::pthread_mutexattr_init(&attr);
+  ::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  ::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+  for (uint64_t i = 0; i < bucket_count; ++i) {
+    ::pthread_mutex_init(&buckets_[i].mutex_, &attr);
+  }
+  ::pthread_mutexattr_destroy(&attr);
+
+  header_->initialized_.store(1, std::memory_order_release);
+}
+
+void SharedMemoryTable::remove(const std::string& name) {
+  boost::interprocess::shared_memory_object::remove(name.c_str());
+}
+
+void SharedMemoryTable::initCollection(size_t type, std::string_view name, uint32_t timeout) {
+  if (name.size() > max_name_size_)
+    [[unlikely]] {
+      WGE_LOG_WARN("the collection name is too long for the shared memory storage: {}", name);
+      return;
+    }
+
+  Bucket& b = bucket(type, name);
+  time_t now = ::time(nullptr);
+  lock(b);
+  if (!find(b, type, name, now)) {
+    emplace(b, type, name, timeout, now);
+  }
+  unlock(b);
+}
+
+std::shared_ptr<Collection> SharedMemoryTable::collection(size_t type, std::string_view name) {
+  if (name.size() > max_name_size_)
+    [[unlikely]] { return nullptr; }
+
+  // Copy the slot and build the collection outside the lock
+  Bucket& b = bucket(type, name);
+  Slot slot;
+  lock(b);
+  Slot* found = find(b, type, name, ::time(nullptr));
+  if (found) {
+    slot = *found;
+  }
+  unlock(b);
+  if (!found) {
+    return nullptr;
+  }
+
+  auto collection = std::make_shared<Collection>(name, slot.timeout_);
+  collection->create_time_ = slot.create_time_;
+  collection->is_new_ = false;
+  collection->last_update_time_ = slot.last_update_time_;
+  collection->update_counter_ = slot.update_counter_;
+  for (size_t i = 0; i < slot.value_count_; ++i) {
+    const Slot::Value& value = slot.values_[i];
+    Common::Variant variant;
+    if (value.type_ == 1) {
+      variant = value.int_value_;
+    } else if (value.type_ == 2) {
+      variant = std::string_view(value.string_, value.string_size_);
+    }
+    collection->assign(collection->kv_[std::string(value.key_, value.key_size_)], variant);
+  }
+  collection->shared_table_ = this;
+  collection->type_ = type;
+
+  return collection;
+}
+
+void SharedMemoryTable::set(size_t type, std::string_view name, uint32_t timeout,
+                            std::string_view key, const Common::Variant& value) {
+  if (name.size() > max_name_size_ || key.size() > max_key_size_ ||
+      (IS_STRING_VIEW_VARIANT(value) &&
+       std::get<std::string_view>(value).size() > max_string_value_size_))
+    [[unlikely]] {
+      WGE_LOG_WARN("the value is too long for the shared memory storage: {}.{}", name, key);
+      return;
+    }
+
+  Bucket& b = bucket(type, name);
+  time_t now = ::time(nullptr);
+  lock(b);
+  Slot* slot = find(b, type, name, now);
+  if (!slot) {
+    slot = &emplace(b, type, name, timeout, now);
+  }
+
+  Slot::Value* slot_value = slot->emplaceValue(key);
+  if (slot_value)
+    [[likely]] {
+      slot_value->type_ = value.index();
+      if (IS_INT_VARIANT(value)) {
+        slot_value->int_value_ = std::get<int64_t>(value);
+      } else if (IS_STRING_VIEW_VARIANT(value)) {
+        std::string_view string_value = std::get<std::string_view>(value);
+        slot_value->string_size_ = string_value.size();
+        ::memcpy(slot_value->string_, string_value.data(), string_value.size());
+      }
+      slot->last_update_time_ = now;
+      ++slot->update_counter_;
+    }
+  unlock(b);
+
+  if (!slot_value)
+    [[unlikely]] {
+      WGE_LOG_WARN("the values of the collection {} exceed the shared memory storage limit", name);
+    }
+}
+
+std::optional<int64_t> SharedMemoryTable::increase(size_t type, std::string_view name,
+                                                   uint32_t timeout, std::string_view key,
+                                                   int64_t delta) {
+  if (name.size() > max_name_size_ || key.size() > max_key_size_)
+    [[unlikely]] {
+      WGE_LOG_WARN("the value is too long for the shared memory storage: {}.{}", name, key);
+      return std::nullopt;
+    }
+
+  Bucket& b = bucket(type, name);
+  time_t now = ::time(nullptr);
+  std::optional<int64_t> result;
+  lock(b);
+  Slot* slot = find(b, type, name, now);
+  if (!slot) {
+    slot = &emplace(b, type, name, timeout, now);
+  }
+
+  Slot::Value* slot_value = slot->emplaceValue(key);
+  if (slot_value)
+    [[likely]] {
+      // The string value isn't increased, the same as the TX variable
+      if (slot_value->type_ == 0) {
+        slot_value->type_ = 1;
+        slot_value->int_value_ = 0;
+      }
+      if (slot_value->type_ == 1) {
+        slot_value->int_value_ += delta;
+        slot->last_update_time_ = now;
+        ++slot->update_counter_;
+        result = slot_value->int_value_;
+      }
+    }
+  unlock(b);
+
+  if (!slot_value)
+    [[unlikely]] {
+      WGE_LOG_WARN("the values of the collection {} exceed the shared memory storage limit", name);
+    }
+
+  return result;
+}
+
+size_t SharedMemoryTable::sweep() {
+  time_t now = ::time(nullptr);
+  size_t count = 0;
+  for (uint64_t i = 0; i < header_->bucket_count_; ++i) {
+    Bucket& b = buckets_[i];
+    lock(b);
+    for (auto& slot : b.slots_) {
+      if (slot.used_ && slot.isExpired(now)) {
+        clear(slot);
+        ++count;
+      }
+    }
+    unlock(b);
+  }
+
+  header_->eviction_count_.fetch_add(count, std::memory_order_relaxed);
+  return count;
+}
+
+size_t SharedMemoryTable::liveCount() const {
+  return header_->live_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t SharedMemoryTable::evictionCount() const {
+  return header_->eviction_count_.load(std::memory_order_relaxed);
+}
+
+SharedMemoryTable::Bucket& SharedMemoryTable::bucket(size_t type, std::string_view name) {
+  return buckets_[hash(type, name) % header_->bucket_count_];
+}
+
+void SharedMemoryTable::lock(Bucket& bucket) {
+  int ret = ::pthread_mutex_lock(&bucket.mutex_);
+  if (ret == EOWNERDEAD)
+    [[unlikely]] {
+      // The owner died while holding the lock, the bucket may be modified halfway, so it's cleared
+      WGE_LOG_WARN("the owner of the shared memory storage lock died, the bucket is cleared");
+      size_t count = 0;
+      for (auto& slot : bucket.slots_) {
+        if (slot.used_) {
+          clear(slot);
+          ++count;
+        }
+      }
+      header_->eviction_count_.fetch_add(count, std::memory_order_relaxed);
+      ::pthread_mutex_consistent(&bucket.mutex_);
+    }
+}
+
+void SharedMemoryTable::unlock(Bucket& bucket) { ::pthread_mutex_unlock(&bucket.mutex_); }
+
+SharedMemoryTable::Slot* SharedMemoryTable::find(Bucket& bucket, size_t type,
+                                                 std::string_view name, time_t now) {
+  for (auto& slot : bucket.slots_) {
+    if (slot.used_ && slot.type_ == type && slot.name() == name) {
+      if (slot.isExpired(now))
+        [[unlikely]] {
+          clear(slot);
+          header_->eviction_count_.fetch_add(1, std::memory_order_relaxed);
+          return nullptr;
+        }
+      return &slot;
+    }
+  }
+
+  return nullptr;
+}
+
+SharedMemoryTable::Slot& SharedMemoryTable::emplace(Bucket& bucket, size_t type,
+                                                    std::string_view name, uint32_t timeout,
+                                                    time_t now) {
+  // Pick a free slot, or else evict the expired or the least recently updated collection
+  Slot* picked = nullptr;
+  for (auto& slot : bucket.slots_) {
+    if (!slot.used_) {
+      picked = &slot;
+      break;
+    }
+    if (!picked || slot.isExpired(now) ||
+        (!picked->isExpired(now) && slot.last_update_time_ < picked->last_update_time_)) {
+      picked = &slot;
+    }
+  }
+  if (picked->used_) {
+    clear(*picked);
+    header_->eviction_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  picked->used_ = true;
+  picked->type_ = type;
+  picked->name_size_ = name.size();
+  ::memcpy(picked->name_, name.data(), name.size());
+  picked->value_count_ = 0;
+  picked->timeout_ = timeout;
+  picked->create_time_ = now;
+  picked->last_update_time_ = now;
+  picked->update_counter_ = 0;
+  header_->live_count_.fetch_add(1, std::memory_order_relaxed);
+
+  return *picked;
+}
+
+void SharedMemoryTable::clear(Slot& slot) {
+  slot.used_ = false;
+  header_->live_count_.fetch_sub(1, std::memory_order_relaxed);
+}
+} // namespace PersistentStorage
+} // namespace Wge
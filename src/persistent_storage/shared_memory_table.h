@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../common/variant.h"
+
+namespace boost::interprocess {
+class mapped_region;
+}
+
+namespace Wge {
+namespace PersistentStorage {
+class Collection;
+
+/**
+ * A fixed-size hash table of the collections in a named shared memory segment, so that the
+ * processes that attach the same segment (e.g. the workers of a multi-process proxy) share the
+ * persistent collections, and the counters such as IP:dos_counter are counted across the workers.
+ * The table is divided into the buckets, and each bucket has a fixed count of the collection slots
+ * and a robust process-shared mutex. If a process dies while holding the mutex, the next process
+ * that locks the bucket clears it, since the bucket may be modified halfway. If the creator of the
+ * segment dies before initializing it, the process that attaches the segment initializes it.
+ * A collection expires if it isn't updated in its timeout seconds. If all of the slots of a bucket
+ * are occupied, the expired collection or else the least recently updated collection is evicted.
+ * Each collection holds a fixed count of the values, and the key and the string value are limited
+ * in size, the value that exceeds the limits is dropped.
+ */
+class SharedMemoryTable {
+public:
+  // The limits of a collection
+  static constexpr size_t max_name_size_ = 128;
+  static constexpr size_t max_value_count_ = 8;
+  static constexpr size_t max_key_size_ = 32;
+  static constexpr size_t max_string_value_size_ = 64;
+
+  // The count of the slots of each bucket
+  static constexpr size_t bucket_size_ = 8;
+
+public:
+  ~SharedMemoryTable();
+
+public:
+  /**
+   * Attach the named shared memory segment, the segment is created and initialized if it doesn't
+   * exist.
+   * @param name the name of the shared memory segment.
+   * @param capacity the max count of the collections. It's only used to create the segment, the
+   * capacity of the existing segment is kept.
+   * @return the table, or an error string if fails.
+   */
+  static std::expected<std::unique_ptr<SharedMemoryTable>, std::string>
+  attach(const std::string& name, size_t capacity);
+
+  /**
+   * Remove the named shared memory segment. The processes that have attached the segment can
+   * still use it until they detach.
+   * @param name the name of the shared memory segment.
+   */
+  static void remove(const std::string& name);
+
+public:
+  /**
+   * Create the collection if it doesn't exist or is expired.
+   * @param type the type of the collection.
+   * @param name the name of the collection.
+   * @param timeout the timeout of the new collection.
+   */
+  void initCollection(size_t type, std::string_view name, uint32_t timeout);
+
+  /**
+   * Copy the collection from the shared memory.
+   * @param type the type of the collection.
+   * @param name the name of the collection.
+   * @return the copy of the collection, or nullptr if the collection doesn't exist or is expired.
+   * The values that are set to the copy are written through to the shared memory.
+   */
+  std::shared_ptr<Collection> collection(size_t type, std::string_view name);
+
+  /**
+   * Set a value of the collection in the shared memory. The collection is created if it doesn't
+   * exist.
+   * @param type the type of the collection.
+   * @param name the name of the collection.
+   * @param timeout the timeout of the collection if it's created.
+   * @param key the key of the value.
+   * @param value the value.
+   */
+  void set(size_t type, std::string_view name, uint32_t timeout, std::string_view key,
+           const Common::Variant& value);
+
+  /**
+   * Increase an integer value of the collection in the shared memory. The value is read, increased
+   * and written back with the bucket locked, so the concurrent increments of the processes aren't
+   * lost. The collection is created if it doesn't exist.
+   * @param type the type of the collection.
+   * @param name the name of the collection.
+   * @param timeout the timeout of the collection if it's created.
+   * @param key the key of the value. The value is created with the delta if it doesn't exist.
+   * @param delta the delta, negative to decrease.
+   * @return the increased value, or std::nullopt if the value isn't an integer or exceeds the
+   * limits.
+   */
+  std::optional<int64_t> increase(size_t type, std::string_view name, uint32_t timeout,
+                                  std::string_view key, int64_t delta);
+
+  /**
+   * Evict all of the expired collections.
+   * @return the count of the evicted collections.
+   */
+  size_t sweep();
+
+  /**
+   * @return the count of the live collections of all processes.
+   */
+  size_t liveCount() const;
+
+  /**
+   * @return the count of the evicted collections of all processes.
+   */
+  uint64_t evictionCount() const;
+
+  /**
+   * @return the name of the shared memory segment.
+   */
+  const std::string& name() const { return name_; }
+
+private:
+  struct Header;
+  struct Bucket;
+  struct Slot;
+
+  SharedMemoryTable() = default;
+
+  void initialize(uint64_t bucket_count);
+  Bucket& bucket(size_t type, std::string_view name);
+  void lock(Bucket& bucket);
+  void unlock(Bucket& bucket);
+  Slot* find(Bucket& bucket, size_t type, std::string_view name, time_t now);
+  Slot& emplace(Bucket& bucket, size_t type, std::string_view name, uint32_t timeout, time_t now);
+  void clear(Slot& slot);
+
+private:
+  std::string name_;
+  std::unique_ptr<boost::interprocess::mapped_region> region_;
+  Header* header_{nullptr};
+  Bucket* buckets_{nullptr};
+};
+} // namespace PersistentStorage
+} // namespace Wge
@@ -20,33 +20,548 @@
  */
 #include "storage.h"
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../common/log.h"
+
 namespace Wge {
 namespace PersistentStorage {
+namespace {
+// The layout of the snapshot file:
+// magic | version | payload size | payload checksum | payload
+// payload: collection count | collection...
+// collection: type | name | create time | last update time | timeout | update counter |
+//             value count | (key | value type | value)...
+// The integers are 64 bits in the native byte order, and the strings are length-prefixed.
+constexpr std::string_view snapshot_magic = "WGESTOR1";
+constexpr uint64_t snapshot_version = 1;
+constexpr size_t snapshot_header_size = snapshot_magic.size() + 3 * sizeof(uint64_t);
+
+// FNV-1a that consumes 8 bytes at a time. The data can be updated in pieces, and the result is the
+// same as updating the whole data at once.
+class Checksum {
+public:
+  void update(std::string_view data) {
+    if (tail_size_) {
+      size_t size = std::min(data.size(), sizeof(tail_) - tail_size_);
+      ::memcpy(tail_ + tail_size_, data.data(), size);
+      tail_size_ += size;
+      data.remove_prefix(size);
+      if (tail_size_ < sizeof(tail_)) {
+        return;
+      }
+      mix(tail_);
+      tail_size_ = 0;
+    }
+
+    for (; data.size() >= sizeof(uint64_t); data.remove_prefix(sizeof(uint64_t))) {
+      mix(data.data());
+    }
+    ::memcpy(tail_, data.data(), data.size());
+    tail_size_ = data.size();
+  }
+
+  uint64_t value() const {
+    uint64_t hash = hash_;
+    for (size_t i = 0; i < tail_size_; ++i) {
+      hash ^= static_cast<unsigned char>(tail_[i]);
+      hash *= prime_;
+    }
+    return hash;
+  }
 
-void Storage::loadFromFile(const std::string& file) {
-  // TODO: Implement
-  throw "Not implemented!";
+private:
+  void mix(const char* data) {
+    uint64_t word;
+    ::memcpy(&word, data, sizeof(word));
+    hash_ ^= word;
+    hash_ *= prime_;
+  }
+
+private:
+  static constexpr uint64_t prime_ = 0x100000001b3;
+  uint64_t hash_{0xcbf29ce484222325};
+  char tail_[sizeof(uint64_t)];
+  size_t tail_size_{0};
+};
+
+void append(std::string& buffer, uint64_t value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
 }
 
-void Storage::storeToFile(const std::string& file) {
-  // TODO: Implement
-  throw "Not implemented!";
+void append(std::string& buffer, std::string_view value) {
+  append(buffer, static_cast<uint64_t>(value.size()));
+  buffer.append(value);
+}
+
+// Read the integers and the length-prefixed strings from the mapped file, the read string refers
+// to the mapped memory.
+class Reader {
+public:
+  Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+public:
+  bool read(uint64_t& value) {
+    if (size_ - pos_ < sizeof(value)) {
+      return false;
+    }
+    ::memcpy(&value, data_ + pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return true;
+  }
+
+  bool read(std::string_view& value) {
+    uint64_t size;
+    if (!read(size) || size_ - pos_ < size) {
+      return false;
+    }
+    value = {data_ + pos_, size};
+    pos_ += size;
+    return true;
+  }
+
+private:
+  const char* data_;
+  size_t size_;
+  size_t pos_{0};
+};
+
+struct Record {
+  Storage::Type type_;
+  std::string_view name_;
+  uint64_t create_time_;
+  uint64_t last_update_time_;
+  uint64_t timeout_;
+  uint64_t update_counter_;
+  std::vector<std::pair<std::string_view, Common::Variant>> values_;
+};
+
+bool readRecord(Reader& reader, Record& record) {
+  uint64_t type;
+  uint64_t value_count;
+  if (!reader.read(type) || type >= static_cast<uint64_t>(Storage::Type::SizeOfType) ||
+      !reader.read(record.name_) || !reader.read(record.create_time_) ||
+      !reader.read(record.last_update_time_) || !reader.read(record.timeout_) ||
+      !reader.read(record.update_counter_) || !reader.read(value_count)) {
+    return false;
+  }
+  record.type_ = static_cast<Storage::Type>(type);
+
+  for (uint64_t i = 0; i < value_count; ++i) {
+    std::string_view key;
+    uint64_t value_type;
+    if (!reader.read(key) || !reader.read(value_type)) {
+      return false;
+    }
+
+    Common::Variant value;
+    switch (value_type) {
+    case 0:
+      break;
+    case 1: {
+      uint64_t int_value;
+      if (!reader.read(int_value)) {
+        return false;
+      }
+      value = static_cast<int64_t>(int_value);
+    } break;
+    case 2: {
+      std::string_view string_value;
+      if (!reader.read(string_value)) {
+        return false;
+      }
+      value = string_value;
+    } break;
+    default:
+      return false;
+    }
+    record.values_.emplace_back(key, value);
+  }
+
+  return true;
+}
+} // namespace
+
+Storage::~Storage() { stopSnapshot(); }
+
+std::expected<bool, std::string> Storage::loadFromFile(const std::string& file) {
+  if (shared_table_)
+    [[unlikely]] {
+      return std::unexpected("the snapshot isn't supported by the shared memory storage");
+    }
+
+  int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return std::unexpected(std::format("open file {} failed", file));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < snapshot_header_size) {
+    ::close(fd);
+    return std::unexpected(std::format("the snapshot {} is corrupted", file));
+  }
+
+  void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return std::unexpected(std::format("map file {} failed", file));
+  }
+  std::unique_ptr<void, std::function<void(void*)>> data_guard(
+      data, [size = st.st_size](void* data) { ::munmap(data, size); });
+
+  // Verify the header and the checksum before loading any collection
+  const char* begin = static_cast<const char*>(data);
+  Reader header_reader(begin + snapshot_magic.size(), snapshot_header_size - snapshot_magic.size());
+  uint64_t version;
+  uint64_t payload_size;
+  uint64_t payload_checksum;
+  if (std::string_view(begin, snapshot_magic.size()) != snapshot_magic ||
+      !header_reader.read(version) || !header_reader.read(payload_size) ||
+      !header_reader.read(payload_checksum)) {
+    return std::unexpected(std::format("the snapshot {} is corrupted", file));
+  }
+  if (version != snapshot_version) {
+    return std::unexpected(
+        std::format("the snapshot {} is saved by the other version: {}", file, version));
+  }
+  std::string_view payload(begin + snapshot_header_size, st.st_size - snapshot_header_size);
+  Checksum checksum;
+  checksum.update(payload);
+  if (payload.size() != payload_size || checksum.value() != payload_checksum) {
+    return std::unexpected(std::format("the checksum of the snapshot {} mismatched", file));
+  }
+
+  Reader reader(payload.data(), payload.size());
+  uint64_t count;
+  if (!reader.read(count)) {
+    return std::unexpected(std::format("the snapshot {} is corrupted", file));
+  }
+
+  // Parse all of the records before loading any collection, so a corrupted snapshot loads nothing
+  Reader records_reader = reader;
+  Record record;
+  for (uint64_t i = 0; i < count; ++i) {
+    record.values_.clear();
+    if (!readRecord(reader, record)) {
+      return std::unexpected(std::format("the snapshot {} is corrupted", file));
+    }
+  }
+
+  time_t now = ::time(nullptr);
+  size_t loaded_count = 0;
+  for (uint64_t i = 0; i < count; ++i) {
+    record.values_.clear();
+    readRecord(records_reader, record);
+    if (now >= static_cast<time_t>(record.last_update_time_ + record.timeout_)) {
+      continue;
+    }
+
+    Shard& s = shard(record.type_, record.name_);
+    std::lock_guard<std::mutex> lock(s.mutex_);
+    if (s.collections_.contains(record.name_)) {
+      continue;
+    }
+
+    std::shared_ptr<Collection> collection = makeCollection(s, record.name_);
+    collection->create_time_ = record.create_time_;
+    collection->is_new_ = false;
+    collection->last_update_time_ = record.last_update_time_;
+    collection->timeout_ = record.timeout_;
+    collection->update_counter_ = record.update_counter_;
+    for (auto& [key, value] : record.values_) {
+      collection->assign(collection->kv_[std::string(key)], value);
+    }
+    s.collections_.emplace(record.name_, std::move(collection));
+    ++loaded_count;
+  }
+
+  WGE_LOG_INFO("Loaded {} collections from the snapshot {}", loaded_count, file);
+  return true;
+}
+
+std::expected<bool, std::string> Storage::storeToFile(const std::string& file) {
+  if (shared_table_)
+    [[unlikely]] {
+      return std::unexpected("the snapshot isn't supported by the shared memory storage");
+    }
+
+  std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+
+  // Serialize the shards that are updated since the last snapshot, the others reuse the last
+  // serialized collections.
+  time_t now = ::time(nullptr);
+  uint64_t count = 0;
+  uint64_t payload_size = sizeof(count);
+  for (size_t type = 0; type < shards_.size(); ++type) {
+    for (auto& s : shards_[type]) {
+      if (s.dirty_.exchange(false, std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(s.mutex_);
+        s.snapshot_.clear();
+        s.snapshot_count_ = 0;
+        for (auto& [name, collection] : s.collections_) {
+          if (collection->isExpired(now)) {
+            continue;
+          }
+
+          append(s.snapshot_, static_cast<uint64_t>(type));
+          append(s.snapshot_, name);
+          append(s.snapshot_, static_cast<uint64_t>(collection->createTime()));
+          append(s.snapshot_, static_cast<uint64_t>(collection->lastUpdateTime()));
+          append(s.snapshot_, static_cast<uint64_t>(collection->timeout()));
+          append(s.snapshot_, collection->updateCounter());
+
+          std::lock_guard<std::mutex> kv_lock(collection->kv_mutex_);
+          append(s.snapshot_, static_cast<uint64_t>(collection->kv_.size()));
+          for (auto& [key, value] : collection->kv_) {
+            append(s.snapshot_, key);
+            append(s.snapshot_, static_cast<uint64_t>(value.variant_.index()));
+            if (IS_INT_VARIANT(value.variant_)) {
+              append(s.snapshot_, static_cast<uint64_t>(std::get<int64_t>(value.variant_)));
+            } else if (IS_STRING_VIEW_VARIANT(value.variant_)) {
+              append(s.snapshot_, std::get<std::string_view>(value.variant_));
+            }
+          }
+          ++s.snapshot_count_;
+        }
+      }
+      count += s.snapshot_count_;
+      payload_size += s.snapshot_.size();
+    }
+  }
+
+  std::string count_buffer;
+  append(count_buffer, count);
+  Checksum checksum;
+  checksum.update(count_buffer);
+  for (auto& shards : shards_) {
+    for (auto& s : shards) {
+      checksum.update(s.snapshot_);
+    }
+  }
+
+  // The storages of the same process may save to the same file
+  std::string tmp_file =
+      std::format("{}.{}.{}.tmp", file, ::getpid(), static_cast<const void*>(this));
+  std::ofstream ofs(tmp_file, std::ios::binary | std::ios::trunc);
+  if (!ofs.is_open()) {
+    return std::unexpected(std::format("open file {} failed", tmp_file));
+  }
+
+  std::string header(snapshot_magic);
+  append(header, snapshot_version);
+  append(header, payload_size);
+  append(header, checksum.value());
+  ofs.write(header.data(), header.size());
+  ofs.write(count_buffer.data(), count_buffer.size());
+  for (auto& shards : shards_) {
+    for (auto& s : shards) {
+      ofs.write(s.snapshot_.data(), s.snapshot_.size());
+    }
+  }
+
+  ofs.close();
+  if (!ofs) {
+    std::filesystem::remove(tmp_file);
+    return std::unexpected(std::format("write file {} failed", tmp_file));
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_file, file, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_file);
+    return std::unexpected(
+        std::format("rename {} to {} failed: {}", tmp_file, file, ec.message()));
+  }
+
+  WGE_LOG_DEBUG("Saved {} collections to the snapshot {}", count, file);
+  return true;
+}
+
+void Storage::startSnapshot(const std::string& file, std::chrono::seconds interval) {
+  stopSnapshot();
+
+  snapshot_file_ = file;
+  snapshot_stop_ = false;
+  snapshot_thread_ = std::thread([this, interval]() {
+    std::unique_lock<std::mutex> lock(snapshot_thread_mutex_);
+    while (!snapshot_cv_.wait_for(lock, interval, [this]() { return snapshot_stop_; })) {
+      lock.unlock();
+      auto result = storeToFile(snapshot_file_);
+      if (!result.has_value())
+        [[unlikely]] { WGE_LOG_ERROR("{}", result.error()); }
+      lock.lock();
+    }
+  });
+}
+
+void Storage::stopSnapshot() {
+  if (!snapshot_thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(snapshot_thread_mutex_);
+    snapshot_stop_ = true;
+  }
+  snapshot_cv_.notify_all();
+  snapshot_thread_.join();
+
+  auto result = storeToFile(snapshot_file_);
+  if (!result.has_value())
+    [[unlikely]] { WGE_LOG_ERROR("{}", result.error()); }
+  snapshot_file_.clear();
+}
+
+std::expected<bool, std::string> Storage::useSharedMemory(const std::string& name,
+                                                          size_t capacity) {
+  auto table = SharedMemoryTable::attach(name, capacity);
+  if (!table.has_value()) {
+    return std::unexpected(table.error());
+  }
+
+  for (auto& shards : shards_) {
+    for (auto& s : shards) {
+      std::lock_guard<std::mutex> lock(s.mutex_);
+      live_count_.fetch_sub(s.collections_.size(), std::memory_order_relaxed);
+      s.collections_.clear();
+    }
+  }
+  shared_table_ = std::move(table.value());
+  return true;
+}
+
+const std::string& Storage::sharedMemoryName() const {
+  static const std::string empty;
+  return shared_table_ ? shared_table_->name() : empty;
 }
 
 void Storage::initCollection(Type type, std::string_view collection_name) {
-  std::lock_guard<std::mutex> lock(collections_mutex_[static_cast<size_t>(type)]);
-  collections_[static_cast<size_t>(type)].try_emplace(collection_name);
+  if (shared_table_) {
+    shared_table_->initCollection(static_cast<size_t>(type), collection_name, collectionTimeout());
+    return;
+  }
+
+  Shard& s = shard(type, collection_name);
+  time_t now = ::time(nullptr);
+
+  std::lock_guard<std::mutex> lock(s.mutex_);
+  auto iter = s.collections_.find(collection_name);
+  if (iter != s.collections_.end()) {
+    if (!iter->second->isExpired(now))
+      [[likely]] { return; }
+
+    // Renew the expired collection
+    iter->second = makeCollection(s, collection_name);
+    live_count_.fetch_sub(1, std::memory_order_relaxed);
+    eviction_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  if (now >= s.next_sweep_time_)
+    [[unlikely]] {
+      sweep(s, now);
+      s.next_sweep_time_ = now + 1;
+    }
+
+  s.collections_.emplace(collection_name, makeCollection(s, collection_name));
+}
+
+std::shared_ptr<Collection> Storage::collection(Type type, std::string_view collection_name) {
+  if (shared_table_) {
+    return shared_table_->collection(static_cast<size_t>(type), collection_name);
+  }
+
+  Shard& s = shard(type, collection_name);
+
+  std::lock_guard<std::mutex> lock(s.mutex_);
+  auto iter = s.collections_.find(collection_name);
+  if (iter == s.collections_.end()) {
+    return nullptr;
+  }
+
+  // Evict the expired collection lazily
+  if (iter->second->isExpired(::time(nullptr)))
+    [[unlikely]] {
+      s.collections_.erase(iter);
+      s.dirty_.store(true, std::memory_order_relaxed);
+      live_count_.fetch_sub(1, std::memory_order_relaxed);
+      eviction_count_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+  return iter->second;
+}
+
+size_t Storage::sweep() {
+  if (shared_table_) {
+    return shared_table_->sweep();
+  }
+
+  time_t now = ::time(nullptr);
+  size_t count = 0;
+  for (auto& shards : shards_) {
+    for (auto& s : shards) {
+      std::lock_guard<std::mutex> lock(s.mutex_);
+      count += sweep(s, now);
+    }
+  }
+
+  return count;
+}
+
+size_t Storage::liveCount() const {
+  if (shared_table_) {
+    return shared_table_->liveCount();
+  }
+
+  return live_count_.load(std::memory_order_relaxed);
 }
 
-Collection* Storage::collection(Type type, std::string_view collection_name) {
-  std::lock_guard<std::mutex> lock(collections_mutex_[static_cast<size_t>(type)]);
-  auto iter = collections_[static_cast<size_t>(type)].find(collection_name);
-  if (iter != collections_[static_cast<size_t>(type)].end()) {
-    return &iter->second;
+uint64_t Storage::evictionCount() const {
+  if (shared_table_) {
+    return shared_table_->evictionCount();
   }
 
-  return nullptr;
+  return eviction_count_.load(std::memory_order_relaxed);
+}
+
+Storage::Shard& Storage::shard(Type type, std::string_view collection_name) {
+  size_t index = StringHash{}(collection_name) % shard_count_;
+  return shards_[static_cast<size_t>(type)][index];
+}
+
+std::shared_ptr<Collection> Storage::makeCollection(Shard& shard,
+                                                    std::string_view collection_name) {
+  auto collection = std::make_shared<Collection>(collection_name, collectionTimeout());
+  collection->dirty_ = &shard.dirty_;
+  shard.dirty_.store(true, std::memory_order_relaxed);
+  live_count_.fetch_add(1, std::memory_order_relaxed);
+  return collection;
+}
+
+size_t Storage::sweep(Shard& shard, time_t now) {
+  size_t count = std::erase_if(shard.collections_,
+                               [now](const auto& item) { return item.second->isExpired(now); });
+  if (count)
+    [[unlikely]] {
+      shard.dirty_.store(true, std::memory_order_relaxed);
+      live_count_.fetch_sub(count, std::memory_order_relaxed);
+      eviction_count_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+  return count;
 }
 
 } // namespace PersistentStorage
-} // namespace Wge
\ No newline at end of file
+} // namespace Wge
@@ -21,9 +21,19 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <expected>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 
 #include "collection.h"
+#include "shared_memory_table.h"
 
 namespace Wge {
 namespace PersistentStorage {
@@ -36,6 +46,10 @@ namespace PersistentStorage {
  * +---------+-----------+---------+----------+---------+
  * |  GLOBAL |  RESOURCE |   IP    |  SESSION |  USER   |
  * +---------+-----------+---------+----------+---------+
+ *                 shards: ↓
+ *                 +-------+-------+-------+
+ *                 |   0   |   1   |  ...  |
+ *                 +-------+-------+-------+
  *                 hash table: ↓
  *                 +-------+-------+-------+
  *                 | key1  |  key2 |  ...  |
@@ -48,24 +62,178 @@ namespace PersistentStorage {
  *                      +---------------+
  *                      | string or int |
  *                      +---------------+
+ * The collections of each type are distributed to the shards by the hash of the collection name,
+ * and each shard has its own lock, so the transactions that access the different collections (e.g.
+ * the IP collections of the different clients) rarely contend.
+ * A collection expires if it isn't updated in its timeout seconds. The expired collection is
+ * evicted lazily when it is accessed, and the shard sweeps its expired collections at most once
+ * per second when a new collection is inserted, so the storage doesn't grow without bound.
+ * The storage can be saved to a snapshot file and loaded at the next startup. The snapshot is
+ * written periodically by a background thread, and only the shards that are updated since the
+ * last snapshot are serialized again.
+ * In a multi-process deployment, the storage can be switched to a shared memory table, so that the
+ * collections are shared by all of the processes that attach the same segment. See the
+ * SharedMemoryTable for the limits.
  */
 class Storage {
 public:
   enum class Type { GLOBAL = 0, RESOURCE, IP, SESSION, USER, SizeOfType };
 
+  // The count of the shards of each type
+  static constexpr size_t shard_count_ = 64;
+
+public:
+  Storage() = default;
+  ~Storage();
+
+public:
+  /**
+   * Load the collections from a snapshot file that is saved by storeToFile.
+   * The file is memory-mapped and verified by its version and checksum before any collection is
+   * loaded. The expired collections and the collections that already exist are skipped.
+   * @param file the snapshot file path.
+   * @return an error string is returned if fails, and returned true otherwise.
+   * @note the snapshot isn't supported by the shared memory storage, since the collections outlive
+   * the process anyway.
+   */
+  std::expected<bool, std::string> loadFromFile(const std::string& file);
+
+  /**
+   * Save the live collections to a snapshot file.
+   * The snapshot is written to a temporary file and renamed to the file, so the file is either the
+   * old snapshot or the new one even if the process crashes.
+   * @param file the snapshot file path.
+   * @return an error string is returned if fails, and returned true otherwise.
+   */
+  std::expected<bool, std::string> storeToFile(const std::string& file);
+
+  /**
+   * Start a background thread that saves the snapshot periodically. If the thread is running, it's
+   * restarted with the new arguments.
+   * @param file the snapshot file path.
+   * @param interval the interval of the snapshots.
+   */
+  void startSnapshot(const std::string& file, std::chrono::seconds interval);
+
+  /**
+   * Stop the background snapshot thread, and save the last snapshot.
+   */
+  void stopSnapshot();
+
+  /**
+   * @return the snapshot file path of the background snapshot thread, empty if it isn't started.
+   */
+  const std::string& snapshotFile() const { return snapshot_file_; }
+
 public:
-  void loadFromFile(const std::string& file);
-  void storeToFile(const std::string& file);
+  /**
+   * Store the collections in the named shared memory segment instead of the process memory. The
+   * segment is created if it doesn't exist. The collections that are stored in the process memory
+   * before are dropped.
+   * It must be called before the storage is accessed by the transactions.
+   * @param name the name of the shared memory segment.
+   * @param capacity the max count of the collections of all types.
+   * @return an error string is returned if fails, and returned true otherwise.
+   */
+  std::expected<bool, std::string> useSharedMemory(const std::string& name, size_t capacity);
+
+  /**
+   * @return the name of the shared memory segment, empty if the storage uses the process memory.
+   */
+  const std::string& sharedMemoryName() const;
 
 public:
+  /**
+   * Initialize a collection. If the collection exists and isn't expired, do nothing, otherwise a
+   * new collection is created.
+   * @param type the type of the collection.
+   * @param collection_name the name of the collection, e.g. the ip address of the client.
+   */
   void initCollection(Type type, std::string_view collection_name);
-  Collection* collection(Type type, std::string_view collection_name);
+
+  /**
+   * Get a collection.
+   * @param type the type of the collection.
+   * @param collection_name the name of the collection.
+   * @return the collection, or nullptr if the collection doesn't exist or is expired. The returned
+   * collection is kept alive by the caller even if it is evicted concurrently.
+   */
+  std::shared_ptr<Collection> collection(Type type, std::string_view collection_name);
+
+  /**
+   * Evict all of the expired collections.
+   * @return the count of the evicted collections.
+   */
+  size_t sweep();
+
+  /**
+   * Set the timeout of the collections that are created later. It's configured by the
+   * SecCollectionTimeout.
+   * @param timeout the seconds that the collection expires after the last update.
+   */
+  void collectionTimeout(uint32_t timeout) {
+    collection_timeout_.store(timeout, std::memory_order_relaxed);
+  }
+
+  /**
+   * @return the timeout of the collections that are created later.
+   */
+  uint32_t collectionTimeout() const { return collection_timeout_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the count of the live collections of all types.
+   */
+  size_t liveCount() const;
+
+  /**
+   * @return the count of the collections that are evicted since the storage is created.
+   */
+  uint64_t evictionCount() const;
+
+private:
+  struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view value) const {
+      return std::hash<std::string_view>{}(value);
+    }
+  };
+
+  // Aligned to the cache line to avoid the false sharing between the shard locks
+  struct alignas(64) Shard {
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Collection>, StringHash, std::equal_to<>>
+        collections_;
+    time_t next_sweep_time_{0};
+
+    // Whether the shard is updated since the last snapshot
+    std::atomic_bool dirty_{false};
+
+    // The serialized collections of the last snapshot, it's guarded by the snapshot_mutex_
+    std::string snapshot_;
+    uint64_t snapshot_count_{0};
+  };
 
 private:
-  std::array<std::unordered_map<std::string_view, Collection>,
-             static_cast<size_t>(Type::SizeOfType)>
-      collections_;
-  std::array<std::mutex, static_cast<size_t>(Type::SizeOfType)> collections_mutex_;
+  Shard& shard(Type type, std::string_view collection_name);
+
+  // Must be called with the lock of the shard held
+  size_t sweep(Shard& shard, time_t now);
+  std::shared_ptr<Collection> makeCollection(Shard& shard, std::string_view collection_name);
+
+private:
+  std::array<std::array<Shard, shard_count_>, static_cast<size_t>(Type::SizeOfType)> shards_;
+  std::atomic<uint32_t> collection_timeout_{3600};
+  std::atomic<size_t> live_count_{0};
+  std::atomic<uint64_t> eviction_count_{0};
+
+  std::mutex snapshot_mutex_;
+  std::thread snapshot_thread_;
+  std::string snapshot_file_;
+  std::mutex snapshot_thread_mutex_;
+  std::condition_variable snapshot_cv_;
+  bool snapshot_stop_{false};
+
+  std::unique_ptr<SharedMemoryTable> shared_table_;
 };
 } // namespace PersistentStorage
-} // namespace Wge
\ No newline at end of file
+} // namespace Wge
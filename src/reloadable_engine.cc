@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "reloadable_engine.h"
+
+#include "audit_log.h"
+#include "common/assert.h"
+#include "common/log.h"
+
+namespace Wge {
+ReloadableEngine::ReloadableEngine(Loader loader, spdlog::level::level_enum level,
+                                   const std::string& log_file)
+    : loader_(std::move(loader)), level_(level), log_file_(log_file) {}
+
+ReloadableEngine::~ReloadableEngine() {
+  if (reload_thread_.joinable()) {
+    reload_thread_.join();
+  }
+
+  // The audit logs of the retired engines that are still alive are released to the engines
+  std::lock_guard<std::mutex> lock(publish_mutex_);
+  stopRetiredAuditLogs();
+}
+
+std::expected<bool, std::string> ReloadableEngine::init(size_t concurrency) {
+  // The first engine takes the calling thread as the main thread and initializes the log
+  std::shared_ptr<Engine> engine = std::make_shared<Engine>(level_, log_file_);
+  auto result = loader_(*engine);
+  if (!result.has_value()) {
+    return result;
+  }
+  engine->init(concurrency);
+
+  publish(std::move(engine));
+  return true;
+}
+
+std::future<std::expected<uint64_t, std::string>> ReloadableEngine::reload(size_t concurrency) {
+  ASSERT_IS_MAIN_THREAD();
+  assert(engine_.load());
+
+  std::promise<std::expected<uint64_t, std::string>> promise;
+  std::future<std::expected<uint64_t, std::string>> future = promise.get_future();
+
+  if (reloading_.exchange(true)) {
+    promise.set_value(std::unexpected("a reload is running"));
+    return future;
+  }
+
+  // The previous reload thread has finished
+  if (reload_thread_.joinable()) {
+    reload_thread_.join();
+  }
+
+  reload_thread_ = std::thread([this, concurrency, promise = std::move(promise)]() mutable {
+    is_engine_builder_thread = true;
+
+    auto engine = build(concurrency);
+    if (engine.has_value()) {
+      publish(std::move(engine.value()));
+      WGE_LOG_INFO("reloaded the rule set, version: {}", version());
+      reloading_ = false;
+      promise.set_value(version());
+    } else {
+      WGE_LOG_ERROR("reload the rule set failed: {}", engine.error());
+      reloading_ = false;
+      promise.set_value(std::unexpected(engine.error()));
+    }
+  });
+
+  return future;
+}
+
+std::expected<bool, std::string>
+ReloadableEngine::updatePropertyStore(const std::string& json_string) {
+  std::lock_guard<std::mutex> lock(publish_mutex_);
+  return engine_.load()->updatePropertyStore(json_string);
+}
+
+TransactionPtr ReloadableEngine::makeTransaction() const {
+  std::shared_ptr<const Engine> engine = engine_.load();
+  assert(engine);
+
+  TransactionPtr t = engine->makeTransaction();
+  t->engine_holder_ = std::move(engine);
+  return t;
+}
+
+std::expected<std::shared_ptr<Engine>, std::string> ReloadableEngine::build(size_t concurrency) {
+  std::shared_ptr<Engine> engine =
+      std::shared_ptr<Engine>(new Engine(engine_.load()->storage_));
+  auto result = loader_(*engine);
+  if (!result.has_value()) {
+    return std::unexpected(result.error());
+  }
+  engine->init(concurrency);
+
+  return engine;
+}
+
+void ReloadableEngine::publish(std::shared_ptr<Engine> engine) {
+  std::lock_guard<std::mutex> lock(publish_mutex_);
+
+  // The successor takes the latest property store of the predecessor
+  std::shared_ptr<Engine> predecessor = engine_.load();
+  if (predecessor) {
+    engine->property_store_.store(predecessor->property_store_.load());
+    if (predecessor->audit_log_) {
+      retired_audit_logs_.emplace_back(predecessor, predecessor->audit_log_);
+    }
+  }
+
+  engine_.store(std::move(engine));
+  ++version_;
+
+  predecessor.reset();
+  stopRetiredAuditLogs();
+}
+
+void ReloadableEngine::stopRetiredAuditLogs() {
+  // The retired engine that has been destroyed doesn't log any more, so its audit log is stopped
+  // here, which writes the pending records and joins the writer thread.
+  std::erase_if(retired_audit_logs_, [](auto& retired) {
+    if (!retired.first.expired()) {
+      return false;
+    }
+
+    retired.second->stop();
+    return true;
+  });
+}
+} // namespace Wge
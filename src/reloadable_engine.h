@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <expected>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "engine.h"
+
+namespace Wge {
+/**
+ * The engine that can reload the rule set at runtime.
+ * Each version of the rule set is an immutable, initialized engine. A reload builds a successor
+ * engine in a background thread, and publishes it atomically when it's built successfully, the
+ * same way as the property store is updated. The new transactions use the latest engine, and the
+ * in-flight transactions finish on the engine that they were made by, which is destroyed after the
+ * last of its transactions is destroyed. The persistent storage and the property store are shared
+ * by the successors. The audit log of the retired engine is stopped by the reload thread after the
+ * engine is destroyed, so that the worker thread that destroys it never joins the writer thread.
+ */
+class ReloadableEngine final {
+public:
+  /**
+   * The loader loads the rule set into an engine, e.g. by Engine::loadFromFiles. It's called for
+   * the first version and each reload, so it should read the latest rule files.
+   */
+  using Loader = std::function<std::expected<bool, std::string>(Engine& engine)>;
+
+  /**
+   * Construct the reloadable engine
+   * @param loader the loader of the rule set.
+   * @param level the debug log level. see Engine::Engine.
+   * @param log_file the log file path. see Engine::Engine.
+   */
+  ReloadableEngine(Loader loader, spdlog::level::level_enum level = spdlog::level::info,
+                   const std::string& log_file = "");
+  ~ReloadableEngine();
+
+  ReloadableEngine(const ReloadableEngine&) = delete;
+  ReloadableEngine& operator=(const ReloadableEngine&) = delete;
+
+public:
+  /**
+   * Load and initialize the first version of the rule set in the calling thread.
+   * @param concurrency the max count of the compiling threads. see Engine::init.
+   * @return an error string is returned if fails, and returned true otherwise
+   * @note must call once in the main thread before call makeTransaction.
+   */
+  std::expected<bool, std::string> init(size_t concurrency = 0);
+
+  /**
+   * Reload the rule set in a background thread. The current engine keeps serving until the
+   * successor is published, and it keeps serving if the reload fails.
+   * @param concurrency the max count of the compiling threads. see Engine::init.
+   * @return the future of the version of the published successor, or an error string if fails.
+   * Only one reload runs at a time, the reload that is requested while another is running fails.
+   * @note must call in the main thread after init.
+   */
+  std::future<std::expected<uint64_t, std::string>> reload(size_t concurrency = 0);
+
+  /**
+   * Dynamically and safely update the property store of the current engine and the successors.
+   * see Engine::updatePropertyStore.
+   */
+  std::expected<bool, std::string> updatePropertyStore(const std::string& json_string);
+
+public:
+  /**
+   * Make a transaction by the current engine. The transaction keeps the engine alive, so that the
+   * engine isn't destroyed by the reload until the transaction is destroyed.
+   * @return pointer of transaction
+   */
+  TransactionPtr makeTransaction() const;
+
+  /**
+   * Get the current engine
+   * @return the current engine, which is kept alive by the returned pointer.
+   */
+  std::shared_ptr<const Engine> engine() const { return engine_.load(); }
+
+  /**
+   * Get the version of the current engine. The first version is 1, and each successful reload
+   * increases it by 1.
+   * @return the version of the current engine.
+   */
+  uint64_t version() const { return version_.load(); }
+
+private:
+  std::expected<std::shared_ptr<Engine>, std::string> build(size_t concurrency);
+  void publish(std::shared_ptr<Engine> engine);
+  void stopRetiredAuditLogs();
+
+private:
+  Loader loader_;
+  spdlog::level::level_enum level_;
+  std::string log_file_;
+
+  std::atomic<std::shared_ptr<Engine>> engine_;
+  std::atomic<uint64_t> version_{0};
+
+  // Serializes the publishing and the property store updating, so that a successor never misses
+  // an update of the property store.
+  std::mutex publish_mutex_;
+
+  // The audit logs of the retired engines, which are kept alive until the engines are destroyed.
+  // Guarded by the publish_mutex_.
+  std::vector<std::pair<std::weak_ptr<const Engine>, std::shared_ptr<AuditLog>>>
+      retired_audit_logs_;
+
+  std::thread reload_thread_;
+  std::atomic_bool reloading_{false};
+};
+} // namespace Wge
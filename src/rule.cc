@@ -27,9 +27,74 @@
 #include "common/try.h"
 #include "engine.h"
 #include "operator/operator_include.h"
+#include "transformation/fused_transform.h"
 #include "variable/collection_base.h"
 
 namespace Wge {
+namespace {
+// The buffers of a batch evaluation
+struct BatchBuffers {
+  std::vector<Common::EvaluateElement> transformed_;
+  std::vector<std::list<const Transformation::TransformBase*>> transform_lists_;
+  std::vector<std::string_view> operands_;
+  std::vector<Operator::OperatorBase::Result> results_;
+};
+
+// The batch buffers that hold more values than this are released after the evaluation, so a huge
+// collection doesn't pin the memory of the worker thread
+constexpr size_t batch_max_keep_size = 1024;
+
+// Takes the thread local batch buffers of the current depth. The chained rules are evaluated within
+// the value evaluation of the top rule, so each depth of the nested batch evaluations takes its own
+// buffers from the pool.
+class ScopedBatchBuffers {
+public:
+  ScopedBatchBuffers(size_t count) {
+    if (depth_ == pool_.size()) {
+      pool_.emplace_back(std::make_unique<BatchBuffers>());
+    }
+    buffers_ = pool_[depth_++].get();
+
+    if (buffers_->operands_.size() < count) {
+      buffers_->transformed_.resize(count);
+      buffers_->transform_lists_.resize(count);
+      buffers_->operands_.resize(count);
+      buffers_->results_.resize(count);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      buffers_->transformed_[i].clear();
+      buffers_->transform_lists_[i].clear();
+      buffers_->operands_[i] = {};
+      buffers_->results_[i] = {};
+    }
+  }
+
+  ~ScopedBatchBuffers() {
+    --depth_;
+    if (buffers_->operands_.size() > batch_max_keep_size)
+      [[unlikely]] { *buffers_ = BatchBuffers(); }
+  }
+
+  ScopedBatchBuffers(const ScopedBatchBuffers&) = delete;
+  ScopedBatchBuffers& operator=(const ScopedBatchBuffers&) = delete;
+
+public:
+  BatchBuffers* operator->() const { return buffers_; }
+
+private:
+  BatchBuffers* buffers_;
+
+  // The buffers are allocated separately, so that growing the pool doesn't move the buffers that
+  // are used by the outer depths
+  static thread_local std::vector<std::unique_ptr<BatchBuffers>> pool_;
+  static thread_local size_t depth_;
+};
+
+thread_local std::vector<std::unique_ptr<BatchBuffers>> ScopedBatchBuffers::pool_;
+thread_local size_t ScopedBatchBuffers::depth_ = 0;
+} // namespace
+
 std::unordered_set<std::string> Rule::string_pool_;
 void Rule::initExceptVariables() {
   ASSERT_IS_MAIN_THREAD();
@@ -89,19 +154,31 @@ void Rule::initExceptVariables() {
   }
 }
 
-void Rule::initPmfOperator(const std::string& serialize_dir) {
-  ASSERT_IS_MAIN_THREAD();
+void Rule::collectOperators(std::vector<Operator::OperatorBase*>& operators) const {
+  for (auto& op : operators_) {
+    operators.emplace_back(op.get());
+  }
 
+  // collect the operators of chained rule
+  if (chain_) {
+    chain_->collectOperators(operators);
+  }
+}
+
+void Rule::collectDatabases(std::vector<const Common::Hyperscan::HsDataBase*>& databases) const {
   for (auto& op : operators_) {
-    Operator::PmFromFile* pm_from_file = dynamic_cast<Operator::PmFromFile*>(op.get());
-    if (pm_from_file) {
-      pm_from_file->init(serialize_dir);
+    op->collectDatabases(databases);
+  }
+
+  for (auto& variable : variables_) {
+    auto collection = dynamic_cast<const Variable::CollectionBase*>(variable.get());
+    if (collection) {
+      collection->collectDatabases(databases);
     }
   }
 
-  // init the pmf operator of chained rule
   if (chain_) {
-    chain_->initPmfOperator(serialize_dir);
+    chain_->collectDatabases(databases);
   }
 }
 
@@ -115,6 +192,30 @@ void Rule::initFlags(const Rule& default_action_rule) {
   multiMatch(default_action_rule.multiMatch() || multiMatch());
 }
 
+void Rule::initFusedTransforms(const Rule* default_action_rule) {
+  ASSERT_IS_MAIN_THREAD();
+
+  fused_transforms_.clear();
+  fused_transforms_holder_.clear();
+  if (!multiMatch()) {
+    std::vector<const Transformation::TransformBase*> transforms;
+    if (!isIgnoreDefaultTransform() && default_action_rule) {
+      for (auto& transform : default_action_rule->transforms()) {
+        transforms.emplace_back(transform.get());
+      }
+    }
+    for (auto& transform : transforms_) {
+      transforms.emplace_back(transform.get());
+    }
+    fused_transforms_ = Transformation::FusedTransform::fuse(transforms, fused_transforms_holder_);
+  }
+
+  // init the fused transformations of chained rule
+  if (chain_) {
+    chain_->initFusedTransforms(default_action_rule);
+  }
+}
+
 /**
  * The evaluation process is as follows:
  * 1. Evaluate the variables
@@ -164,13 +265,157 @@ bool Rule::evaluate(Transaction& t) const {
   static thread_local std::list<const Transformation::TransformBase*> transform_list;
   static thread_local Operator::OperatorBase::Results op_results;
 
+  // The chained rules are evaluated within the value evaluation of the top rule, so they are
+  // accounted to the top rule without their own timing
+  RuleProfiler::Counters* profile = chain_index_ == -1 ? t.getProfileCounters() : nullptr;
+
   // Evaluate the variables
   bool rule_matched = false;
+
+  // Handle the operator results of a variable value. Returns false if the rule is not matched and
+  // the evaluation should be stopped.
+  auto handle_results = [&](const std::unique_ptr<Wge::Variable::VariableBase>& var,
+                            const Common::EvaluateElement& variable_value,
+                            const Common::EvaluateElement& transformed,
+                            std::list<const Transformation::TransformBase*>& transforms,
+                            Operator::OperatorBase::Results& results) -> bool {
+    for (auto& op_result : results) {
+      // If the variable is matched, evaluate the actions
+      if (op_result.matched_) {
+        WGE_LOG_TRACE([&]() {
+          if (!var->isCollection()) {
+            return std::format("variable is matched. {}{}", var->mainName(),
+                               var->subName().empty() ? "" : "." + var->subName());
+          } else {
+            return std::format("variable of collection is matched. {}:{}", var->mainName(),
+                               variable_value.variable_sub_name_);
+          }
+        }());
+
+        if (isNeedPushMatched()) {
+          t.pushMatchedVariable(var.get(), chain_index_, variable_value, transformed,
+                                op_result.capture_, std::move(transforms));
+        }
+
+        if (variable_value.ptree_node_) {
+          t.pushMatchedVPTree(chain_index_, variable_value.ptree_node_);
+        }
+
+        if (op_result.ptree_node_) {
+          t.pushMatchedOPTree(chain_index_, op_result.ptree_node_);
+        }
+
+        rule_matched = true;
+
+        // Evaluate the matched branch actions
+        evaluateActions(t, Action::ActionBase::Branch::Matched);
+
+        // Evaluate the chained rules
+        if (chain_ && matchedMultiChain())
+          [[unlikely]] { rule_matched = evaluateChain(t); }
+
+        // If the first match is enabled, stop evaluating the rule
+        if (firstMatch())
+          [[unlikely]] {
+            WGE_LOG_TRACE("first match is enabled, stop evaluating the rule");
+            break;
+          }
+      } else {
+        // Evaluate the unmatched branch actions
+        evaluateActions(t, Action::ActionBase::Branch::Unmatched);
+
+        // Evaluate the chained rules
+        bool chain_matched = false;
+        if (chain_ && unmatchedMultiChain())
+          [[unlikely]] {
+            chain_matched = evaluateChain(t);
+            rule_matched = chain_matched;
+          }
+
+        // If all match is enabled, and the variable is not matched, stop evaluating the rule
+        if (!chain_matched && allMatch())
+          [[unlikely]] {
+            WGE_LOG_TRACE(
+                "all match is enabled, but variable is not matched, stop evaluating the rule");
+            return false;
+          }
+      }
+    }
+
+    return true;
+  };
+
   for (auto& var : variables_) {
     Common::EvaluateResults result;
-    evaluateVariable(t, var, result);
+    {
+      RuleProfiler::ScopedTimer timer(profile ? &profile->variable_ns_ : nullptr);
+      evaluateVariable(t, var, result);
+    }
+
+    // Evaluate the values of a large collection as a batch, so that the operator such as
+    // @pmFromFile scans all the values by one call instead of one call per value.
+    if (result.size() >= batch_threshold_ && operators_.size() == 1 &&
+        operators_.front()->batchSupported() && !t.getAdditionalCond())
+      [[unlikely]] {
+        const auto& op = operators_.front();
+        const size_t count = result.size();
+        ScopedBatchBuffers batch(count);
+        auto& batch_transformed = batch->transformed_;
+        auto& batch_transform_lists = batch->transform_lists_;
+        auto& batch_operands = batch->operands_;
+        auto& batch_results = batch->results_;
+
+        RuleProfiler::ScopedTimer timer(profile ? &profile->value_ns_ : nullptr);
+
+        // Evaluate the transformations of all values. The transformed values are kept by the
+        // transaction, so they are still valid after the following values are transformed.
+        for (size_t i = 0; i < count; ++i) {
+          if (IS_STRING_VIEW_VARIANT(result[i].variant_))
+            [[likely]] {
+              evaluateTransform(t, var.get(), result[i], batch_transformed[i],
+                                batch_transform_lists[i]);
+            }
+
+          const Common::Variant& operand = batch_transform_lists[i].empty()
+                                               ? result[i].variant_
+                                               : batch_transformed[i].variant_;
+          if (IS_STRING_VIEW_VARIANT(operand))
+            [[likely]] { batch_operands[i] = std::get<std::string_view>(operand); }
+        }
+
+        // Evaluate the operator
+        op->evaluateBatch(t, std::span(batch_operands.data(), count),
+                          std::span(batch_results.data(), count));
+
+        for (size_t i = 0; i < count; ++i) {
+          // Same as evaluateOperator(), the value that isn't a string is not matched
+          const Common::Variant& operand = batch_transform_lists[i].empty()
+                                               ? result[i].variant_
+                                               : batch_transformed[i].variant_;
+          op_results.clear();
+          auto& op_result = op_results.emplace_back(batch_results[i]);
+          if (!IS_STRING_VIEW_VARIANT(operand))
+            [[unlikely]] { op_result = {}; }
+          op_result.matched_ ^= op->isNot();
+          if (op_result.matched_ && !op_result.capture_.empty()) {
+            t.setCapture(0, op_result.capture_);
+          }
+
+          if (!handle_results(var, result[i], batch_transformed[i], batch_transform_lists[i],
+                              op_results))
+            [[unlikely]] { return false; }
+
+          if (firstMatch() && rule_matched)
+            [[unlikely]] { break; }
+        }
+
+        if (firstMatch() && rule_matched)
+          [[unlikely]] { break; }
+        continue;
+      }
 
     // Evaluate each variable result
+    RuleProfiler::ScopedTimer timer(profile ? &profile->value_ns_ : nullptr);
     for (size_t i = 0; i < result.size(); ++i) {
       const Common::EvaluateElement& variable_value = result[i];
       transformed_value.clear();
@@ -188,68 +433,8 @@ bool Rule::evaluate(Transaction& t) const {
           op_results);
       assert(!op_results.empty());
 
-      for (auto& op_result : op_results) {
-        // If the variable is matched, evaluate the actions
-        if (op_result.matched_) {
-          WGE_LOG_TRACE([&]() {
-            if (!var->isCollection()) {
-              return std::format("variable is matched. {}{}", var->mainName(),
-                                 var->subName().empty() ? "" : "." + var->subName());
-            } else {
-              return std::format("variable of collection is matched. {}:{}", var->mainName(),
-                                 variable_value.variable_sub_name_);
-            }
-          }());
-
-          if (isNeedPushMatched()) {
-            t.pushMatchedVariable(var.get(), chain_index_, result[i], transformed_value,
-                                  op_result.capture_, std::move(transform_list));
-          }
-
-          if (variable_value.ptree_node_) {
-            t.pushMatchedVPTree(chain_index_, variable_value.ptree_node_);
-          }
-
-          if (op_result.ptree_node_) {
-            t.pushMatchedOPTree(chain_index_, op_result.ptree_node_);
-          }
-
-          rule_matched = true;
-
-          // Evaluate the matched branch actions
-          evaluateActions(t, Action::ActionBase::Branch::Matched);
-
-          // Evaluate the chained rules
-          if (chain_ && matchedMultiChain())
-            [[unlikely]] { rule_matched = evaluateChain(t); }
-
-          // If the first match is enabled, stop evaluating the rule
-          if (firstMatch())
-            [[unlikely]] {
-              WGE_LOG_TRACE("first match is enabled, stop evaluating the rule");
-              break;
-            }
-        } else {
-          // Evaluate the unmatched branch actions
-          evaluateActions(t, Action::ActionBase::Branch::Unmatched);
-
-          // Evaluate the chained rules
-          bool chain_matched = false;
-          if (chain_ && unmatchedMultiChain())
-            [[unlikely]] {
-              chain_matched = evaluateChain(t);
-              rule_matched = chain_matched;
-            }
-
-          // If all match is enabled, and the variable is not matched, stop evaluating the rule
-          if (!chain_matched && allMatch())
-            [[unlikely]] {
-              WGE_LOG_TRACE(
-                  "all match is enabled, but variable is not matched, stop evaluating the rule");
-              return false;
-            }
-        }
-      }
+      if (!handle_results(var, variable_value, transformed_value, transform_list, op_results))
+        [[unlikely]] { return false; }
 
       if (firstMatch() && rule_matched)
         [[unlikely]] { break; }
@@ -387,6 +572,19 @@ void Rule::evaluateTransform(
     std::list<const Transformation::TransformBase*>& transform_list) const {
   const Common::EvaluateElement* p_input = &input;
 
+  // Evaluate the fused transformations that already joined the default transformations
+  if (!fused_transforms_.empty()) {
+    for (auto transform : fused_transforms_) {
+      bool ret = transform->evaluate(t, var, *p_input, output);
+      if (ret) {
+        transform_list.emplace_back(transform);
+        p_input = &output;
+      }
+      WGE_LOG_TRACE("evaluate fused transformation: {} {}", transform->name(), ret);
+    }
+    return;
+  }
+
   // Check if the default transformation should be ignored
   if (!isIgnoreDefaultTransform())
     [[unlikely]] {
@@ -92,14 +92,20 @@ public:
   void initExceptVariables();
 
   /**
-   * Initialize the Pmf operator.
-   * We can't auto initialize the Pmf operator in the constructor because it requires the
-   * serialize_dir which is specified by SecPmfSerializeDir. The SecPmfSerializeDir directive may be
-   * defined after the SecRule, So We must manually initialize the pmf operator after the all
-   * directives are loaded. We must call this function and only once before evaluating the rule.
-   * @param serialize_dir The serialize directory.
+   * Collect the operators of the rule and its chained rules.
+   * The operators aren't compiled while parsing, because the compilation is the most of the startup
+   * time and the SecPmfSerializeDir directive may be defined after the SecRule. The engine collects
+   * the operators of all rules after the all directives are loaded, and compiles them concurrently.
+   * @param operators the collected operators are appended to it.
    */
-  void initPmfOperator(const std::string& serialize_dir);
+  void collectOperators(std::vector<Operator::OperatorBase*>& operators) const;
+
+  /**
+   * Collect the hyperscan databases that are used by the operators and the variables of the rule
+   * and its chained rules.
+   * @param databases the collected databases are appended to it.
+   */
+  void collectDatabases(std::vector<const Common::Hyperscan::HsDataBase*>& databases) const;
 
   /**
    * Initialize the flags of the rule according to the default action rule.
@@ -110,6 +116,16 @@ public:
    */
   void initFlags(const Rule& default_action_rule);
 
+  /**
+   * Initialize the fused transformations of the rule.
+   * The default transformations and the transformations that defined in the rule are joined and
+   * the consecutive byte-wise transformations are fused into one pass. The rules that enable the
+   * multiMatch are skipped, because they need the intermediate value of each transformation. We
+   * must call this function after initFlags and only once before evaluating the rule.
+   * @param default_action_rule The default action rule. nullptr means there is no default action.
+   */
+  void initFusedTransforms(const Rule* default_action_rule);
+
   /**
    * Evaluate the rule
    * The evaluation process is as follows:
@@ -179,6 +195,9 @@ public:
     return transforms_;
   }
   std::vector<std::unique_ptr<Transformation::TransformBase>>& transforms() { return transforms_; }
+  const std::vector<const Transformation::TransformBase*>& fusedTransforms() const {
+    return fused_transforms_;
+  }
   bool isIgnoreDefaultTransform() const {
     return flags_.test(static_cast<size_t>(Flags::IGNORE_DEFAULT_TRANSFORM));
   }
@@ -238,6 +257,9 @@ public:
    * chain.
    */
   Rule* chainRule(size_t index);
+  const Rule* chainRule(size_t index) const {
+    return const_cast<Rule*>(this)->chainRule(index);
+  }
 
   // Details (Cold Data)
 public:
@@ -395,7 +417,17 @@ private:
 
   std::vector<std::unique_ptr<Variable::VariableBase>> variables_;
   std::vector<std::unique_ptr<Transformation::TransformBase>> transforms_;
+
+  // The effective transformations (default and rule defined) with the byte-wise transformations
+  // fused. Empty means nothing was fused and the transformations are evaluated step by step.
+  std::vector<const Transformation::TransformBase*> fused_transforms_;
+  std::vector<std::unique_ptr<Transformation::TransformBase>> fused_transforms_holder_;
+
   std::vector<std::unique_ptr<Operator::OperatorBase>> operators_;
+
+  // The minimum count of the values of a variable to evaluate the operator as a batch
+  static constexpr size_t batch_threshold_ = 8;
+
   std::vector<const Action::ActionBase*> matched_branch_actions_;
   std::vector<const Action::ActionBase*> unmatched_branch_actions_;
 
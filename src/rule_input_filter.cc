@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "rule_input_filter.h"
+
+#include <string_view>
+#include <unordered_map>
+
+#include "rule.h"
+#include "transaction.h"
+
+namespace Wge {
+namespace {
+using InputSource = RuleInputFilter::InputSource;
+using Inputs = RuleInputFilter::Inputs;
+
+constexpr Inputs bit(InputSource source) { return 1 << static_cast<size_t>(source); }
+
+// The variables that produce no value if their input sources are absent. The other variables may
+// produce a value anyway (e.g. REQUEST_HEADERS, TX), so the rules that read them can't be skipped.
+const std::unordered_map<std::string_view, Inputs> variable_inputs = {
+    {"ARGS", bit(InputSource::QueryArgs) | bit(InputSource::RequestBody)},
+    {"ARGS_NAMES", bit(InputSource::QueryArgs) | bit(InputSource::RequestBody)},
+    {"ARGS_GET", bit(InputSource::QueryArgs)},
+    {"ARGS_GET_NAMES", bit(InputSource::QueryArgs)},
+    {"ARGS_POST", bit(InputSource::RequestBody)},
+    {"ARGS_POST_NAMES", bit(InputSource::RequestBody)},
+    {"FILES", bit(InputSource::RequestBody)},
+    {"FILES_NAMES", bit(InputSource::RequestBody)},
+    {"MULTIPART_PART_HEADERS", bit(InputSource::RequestBody)},
+    {"REQUEST_BODY", bit(InputSource::RequestBody)},
+    {"XML", bit(InputSource::Xml)},
+    {"REQUEST_COOKIES", bit(InputSource::RequestCookies)},
+    {"REQUEST_COOKIES_NAMES", bit(InputSource::RequestCookies)},
+    {"RESPONSE_BODY", bit(InputSource::ResponseBody)},
+};
+} // namespace
+
+void RuleInputFilter::init(const std::vector<Rule>& rules) {
+  std::vector<Inputs> required_inputs;
+  required_inputs.reserve(rules.size());
+  window_rules_.clear();
+  window_rules_.reserve(rules.size());
+  for (auto& rule : rules) {
+    window_rules_.emplace_back(isWindowRule(rule));
+    required_inputs.emplace_back(requiredInputs(rule));
+    if (required_inputs.back() != 0) {
+      enabled_ = true;
+    }
+  }
+
+  if (!enabled_) {
+    return;
+  }
+
+  // Build the jump table backward: the rule is a candidate if it can't be skipped or it reads any
+  // of the present input sources, otherwise the next candidate is the next candidate of the next
+  // rule.
+  for (size_t present_inputs = 0; present_inputs < inputs_combination_total_; ++present_inputs) {
+    auto& next_candidates = next_candidates_[present_inputs];
+    next_candidates.resize(rules.size() + 1);
+    next_candidates[rules.size()] = rules.size();
+    for (size_t i = rules.size(); i > 0; --i) {
+      Inputs required = required_inputs[i - 1];
+      if (required == 0 || (required & present_inputs)) {
+        next_candidates[i - 1] = i - 1;
+      } else {
+        next_candidates[i - 1] = next_candidates[i];
+      }
+    }
+  }
+}
+
+RuleInputFilter::Inputs RuleInputFilter::presentInputs(const Transaction& t) {
+  Inputs present_inputs = 0;
+
+  if (!t.getRequestLineInfo().query_params_.getLinked().empty()) {
+    present_inputs |= bit(InputSource::QueryArgs);
+  }
+
+  // The request body may be processed in the stream mode, so the parsed results are checked too
+  // since the current window of the body may be empty.
+  auto& multi_part = t.getBodyMultiPart();
+  if (!t.getRequestBody().empty() || !t.getBodyQueryParam().getLinked().empty() ||
+      !multi_part.getNameValueLinked().empty() || !multi_part.getNameFileNameLinked().empty() ||
+      !multi_part.getHeaders().empty() || !t.getBodyJson().getKeyValuesLinked().empty()) {
+    present_inputs |= bit(InputSource::RequestBody);
+  }
+
+  auto& xml = t.getBodyXml();
+  if (!xml.getTags().empty() || !xml.getAttributes().empty() || !xml.getTagValuesStr().empty()) {
+    present_inputs |= bit(InputSource::Xml);
+  }
+
+  if (!t.getCookies().empty()) {
+    present_inputs |= bit(InputSource::RequestCookies);
+  }
+
+  if (!t.getResponseBody().empty()) {
+    present_inputs |= bit(InputSource::ResponseBody);
+  }
+
+  return present_inputs;
+}
+
+RuleInputFilter::Inputs RuleInputFilter::requiredInputs(const Rule& rule) {
+  // A skipped rule must behave the same as a rule that has no variable value, and such rule only
+  // evaluates the chained rules if the unmatched chain is enabled.
+  if (rule.variables().empty() || rule.unmatchedChain() || rule.unmatchedMultiChain()) {
+    return 0;
+  }
+
+  Inputs required = 0;
+  for (auto& var : rule.variables()) {
+    // The counter always produces a value, even if it is 0
+    if (var->isCounter()) {
+      return 0;
+    }
+
+    auto iter = variable_inputs.find(var->mainName());
+    if (iter == variable_inputs.end()) {
+      return 0;
+    }
+
+    required |= iter->second;
+  }
+
+  return required;
+}
+
+bool RuleInputFilter::isWindowRule(const Rule& rule) {
+  // The skip action must be evaluated by each window too, otherwise the body rules that it skips
+  // (e.g. the rules of the higher paranoia levels) are evaluated.
+  if (rule.skip() > 0) {
+    return true;
+  }
+
+  constexpr Inputs body_inputs =
+      bit(InputSource::RequestBody) | bit(InputSource::Xml) | bit(InputSource::ResponseBody);
+  for (const Rule* current = &rule; current; current = current->chainRule(0)) {
+    for (auto& var : current->variables()) {
+      auto iter = variable_inputs.find(var->mainName());
+      if (iter != variable_inputs.end() && (iter->second & body_inputs)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+} // namespace Wge
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wge {
+class Rule;
+class Transaction;
+
+/**
+ * The rule input filter of a phase.
+ * Some of the input sources are absent in most of the transactions, e.g. the GET requests have no
+ * request body. A rule only reads its top-level variables before it is matched (the chained rules
+ * and the macros of the operators are evaluated after a variable value is produced), so if all of
+ * its variables read the absent input sources, the rule produces no variable value and can't be
+ * matched. Those rules are skipped without evaluating them.
+ * The input sources that each rule reads are analyzed statically at the engine initialization, and
+ * the consecutive rules that can be skipped by a combination of the present input sources are
+ * jumped over at once.
+ */
+class RuleInputFilter {
+public:
+  /**
+   * The input sources that may be absent in a transaction.
+   */
+  enum class InputSource : uint8_t {
+    // The query arguments of the request line
+    QueryArgs = 0,
+    // The request body and the arguments, files and multipart headers parsed from it
+    RequestBody,
+    // The xml tags and attributes parsed from the request body
+    Xml,
+    // The cookies of the request headers
+    RequestCookies,
+    // The response body
+    ResponseBody,
+    InputSourceTotal
+  };
+
+  /**
+   * The bitmap of the input sources, the bit index is the value of the InputSource.
+   */
+  using Inputs = uint8_t;
+  static constexpr size_t inputs_combination_total_ =
+      1 << static_cast<size_t>(InputSource::InputSourceTotal);
+
+public:
+  /**
+   * Build the filter of the phase.
+   * @param rules the rules of the phase.
+   */
+  void init(const std::vector<Rule>& rules);
+
+  /**
+   * Get the input sources that are present in the transaction.
+   * @param t the transaction.
+   * @return the bitmap of the present input sources.
+   */
+  static Inputs presentInputs(const Transaction& t);
+
+  /**
+   * Get the next rule that need to be evaluated.
+   * @param present_inputs the present input sources of the transaction.
+   * @param rule_index the index of the current rule in the phase.
+   * @return the index of the first rule that need to be evaluated from the rule_index (include
+   * itself). The count of the rules is returned if there is no rule need to be evaluated.
+   */
+  size_t nextCandidate(Inputs present_inputs, size_t rule_index) const {
+    return next_candidates_[present_inputs][rule_index];
+  }
+
+  /**
+   * @return true if there is any rule that can be skipped by the filter.
+   */
+  bool enabled() const { return enabled_; }
+
+  /**
+   * Get the input sources that the rule reads.
+   * @param rule the rule.
+   * @return the bitmap of the input sources. 0 means that the rule may read the input sources that
+   * are always present (or unknown), so it can't be skipped.
+   */
+  static Inputs requiredInputs(const Rule& rule);
+
+  /**
+   * Whether the rule is evaluated by each window of the body in the stream mode. The other rules
+   * are evaluated only once by the last window.
+   * @param rule_index the index of the rule in the phase.
+   */
+  bool windowRule(size_t rule_index) const { return window_rules_[rule_index]; }
+
+  /**
+   * Whether the rule needs to be evaluated by each window of the body in the stream mode, that is
+   * the rule or its chained rules read the body, or it controls the flow of the body rules by the
+   * skip action.
+   * @param rule the rule.
+   */
+  static bool isWindowRule(const Rule& rule);
+
+private:
+  bool enabled_{false};
+  std::vector<bool> window_rules_;
+
+  // The index of the next rule that need to be evaluated of each combination of the present input
+  // sources. The size of each vector is the count of the rules + 1.
+  std::array<std::vector<uint32_t>, inputs_combination_total_> next_candidates_;
+};
+} // namespace Wge
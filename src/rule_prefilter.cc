@@ -0,0 +1,372 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "rule_prefilter.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <format>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/hyperscan/scanner.h"
+#include "common/log.h"
+#include "common/string.h"
+#include "operator/pm.h"
+#include "operator/rx.h"
+#include "rule.h"
+#include "transaction.h"
+
+namespace Wge {
+namespace {
+// The variables whose values are not changed by the rules during the phase. The values of the other
+// variables (e.g. TX, MATCHED_VAR) may be changed by the previous rules of the same phase, so they
+// can't be scanned ahead.
+const std::unordered_set<std::string_view> stable_variables = {
+    "ARGS",
+    "ARGS_GET",
+    "ARGS_GET_NAMES",
+    "ARGS_NAMES",
+    "ARGS_POST",
+    "ARGS_POST_NAMES",
+    "FILES",
+    "FILES_NAMES",
+    "QUERY_STRING",
+    "REQUEST_BASENAME",
+    "REQUEST_BODY",
+    "REQUEST_COOKIES",
+    "REQUEST_COOKIES_NAMES",
+    "REQUEST_FILENAME",
+    "REQUEST_HEADERS",
+    "REQUEST_HEADERS_NAMES",
+    "REQUEST_LINE",
+    "REQUEST_METHOD",
+    "REQUEST_PROTOCOL",
+    "REQUEST_URI",
+    "REQUEST_URI_RAW",
+    "RESPONSE_BODY",
+    "RESPONSE_HEADERS",
+    "RESPONSE_HEADERS_NAMES",
+};
+
+bool isAscii(std::string_view data) {
+  for (unsigned char c : data) {
+    if (c & 0x80)
+      [[unlikely]] { return false; }
+  }
+  return true;
+}
+
+// Convert the @pm phrases to a regular expression that matches any of the phrases.
+std::string makePmPattern(std::string_view phrases) {
+  std::string pattern;
+  for (auto token : Common::SplitTokens(phrases)) {
+    if (token.empty()) {
+      continue;
+    }
+    pattern += pattern.empty() ? "(?:" : "|";
+    for (unsigned char c : token) {
+      if (std::isalnum(c)) {
+        pattern += c;
+      } else {
+        pattern += std::format("\\x{:02x}", c);
+      }
+    }
+  }
+  if (!pattern.empty()) {
+    pattern += ")";
+  }
+  return pattern;
+}
+
+// Get the prefilter pattern of the rule. Returns false if the rule can't be prefiltered.
+bool getPattern(const Rule& rule, std::string& pattern, unsigned int& flag) {
+  // A skipped rule must behave the same as an unmatched rule, so the rule that does something when
+  // it is unmatched can't be skipped.
+  if (rule.operators().size() != 1 || rule.multiMatch() || rule.emptyMatch() ||
+      rule.unmatchedChain() || rule.unmatchedMultiChain() ||
+      !rule.unmatchedBranchActions().empty()) {
+    return false;
+  }
+
+  auto& op = rule.operators().front();
+  if (op->isNot() || op->macro()) {
+    return false;
+  }
+
+  flag = HS_FLAG_PREFILTER | HS_FLAG_ALLOWEMPTY | HS_FLAG_SINGLEMATCH | HS_FLAG_DOTALL |
+         HS_FLAG_MULTILINE;
+  if (dynamic_cast<const Operator::Rx*>(op.get())) {
+    pattern = op->literalValue();
+  } else if (dynamic_cast<const Operator::Pm*>(op.get())) {
+    pattern = makePmPattern(op->literalValue());
+    flag |= HS_FLAG_CASELESS;
+  } else {
+    return false;
+  }
+
+  // The operator may use the utf8 mode, and the non-ascii pattern has different semantics in the
+  // hyperscan byte mode.
+  if (pattern.empty() || !isAscii(pattern)) {
+    return false;
+  }
+
+  return true;
+}
+
+// Check the pattern is supported by hyperscan. Returns false if the pattern can't be compiled.
+bool checkPattern(const std::string& pattern, unsigned int flag, bool& may_match_empty) {
+  hs_expr_info_t* info = nullptr;
+  hs_compile_error_t* compile_err = nullptr;
+  hs_error_t err = ::hs_expression_info(pattern.c_str(), flag, &info, &compile_err);
+  if (err != HS_SUCCESS) {
+    WGE_LOG_DEBUG("rule prefilter: unsupported pattern: {} error: {}", pattern,
+                  compile_err ? compile_err->message : "");
+    ::hs_free_compile_error(compile_err);
+    return false;
+  }
+
+  may_match_empty = info->min_width == 0;
+  ::free(info);
+  return true;
+}
+} // namespace
+
+RulePrefilter::RulePrefilter() = default;
+RulePrefilter::~RulePrefilter() = default;
+
+void RulePrefilter::init(const std::vector<Rule>& rules, const Rule* default_action) {
+  groups_.clear();
+  rule_groups_.clear();
+  rule_groups_.resize(rules.size());
+
+  std::vector<std::vector<Common::Hyperscan::Expression>> expressions;
+  std::unordered_map<std::string, uint32_t> group_index;
+  for (auto& rule : rules) {
+    assert(rule.index() >= 0 && static_cast<size_t>(rule.index()) < rules.size());
+
+    std::string pattern;
+    unsigned int flag;
+    if (!getPattern(rule, pattern, flag)) {
+      continue;
+    }
+
+    bool may_match_empty = false;
+    if (!checkPattern(pattern, flag, may_match_empty)) {
+      continue;
+    }
+
+    // All of the variables of the rule must be prefiltered, otherwise the rule may be matched by
+    // the variable that isn't scanned.
+    bool all_stable = !rule.variables().empty();
+    for (auto& var : rule.variables()) {
+      if (var->isCounter() || !stable_variables.contains(var->mainName())) {
+        all_stable = false;
+        break;
+      }
+    }
+    if (!all_stable) {
+      continue;
+    }
+
+    // The transformations that will be applied to the variables
+    std::vector<const Transformation::TransformBase*> transforms = rule.fusedTransforms();
+    if (transforms.empty() && !rule.isIgnoreDefaultTransform() && default_action) {
+      for (auto& transform : default_action->transforms()) {
+        transforms.emplace_back(transform.get());
+      }
+    }
+    if (rule.fusedTransforms().empty()) {
+      for (auto& transform : rule.transforms()) {
+        transforms.emplace_back(transform.get());
+      }
+    }
+    std::string transforms_key;
+    for (auto transform : transforms) {
+      transforms_key += transform->name();
+      transforms_key += ',';
+    }
+
+    for (auto& var : rule.variables()) {
+      // The rules share the group only if they inspect the same values, so the except variables of
+      // the collection are a part of the key.
+      auto full_name = var->fullName();
+      std::string key = std::format("{}:{}", full_name.main_name_, full_name.sub_name_);
+      for (auto& except_var : rule.exceptVariables()) {
+        auto except_name = except_var->fullName();
+        if (except_name.main_name_ == full_name.main_name_) {
+          key += std::format("|!{}", except_name.sub_name_);
+        }
+      }
+      key += '@';
+      key += transforms_key;
+
+      auto iter = group_index.find(key);
+      if (iter == group_index.end()) {
+        iter = group_index.emplace(key, static_cast<uint32_t>(groups_.size())).first;
+        auto& group = groups_.emplace_back();
+        group.variable_ = var.get();
+        group.transforms_ = transforms;
+        expressions.emplace_back();
+      }
+
+      uint32_t index = iter->second;
+      auto& group = groups_[index];
+      group.rule_indexes_.emplace_back(rule.index());
+      if (may_match_empty) {
+        group.empty_match_rule_indexes_.emplace_back(rule.index());
+      }
+      expressions[index].push_back({pattern, flag, static_cast<uint64_t>(rule.index())});
+      rule_groups_[rule.index()].emplace_back(index);
+    }
+  }
+
+  // Compile the databases
+  size_t indexed_count = 0;
+  for (size_t i = 0; i < groups_.size(); ++i) {
+    auto& group = groups_[i];
+    Common::Hyperscan::ExpressionList expression_list(false);
+    for (size_t j = 0; j < expressions[i].size(); ++j) {
+      expression_list.add(std::move(expressions[i][j]), false, j == expressions[i].size() - 1);
+    }
+    auto hs_db = std::make_shared<Common::Hyperscan::HsDataBase>(std::move(expression_list), false);
+    if (hs_db->blockNative()) {
+      group.scanner_ = std::make_unique<Common::Hyperscan::Scanner>(hs_db);
+    } else {
+      WGE_LOG_WARN("rule prefilter: failed to compile the database of {}",
+                   group.variable_->mainName());
+    }
+  }
+
+  // If any group of the rule fails to compile, the rule can't be prefiltered
+  for (auto& group_indexes : rule_groups_) {
+    for (auto index : group_indexes) {
+      if (!groups_[index].scanner_) {
+        group_indexes.clear();
+        break;
+      }
+    }
+    indexed_count += group_indexes.empty() ? 0 : 1;
+  }
+
+  WGE_LOG_INFO("rule prefilter: {} of {} rules are indexed by {} groups", indexed_count,
+               rules.size(), groups_.size());
+}
+
+void RulePrefilter::collectDatabases(
+    std::vector<const Common::Hyperscan::HsDataBase*>& databases) const {
+  for (auto& group : groups_) {
+    databases.emplace_back(&group.scanner_->database());
+  }
+}
+
+void RulePrefilter::reset(State& state) const {
+  state.group_scanned_.assign(groups_.size(), false);
+  state.candidates_.assign(rule_groups_.size(), false);
+}
+
+bool RulePrefilter::isCandidate(Transaction& t, const Rule& rule, State& state) const {
+  assert(rule.index() >= 0);
+  if (static_cast<size_t>(rule.index()) >= rule_groups_.size())
+    [[unlikely]] { return true; }
+
+  auto& group_indexes = rule_groups_[rule.index()];
+  if (group_indexes.empty()) {
+    return true;
+  }
+
+  for (auto index : group_indexes) {
+    if (!state.group_scanned_[index]) {
+      state.group_scanned_[index] = true;
+      scan(t, groups_[index], state);
+    }
+  }
+
+  WGE_LOG_TRACE("rule prefilter. id: {} candidate: {}", rule.id(),
+                static_cast<bool>(state.candidates_[rule.index()]));
+  return state.candidates_[rule.index()];
+}
+
+void RulePrefilter::scan(Transaction& t, const Group& group, State& state) const {
+  // The values that are removed by the ctl action of the current rule may be inspected by the other
+  // rules of the group, so we evaluate the variable without the current rule.
+  const Rule* current_rule = t.getCurrentEvaluateRule();
+  t.setCurrentEvaluateRule(nullptr);
+  Common::EvaluateResults result;
+  group.variable_->evaluate(t, result);
+  t.setCurrentEvaluateRule(current_rule);
+
+  Common::EvaluateElement transformed_value;
+  for (size_t i = 0; i < result.size(); ++i) {
+    const Common::EvaluateElement& variable_value = result[i];
+    if (!IS_STRING_VIEW_VARIANT(variable_value.variant_))
+      [[unlikely]] {
+        markAll(group.rule_indexes_, state);
+        return;
+      }
+
+    // Apply the transformations. The transformed values are cached by the transaction, so the
+    // candidate rules will not transform the values again.
+    const Common::EvaluateElement* p_value = &variable_value;
+    for (auto transform : group.transforms_) {
+      if (transform->evaluate(t, group.variable_, *p_value, transformed_value)) {
+        p_value = &transformed_value;
+      }
+    }
+
+    if (!IS_STRING_VIEW_VARIANT(p_value->variant_))
+      [[unlikely]] {
+        markAll(group.rule_indexes_, state);
+        return;
+      }
+
+    std::string_view value = std::get<std::string_view>(p_value->variant_);
+    if (value.empty()) {
+      markAll(group.empty_match_rule_indexes_, state);
+      continue;
+    }
+
+    // The operators may match a multi-bytes character with the utf8 mode, but the hyperscan
+    // database is compiled with the byte mode.
+    if (!isAscii(value))
+      [[unlikely]] {
+        markAll(group.rule_indexes_, state);
+        return;
+      }
+
+    group.scanner_->blockScan(
+        value, Common::Hyperscan::Scanner::ScanMode::Normal,
+        [](uint64_t id, unsigned long long from, unsigned long long to, unsigned int flags,
+           void* user_data) -> int {
+          State* state = static_cast<State*>(user_data);
+          state->candidates_[id] = true;
+          return 0;
+        },
+        &state);
+  }
+}
+
+void RulePrefilter::markAll(const std::vector<RuleIndexType>& rule_indexes, State& state) {
+  for (auto index : rule_indexes) {
+    state.candidates_[index] = true;
+  }
+}
+} // namespace Wge
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "config.h"
+
+namespace Wge {
+class Rule;
+class Transaction;
+
+namespace Common::Hyperscan {
+class HsDataBase;
+class Scanner;
+} // namespace Common::Hyperscan
+
+namespace Transformation {
+class TransformBase;
+}
+
+namespace Variable {
+class VariableBase;
+}
+
+/**
+ * The rule prefilter of a phase.
+ * The rules that use the @rx or @pm operator and inspect the same target with the same
+ * transformations are grouped, and the patterns of each group are compiled into one hyperscan
+ * database in prefilter mode. Each transformed value of the target is scanned once per phase, and
+ * the rules whose pattern never fired can't match, so they are skipped without evaluating the
+ * precise operator.
+ * The prefilter only guarantees that there is no false negative: the candidate rules are evaluated
+ * as usual.
+ */
+class RulePrefilter {
+public:
+  RulePrefilter();
+  ~RulePrefilter();
+
+public:
+  /**
+   * The prefilter state of a transaction. It must be reset before evaluating the phase.
+   */
+  struct State {
+    // Whether the group has been scanned in the current phase
+    std::vector<bool> group_scanned_;
+
+    // Whether the rule is a candidate that may be matched
+    std::vector<bool> candidates_;
+  };
+
+public:
+  /**
+   * Build the prefilter of the phase.
+   * @param rules the rules of the phase.
+   * @param default_action the default action of the phase, may be nullptr.
+   */
+  void init(const std::vector<Rule>& rules, const Rule* default_action);
+
+  /**
+   * Reset the state of a transaction before evaluating the phase.
+   * @param state the state of the transaction.
+   */
+  void reset(State& state) const;
+
+  /**
+   * Check whether the rule may be matched.
+   * The groups that the rule belongs to are scanned lazily at the first time.
+   * @param t the transaction.
+   * @param rule the rule to be checked.
+   * @param state the state of the transaction.
+   * @return false if the rule can't be matched, true otherwise.
+   */
+  bool isCandidate(Transaction& t, const Rule& rule, State& state) const;
+
+  /**
+   * @return true if there is any rule that is indexed by the prefilter.
+   */
+  bool enabled() const { return !groups_.empty(); }
+
+  /**
+   * Check whether the rule is indexed by the prefilter.
+   * @param rule_index the index of the rule in the phase.
+   * @return true if the rule is indexed by the prefilter.
+   */
+  bool isIndexed(RuleIndexType rule_index) const {
+    return static_cast<size_t>(rule_index) < rule_groups_.size() &&
+           !rule_groups_[rule_index].empty();
+  }
+
+  /**
+   * Collect the hyperscan databases of the groups, e.g. to save them to a snapshot.
+   * @param databases the collected databases are appended to it.
+   */
+  void collectDatabases(std::vector<const Common::Hyperscan::HsDataBase*>& databases) const;
+
+private:
+  struct Group {
+    const Variable::VariableBase* variable_{nullptr};
+    std::vector<const Transformation::TransformBase*> transforms_;
+    std::unique_ptr<Common::Hyperscan::Scanner> scanner_;
+
+    // All of the rules of the group
+    std::vector<RuleIndexType> rule_indexes_;
+
+    // The rules whose pattern may match the empty string
+    std::vector<RuleIndexType> empty_match_rule_indexes_;
+  };
+
+private:
+  void scan(Transaction& t, const Group& group, State& state) const;
+  static void markAll(const std::vector<RuleIndexType>& rule_indexes, State& state);
+
+private:
+  std::vector<Group> groups_;
+
+  // The group indexes of each rule, the index is the index of the rule in the phase. If it is empty
+  // means that the rule isn't indexed by the prefilter.
+  std::vector<std::vector<uint32_t>> rule_groups_;
+};
+} // namespace Wge
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "rule_profiler.h"
+
+#include <algorithm>
+#include <format>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/assert.h"
+#include "rule.h"
+
+namespace Wge {
+namespace {
+std::atomic<uint64_t> profiler_id_generator{0};
+
+// The ids of the alive profilers. Each thread drops its entries of the destroyed profilers once
+// the count of the destroyed profilers is changed, so the entries of the reloaded engines don't
+// pile up.
+std::mutex alive_ids_mutex;
+std::unordered_set<uint64_t> alive_ids;
+std::atomic<uint64_t> destroyed_count{0};
+
+void appendJsonString(std::string& out, std::string_view value) {
+  out += '"';
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        out += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+      } else {
+        out += c;
+      }
+      break;
+    }
+  }
+  out += '"';
+}
+} // namespace
+
+RuleProfiler::RuleProfiler() : id_(++profiler_id_generator) {
+  std::lock_guard<std::mutex> lock(alive_ids_mutex);
+  alive_ids.emplace(id_);
+}
+
+RuleProfiler::~RuleProfiler() {
+  std::lock_guard<std::mutex> lock(alive_ids_mutex);
+  alive_ids.erase(id_);
+  destroyed_count.fetch_add(1, std::memory_order_release);
+}
+
+void RuleProfiler::init(const std::array<std::vector<Rule>, PHASE_TOTAL>& rules) {
+  std::lock_guard<std::mutex> lock(shards_mutex_);
+  assert(shards_.empty());
+
+  rules_.clear();
+  for (size_t phase = 0; phase < PHASE_TOTAL; ++phase) {
+    phase_offsets_[phase] = rules_.size();
+    for (auto& rule : rules[phase]) {
+      rules_.emplace_back(&rule);
+    }
+  }
+  phase_offsets_[PHASE_TOTAL] = rules_.size();
+}
+
+RuleProfiler::PhaseCounters RuleProfiler::phaseCounters(RulePhaseType phase) const {
+  assert(phase >= 1 && phase <= PHASE_TOTAL);
+  return PhaseCounters(localShard().counters_.get() + phase_offsets_[phase - 1]);
+}
+
+std::string RuleProfiler::dump() const {
+  struct RuleProfile {
+    const Rule* rule_;
+    uint64_t evaluate_count_{0};
+    uint64_t matched_count_{0};
+    uint64_t total_ns_{0};
+    uint64_t variable_ns_{0};
+    uint64_t value_ns_{0};
+  };
+
+  struct OperatorProfile {
+    uint64_t evaluate_count_{0};
+    uint64_t value_ns_{0};
+  };
+
+  // Merge the shards
+  std::vector<RuleProfile> rule_profiles(rules_.size());
+  {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      auto& profile = rule_profiles[i];
+      profile.rule_ = rules_[i];
+      for (auto& shard : shards_) {
+        const Counters& counters = shard->counters_[i];
+        profile.evaluate_count_ += counters.evaluate_count_.load(std::memory_order_relaxed);
+        profile.matched_count_ += counters.matched_count_.load(std::memory_order_relaxed);
+        profile.total_ns_ += counters.total_ns_.load(std::memory_order_relaxed);
+        profile.variable_ns_ += counters.variable_ns_.load(std::memory_order_relaxed);
+        profile.value_ns_ += counters.value_ns_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::erase_if(rule_profiles,
+                [](const RuleProfile& profile) { return profile.evaluate_count_ == 0; });
+  std::sort(rule_profiles.begin(), rule_profiles.end(),
+            [](const RuleProfile& left, const RuleProfile& right) {
+              return left.total_ns_ > right.total_ns_;
+            });
+
+  // Aggregate the operator time by the operator name
+  std::map<std::string_view, OperatorProfile> operator_profiles;
+  for (auto& profile : rule_profiles) {
+    if (!profile.rule_->operators().empty()) {
+      auto& operator_profile = operator_profiles[profile.rule_->operators().front()->name()];
+      operator_profile.evaluate_count_ += profile.evaluate_count_;
+      operator_profile.value_ns_ += profile.value_ns_;
+    }
+  }
+
+  std::string json = "{\"rules\":[";
+  for (size_t i = 0; i < rule_profiles.size(); ++i) {
+    auto& profile = rule_profiles[i];
+    const Rule& rule = *profile.rule_;
+    if (i != 0) {
+      json += ',';
+    }
+    json += std::format("{{\"id\":{},\"phase\":{},\"file\":", rule.id(),
+                        static_cast<int>(rule.phase()));
+    appendJsonString(json, rule.filePath());
+    json += std::format(",\"line\":{},\"operator\":", rule.line());
+    appendJsonString(json, rule.operators().empty() ? "" : rule.operators().front()->name());
+    json += std::format(
+        ",\"evaluate_count\":{},\"matched_count\":{},\"total_ns\":{},\"variable_ns\":{},"
+        "\"value_ns\":{}}}",
+        profile.evaluate_count_, profile.matched_count_, profile.total_ns_, profile.variable_ns_,
+        profile.value_ns_);
+  }
+  json += "],\"operators\":[";
+  bool first = true;
+  for (auto& [name, profile] : operator_profiles) {
+    if (!first) {
+      json += ',';
+    }
+    first = false;
+    json += "{\"name\":";
+    appendJsonString(json, name);
+    json += std::format(",\"evaluate_count\":{},\"value_ns\":{}}}", profile.evaluate_count_,
+                        profile.value_ns_);
+  }
+  json += "]}";
+
+  return json;
+}
+
+void RuleProfiler::reset() {
+  std::lock_guard<std::mutex> lock(shards_mutex_);
+  for (auto& shard : shards_) {
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      Counters& counters = shard->counters_[i];
+      counters.evaluate_count_.store(0, std::memory_order_relaxed);
+      counters.matched_count_.store(0, std::memory_order_relaxed);
+      counters.total_ns_.store(0, std::memory_order_relaxed);
+      counters.variable_ns_.store(0, std::memory_order_relaxed);
+      counters.value_ns_.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+RuleProfiler::Shard& RuleProfiler::localShard() const {
+  // Cache the last used shard, since a thread usually works with only one engine
+  thread_local uint64_t cached_id = 0;
+  thread_local Shard* cached_shard = nullptr;
+  if (cached_id == id_)
+    [[likely]] { return *cached_shard; }
+
+  thread_local std::unordered_map<uint64_t, Shard*> thread_shards;
+  thread_local uint64_t pruned_count = 0;
+  uint64_t current_destroyed_count = destroyed_count.load(std::memory_order_acquire);
+  if (pruned_count != current_destroyed_count)
+    [[unlikely]] {
+      std::lock_guard<std::mutex> lock(alive_ids_mutex);
+      std::erase_if(thread_shards,
+                    [](const auto& entry) { return !alive_ids.contains(entry.first); });
+      pruned_count = current_destroyed_count;
+    }
+
+  auto iter = thread_shards.find(id_);
+  if (iter == thread_shards.end()) {
+    auto shard = std::make_unique<Shard>();
+    shard->counters_ = std::make_unique<Counters[]>(rules_.size());
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    iter = thread_shards.emplace(id_, shard.get()).first;
+    shards_.emplace_back(std::move(shard));
+  }
+
+  cached_id = id_;
+  cached_shard = iter->second;
+  return *cached_shard;
+}
+} // namespace Wge
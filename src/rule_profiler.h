@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+namespace Wge {
+class Rule;
+
+/**
+ * The per-rule profiler.
+ * Each thread that evaluates the rules owns a shard of the counters, and only the owner thread
+ * writes the shard, so the counting is lock-free. The shards are merged on demand when the profile
+ * is dumped. The time of the chained rules is accounted to the top rule of the chain.
+ */
+class RuleProfiler {
+public:
+  /**
+   * The counters of a rule.
+   */
+  struct Counters {
+    std::atomic<uint64_t> evaluate_count_{0};
+    std::atomic<uint64_t> matched_count_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> variable_ns_{0};
+
+    // The time of evaluating the values of the variables, that is the transformations, the
+    // operators and the actions of the matched values. It's timed per variable rather than per
+    // value, so the profiling doesn't add the clock reads to each value.
+    std::atomic<uint64_t> value_ns_{0};
+
+    // Only the owner thread writes the counter, so the read-modify-write needn't be atomic
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+      counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+  };
+
+  /**
+   * The counters of the rules in a phase for the current thread.
+   */
+  class PhaseCounters {
+  public:
+    PhaseCounters(Counters* counters) : counters_(counters) {}
+
+  public:
+    Counters& operator[](RuleIndexType index) const { return counters_[index]; }
+
+  private:
+    Counters* counters_;
+  };
+
+  static uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /**
+   * Accumulate the elapsed time of the scope into the counter. Nothing is done if the counter is
+   * nullptr, that is the profiling is disabled.
+   */
+  class ScopedTimer {
+  public:
+    ScopedTimer(std::atomic<uint64_t>* counter)
+        : counter_(counter), start_(counter ? now() : 0) {}
+    ~ScopedTimer() {
+      if (counter_)
+        [[unlikely]] { Counters::add(*counter_, now() - start_); }
+    }
+
+  private:
+    std::atomic<uint64_t>* counter_;
+    uint64_t start_;
+  };
+
+public:
+  RuleProfiler();
+  ~RuleProfiler();
+
+public:
+  /**
+   * Initialize the profiler with the rules.
+   * @param rules the rules of each phase.
+   */
+  void init(const std::array<std::vector<Rule>, PHASE_TOTAL>& rules);
+
+  /**
+   * Get the counters of the rules in the phase for the current thread. The shard of the thread is
+   * created at the first time.
+   * @param phase the phase of the rules, the valid range is 1-5.
+   * @return the counters of the phase, which are indexed by the index of the rule.
+   */
+  PhaseCounters phaseCounters(RulePhaseType phase) const;
+
+  /**
+   * Merge the shards of all threads and dump the profile.
+   * @return the profile in JSON. The rules are sorted by the total time in descending order, and
+   * the rules that have never been evaluated are omitted.
+   */
+  std::string dump() const;
+
+  /**
+   * Reset all counters. The counters that are written concurrently may be lost.
+   */
+  void reset();
+
+private:
+  struct Shard {
+    std::unique_ptr<Counters[]> counters_;
+  };
+
+  Shard& localShard() const;
+
+private:
+  // The unique id of the profiler, which identifies the shard of the thread
+  const uint64_t id_;
+
+  // The offset of the first rule of each phase in the shard
+  std::array<size_t, PHASE_TOTAL + 1> phase_offsets_{};
+  std::vector<const Rule*> rules_;
+
+  mutable std::mutex shards_mutex_;
+  mutable std::vector<std::unique_ptr<Shard>> shards_;
+};
+} // namespace Wge
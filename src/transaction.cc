@@ -20,10 +20,12 @@
  */
 #include "transaction.h"
 
+#include <algorithm>
 #include <chrono>
 #include <format>
 
 #include "action/set_var.h"
+#include "audit_log.h"
 #include "common/assert.h"
 #include "common/log.h"
 #include "common/ragel/uri_parser.h"
@@ -40,7 +42,11 @@ constexpr size_t variable_key_with_macro_size = 100;
 constexpr int max_capture_size = 100;
 
 Transaction::Transaction(const Engine& engin, std::shared_ptr<Common::PropertyStore> property_store)
-    : engine_(engin), property_store_(std::move(property_store)) {
+    : engine_(engin),
+      arena_initial_buffer_(std::make_unique_for_overwrite<std::byte[]>(arena_initial_size_)),
+      arena_(arena_initial_buffer_.get(), arena_initial_size_, &arena_upstream_),
+      string_pool_(&arena_), window_arena_(&window_arena_upstream_),
+      property_store_(std::move(property_store)) {
   for (auto& [ns, size] : engine_.getTxVariableIndexSize()) {
     auto& tx_var_info = tx_variables_[ns];
     tx_var_info.variables_.reserve(size + variable_key_with_macro_size);
@@ -55,9 +61,89 @@ Transaction::Transaction(const Engine& engin, std::shared_ptr<Common::PropertySt
   transform_cache_.reserve(100);
 }
 
+void Transaction::reset(std::shared_ptr<Common::PropertyStore> property_store) {
+  // Http transaction data
+  extractor_.clear();
+  connection_info_ = ConnectionInfo();
+  request_line_ = {};
+  request_line_info_ =
+      RequestLineInfo{.query_params_ = std::move(request_line_info_.query_params_)};
+  request_line_info_.query_params_.clear();
+  response_line_info_ = ResponseLineInfo();
+  request_body_ = {};
+  response_body_ = {};
+  body_query_param_.clear();
+  body_multi_part_.clear();
+  body_xml_.clear();
+  body_json_.clear();
+  req_body_error_msg_.clear();
+  inbound_data_error_ = false;
+  outbound_data_error_ = false;
+  body_limit_status_ = {};
+  cookies_.reset();
+  request_body_stream_.clear();
+  response_body_stream_.clear();
+  process_budget_ = ProcessBudget();
+  defer_evaluation_ = false;
+  suspension_.reset();
+  process_result_ = ProcessResult::Allow;
+  body_window_active_ = false;
+
+  // Current evaluation state. The containers are cleared rather than recreated, so the capacity
+  // that has been allocated by the previous requests is reused.
+  current_phase_ = 1;
+  current_rule_ = nullptr;
+  captured_.clear();
+  const auto& tx_variable_index_size = engine_.getTxVariableIndexSize();
+  for (auto& [ns, tx_var_info] : tx_variables_) {
+    auto iter = tx_variable_index_size.find(ns);
+    tx_var_info.variables_.clear();
+    tx_var_info.variables_.resize(iter != tx_variable_index_size.end() ? iter->second : 0);
+    tx_var_info.local_index_.clear();
+    tx_var_info.local_index_reverse_.clear();
+  }
+  matched_variables_.clear();
+  matched_optrees_.clear();
+  matched_vptrees_.clear();
+  for (auto& rule_remove_flag : rule_remove_flags_) {
+    rule_remove_flag.clear();
+  }
+  for (auto& rule_remove_targets : rule_remove_targets_) {
+    rule_remove_targets.clear();
+  }
+  transform_cache_.clear();
+  transform_cache_statistics_ = TransformCacheStatistics();
+  libinjection_cache_.clear();
+  libinjection_cache_statistics_ = LibinjectionCacheStatistics();
+  allow_phases_.reset();
+  persistent_storage_keys_.fill(std::monostate());
+  audit_messages_.clear();
+
+  // Configuration options by ctl action
+  audit_engine_.reset();
+  audit_log_parts_.reset();
+  request_body_access_.reset();
+  request_body_processor_.reset();
+  parse_xml_into_args_.reset();
+  rule_engine_.reset();
+
+  unique_id_.reset();
+  log_callback_ = nullptr;
+  log_user_data_ = nullptr;
+  additional_cond_ = nullptr;
+  additional_cond_user_data_ = nullptr;
+  string_pool_.clear();
+  arena_.release();
+  window_arena_.release();
+  property_store_ = std::move(property_store);
+}
+
 void Transaction::processConnection(std::string_view downstream_ip, short downstream_port,
                                     std::string_view upstream_ip, short upstream_port) {
   WGE_LOG_TRACE("====process connection====");
+  if (rejectWhileSuspended("processConnection"))
+    [[unlikely]] { return; }
+
   connection_info_.downstream_ip_ = downstream_ip;
   connection_info_.upstream_ip_ = upstream_ip;
   connection_info_.downstream_port_ = downstream_port;
@@ -65,6 +151,9 @@ void Transaction::processConnection(std::string_view downstream_ip, short downst
 }
 
 void Transaction::processUri(std::string_view request_line) {
+  if (rejectWhileSuspended("processUri"))
+    [[unlikely]] { return; }
+
   request_line_ = request_line;
   // Find the first space to extract the HTTP method
   size_t pos_space1 = request_line.find(' ');
@@ -90,6 +179,9 @@ void Transaction::processUri(std::string_view request_line) {
 void Transaction::processUri(std::string_view uri, std::string_view method,
                              std::string_view version) {
   WGE_LOG_TRACE("====process uri====");
+  if (rejectWhileSuspended("processUri"))
+    [[unlikely]] { return; }
+
   // If request_line_ is empty, reconstruct it using method, URI, and version
   if (request_line_.empty()) {
     std::string request_line_buffer;
@@ -99,7 +191,7 @@ void Transaction::processUri(std::string_view uri, std::string_view method,
     request_line_buffer += uri;
     request_line_buffer += " HTTP/";
     request_line_buffer += version;
-    request_line_ = internString(std::move(request_line_buffer));
+    request_line_ = internString(request_line_buffer);
     // Extract protocol string from the reconstructed request line
     request_line_info_.protocol_ = request_line_.substr(method.size() + uri.size() + 2);
   }
@@ -116,7 +208,10 @@ void Transaction::processUri(std::string_view uri, std::string_view method,
   uri_parser.init(uri, request_line_info_, string_pool_);
 
   // Init the query params
-  request_line_info_.query_params_.init(request_line_info_.query_, string_pool_);
+  request_line_info_.query_params_.init(request_line_info_.query_, string_pool_,
+                                        engine_.config().arguments_limit_);
+  if (request_line_info_.query_params_.truncated())
+    [[unlikely]] { req_body_error_msg_ = "Query arguments exceed SecArgumentsLimit"; }
 
   WGE_LOG_TRACE("method: {}, uri: {}, query: {}, protocol: {}, version: {}",
                 request_line_info_.method_, request_line_info_.uri_, request_line_info_.query_,
@@ -128,22 +223,39 @@ bool Transaction::processRequestHeaders(HeaderFind request_header_find,
                                         size_t request_header_count, LogCallback log_callback,
                                         void* log_user_data, AdditionalCondCallback additional_cond,
                                         void* additional_cond_user_data) {
+  if (rejectWhileSuspended("processRequestHeaders"))
+    [[unlikely]] { return false; }
+
+  extractor_.request_headers_.set(std::move(request_header_find),
+                                  std::move(request_header_traversal), request_header_count);
+  return processRequestHeadersPhase(log_callback, log_user_data, additional_cond,
+                                    additional_cond_user_data);
+}
+
+bool Transaction::processRequestHeaders(std::span<const Header> request_headers,
+                                        LogCallback log_callback, void* log_user_data,
+                                        AdditionalCondCallback additional_cond,
+                                        void* additional_cond_user_data) {
+  if (rejectWhileSuspended("processRequestHeaders"))
+    [[unlikely]] { return false; }
+
+  extractor_.request_headers_.set(request_headers);
+  return processRequestHeadersPhase(log_callback, log_user_data, additional_cond,
+                                    additional_cond_user_data);
+}
+
+bool Transaction::processRequestHeadersPhase(LogCallback log_callback, void* log_user_data,
+                                             AdditionalCondCallback additional_cond,
+                                             void* additional_cond_user_data) {
   WGE_LOG_TRACE("====process request headers====");
-  extractor_.request_header_find_ = std::move(request_header_find);
-  extractor_.request_header_traversal_ = std::move(request_header_traversal);
-  extractor_.request_header_count_ = request_header_count;
   log_callback_ = log_callback;
   log_user_data_ = log_user_data;
   additional_cond_ = additional_cond;
   additional_cond_user_data_ = additional_cond_user_data;
 
   // Set the request body processor
-  if (extractor_.request_header_find_) {
-    std::string_view content_type;
-    auto results = extractor_.request_header_find_("content-type");
-    if (!results.empty()) {
-      content_type = results.front();
-    }
+  if (extractor_.request_headers_.provided()) {
+    std::string_view content_type = extractor_.request_headers_.front("content-type");
     if (content_type.starts_with("application/x-www-form-urlencoded")) {
       request_body_processor_ = BodyProcessorType::UrlEncoded;
     } else if (content_type.starts_with("multipart/form-data")) {
@@ -174,6 +286,13 @@ bool Transaction::processRequestBody(std::string_view body, LogCallback log_call
                                      void* log_user_data, AdditionalCondCallback additional_cond,
                                      void* additional_cond_user_data) {
   WGE_LOG_TRACE("====process request body====");
+  if (rejectWhileSuspended("processRequestBody"))
+    [[unlikely]] { return false; }
+
+  if (!limitRequestBody(body, 0))
+    [[unlikely]] { return false; }
+
+  const uint32_t arguments_limit = engine_.config().arguments_limit_;
   request_body_ = body;
   log_callback_ = log_callback;
   log_user_data_ = log_user_data;
@@ -187,28 +306,33 @@ bool Transaction::processRequestBody(std::string_view body, LogCallback log_call
       // Do nothing
     } break;
     case BodyProcessorType::UrlEncoded: {
-      body_query_param_.init(request_body_, string_pool_);
+      body_query_param_.init(request_body_, string_pool_, arguments_limit);
+      if (body_query_param_.truncated())
+        [[unlikely]] { req_body_error_msg_ = "Request body arguments exceed SecArgumentsLimit"; }
     } break;
     case BodyProcessorType::MultiPart: {
-      std::string_view content_type;
-      auto results = extractor_.request_header_find_("content-type");
-      if (!results.empty()) {
-        content_type = results.front();
-      }
-      body_multi_part_.init(content_type, request_body_, engine_.config().upload_file_limit_);
+      std::string_view content_type = extractor_.request_headers_.front("content-type");
+      body_multi_part_.init(content_type, request_body_, engine_.config().upload_file_limit_,
+                            arguments_limit);
+      if (body_multi_part_.truncated())
+        [[unlikely]] { req_body_error_msg_ = "Request body arguments exceed SecArgumentsLimit"; }
     } break;
     case BodyProcessorType::Xml: {
       body_xml_.init(request_body_, string_pool_);
       auto option = getParseXmlIntoArgs();
       if (option != ParseXmlIntoArgsOption::Off) {
-        body_query_param_.merge(body_xml_.getTags());
+        body_query_param_.merge(body_xml_.getTags(), arguments_limit);
+        if (body_query_param_.truncated())
+          [[unlikely]] { req_body_error_msg_ = "Request body arguments exceed SecArgumentsLimit"; }
       }
       if (option == ParseXmlIntoArgsOption::OnlyArgs) {
         body_xml_.clear();
       }
     } break;
     case BodyProcessorType::Json: {
-      body_json_.init(request_body_, string_pool_);
+      body_json_.init(request_body_, string_pool_, arguments_limit);
+      if (body_json_.truncated())
+        [[unlikely]] { req_body_error_msg_ = "Request body arguments exceed SecArgumentsLimit"; }
     } break;
     default: {
       UNREACHABLE();
@@ -234,10 +358,34 @@ bool Transaction::processResponseHeaders(std::string_view status_code, std::stri
                                          void* log_user_data,
                                          AdditionalCondCallback additional_cond,
                                          void* additional_cond_user_data) {
+  if (rejectWhileSuspended("processResponseHeaders"))
+    [[unlikely]] { return false; }
+
+  extractor_.response_headers_.set(std::move(response_header_find),
+                                   std::move(response_header_traversal), response_header_count);
+  return processResponseHeadersPhase(status_code, protocol, log_callback, log_user_data,
+                                     additional_cond, additional_cond_user_data);
+}
+
+bool Transaction::processResponseHeaders(std::string_view status_code, std::string_view protocol,
+                                         std::span<const Header> response_headers,
+                                         LogCallback log_callback, void* log_user_data,
+                                         AdditionalCondCallback additional_cond,
+                                         void* additional_cond_user_data) {
+  if (rejectWhileSuspended("processResponseHeaders"))
+    [[unlikely]] { return false; }
+
+  extractor_.response_headers_.set(response_headers);
+  return processResponseHeadersPhase(status_code, protocol, log_callback, log_user_data,
+                                     additional_cond, additional_cond_user_data);
+}
+
+bool Transaction::processResponseHeadersPhase(std::string_view status_code,
+                                              std::string_view protocol, LogCallback log_callback,
+                                              void* log_user_data,
+                                              AdditionalCondCallback additional_cond,
+                                              void* additional_cond_user_data) {
   WGE_LOG_TRACE("====process response headers====");
-  extractor_.response_header_find_ = std::move(response_header_find);
-  extractor_.response_header_traversal_ = std::move(response_header_traversal);
-  extractor_.response_header_count_ = response_header_count;
   response_line_info_.status_code_ = status_code;
   response_line_info_.protocol_ = protocol;
 
@@ -261,6 +409,12 @@ bool Transaction::processResponseBody(std::string_view body, LogCallback log_cal
                                       void* log_user_data, AdditionalCondCallback additional_cond,
                                       void* additional_cond_user_data) {
   WGE_LOG_TRACE("====process response body====");
+  if (rejectWhileSuspended("processResponseBody"))
+    [[unlikely]] { return false; }
+
+  if (!limitResponseBody(body, 0))
+    [[unlikely]] { return false; }
+
   response_body_ = body;
   log_callback_ = log_callback;
   log_user_data_ = log_user_data;
@@ -278,6 +432,380 @@ bool Transaction::processResponseBody(std::string_view body, LogCallback log_cal
   return result;
 }
 
+bool Transaction::appendRequestBody(std::string_view chunk, bool end_stream,
+                                    LogCallback log_callback, void* log_user_data,
+                                    AdditionalCondCallback additional_cond,
+                                    void* additional_cond_user_data) {
+  WGE_LOG_TRACE("====append request body: {} bytes, end_stream: {}====", chunk.size(),
+                end_stream);
+
+  if (rejectWhileSuspended("appendRequestBody"))
+    [[unlikely]] { return false; }
+
+  auto& stream = request_body_stream_;
+  if (stream.end_stream_ || !stream.result_)
+    [[unlikely]] { return stream.result_; }
+
+  // The rest of the body is ignored once the body limit is exceeded
+  uint64_t offset = stream.received_size_;
+  stream.received_size_ += chunk.size();
+  if (!limitRequestBody(chunk, offset))
+    [[unlikely]] {
+      stream.result_ = false;
+      return false;
+    }
+  if (inbound_data_error_)
+    [[unlikely]] { end_stream = true; }
+  stream.end_stream_ = end_stream;
+
+  // The arguments limit applies to the whole body rather than the window
+  const uint32_t arguments_limit = engine_.config().arguments_limit_;
+  size_t max_arg_count = 0;
+  bool arguments_exhausted = false;
+  if (arguments_limit)
+    [[unlikely]] {
+      max_arg_count = arguments_limit - std::min<size_t>(stream.arg_count_, arguments_limit);
+      arguments_exhausted = max_arg_count == 0;
+    }
+
+  // The data that is held across the chunks is bounded by the SecRequestBodyInMemoryLimit, the
+  // rest of the body is ignored once it's exceeded.
+  const EngineConfig& config = engine_.config();
+  auto exceed_in_memory_limit = [&](size_t held_size) {
+    if (held_size <= config.request_body_in_memory_limit_)
+      [[likely]] { return false; }
+    WGE_LOG_TRACE("request body exceeds the in memory limit: {}",
+                  config.request_body_in_memory_limit_);
+    req_body_error_msg_ = "Request body exceeds SecRequestBodyInMemoryLimit";
+    end_stream = true;
+    stream.end_stream_ = true;
+    return true;
+  };
+
+  auto processor = request_body_processor_.value_or(BodyProcessorType::UnknownFormat);
+  switch (processor) {
+  case BodyProcessorType::UnknownFormat: {
+    request_body_ = stream.join(chunk, config.body_stream_overlap_);
+  } break;
+  case BodyProcessorType::UrlEncoded: {
+    stream.carry_.append(chunk);
+
+    // Only the complete arguments are inspected, the incomplete tail is carried over to the next
+    // chunk
+    size_t complete_size = stream.carry_.size();
+    size_t consumed_size = complete_size;
+    if (!end_stream) {
+      auto pos = stream.carry_.rfind(config.argument_separator_);
+      if (pos == std::string::npos) {
+        if (!exceed_in_memory_limit(stream.carry_.size()))
+          [[likely]] { return true; }
+      } else {
+        complete_size = pos;
+        consumed_size = pos + 1;
+      }
+    }
+
+    // Only the arguments of the current chunk are parsed, the overlap is inspected by REQUEST_BODY
+    size_t overlap_size = stream.overlap_.size();
+    request_body_ = stream.join(std::string_view(stream.carry_).substr(0, consumed_size),
+                                config.body_stream_overlap_);
+    stream.carry_.erase(0, consumed_size);
+    stream.decode_buffer_.clear();
+    body_query_param_.init(arguments_exhausted
+                               ? std::string_view()
+                               : request_body_.substr(overlap_size, complete_size),
+                           stream.decode_buffer_, max_arg_count);
+    stream.arg_count_ += body_query_param_.getLinked().size();
+    if (arguments_exhausted || body_query_param_.truncated())
+      [[unlikely]] { req_body_error_msg_ = "Request body arguments exceed SecArgumentsLimit"; }
+  } break;
+  case BodyProcessorType::Json: {
+    request_body_ = stream.join(chunk, config.body_stream_overlap_);
+    if (arguments_exhausted)
+      [[unlikely]] { body_json_.clear(); }
+    else {
+      auto result = body_json_.initStream(chunk, end_stream, max_arg_count);
+      stream.arg_count_ += body_json_.getKeyValuesLinked().size();
+      if (result == Transformation::StreamResult::INVALID_INPUT)
+        [[unlikely]] { req_body_error_msg_ = "Failed to parse the JSON request body"; }
+      else if (!end_stream) {
+        // The incomplete key-value pair is held by the parser until it's complete
+        exceed_in_memory_limit(body_json_.partialSize());
+      }
+    }
+    if (arguments_exhausted || body_json_.truncated())
+      [[unlikely]] { req_body_error_msg_ = "Request body arguments exceed SecArgumentsLimit"; }
+  } break;
+  case BodyProcessorType::MultiPart:
+  case BodyProcessorType::Xml: {
+    // The multipart and xml parsers don't support the stream mode, so we buffer the chunks and
+    // inspect the whole body at the end of the stream
+    stream.buffered_.append(chunk);
+    if (!end_stream && !exceed_in_memory_limit(stream.buffered_.size()))
+      [[likely]] { return true; }
+    stream.result_ = processRequestBody(stream.buffered_, log_callback, log_user_data,
+                                        additional_cond, additional_cond_user_data);
+    if (process_result_ == ProcessResult::Suspended)
+      [[unlikely]] { suspension_->body_stream_ = &stream; }
+    return stream.result_;
+  } break;
+  default: {
+    UNREACHABLE();
+  } break;
+  }
+
+  stream.result_ = processBodyWindow(2, log_callback, log_user_data, additional_cond,
+                                     additional_cond_user_data);
+  if (process_result_ == ProcessResult::Suspended)
+    [[unlikely]] { suspension_->body_stream_ = &stream; }
+  return stream.result_;
+}
+
+bool Transaction::appendResponseBody(std::string_view chunk, bool end_stream,
+                                     LogCallback log_callback, void* log_user_data,
+                                     AdditionalCondCallback additional_cond,
+                                     void* additional_cond_user_data) {
+  WGE_LOG_TRACE("====append response body: {} bytes, end_stream: {}====", chunk.size(),
+                end_stream);
+
+  if (rejectWhileSuspended("appendResponseBody"))
+    [[unlikely]] { return false; }
+
+  auto& stream = response_body_stream_;
+  if (stream.end_stream_ || !stream.result_)
+    [[unlikely]] { return stream.result_; }
+
+  // The rest of the body is ignored once the body limit is exceeded
+  uint64_t offset = stream.received_size_;
+  stream.received_size_ += chunk.size();
+  if (!limitResponseBody(chunk, offset))
+    [[unlikely]] {
+      stream.result_ = false;
+      return false;
+    }
+  if (outbound_data_error_)
+    [[unlikely]] { end_stream = true; }
+  stream.end_stream_ = end_stream;
+
+  response_body_ = stream.join(chunk, engine_.config().body_stream_overlap_);
+  stream.result_ = processBodyWindow(4, log_callback, log_user_data, additional_cond,
+                                     additional_cond_user_data);
+  if (process_result_ == ProcessResult::Suspended)
+    [[unlikely]] { suspension_->body_stream_ = &stream; }
+  return stream.result_;
+}
+
+std::string_view Transaction::BodyStream::join(std::string_view data, size_t overlap_size) {
+  window_.assign(overlap_);
+  window_.append(data);
+  overlap_.assign(window_, window_.size() - std::min(window_.size(), overlap_size));
+  return window_;
+}
+
+void Transaction::processLogging() {
+  WGE_LOG_TRACE("====process logging====");
+  AuditLog* audit_log = engine_.auditLog();
+  if (audit_log) {
+    audit_log->log(*this);
+  }
+}
+
+bool Transaction::limitRequestBody(std::string_view& body, uint64_t offset) {
+  const EngineConfig& config = engine_.config();
+
+  // The SecRequestBodyNoFilesLimit excludes the size of the uploaded files, and we can't know the
+  // size of the files before parsing the multipart body. So it's only applied to the bodies that
+  // don't carry files.
+  uint64_t limit = config.request_body_limit_;
+  if (request_body_processor_ != BodyProcessorType::MultiPart)
+    [[likely]] { limit = std::min(limit, config.request_body_no_files_limit_); }
+
+  if (offset + body.size() <= limit)
+    [[likely]] { return true; }
+
+  WGE_LOG_TRACE("request body exceeds the limit: {}", limit);
+  inbound_data_error_ = true;
+  if (config.request_body_limit_action_ == EngineConfig::BodyLimitAction::Reject &&
+      config.rule_engine_option_ == EngineConfig::Option::On) {
+    body_limit_status_ = "413";
+    return false;
+  }
+
+  // Only process the part of the body that is within the limit
+  body = body.substr(0, offset < limit ? limit - offset : 0);
+  return true;
+}
+
+bool Transaction::limitResponseBody(std::string_view& body, uint64_t offset) {
+  const EngineConfig& config = engine_.config();
+  uint64_t limit = config.response_body_limit_;
+  if (offset + body.size() <= limit)
+    [[likely]] { return true; }
+
+  WGE_LOG_TRACE("response body exceeds the limit: {}", limit);
+  outbound_data_error_ = true;
+  if (config.response_body_limit_action_ == EngineConfig::BodyLimitAction::Reject &&
+      config.rule_engine_option_ == EngineConfig::Option::On) {
+    body_limit_status_ = "500";
+    return false;
+  }
+
+  // Only process the part of the body that is within the limit
+  body = body.substr(0, offset < limit ? limit - offset : 0);
+  return true;
+}
+
+Transaction::ProcessResult Transaction::resume() {
+  if (!suspension_)
+    [[unlikely]] { return ProcessResult::Allow; }
+
+  Suspension suspension = *suspension_;
+  suspension_.reset();
+  WGE_LOG_TRACE("====resume phase {} from rule index {}====", suspension.phase_,
+                suspension.rule_index_);
+
+  restoreSuspension(suspension);
+  ProcessResult result = evaluatePhase(suspension.phase_, suspension.rule_index_);
+  finishSuspension(suspension, result != ProcessResult::Deny);
+
+  return result;
+}
+
+inline void Transaction::restoreSuspension(const Suspension& suspension) {
+  log_callback_ = suspension.log_callback_;
+  log_user_data_ = suspension.log_user_data_;
+  additional_cond_ = suspension.additional_cond_;
+  additional_cond_user_data_ = suspension.additional_cond_user_data_;
+  body_window_active_ = suspension.body_window_;
+}
+
+inline void Transaction::finishSuspension(const Suspension& suspension, bool result) {
+  // Same as processBodyWindow(), the caches that refer to the window are cleared
+  if (suspension.body_window_) {
+    finishBodyWindow();
+  }
+
+  process_result_ = suspension_ ? ProcessResult::Suspended
+                  : result    ? ProcessResult::Allow
+                              : ProcessResult::Deny;
+
+  // The result of the incremental body inspection is updated when the evaluation is finished
+  if (suspension_) {
+    suspension_->body_stream_ = suspension.body_stream_;
+  } else if (suspension.body_stream_) {
+    suspension.body_stream_->result_ = result;
+  }
+
+  // Reset the log callback and additional condition
+  log_callback_ = nullptr;
+  log_user_data_ = nullptr;
+  additional_cond_ = nullptr;
+  additional_cond_user_data_ = nullptr;
+}
+
+void Transaction::evaluateBatch(const Engine& engine, std::span<Transaction* const> transactions,
+                                RulePhaseType phase, std::vector<bool>& results) {
+  results.assign(transactions.size(), true);
+
+  struct BatchEntry {
+    Transaction* t_;
+    size_t result_index_;
+    Suspension suspension_;
+    PhaseEvaluation evaluation_;
+  };
+  std::vector<BatchEntry> entries;
+  entries.reserve(transactions.size());
+
+  // Start the evaluation of the transactions that are suspended in the phase
+  for (size_t i = 0; i < transactions.size(); ++i) {
+    Transaction* t = transactions[i];
+    if (!t || &t->engine_ != &engine || !t->suspension_ || t->suspension_->phase_ != phase)
+      [[unlikely]] { continue; }
+
+    auto& entry = entries.emplace_back(t, i, *t->suspension_);
+    t->suspension_.reset();
+    t->restoreSuspension(entry.suspension_);
+    if (!t->beginPhase(entry.evaluation_, phase, entry.suspension_.rule_index_))
+      [[unlikely]] {
+        t->finishSuspension(entry.suspension_, true);
+        entries.pop_back();
+      }
+  }
+
+  // Evaluate the rules one by one, and each rule is evaluated for all the transactions that reach
+  // it before the next rule, so the data of the rule stays in the CPU cache. The rules of each
+  // transaction are still evaluated in order, the transactions that skip the rule just wait until
+  // the outer loop reaches their next rule.
+  const std::vector<Rule>& rules = engine.rules(phase);
+  for (size_t rule_index = 0; rule_index < rules.size() && !entries.empty(); ++rule_index) {
+    for (size_t i = 0; i < entries.size();) {
+      auto& entry = entries[i];
+      std::optional<bool> result;
+      while (!result.has_value() && entry.evaluation_.next_index_ <= rule_index) {
+        result = entry.t_->evaluateNextRule(entry.evaluation_, rule_index);
+      }
+
+      if (!result.has_value())
+        [[likely]] {
+          ++i;
+          continue;
+        }
+
+      // The phase of the transaction is finished
+      results[entry.result_index_] = *result;
+      entry.t_->finishSuspension(entry.suspension_, *result);
+      entry = std::move(entries.back());
+      entries.pop_back();
+    }
+  }
+
+  // The rules after the last candidate are all skipped
+  for (auto& entry : entries) {
+    std::optional<bool> result;
+    while (!result.has_value()) {
+      result = entry.t_->evaluateNextRule(entry.evaluation_);
+    }
+    results[entry.result_index_] = *result;
+    entry.t_->finishSuspension(entry.suspension_, *result);
+  }
+}
+
+inline void Transaction::finishBodyWindow() {
+  body_window_active_ = false;
+  transform_cache_.clear();
+  libinjection_cache_.clear();
+  window_arena_.release();
+}
+
+bool Transaction::processBodyWindow(RulePhaseType phase, LogCallback log_callback,
+                                    void* log_user_data, AdditionalCondCallback additional_cond,
+                                    void* additional_cond_user_data) {
+  log_callback_ = log_callback;
+  log_user_data_ = log_user_data;
+  additional_cond_ = additional_cond;
+  additional_cond_user_data_ = additional_cond_user_data;
+
+  // The transform cache and the libinjection cache are keyed by the content of the data, and the
+  // stored keys and the results refer to the copies in the window arena while the window is
+  // evaluated. The window arena is released after the evaluation, so we must clear the caches
+  // before and after the evaluation.
+  transform_cache_.clear();
+  libinjection_cache_.clear();
+  body_window_active_ = true;
+
+  bool result = process(phase);
+
+  finishBodyWindow();
+
+  // Reset the log callback and additional condition
+  log_callback_ = nullptr;
+  log_user_data_ = nullptr;
+  additional_cond_ = nullptr;
+  additional_cond_user_data_ = nullptr;
+
+  return result;
+}
+
 void Transaction::setVariable(const std::string& ns, size_t index, const Common::Variant& value) {
   auto iter_ns = tx_variables_.find(ns);
   if (iter_ns != tx_variables_.end()) {
@@ -285,7 +813,15 @@ void Transaction::setVariable(const std::string& ns, size_t index, const Common:
     assert(index < variables.size());
     if (index < variables.size()) {
       assert(!IS_EMPTY_VARIANT(value));
-      variables[index] = value;
+      // The value may refer to the body window that will be released after the window is
+      // evaluated, so we need to copy it.
+      if (body_window_active_ && IS_STRING_VIEW_VARIANT(value))
+        [[unlikely]] {
+          variables[index] = internString(arena_, std::get<std::string_view>(value));
+        }
+      else {
+        variables[index] = value;
+      }
     }
   }
 }
@@ -619,6 +1155,19 @@ ParseXmlIntoArgsOption Transaction::getParseXmlIntoArgs() const {
   return parse_xml_into_args_.value_or(engine_.parseXmlIntoArgsOption());
 }
 
+AuditLogConfig::AuditEngine Transaction::getAuditEngine() const {
+  return audit_engine_.value_or(engine_.auditLogConfig().audit_engine_);
+}
+
+void Transaction::setAuditLogParts(bool add, AuditLogConfig::AuditLogParts parts) {
+  AuditLogConfig::AuditLogParts current = getAuditLogParts();
+  audit_log_parts_ = add ? current | parts : current & ~parts;
+}
+
+AuditLogConfig::AuditLogParts Transaction::getAuditLogParts() const {
+  return audit_log_parts_.value_or(engine_.auditLogConfig().log_parts_);
+}
+
 std::string_view Transaction::getUniqueId() const {
   // We doesn't generate the unique id in the constructor, because the rules may be not use the
   // unique id any more, so we generate the unique id when the unique id is needed.
@@ -641,84 +1190,244 @@ void Transaction::initUniqueId() const {
 }
 
 inline bool Transaction::process(RulePhaseType phase) {
+  // The public process methods have rejected the call while the evaluation is suspended
+  assert(!suspension_.has_value());
+
+  // Defer the evaluation to Engine::processBatch() or resume()
+  if (defer_evaluation_)
+    [[unlikely]] {
+      current_phase_ = phase;
+      suspension_.emplace(Suspension{phase, 0, log_callback_, log_user_data_, additional_cond_,
+                                     additional_cond_user_data_, body_window_active_, nullptr});
+      process_result_ = ProcessResult::Suspended;
+      return true;
+    }
+
+  process_result_ = evaluatePhase(phase, 0);
+  return process_result_ != ProcessResult::Deny;
+}
+
+inline bool Transaction::rejectWhileSuspended(std::string_view method) const {
+  if (!suspension_)
+    [[likely]] { return false; }
+
+  // The suspended evaluation and its result are kept, it's still continued by resume() or
+  // Engine::processBatch()
+  WGE_LOG_ERROR("the evaluation of phase {} is suspended, {} is rejected", suspension_->phase_,
+                method);
+  return true;
+}
+
+inline Transaction::ProcessResult Transaction::evaluatePhase(RulePhaseType phase,
+                                                             size_t rule_index) {
+  PhaseEvaluation evaluation;
+  if (!beginPhase(evaluation, phase, rule_index))
+    [[unlikely]] { return ProcessResult::Allow; }
+
+  // The budget of this call. Once it's exhausted, the evaluation is suspended at the rule boundary
+  const bool budget_enabled = process_budget_.enabled();
+  const std::chrono::steady_clock::time_point budget_start =
+      budget_enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  uint32_t evaluated_count = 0;
+
+  while (true) {
+    // Suspend the evaluation if the budget is exhausted. At least one rule is evaluated per call,
+    // so the evaluation always makes progress. The phase whose rules are all evaluated is finished
+    // rather than suspended.
+    if (budget_enabled && evaluated_count > 0 &&
+        evaluation.next_index_ < evaluation.rules_->size())
+      [[unlikely]] {
+        if ((process_budget_.rule_count_ != 0 && evaluated_count >= process_budget_.rule_count_) ||
+            (process_budget_.time_.count() != 0 &&
+             std::chrono::steady_clock::now() - budget_start >= process_budget_.time_)) {
+          WGE_LOG_TRACE("budget is exhausted, suspend phase {} at rule index {}", phase,
+                        evaluation.next_index_);
+          suspension_.emplace(Suspension{phase, evaluation.next_index_, log_callback_,
+                                         log_user_data_, additional_cond_,
+                                         additional_cond_user_data_, body_window_active_, nullptr});
+          return ProcessResult::Suspended;
+        }
+      }
+
+    std::optional<bool> result = evaluateNextRule(evaluation);
+    if (result.has_value())
+      [[unlikely]] { return *result ? ProcessResult::Allow : ProcessResult::Deny; }
+    evaluated_count += evaluation.evaluated_;
+  }
+}
+
+inline bool Transaction::beginPhase(PhaseEvaluation& evaluation, RulePhaseType phase,
+                                    size_t rule_index) {
   if (engine_.config().rule_engine_option_ == EngineConfig::Option::Off)
-    [[unlikely]] { return true; }
+    [[unlikely]] { return false; }
 
   current_phase_ = phase;
 
   // Skip the phase that is allowed
   if (allow_phases_.test(phase))
-    [[unlikely]] { return true; }
+    [[unlikely]] { return false; }
 
   // Get the rules in the given phase
-  auto& rules = engine_.rules(phase);
-  const Wge::Rule* default_action = engine_.defaultActions(phase);
-
-  // Traverse the rules and evaluate them
-  auto begin = rules.begin();
-  auto& rule_remove_flag = rule_remove_flags_[phase - 1];
-  for (auto iter = begin; iter != rules.end();) {
-    current_rule_ = &(*iter);
-
-    // Skip the rules that have been removed
-    assert(current_rule_->index() != -1);
-    if (!rule_remove_flag.empty() && rule_remove_flag[current_rule_->index()])
-      [[unlikely]] {
-        ++iter;
-        continue;
-      }
+  evaluation.phase_ = phase;
+  evaluation.rules_ = &engine_.rules(phase);
+  evaluation.default_action_ = engine_.defaultActions(phase);
+  evaluation.next_index_ = rule_index;
+
+  // The state of the prefilter is kept for the resumed evaluation
+  const RulePrefilter& prefilter = engine_.rulePrefilter(phase);
+  if (prefilter.enabled()) {
+    evaluation.prefilter_ = &prefilter;
+    if (rule_index == 0) {
+      prefilter.reset(prefilter_state_);
+    }
+  }
 
-    // Clean the current captured and matched, there are:
-    // TX.[0-99], MATCHED_VAR_NAME, MATCHED_VAR, MATCHED_VARS_NAMES, MATCHED_VARS
-    captured_.clear();
-    matched_variables_.clear();
+  const RuleInputFilter& input_filter = engine_.ruleInputFilter(phase);
+  if (input_filter.enabled())
+    [[likely]] {
+      evaluation.input_filter_ = &input_filter;
+      evaluation.present_inputs_ = RuleInputFilter::presentInputs(*this);
+    }
 
-    // Evaluate the rule
-    auto is_matched = current_rule_->evaluate(*this);
+  // The body is evaluated window by window in the stream mode
+  if (body_window_active_)
+    [[unlikely]] {
+      BodyStream& stream = phase == 2 ? request_body_stream_ : response_body_stream_;
+      stream.matched_rules_.resize(evaluation.rules_->size());
+      evaluation.body_stream_ = &stream;
+      evaluation.window_filter_ = &input_filter;
+    }
 
-    if (!is_matched || current_rule_->operators().empty())
-      [[likely]] {
-        ++iter;
-        continue;
-      }
+  evaluation.profile_enabled_ = engine_.isProfileEnabled();
+  if (evaluation.profile_enabled_)
+    [[unlikely]] { evaluation.phase_counters_ = engine_.profiler().phaseCounters(phase); }
 
-    // Log the matched rule
-    if (log_callback_)
-      [[likely]] {
-        if (current_rule_->log()) {
-          log_callback_(*current_rule_, log_user_data_);
-        }
+  return true;
+}
+
+inline std::optional<bool> Transaction::evaluateNextRule(PhaseEvaluation& evaluation,
+                                                         size_t max_index) {
+  const std::vector<Rule>& rules = *evaluation.rules_;
+  size_t index = evaluation.next_index_;
+  evaluation.evaluated_ = false;
+
+  // Jump over the rules whose input sources are all absent
+  if (evaluation.input_filter_)
+    [[likely]] {
+      index = evaluation.input_filter_->nextCandidate(evaluation.present_inputs_, index);
+    }
+  if (index >= rules.size())
+    [[unlikely]] {
+      evaluation.next_index_ = rules.size();
+      return true;
+    }
+
+  if (index > max_index)
+    [[unlikely]] {
+      evaluation.next_index_ = index;
+      return std::nullopt;
+    }
+
+  current_rule_ = &rules[index];
+  evaluation.next_index_ = index + 1;
+
+  // Skip the rules that have been removed
+  assert(current_rule_->index() != -1);
+  auto& rule_remove_flag = rule_remove_flags_[evaluation.phase_ - 1];
+  if (!rule_remove_flag.empty() && rule_remove_flag[current_rule_->index()])
+    [[unlikely]] { return std::nullopt; }
+
+  // Only the window rules are evaluated by the windows before the last one, and the other rules
+  // are evaluated once by the last window. The window rule that has been matched by a previous
+  // window is not evaluated again, so its actions are not repeated.
+  const bool window_rule =
+      evaluation.body_stream_ && evaluation.window_filter_->windowRule(index);
+  if (evaluation.body_stream_)
+    [[unlikely]] {
+      if (window_rule ? evaluation.body_stream_->matched_rules_[index]
+                      : !evaluation.body_stream_->end_stream_) {
+        return std::nullopt;
       }
+    }
 
-    // Do the disruptive action
-    if (engine_.config().rule_engine_option_ != EngineConfig::Option::DetectionOnly) {
-      std::optional<bool> disruptive = doDisruptive(*current_rule_, default_action);
-      if (disruptive.has_value()) {
-        if (!disruptive.value()) {
-          // Modify the response status code
-          response_line_info_.status_code_ = current_rule_->status();
-        }
-        return disruptive.value();
+  // Skip the rules that can't be matched according to the prefilter
+  if (evaluation.prefilter_ &&
+      !evaluation.prefilter_->isCandidate(*this, *current_rule_, prefilter_state_)) {
+    return std::nullopt;
+  }
+
+  evaluation.evaluated_ = true;
+
+  // Clean the current captured and matched, there are:
+  // TX.[0-99], MATCHED_VAR_NAME, MATCHED_VAR, MATCHED_VARS_NAMES, MATCHED_VARS
+  captured_.clear();
+  matched_variables_.clear();
+
+  // Evaluate the rule
+  uint64_t profile_start = 0;
+  if (evaluation.profile_enabled_)
+    [[unlikely]] {
+      profile_counters_ = &evaluation.phase_counters_[current_rule_->index()];
+      profile_start = RuleProfiler::now();
+    }
+  auto is_matched = current_rule_->evaluate(*this);
+  if (evaluation.profile_enabled_)
+    [[unlikely]] {
+      RuleProfiler::Counters::add(profile_counters_->evaluate_count_, 1);
+      RuleProfiler::Counters::add(profile_counters_->matched_count_, is_matched ? 1 : 0);
+      RuleProfiler::Counters::add(profile_counters_->total_ns_,
+                                  RuleProfiler::now() - profile_start);
+      profile_counters_ = nullptr;
+    }
+
+  if (!is_matched || current_rule_->operators().empty())
+    [[likely]] { return std::nullopt; }
+
+  // The rule that has a skip action is evaluated by each window to keep the flow
+  if (window_rule && current_rule_->skip() == 0)
+    [[unlikely]] { evaluation.body_stream_->matched_rules_[index] = true; }
+
+  // Log the matched rule
+  if (log_callback_)
+    [[likely]] {
+      if (current_rule_->log()) {
+        log_callback_(*current_rule_, log_user_data_);
       }
     }
 
-    // Skip the rules if current rule that has a skip action or skipAfter action is matched
-    int skip = current_rule_->skip();
-    if (skip > 0)
-      [[unlikely]] {
-        if (std::distance(iter, rules.end()) > skip + 1) {
-          iter += skip + 1;
-        } else {
-          iter = rules.end();
-        }
-        continue;
+  // Record the matched rule for the audit log. The macros are expanded now, since the variables
+  // that they refer to may be changed by the later rules.
+  if (engine_.auditLog())
+    [[unlikely]] {
+      if ((current_rule_->auditLog() || current_rule_->log()) && !current_rule_->noAuditLog()) {
+        std::string_view msg = current_rule_->msgMacro()
+                                   ? internString(arena_, getMsgMacroExpanded())
+                                   : current_rule_->msg();
+        std::string_view log_data = current_rule_->logDataMacro()
+                                        ? internString(arena_, getLogDataMacroExpanded())
+                                        : current_rule_->logData();
+        audit_messages_.emplace_back(current_rule_, msg, log_data);
       }
+    }
 
-    // If skip and skipAfter are not set, then continue to the next rule
-    ++iter;
+  // Do the disruptive action
+  if (engine_.config().rule_engine_option_ != EngineConfig::Option::DetectionOnly) {
+    std::optional<bool> disruptive = doDisruptive(*current_rule_, evaluation.default_action_);
+    if (disruptive.has_value()) {
+      if (!disruptive.value()) {
+        // Modify the response status code
+        response_line_info_.status_code_ = current_rule_->status();
+      }
+      return disruptive.value();
+    }
   }
 
-  return true;
+  // Skip the rules if current rule that has a skip action or skipAfter action is matched
+  int skip = current_rule_->skip();
+  if (skip > 0)
+    [[unlikely]] { evaluation.next_index_ = std::min(index + skip + 1, rules.size()); }
+
+  return std::nullopt;
 }
 
 inline std::optional<size_t> Transaction::getLocalVariableIndex(const std::string& ns,
@@ -776,11 +1485,8 @@ void Transaction::initCookies() const {
 
   cookies_.emplace();
 
-  // Get the cookies form the request headers
-  std::vector<std::string_view> result = extractor_.request_header_find_("cookie");
-
-  // Parse the cookies
-  for (auto& cookies : result) {
+  // Get the cookies form the request headers, and parse them
+  extractor_.request_headers_.find("cookie", [this](std::string_view cookies) {
     size_t begin = 0;
     size_t end = 0;
     while (end != std::string_view::npos) {
@@ -794,7 +1500,7 @@ void Transaction::initCookies() const {
       }
       begin = end + 1;
     }
-  }
+  });
 }
 
 inline std::optional<bool> Transaction::doDisruptive(const Rule& rule, const Rule* default_action) {
@@ -20,9 +20,13 @@
  */
 #pragma once
 
+#include <chrono>
+#include <cstring>
 #include <forward_list>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string_view>
 #include <unordered_map>
@@ -40,11 +44,15 @@
 #include "common/ragel/multi_part.h"
 #include "common/ragel/query_param.h"
 #include "common/ragel/xml.h"
+#include "common/tracked_resource.h"
 #include "common/variant.h"
 #include "config.h"
 #include "http_extractor.h"
 #include "macro/macro_base.h"
 #include "persistent_storage/storage.h"
+#include "rule_input_filter.h"
+#include "rule_prefilter.h"
+#include "rule_profiler.h"
 #include "variable/full_name.h"
 
 namespace Wge {
@@ -62,6 +70,8 @@ class TransformBase;
 
 class Transaction final {
   friend class Engine;
+  friend class TransactionPool;
+  friend class ReloadableEngine;
 
 protected:
   Transaction(const Engine& engin, std::shared_ptr<Common::PropertyStore> property_store);
@@ -97,6 +107,13 @@ public:
     std::string_view protocol_;
   };
 
+  // The matched rule that is recorded for the audit log
+  struct AuditMessage {
+    const Rule* rule_;
+    std::string_view msg_;
+    std::string_view log_data_;
+  };
+
   // For the MATCHED_VAR_NAME, MATCHED_VAR, MATCHED_VARS_NAMES, MATCHED_VARS
   struct MatchedVariable {
     // The matched variable
@@ -124,29 +141,77 @@ public:
           transform_list_(std::move(transform_list)) {}
   };
 
+  // The key of the transformation cache is addressed by the content of the input data rather than
+  // the address of it, so the same value that is reached through different variables (e.g. ARGS and
+  // ARGS_GET) or different string objects shares the transformed result. The transformation chain
+  // prefix is implied by the key, because the input of each transformation is the output of the
+  // previous one. The input of the stored key is copied into the arena of the transaction, because
+  // the input may be released or overwritten (e.g. the body window) while the cache is alive. The
+  // input that is already owned by the arena, such as the output of the previous transformation,
+  // is not copied again.
   struct TransformCacheKey {
     std::string_view input_data_view_;
     const char* transformation_name_;
+    size_t hash_;
 
     TransformCacheKey(std::string_view input_data_view, const char* transformation_name)
-        : input_data_view_(input_data_view), transformation_name_(transformation_name) {}
+        : input_data_view_(input_data_view), transformation_name_(transformation_name),
+          hash_(std::hash<std::string_view>()(input_data_view) ^
+                (std::hash<const char*>()(transformation_name) << 1)) {}
+
+    /**
+     * Get the key that is stored in the cache.
+     * @param t the transaction whose arena keeps the input.
+     * @return the key that has the same hash and refers to the input that is owned by the arena.
+     */
+    TransformCacheKey stored(Transaction& t) const {
+      TransformCacheKey key(*this);
+      if (!t.ownsString(input_data_view_)) {
+        key.input_data_view_ = t.internString(input_data_view_);
+      }
+      return key;
+    }
 
     bool operator==(const TransformCacheKey& other) const {
-      return input_data_view_.data() == other.input_data_view_.data() &&
-             input_data_view_.size() == other.input_data_view_.size() &&
-             transformation_name_ == other.transformation_name_;
-    }
+      if (hash_ != other.hash_ || transformation_name_ != other.transformation_name_ ||
+          input_data_view_.size() != other.input_data_view_.size()) {
+        return false;
+      }
 
-    friend size_t hash_value(const TransformCacheKey& key) {
-      return std::hash<const void*>()(key.input_data_view_.data()) ^
-             (std::hash<size_t>()(key.input_data_view_.size()) << 2) ^
-             (std::hash<const char*>()(key.transformation_name_) << 4);
+      return input_data_view_.data() == other.input_data_view_.data() ||
+             input_data_view_ == other.input_data_view_;
     }
+
+    friend size_t hash_value(const TransformCacheKey& key) { return key.hash_; }
+  };
+
+  struct TransformCacheStatistics {
+    uint64_t hit_count_{0};
+    uint64_t miss_count_{0};
   };
 
   using TransformCache =
       boost::unordered_flat_map<TransformCacheKey, std::optional<Common::EvaluateElement>>;
 
+  // The libinjection cache is keyed by the content of the value and the name of the operator, in
+  // the same way as the transformation cache, and the stored key refers to the value that is owned
+  // by the arena, which is usually the output of the transformation. The CRS checks the same
+  // values with the same transformations by several @detectSqli/@detectXSS rules, so they share
+  // one detection.
+  using LibinjectionCacheKey = TransformCacheKey;
+
+  struct LibinjectionResult {
+    bool detected_{false};
+    std::string_view fingerprint_;
+  };
+
+  struct LibinjectionCacheStatistics {
+    uint64_t hit_count_{0};
+    uint64_t miss_count_{0};
+  };
+
+  using LibinjectionCache = boost::unordered_flat_map<LibinjectionCacheKey, LibinjectionResult>;
+
   /**
    * The log callback
    * @param rule the reference to the matched rule.
@@ -209,6 +274,24 @@ public:
                              AdditionalCondCallback additional_cond = nullptr,
                              void* additional_cond_user_data = nullptr);
 
+  /**
+   * Process the request headers.
+   * Unlike the overload with the find and traversal functions, the headers are accessed directly
+   * without calling any function, and the lookups of the headers don't copy or allocate anything.
+   * @param request_headers the request headers, the keys must be lower case. The memory of the
+   * headers must be kept valid until the transaction is destroyed.
+   * @param log_callback the log callback. if the rule is matched, the log_callback will be called.
+   * @param log_user_data the user data pointer for the log callback.
+   * @param additional_cond an "AND" logic based on the original logic of the rule, only if both
+   * match successfully is the final result true.
+   * @param additional_cond_user_data the user data pointer for the additional condition callback.
+   * @return true if the request is safe, false otherwise that means need to deny the request.
+   */
+  bool processRequestHeaders(std::span<const Header> request_headers,
+                             LogCallback log_callback = nullptr, void* log_user_data = nullptr,
+                             AdditionalCondCallback additional_cond = nullptr,
+                             void* additional_cond_user_data = nullptr);
+
   /**
    * Process the request body.
    * @param body the request body.
@@ -246,6 +329,27 @@ public:
                               AdditionalCondCallback additional_cond = nullptr,
                               void* additional_cond_user_data = nullptr);
 
+  /**
+   * Process the response headers.
+   * Unlike the overload with the find and traversal functions, the headers are accessed directly
+   * without calling any function, and the lookups of the headers don't copy or allocate anything.
+   * @param status_code the status code of the response. E.g. 200
+   * @param protocol the protocol of the response. E.g. HTTP/1.1
+   * @param response_headers the response headers, the keys must be lower case. The memory of the
+   * headers must be kept valid until the transaction is destroyed.
+   * @param log_callback the log callback. if the rule is matched, the log_callback will be called.
+   * @param log_user_data the user data pointer for the log callback.
+   * @param additional_cond an "AND" logic based on the original logic of the rule, only if both
+   * match successfully is the final result true.
+   * @param additional_cond_user_data the user data pointer for the additional condition callback.
+   * @return true if the request is safe, false otherwise that means need to deny the request.
+   */
+  bool processResponseHeaders(std::string_view status_code, std::string_view protocol,
+                              std::span<const Header> response_headers,
+                              LogCallback log_callback = nullptr, void* log_user_data = nullptr,
+                              AdditionalCondCallback additional_cond = nullptr,
+                              void* additional_cond_user_data = nullptr);
+
   /**
    * Process the response body.
    * @param body the response body.
@@ -261,6 +365,130 @@ public:
                            AdditionalCondCallback additional_cond = nullptr,
                            void* additional_cond_user_data = nullptr);
 
+  /**
+   * Process the request body incrementally.
+   * The body can be fed chunk by chunk as it arrives, the caller doesn't need to buffer the whole
+   * body. The phase 2 rules that read the body are evaluated against each inspectable window of
+   * the body, so a malicious payload can be denied before the rest of the body is received. The
+   * other phase 2 rules are evaluated once by the last window. The tail of the previous window
+   * (SecBodyStreamOverlap) is prepended to the next window, so REQUEST_BODY matches the patterns
+   * that span the chunks.
+   * - UrlEncoded: the window ends at the last complete argument, the incomplete tail is carried
+   * over to the next chunk.
+   * - Json: the complete key-value pairs of the chunk are inspected, a key-value pair that spans
+   * multiple chunks is inspected once it is complete.
+   * - MultiPart and Xml: the chunks are buffered and inspected at the end of the stream.
+   * - UnknownFormat: each chunk is inspected as it is.
+   * The data that is held across the chunks is limited by SecRequestBodyInMemoryLimit, the
+   * REQBODY_ERROR is set and the rest of the body is ignored once it's exceeded.
+   * @param chunk the chunk of the request body. The memory of the chunk can be released after the
+   * call returns.
+   * @param end_stream indicates if this is the last chunk.
+   * @param log_callback the log callback. if the rule is matched, the log_callback will be called.
+   * @param log_user_data the user data pointer for the log callback.
+   * @param additional_cond an "AND" logic based on the original logic of the rule, only if both
+   * match successfully is the final result true.
+   * @param additional_cond_user_data the user data pointer for the additional condition callback.
+   * @return true if the request is safe, false otherwise that means need to deny the request.
+   * @note Don't mix this method with processRequestBody in the same transaction.
+   */
+  bool appendRequestBody(std::string_view chunk, bool end_stream,
+                         LogCallback log_callback = nullptr, void* log_user_data = nullptr,
+                         AdditionalCondCallback additional_cond = nullptr,
+                         void* additional_cond_user_data = nullptr);
+
+  /**
+   * Process the response body incrementally.
+   * The phase 4 rules that read the response body are evaluated against each chunk of the response
+   * body with the tail of the previous chunk, and the other phase 4 rules are evaluated once by the
+   * last chunk.
+   * @param chunk the chunk of the response body. The memory of the chunk can be released after the
+   * call returns.
+   * @param end_stream indicates if this is the last chunk.
+   * @param log_callback the log callback. if the rule is matched, the log_callback will be called.
+   * @param log_user_data the user data pointer for the log callback.
+   * @param additional_cond an "AND" logic based on the original logic of the rule, only if both
+   * match successfully is the final result true.
+   * @param additional_cond_user_data the user data pointer for the additional condition callback.
+   * @return true if the request is safe, false otherwise that means need to deny the request.
+   * @note Don't mix this method with processResponseBody in the same transaction.
+   */
+  bool appendResponseBody(std::string_view chunk, bool end_stream,
+                          LogCallback log_callback = nullptr, void* log_user_data = nullptr,
+                          AdditionalCondCallback additional_cond = nullptr,
+                          void* additional_cond_user_data = nullptr);
+
+  /**
+   * Process the logging of the transaction. It should be called once after the response is sent.
+   * If the transaction is relevant to the audit log, the selected parts of the transaction are
+   * serialized and handed over to the writer thread of the audit log. No file I/O is performed by
+   * the calling thread.
+   */
+  void processLogging();
+
+  /**
+   * The result of the rule evaluation of a phase.
+   */
+  enum class ProcessResult {
+    // The request is safe
+    Allow,
+    // The request needs to be denied
+    Deny,
+    // The evaluation is suspended and needs to be resumed, see setProcessBudget()
+    Suspended
+  };
+
+  /**
+   * Set the budget of the rule evaluation. Each call of the process methods and resume() has its
+   * own budget. If the budget is exhausted, the evaluation of the phase is suspended at the rule
+   * boundary, the method returns true, and processResult() returns ProcessResult::Suspended. Then
+   * the caller can serve the other requests, and call resume() later to continue the evaluation
+   * from the next rule.
+   * @param time_budget the maximum time of the rule evaluation per call. Zero means unlimited.
+   * @param rule_budget the maximum count of the evaluated rules per call. Zero means unlimited.
+   * @note a rule is never interrupted, and at least one rule is evaluated per call, so the
+   * evaluation always makes progress. The budget is cleared when the transaction is reused.
+   */
+  void setProcessBudget(std::chrono::nanoseconds time_budget, uint32_t rule_budget = 0) {
+    process_budget_.time_ = time_budget;
+    process_budget_.rule_count_ = rule_budget;
+  }
+
+  /**
+   * Check whether the evaluation of the current phase is suspended since the budget is exhausted.
+   * While it's suspended, the data passed to the suspended process method must be kept valid until
+   * the evaluation is resumed to the end. The process method that is called while it's suspended
+   * is a misuse and is rejected: it changes nothing, evaluates nothing, logs an error and returns
+   * false, and processResult() keeps returning ProcessResult::Suspended.
+   * @return true if the evaluation is suspended, false otherwise.
+   */
+  bool isSuspended() const { return suspension_.has_value(); }
+
+  /**
+   * Get the result of the last call of the process methods, resume() or Engine::processBatch().
+   * Unlike the returned value of the process methods, it tells the suspended evaluation apart from
+   * the safe request.
+   * @return the result of the last evaluation.
+   */
+  ProcessResult processResult() const { return process_result_; }
+
+  /**
+   * Resume the suspended evaluation of the current phase with a new budget. The callbacks that
+   * are passed to the suspended process method are used.
+   * @return the result of the evaluation, ProcessResult::Suspended if the evaluation is suspended
+   * again. ProcessResult::Allow if nothing is suspended.
+   */
+  ProcessResult resume();
+
+  /**
+   * Defer the rule evaluation of the process methods. If enabled, the process methods only prepare
+   * the data of the phase, and the evaluation is suspended before the first rule. Then the
+   * evaluation is done by Engine::processBatch() together with the other transactions, or by
+   * resume(). The deferral is cleared when the transaction is reused.
+   * @param value true to defer the evaluation, false to evaluate the rules in the process methods.
+   */
+  void deferEvaluation(bool value) { defer_evaluation_ = value; }
+
   // Http transaction data
 public:
   const HttpExtractor& httpExtractor() const { return extractor_; }
@@ -275,6 +503,17 @@ public:
   const Common::Ragel::Xml& getBodyXml() const { return body_xml_; }
   const Common::Ragel::Json& getBodyJson() const { return body_json_; }
   const std::string& getReqBodyErrorMsg() const { return req_body_error_msg_; }
+  bool getInboundDataError() const { return inbound_data_error_; }
+  bool getOutboundDataError() const { return outbound_data_error_; }
+
+  /**
+   * Get the status code of the response that should be sent if the transaction is rejected by the
+   * body limit, that is the body exceeds the limit and the SecRequestBodyLimitAction or the
+   * SecResponseBodyLimitAction is Reject.
+   * @return "413" for the request body, "500" for the response body. Empty if the transaction
+   * isn't rejected by the body limit.
+   */
+  std::string_view getBodyLimitStatus() const { return body_limit_status_; }
   const std::unordered_multimap<std::string_view, std::string_view>& getCookies() const {
     initCookies();
     return *cookies_;
@@ -566,6 +805,24 @@ public:
   std::string_view getReplyMacroExpanded();
 
   TransformCache& getTransformCache() { return transform_cache_; }
+  TransformCacheStatistics& getTransformCacheStatistics() { return transform_cache_statistics_; }
+  const TransformCacheStatistics& getTransformCacheStatistics() const {
+    return transform_cache_statistics_;
+  }
+
+  LibinjectionCache& getLibinjectionCache() { return libinjection_cache_; }
+  LibinjectionCacheStatistics& getLibinjectionCacheStatistics() {
+    return libinjection_cache_statistics_;
+  }
+  const LibinjectionCacheStatistics& getLibinjectionCacheStatistics() const {
+    return libinjection_cache_statistics_;
+  }
+
+  /**
+   * Get the profiling counters of the rule that is being evaluated.
+   * @return the counters if the profiling is enabled, and nullptr otherwise.
+   */
+  RuleProfiler::Counters* getProfileCounters() const { return profile_counters_; }
 
   std::string_view getPersistentStorageKey(PersistentStorage::Storage::Type type) const;
 
@@ -583,6 +840,11 @@ public:
   BodyProcessorType getRequestBodyProcessor() const { return *request_body_processor_; }
   void setParseXmlIntoArgs(ParseXmlIntoArgsOption option) { parse_xml_into_args_ = option; }
   ParseXmlIntoArgsOption getParseXmlIntoArgs() const;
+  void setAuditEngine(AuditLogConfig::AuditEngine option) { audit_engine_ = option; }
+  AuditLogConfig::AuditEngine getAuditEngine() const;
+  void setAuditLogParts(bool add, AuditLogConfig::AuditLogParts parts);
+  AuditLogConfig::AuditLogParts getAuditLogParts() const;
+  const std::vector<AuditMessage>& getAuditMessages() const { return audit_messages_; }
 
 public:
   std::string_view getUniqueId() const;
@@ -590,13 +852,45 @@ public:
   void* getAdditionalCondUserdata() const { return additional_cond_user_data_; }
 
   /**
-   * Intern a string into the string pool.
+   * Intern a string into the arena of the transaction.
    * @param str the string to be interned.
-   * @return the string view of the interned string.
+   * @return the string view of the interned string, it's valid until the transaction is destroyed
+   * or reset. If the string is interned during the evaluation of a body window in the stream mode,
+   * it's only valid until the window is evaluated. The interned string is null-terminated.
+   */
+  std::string_view internString(std::string_view str) {
+    return internString(body_window_active_ ? window_arena_ : arena_, str);
+  }
+
+  /**
+   * Check whether the string is owned by the arenas of the transaction. The owned string is never
+   * overwritten, and it's valid as long as the caches of the transaction that may refer to it.
+   * @param str the string to be checked.
+   * @return true if the string is empty or owned by the arenas, false otherwise.
+   */
+  bool ownsString(std::string_view str) const {
+    if (str.empty()) {
+      return true;
+    }
+
+    const std::byte* data = reinterpret_cast<const std::byte*>(str.data());
+    const std::byte* initial_buffer = arena_initial_buffer_.get();
+    if (std::less_equal<const std::byte*>()(initial_buffer, data) &&
+        std::less_equal<const std::byte*>()(data + str.size(),
+                                            initial_buffer + arena_initial_size_)) {
+      return true;
+    }
+
+    return arena_upstream_.owns(data, str.size()) || window_arena_upstream_.owns(data, str.size());
+  }
+
+  /**
+   * Get the size of the memory that the arenas of the transaction allocate beyond the initial
+   * buffer.
+   * @return the size in bytes.
    */
-  std::string_view internString(std::string&& str) {
-    string_pool_.emplace_front(std::move(str));
-    return string_pool_.front();
+  size_t arenaAllocatedSize() const {
+    return arena_upstream_.allocatedSize() + window_arena_upstream_.allocatedSize();
   }
 
   const Common::PropertyTree* propertyTree() {
@@ -607,13 +901,107 @@ public:
   }
 
 private:
+  /**
+   * Reset the transaction to the initial state so that it can be reused by another request.
+   * The allocated memory of the containers is kept to avoid the allocation churn.
+   * @param property_store the property store snapshot of the new request.
+   */
+  void reset(std::shared_ptr<Common::PropertyStore> property_store);
   void initUniqueId() const;
   inline bool process(RulePhaseType phase);
+
+  // Reject the process method that is called while the evaluation is suspended. It must be checked
+  // before the process method changes anything, since the suspended evaluation uses the data.
+  inline bool rejectWhileSuspended(std::string_view method) const;
+
+  static std::string_view internString(std::pmr::monotonic_buffer_resource& arena,
+                                       std::string_view str) {
+    char* buffer = static_cast<char*>(arena.allocate(str.size() + 1, alignof(char)));
+    std::memcpy(buffer, str.data(), str.size());
+    buffer[str.size()] = '\0';
+    return {buffer, str.size()};
+  }
+
+  struct BodyStream;
+
+  // The state of the rule evaluation of a phase
+  struct PhaseEvaluation {
+    RulePhaseType phase_{0};
+    const std::vector<Rule>* rules_{nullptr};
+    const Rule* default_action_{nullptr};
+
+    // nullptr if the prefilter or the input filter is disabled
+    const RulePrefilter* prefilter_{nullptr};
+    const RuleInputFilter* input_filter_{nullptr};
+    RuleInputFilter::Inputs present_inputs_{0};
+
+    bool profile_enabled_{false};
+    RuleProfiler::PhaseCounters phase_counters_{nullptr};
+
+    // Not null if the body is evaluated window by window
+    BodyStream* body_stream_{nullptr};
+    const RuleInputFilter* window_filter_{nullptr};
+
+    // The index of the next rule to evaluate
+    size_t next_index_{0};
+
+    // Whether the last step evaluated a rule rather than skipped it
+    bool evaluated_{false};
+  };
+
+  /**
+   * Evaluate the rules of the phase from the specified rule.
+   * @param phase the phase to evaluate.
+   * @param rule_index the index of the first rule to evaluate. Nonzero if the evaluation is
+   * resumed.
+   * @return the result of the evaluation.
+   */
+  inline ProcessResult evaluatePhase(RulePhaseType phase, size_t rule_index);
+
+  /**
+   * Prepare the evaluation of the phase.
+   * @return false if the rules of the phase don't need to be evaluated, true otherwise.
+   */
+  inline bool beginPhase(PhaseEvaluation& evaluation, RulePhaseType phase, size_t rule_index);
+
+  /**
+   * Evaluate the next candidate rule of the phase.
+   * @param max_index the candidate rule whose index is greater than it is not evaluated, the next
+   * index is just moved to it.
+   * @return the result of the phase if the phase is finished, that is all the rules are evaluated
+   * or a disruptive action is done. Otherwise nullopt.
+   */
+  inline std::optional<bool>
+  evaluateNextRule(PhaseEvaluation& evaluation,
+                   size_t max_index = std::numeric_limits<size_t>::max());
+
+  /**
+   * Evaluate the suspended phase of the transactions rule by rule.
+   * @see Engine::processBatch()
+   */
+  static void evaluateBatch(const Engine& engine, std::span<Transaction* const> transactions,
+                            RulePhaseType phase, std::vector<bool>& results);
   inline std::optional<size_t> getLocalVariableIndex(const std::string& ns,
                                                      const std::string& key) const;
   inline size_t getOrCreateLocalVariableIndex(const std::string& ns, const std::string& key);
   void initCookies() const;
   inline std::optional<bool> doDisruptive(const Rule& rule, const Rule* default_action);
+  bool limitRequestBody(std::string_view& body, uint64_t offset);
+  bool limitResponseBody(std::string_view& body, uint64_t offset);
+  bool processRequestHeadersPhase(LogCallback log_callback, void* log_user_data,
+                                  AdditionalCondCallback additional_cond,
+                                  void* additional_cond_user_data);
+  bool processResponseHeadersPhase(std::string_view status_code, std::string_view protocol,
+                                   LogCallback log_callback, void* log_user_data,
+                                   AdditionalCondCallback additional_cond,
+                                   void* additional_cond_user_data);
+  bool processBodyWindow(RulePhaseType phase, LogCallback log_callback, void* log_user_data,
+                         AdditionalCondCallback additional_cond, void* additional_cond_user_data);
+
+  // Keeps the engine of the hot reload alive until the transaction is destroyed. It's the first
+  // member, so it's destroyed after all of the other members that may refer to the engine.
+private:
+  std::shared_ptr<const Engine> engine_holder_;
 
   // Http transaction data
 private:
@@ -629,8 +1017,106 @@ private:
   Common::Ragel::Xml body_xml_;
   Common::Ragel::Json body_json_;
   std::string req_body_error_msg_;
+  bool inbound_data_error_{false};
+  bool outbound_data_error_{false};
+  std::string_view body_limit_status_;
   mutable std::optional<std::unordered_multimap<std::string_view, std::string_view>> cookies_;
 
+  // The state of the incremental body inspection
+  struct BodyStream {
+    // The incomplete tail of the previous chunk that will be prepended to the next chunk
+    std::string carry_;
+
+    // The tail of the previous window that will be prepended to the next window, so that the
+    // patterns that span the chunks can be matched
+    std::string overlap_;
+
+    // The window that is being inspected
+    std::string window_;
+
+    // The buffered chunks of the body processors that don't support the stream mode
+    std::string buffered_;
+
+    // The decoded strings of the current window
+    std::pmr::forward_list<std::pmr::string> decode_buffer_;
+
+    // The size of the received chunks, it's used to enforce the body limit
+    uint64_t received_size_{0};
+
+    // The count of the arguments that have been parsed, it's used to enforce the arguments limit
+    size_t arg_count_{0};
+
+    // The window rules that have been matched by the previous windows, they are not evaluated
+    // again by the rest of the windows
+    std::vector<bool> matched_rules_;
+
+    bool end_stream_{false};
+    bool result_{true};
+
+    /**
+     * Join the overlap and the data of the current window.
+     * @param data the data of the current window.
+     * @param overlap_size the max size of the overlap of the next window.
+     * @return the window that is valid until the next call. The overlap is updated to the tail of
+     * it.
+     */
+    std::string_view join(std::string_view data, size_t overlap_size);
+
+    void clear() {
+      carry_.clear();
+      overlap_.clear();
+      window_.clear();
+      buffered_.clear();
+      decode_buffer_.clear();
+      received_size_ = 0;
+      arg_count_ = 0;
+      matched_rules_.clear();
+      end_stream_ = false;
+      result_ = true;
+    }
+  };
+  BodyStream request_body_stream_;
+  BodyStream response_body_stream_;
+
+  // Indicates that the body is evaluated window by window, and the string views of the body will be
+  // invalid after the window is evaluated.
+  bool body_window_active_{false};
+
+  // The budget of the rule evaluation per call
+  struct ProcessBudget {
+    std::chrono::nanoseconds time_{0};
+    uint32_t rule_count_{0};
+
+    bool enabled() const { return time_.count() != 0 || rule_count_ != 0; }
+  };
+  ProcessBudget process_budget_;
+  bool defer_evaluation_{false};
+
+  // The state of the suspended evaluation, it's used to resume the evaluation from the next rule
+  struct Suspension {
+    RulePhaseType phase_;
+    size_t rule_index_;
+    LogCallback log_callback_;
+    void* log_user_data_;
+    AdditionalCondCallback additional_cond_;
+    void* additional_cond_user_data_;
+    bool body_window_;
+
+    // The incremental body inspection whose result is updated by the resumed evaluation
+    BodyStream* body_stream_;
+  };
+  std::optional<Suspension> suspension_;
+  ProcessResult process_result_{ProcessResult::Allow};
+
+  // Finish the evaluation of a body window, the caches and the interned strings that refer to the
+  // window are released.
+  inline void finishBodyWindow();
+
+  // Restore the state of the suspended evaluation before it's resumed, and finish the suspension
+  // with the result after it's resumed.
+  inline void restoreSuspension(const Suspension& suspension);
+  inline void finishSuspension(const Suspension& suspension, bool result);
+
   // Current evaluation state
 private:
   const Engine& engine_;
@@ -668,16 +1154,24 @@ private:
       rule_remove_targets_;
 
   TransformCache transform_cache_;
+  TransformCacheStatistics transform_cache_statistics_;
+  LibinjectionCache libinjection_cache_;
+  LibinjectionCacheStatistics libinjection_cache_statistics_;
   std::bitset<PHASE_TOTAL> allow_phases_;
+  RulePrefilter::State prefilter_state_;
+  RuleProfiler::Counters* profile_counters_{nullptr};
 
   std::array<std::variant<std::monostate, std::string, const Macro::MacroBase*>,
              static_cast<size_t>(PersistentStorage::Storage::Type::SizeOfType)>
       persistent_storage_keys_;
 
+  // The matched rules that are recorded only if the audit log is enabled
+  std::vector<AuditMessage> audit_messages_;
+
   // Configuration options by ctl action
 private:
   std::optional<AuditLogConfig::AuditEngine> audit_engine_;
-  std::optional<AuditLogConfig::AuditLogPart> audit_log_part_;
+  std::optional<AuditLogConfig::AuditLogParts> audit_log_parts_;
   std::optional<EngineConfig::Option> request_body_access_;
   std::optional<BodyProcessorType> request_body_processor_;
   std::optional<ParseXmlIntoArgsOption> parse_xml_into_args_;
@@ -689,7 +1183,23 @@ private:
   void* log_user_data_;
   AdditionalCondCallback additional_cond_;
   void* additional_cond_user_data_;
-  std::forward_list<std::string> string_pool_;
+
+  // The transient strings of the transaction, such as the transformed values and the decoded
+  // arguments, are allocated from the arena and released in one shot when the transaction is
+  // destroyed or reset. The initial buffer is kept by the reset, so the recycled transaction
+  // doesn't allocate until the initial buffer is exhausted.
+  // The upstream resources of the arenas remember the blocks of the arenas, see ownsString(). Most
+  // of the requests don't exhaust the initial buffer.
+  static constexpr size_t arena_initial_size_ = 16 * 1024;
+  std::unique_ptr<std::byte[]> arena_initial_buffer_;
+  Common::TrackedResource arena_upstream_;
+  std::pmr::monotonic_buffer_resource arena_;
+  std::pmr::forward_list<std::pmr::string> string_pool_;
+
+  // The strings that are interned during the evaluation of a body window, it's released after each
+  // window so that the memory is bounded by the window rather than the whole body
+  Common::TrackedResource window_arena_upstream_;
+  std::pmr::monotonic_buffer_resource window_arena_;
   std::shared_ptr<Common::PropertyStore> property_store_;
 };
 
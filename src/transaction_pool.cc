@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "transaction_pool.h"
+
+#include <algorithm>
+
+#include "common/assert.h"
+#include "engine.h"
+
+namespace Wge {
+TransactionPool::TransactionPool(const Engine& engine, size_t max_idle_size)
+    : engine_(engine), max_idle_size_(max_idle_size) {
+  idle_.reserve(max_idle_size_);
+#ifndef NDEBUG
+  owner_thread_id_ = std::this_thread::get_id();
+#endif
+}
+
+TransactionPool::Ptr TransactionPool::acquire() {
+  assert(owner_thread_id_ == std::this_thread::get_id());
+
+  if (idle_.empty())
+    [[unlikely]] { return Ptr(engine_.makeTransaction().release(), Recycler(this)); }
+
+  TransactionPtr t = std::move(idle_.back());
+  idle_.pop_back();
+
+  // Each transaction has its own property store snapshot
+  t->property_store_ = engine_.property_store_.load();
+  return Ptr(t.release(), Recycler(this));
+}
+
+void TransactionPool::reserve(size_t size) {
+  assert(owner_thread_id_ == std::this_thread::get_id());
+
+  size = std::min(size, max_idle_size_);
+  while (idle_.size() < size) {
+    idle_.emplace_back(engine_.makeTransaction());
+  }
+}
+
+void TransactionPool::release(Transaction* t) {
+  assert(owner_thread_id_ == std::this_thread::get_id());
+
+  TransactionPtr holder(t);
+  if (idle_.size() < max_idle_size_)
+    [[likely]] {
+      // Reset the transaction as soon as it's released, so that the idle transaction doesn't hold
+      // the memory of the strings and the property store snapshot of the previous request.
+      holder->reset(nullptr);
+      idle_.emplace_back(std::move(holder));
+    }
+}
+
+void TransactionPool::Recycler::operator()(Transaction* t) const {
+  if (pool_)
+    [[likely]] { pool_->release(t); }
+  else {
+    delete t;
+  }
+}
+} // namespace Wge
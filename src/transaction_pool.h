@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#ifndef NDEBUG
+#include <thread>
+#endif
+
+#include "transaction.h"
+
+namespace Wge {
+class Engine;
+
+/**
+ * The transaction pool recycles the transactions instead of constructing a new one for each
+ * request. A recycled transaction is reset to the initial state but keeps the memory of its
+ * containers, so the steady state of the worker thread doesn't allocate for the transaction itself.
+ * The pool isn't thread-safe, each worker thread should own a pool.
+ * @note The pool must outlive all of the transactions that it made, and the engine must outlive the
+ * pool.
+ */
+class TransactionPool final {
+public:
+  /**
+   * Construct the transaction pool
+   * @param engine the initialized engine that makes the transactions.
+   * @param max_idle_size the max count of the idle transactions that are kept by the pool. The
+   * transactions that are released when the pool is full will be destroyed.
+   */
+  TransactionPool(const Engine& engine, size_t max_idle_size = 64);
+
+  TransactionPool(const TransactionPool&) = delete;
+  TransactionPool& operator=(const TransactionPool&) = delete;
+
+public:
+  // Returns the transaction to the pool rather than deleting it.
+  class Recycler {
+  public:
+    Recycler(TransactionPool* pool = nullptr) : pool_(pool) {}
+    void operator()(Transaction* t) const;
+
+  private:
+    TransactionPool* pool_;
+  };
+
+  using Ptr = std::unique_ptr<Transaction, Recycler>;
+
+public:
+  /**
+   * Acquire a transaction from the pool. If there is no idle transaction, a new one will be made.
+   * @return pointer of transaction, the transaction will be returned to the pool when the pointer
+   * is destroyed.
+   */
+  Ptr acquire();
+
+  /**
+   * Make the pool holds the specified count of idle transactions in advance.
+   * @param size the count of the idle transactions. it's limited by the max_idle_size.
+   */
+  void reserve(size_t size);
+
+  /**
+   * @return the count of the idle transactions.
+   */
+  size_t idleSize() const { return idle_.size(); }
+
+private:
+  void release(Transaction* t);
+
+private:
+  const Engine& engine_;
+  size_t max_idle_size_;
+  std::vector<TransactionPtr> idle_;
+
+#ifndef NDEBUG
+  std::thread::id owner_thread_id_;
+#endif
+};
+} // namespace Wge
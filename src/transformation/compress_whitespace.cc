@@ -20,12 +20,65 @@
  */
 #include "compress_whitespace.h"
 
+#include <cstring>
+
 #include <compress_whitespace.h>
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
+namespace {
+// Find the first whitespace that will be changed: a whitespace other than the space, or a space
+// that is followed by another whitespace.
+size_t findCompressible(std::string_view data) {
+  size_t offset = 0;
+  while (true) {
+    size_t pos = Common::Simd::findWhitespace(data.substr(offset), true);
+    if (pos == std::string_view::npos) {
+      return pos;
+    }
+
+    pos += offset;
+    if (data[pos] != ' ' ||
+        (pos + 1 < data.size() && Common::Simd::isWhitespace(data[pos + 1], true))) {
+      return pos;
+    }
+    offset = pos + 1;
+  }
+}
+} // namespace
+
 bool CompressWhiteSpace::evaluate(std::string_view data, std::string& result) const {
-  return compressWhitespace(data, result);
+  result.clear();
+  size_t pos = findCompressible(data);
+  if (pos == std::string_view::npos) {
+    return false;
+  }
+
+  // Copy the chunks between the whitespaces, and a run of the whitespaces is replaced by one space
+  result.resize(data.size());
+  char* r = result.data();
+  while (pos != std::string_view::npos) {
+    ::memcpy(r, data.data(), pos);
+    r += pos;
+    *r++ = ' ';
+    ++pos;
+    while (pos < data.size() && Common::Simd::isWhitespace(data[pos], true)) {
+      ++pos;
+    }
+    data.remove_prefix(pos);
+    pos = Common::Simd::findWhitespace(data, true);
+  }
+  ::memcpy(r, data.data(), data.size());
+  r += data.size();
+
+  result.resize(r - result.data());
+  return true;
+}
+
+bool CompressWhiteSpace::mayChange(std::string_view data) const {
+  return findCompressible(data) != std::string_view::npos;
 }
 
 std::unique_ptr<StreamState, std::function<void(StreamState*)>>
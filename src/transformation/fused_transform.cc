@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "fused_transform.h"
+
+#include <array>
+
+#include "compress_whitespace.h"
+#include "lowercase.h"
+#include "remove_nulls.h"
+#include "remove_whitespace.h"
+#include "replace_nulls.h"
+
+namespace Wge {
+namespace Transformation {
+namespace {
+// The whitespace of the removeWhitespace and compressWhitespace: [ \f\t\n\r\v] | 0xA0
+constexpr std::array<bool, 256> whitespace_table = []() {
+  std::array<bool, 256> table{};
+  for (unsigned char c : {' ', '\f', '\t', '\n', '\r', '\v'}) {
+    table[c] = true;
+  }
+  table[0xA0] = true;
+  return table;
+}();
+} // namespace
+
+std::unordered_set<std::string> FusedTransform::name_pool_;
+std::mutex FusedTransform::name_pool_mutex_;
+
+std::vector<const TransformBase*>
+FusedTransform::fuse(const std::vector<const TransformBase*>& transforms,
+                     std::vector<std::unique_ptr<TransformBase>>& fused_transforms) {
+  ASSERT_IS_MAIN_THREAD();
+
+  std::vector<const TransformBase*> result;
+  std::vector<const TransformBase*> run;
+  std::vector<Kernel> run_kernels;
+  bool fused = false;
+
+  auto flush_run = [&]() {
+    if (run.size() >= 2) {
+      fused_transforms.emplace_back(new FusedTransform(std::move(run), std::move(run_kernels)));
+      result.emplace_back(fused_transforms.back().get());
+      fused = true;
+    } else {
+      result.insert(result.end(), run.begin(), run.end());
+    }
+    run.clear();
+    run_kernels.clear();
+  };
+
+  for (auto transform : transforms) {
+    auto kernel = kernelOf(transform);
+    if (!kernel) {
+      flush_run();
+      result.emplace_back(transform);
+      continue;
+    }
+
+    run.emplace_back(transform);
+    run_kernels.emplace_back(*kernel);
+    if (run.size() == max_fused_size_) {
+      flush_run();
+    }
+  }
+  flush_run();
+
+  if (!fused) {
+    result.clear();
+  }
+
+  return result;
+}
+
+bool FusedTransform::evaluate(std::string_view data, std::string& result) const {
+  result.resize(data.size());
+  char* r = result.data();
+  bool changed = false;
+
+  // The run state of the kernels that collapse a run of bytes into one byte. Indicates whether the
+  // previous byte that the kernel received belongs to the run.
+  std::array<bool, max_fused_size_> in_run{};
+
+  const size_t kernel_size = kernels_.size();
+  for (char c : data) {
+    bool keep = true;
+    for (size_t i = 0; i < kernel_size && keep; ++i) {
+      switch (kernels_[i]) {
+      case Kernel::LowerCase:
+        if (c >= 'A' && c <= 'Z') {
+          c += 32;
+          changed = true;
+        }
+        break;
+      case Kernel::RemoveNulls:
+        if (c == '\0') {
+          keep = false;
+          changed = true;
+        }
+        break;
+      case Kernel::ReplaceNulls:
+        if (c == '\0') {
+          changed = true;
+          if (in_run[i]) {
+            keep = false;
+          } else {
+            c = ' ';
+            in_run[i] = true;
+          }
+        } else {
+          in_run[i] = false;
+        }
+        break;
+      case Kernel::RemoveWhitespace:
+        if (whitespace_table[static_cast<unsigned char>(c)]) {
+          keep = false;
+          changed = true;
+        }
+        break;
+      case Kernel::CompressWhitespace:
+        if (whitespace_table[static_cast<unsigned char>(c)]) {
+          if (in_run[i]) {
+            keep = false;
+            changed = true;
+          } else {
+            if (c != ' ') {
+              c = ' ';
+              changed = true;
+            }
+            in_run[i] = true;
+          }
+        } else {
+          in_run[i] = false;
+        }
+        break;
+      default:
+        UNREACHABLE();
+        break;
+      }
+    }
+
+    if (keep) {
+      *r++ = c;
+    }
+  }
+
+  if (!changed) {
+    result.clear();
+    return false;
+  }
+
+  result.resize(r - result.data());
+  return true;
+}
+
+bool FusedTransform::mayChange(std::string_view data) const {
+  // Each transformation receives the original data if none of the previous ones changes it
+  for (auto transform : transforms_) {
+    if (transform->mayChange(data)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+FusedTransform::FusedTransform(std::vector<const TransformBase*>&& transforms,
+                               std::vector<Kernel>&& kernels)
+    : transforms_(std::move(transforms)), kernels_(std::move(kernels)) {
+  assert(transforms_.size() == kernels_.size());
+  assert(kernels_.size() <= max_fused_size_);
+
+  std::string name;
+  for (auto transform : transforms_) {
+    if (!name.empty()) {
+      name += ',';
+    }
+    name += transform->name();
+  }
+  std::lock_guard<std::mutex> lock(name_pool_mutex_);
+  name_ = name_pool_.emplace(std::move(name)).first->c_str();
+}
+
+std::optional<FusedTransform::Kernel> FusedTransform::kernelOf(const TransformBase* transform) {
+  if (dynamic_cast<const LowerCase*>(transform)) {
+    return Kernel::LowerCase;
+  } else if (dynamic_cast<const RemoveNulls*>(transform)) {
+    return Kernel::RemoveNulls;
+  } else if (dynamic_cast<const ReplaceNulls*>(transform)) {
+    return Kernel::ReplaceNulls;
+  } else if (dynamic_cast<const RemoveWhitespace*>(transform)) {
+    return Kernel::RemoveWhitespace;
+  } else if (dynamic_cast<const CompressWhiteSpace*>(transform)) {
+    return Kernel::CompressWhitespace;
+  }
+
+  return std::nullopt;
+}
+} // namespace Transformation
+} // namespace Wge
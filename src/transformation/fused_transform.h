@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "transform_base.h"
+
+namespace Wge {
+namespace Transformation {
+/**
+ * The fused transformation evaluates a run of the byte-wise transformations (e.g.
+ * t:lowercase,t:removeNulls,t:compressWhitespace) in a single pass. Each byte of the input flows
+ * through the kernels of the transformations one by one, so the input is walked once, only one
+ * output buffer is written and only one cache entry is made, instead of one of each per step.
+ * The result is the same as evaluating the transformations step by step.
+ */
+class FusedTransform final : public TransformBase {
+public:
+  /**
+   * Fuse the transformation chain.
+   * The runs of the consecutive byte-wise transformations in the chain are replaced by the fused
+   * transformations, and the other transformations are kept as is.
+   * @param transforms the transformation chain.
+   * @param fused_transforms the fused transformations that are made will be stored in it, and the
+   * caller should keep them alive as long as the returned chain is used.
+   * @return the fused transformation chain. Empty if nothing is fused.
+   */
+  static std::vector<const TransformBase*>
+  fuse(const std::vector<const TransformBase*>& transforms,
+       std::vector<std::unique_ptr<TransformBase>>& fused_transforms);
+
+public:
+  const char* name() const override { return name_; }
+  bool evaluate(std::string_view data, std::string& result) const override;
+  bool mayChange(std::string_view data) const override;
+
+  /**
+   * Get the transformations that are fused.
+   * @return the transformations in the order of evaluation.
+   */
+  const std::vector<const TransformBase*>& transforms() const { return transforms_; }
+
+private:
+  enum class Kernel : uint8_t {
+    LowerCase,
+    RemoveNulls,
+    ReplaceNulls,
+    RemoveWhitespace,
+    CompressWhitespace,
+  };
+
+  FusedTransform(std::vector<const TransformBase*>&& transforms, std::vector<Kernel>&& kernels);
+
+  static std::optional<Kernel> kernelOf(const TransformBase* transform);
+
+private:
+  // The max count of the transformations that are fused into one
+  static constexpr size_t max_fused_size_ = 16;
+
+  // The name is joined by the names of the transformations. The same chain shares the same name
+  // pointer, so that the results are shared in the transformation cache.
+  const char* name_;
+  std::vector<const TransformBase*> transforms_;
+  std::vector<Kernel> kernels_;
+
+  // The names are shared by the engines, and the engine of the hot reload is built by the builder
+  // thread while the main thread may build another engine, so the pool is guarded by the mutex.
+  static std::unordered_set<std::string> name_pool_;
+  static std::mutex name_pool_mutex_;
+};
+} // namespace Transformation
+} // namespace Wge
@@ -25,6 +25,7 @@
 #include "transform_base.h"
 
 #include "../common/empty_string.h"
+#include "../common/simd/byte_kernel.h"
 
 namespace Wge {
 namespace Transformation {
@@ -37,17 +38,10 @@ public:
 
     // To hex string
     result.resize(data.length() * 2);
-    char* pr = result.data();
-    for (size_t i = 0; i < data.length(); ++i) {
-      pr[i * 2] = hex_table_[*(data.data() + i) >> 4];
-      pr[i * 2 + 1] = hex_table_[*(data.data() + i) & 0x0f];
-    }
+    Common::Simd::hexEncode(data.data(), data.length(), result.data());
 
     return true;
   }
-
-private:
-  static constexpr std::string_view hex_table_{"0123456789abcdef"};
 };
 } // namespace Transformation
 } // namespace Wge
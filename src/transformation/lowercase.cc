@@ -20,12 +20,29 @@
  */
 #include "lowercase.h"
 
+#include <cstring>
+
 #include <lowercase.h>
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 bool LowerCase::evaluate(std::string_view data, std::string& result) const {
-  return lowercase(data, result);
+  result.clear();
+  size_t pos = Common::Simd::findInRange(data, 'A', 'Z');
+  if (pos == std::string_view::npos) {
+    return false;
+  }
+
+  result.resize(data.size());
+  ::memcpy(result.data(), data.data(), pos);
+  Common::Simd::flipCase(data.data() + pos, data.size() - pos, result.data() + pos, 'A', 'Z');
+  return true;
+}
+
+bool LowerCase::mayChange(std::string_view data) const {
+  return Common::Simd::findInRange(data, 'A', 'Z') != std::string_view::npos;
 }
 
 std::unique_ptr<StreamState, std::function<void(StreamState*)>> LowerCase::newStream() const {
@@ -24,6 +24,8 @@
 
 #include "transform_base.h"
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 class ParityOdd7Bit final : public TransformBase {
@@ -31,8 +33,14 @@ class ParityOdd7Bit final : public TransformBase {
 
 public:
   bool evaluate(std::string_view data, std::string& result) const override {
-    assert(false);
-    throw "Not implemted!";
+    result.resize(data.size());
+    if (!Common::Simd::parity7Bit(data.data(), data.size(), result.data(),
+                                  Common::Simd::Parity::Odd)) {
+      result.clear();
+      return false;
+    }
+
+    return true;
   }
 };
 } // namespace Transformation
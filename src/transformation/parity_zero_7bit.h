@@ -24,6 +24,8 @@
 
 #include "transform_base.h"
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 class ParityZero7Bit final : public TransformBase {
@@ -31,8 +33,18 @@ class ParityZero7Bit final : public TransformBase {
 
 public:
   bool evaluate(std::string_view data, std::string& result) const override {
-    assert(false);
-    throw "Not implemted!";
+    result.resize(data.size());
+    if (!Common::Simd::parity7Bit(data.data(), data.size(), result.data(),
+                                  Common::Simd::Parity::Zero)) {
+      result.clear();
+      return false;
+    }
+
+    return true;
+  }
+
+  bool mayChange(std::string_view data) const override {
+    return Common::Simd::findInRange(data, 0x80, 0xff) != std::string_view::npos;
   }
 };
 } // namespace Transformation
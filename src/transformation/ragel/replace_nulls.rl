@@ -26,62 +26,6 @@
 #include "src/transformation/stream_util.h"
 
 // Replaces NUL bytes in input with space characters (ASCII 0x20).
-// clang-format off
-%%{
-  machine replace_nulls;
-  
-  action skip {}
-
-  action exec_transformation { 
-    result.resize(input.size());
-    r = result.data();
-    if(ts > input.data()){
-      memcpy(r, input.data(), ts - input.data());
-      r += ts - input.data();
-    }
-    p = ts;
-    fhold;
-    fgoto transformation;
-  }
-
-  # prescan
-  main := |*
-    0x00 => exec_transformation;
-    any => skip;
-  *|;
-  
-  transformation := |*
-    0x00+ => {*r++ = 0x20; };
-    any => { *r++ = fc; };
-  *|;
-}%%
-
-%% write data;
-// clang-format on
-
-static bool replaceNulls(std::string_view input, std::string& result) {
-  result.clear();
-  char* r = nullptr;
-
-  const char* p = input.data();
-  const char* pe = p + input.size();
-  const char* eof = pe;
-  const char *ts, *te;
-  int cs, act;
-
-  // clang-format off
-	%% write init;
-  %% write exec;
-  // clang-format on
-
-  if (r) {
-    result.resize(r - result.data());
-    return true;
-  }
-
-  return false;
-}
-
 // clang-format off
 %%{
   machine replace_nulls_stream;
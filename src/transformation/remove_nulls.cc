@@ -20,12 +20,45 @@
  */
 #include "remove_nulls.h"
 
+#include <cstring>
+
 #include <remove_nulls.h>
 
 namespace Wge {
 namespace Transformation {
 bool RemoveNulls::evaluate(std::string_view data, std::string& result) const {
-  return removeNulls(data, result);
+  result.clear();
+
+  // The data of the empty view may be null, which must not be passed to memchr or memcpy
+  if (data.empty()) {
+    return false;
+  }
+
+  const char* p = data.data();
+  const char* pe = p + data.size();
+  const char* null = static_cast<const char*>(::memchr(p, '\0', pe - p));
+  if (!null) {
+    return false;
+  }
+
+  // Copy the chunks between the nulls, the memchr is vectorized by the libc
+  result.resize(data.size());
+  char* r = result.data();
+  while (null) {
+    ::memcpy(r, p, null - p);
+    r += null - p;
+    p = null + 1;
+    null = static_cast<const char*>(::memchr(p, '\0', pe - p));
+  }
+  ::memcpy(r, p, pe - p);
+  r += pe - p;
+
+  result.resize(r - result.data());
+  return true;
+}
+
+bool RemoveNulls::mayChange(std::string_view data) const {
+  return !data.empty() && ::memchr(data.data(), '\0', data.size()) != nullptr;
 }
 
 std::unique_ptr<StreamState, std::function<void(StreamState*)>> RemoveNulls::newStream() const {
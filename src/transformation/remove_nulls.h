@@ -31,6 +31,7 @@ class RemoveNulls final : public TransformBase {
 
 public:
   bool evaluate(std::string_view data, std::string& result) const override;
+  bool mayChange(std::string_view data) const override;
   std::unique_ptr<StreamState, std::function<void(StreamState*)>> newStream() const override;
   StreamResult evaluateStream(std::string_view input, std::string& output, StreamState& state,
                               bool end_stream) const override;
@@ -20,12 +20,39 @@
  */
 #include "remove_whitespace.h"
 
+#include <cstring>
+
 #include <remove_whitespace.h>
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 bool RemoveWhitespace::evaluate(std::string_view data, std::string& result) const {
-  return removeWhitespace(data, result);
+  result.clear();
+  size_t pos = Common::Simd::findWhitespace(data, true);
+  if (pos == std::string_view::npos) {
+    return false;
+  }
+
+  // Copy the chunks between the whitespaces
+  result.resize(data.size());
+  char* r = result.data();
+  while (pos != std::string_view::npos) {
+    ::memcpy(r, data.data(), pos);
+    r += pos;
+    data.remove_prefix(pos + 1);
+    pos = Common::Simd::findWhitespace(data, true);
+  }
+  ::memcpy(r, data.data(), data.size());
+  r += data.size();
+
+  result.resize(r - result.data());
+  return true;
+}
+
+bool RemoveWhitespace::mayChange(std::string_view data) const {
+  return Common::Simd::findWhitespace(data, true) != std::string_view::npos;
 }
 
 std::unique_ptr<StreamState, std::function<void(StreamState*)>>
@@ -20,12 +20,49 @@
  */
 #include "replace_nulls.h"
 
+#include <cstring>
+
 #include <replace_nulls.h>
 
 namespace Wge {
 namespace Transformation {
 bool ReplaceNulls::evaluate(std::string_view data, std::string& result) const {
-  return replaceNulls(data, result);
+  result.clear();
+
+  // The data of the empty view may be null, which must not be passed to memchr or memcpy
+  if (data.empty()) {
+    return false;
+  }
+
+  const char* p = data.data();
+  const char* pe = p + data.size();
+  const char* null = static_cast<const char*>(::memchr(p, '\0', pe - p));
+  if (!null) {
+    return false;
+  }
+
+  // Copy the chunks between the nulls, and a run of the nulls is replaced by one space
+  result.resize(data.size());
+  char* r = result.data();
+  while (null) {
+    ::memcpy(r, p, null - p);
+    r += null - p;
+    *r++ = ' ';
+    p = null + 1;
+    while (p < pe && *p == '\0') {
+      ++p;
+    }
+    null = static_cast<const char*>(::memchr(p, '\0', pe - p));
+  }
+  ::memcpy(r, p, pe - p);
+  r += pe - p;
+
+  result.resize(r - result.data());
+  return true;
+}
+
+bool ReplaceNulls::mayChange(std::string_view data) const {
+  return !data.empty() && ::memchr(data.data(), '\0', data.size()) != nullptr;
 }
 
 std::unique_ptr<StreamState, std::function<void(StreamState*)>> ReplaceNulls::newStream() const {
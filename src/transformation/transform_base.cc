@@ -25,18 +25,31 @@
 
 namespace Wge {
 namespace Transformation {
+namespace {
+// The output buffer that grows bigger than this is released after the evaluation, so a few big
+// values don't pin the memory of each thread
+constexpr size_t output_buffer_max_keep_size = 64 * 1024;
+} // namespace
+
 bool TransformBase::evaluate(Transaction& t, const Variable::VariableBase* variable,
                              const Common::EvaluateElement& input,
                              Common::EvaluateElement& output) const {
   assert(variable);
 
-  // Check the cache
+  // Most of the values don't contain the bytes that the transformation works on
   std::string_view input_data_view = std::get<std::string_view>(input.variant_);
+  if (!mayChange(input_data_view)) {
+    return false;
+  }
+
+  // Check the cache
   auto& transform_cache = t.getTransformCache();
   Transaction::TransformCacheKey cache_key(input_data_view, name());
+  auto& transform_cache_statistics = t.getTransformCacheStatistics();
   auto iter = transform_cache.find(cache_key);
   if (iter != transform_cache.end())
     [[likely]] {
+      ++transform_cache_statistics.hit_count_;
       WGE_LOG_TRACE(
           "transform cache hit: {} {}",
           [&]() {
@@ -62,20 +75,27 @@ bool TransformBase::evaluate(Transaction& t, const Variable::VariableBase* varia
       }
     }
 
-  // Evaluate the transformation and store the result in the cache
-  std::string output_buffer;
+  ++transform_cache_statistics.miss_count_;
+
+  // Evaluate the transformation and store the result in the cache. The output buffer is reused by
+  // the evaluations of the thread, and the result is copied into the arena of the transaction.
+  static thread_local std::string output_buffer;
+  output_buffer.clear();
   bool ret = evaluate(input_data_view, output_buffer);
   if (ret) {
     auto iter_transform_result =
-        transform_cache.emplace(cache_key, t.internString(std::move(output_buffer))).first;
+        transform_cache.emplace(cache_key.stored(t), t.internString(output_buffer)).first;
     output.variant_ = iter_transform_result->second->variant_;
     output.variable_sub_name_ = input.variable_sub_name_;
     output.ptree_node_ = input.ptree_node_;
   } else {
     // Store nullopt to indicate failure
-    transform_cache.emplace(cache_key, std::nullopt);
+    transform_cache.emplace(cache_key.stored(t), std::nullopt);
   }
 
+  if (output_buffer.capacity() > output_buffer_max_keep_size)
+    [[unlikely]] { std::string().swap(output_buffer); }
+
   return ret;
 }
 } // namespace Transformation
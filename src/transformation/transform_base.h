@@ -69,6 +69,14 @@ public:
     return StreamResult::INVALID_INPUT;
   }
 
+  /**
+   * Check quickly whether the transformation may change the data. If not, the evaluation returns
+   * false directly without hashing the data, looking up the cache and writing the result.
+   * @param data the data to be checked.
+   * @return false if the transformation never changes the data, otherwise true.
+   */
+  virtual bool mayChange(std::string_view data) const { return true; }
+
   /**
    * Get the name of the transform.
    * @return the mname of the transform.
@@ -23,6 +23,8 @@
 #include <trim_left.h>
 #include <trim_right.h>
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 bool Trim::evaluate(std::string_view data, std::string& result) const {
@@ -31,10 +33,18 @@ bool Trim::evaluate(std::string_view data, std::string& result) const {
 
   std::string_view right_input = ret1 ? left_result : data;
   auto ret2 = trimRight(right_input, result);
+  if (ret1 && !ret2) {
+    result = std::move(left_result);
+  }
 
   return ret1 || ret2;
 }
 
+bool Trim::mayChange(std::string_view data) const {
+  return !data.empty() && (Common::Simd::isWhitespace(data.front(), false) ||
+                            Common::Simd::isWhitespace(data.back(), false));
+}
+
 std::unique_ptr<StreamState, std::function<void(StreamState*)>> Trim::newStream() const {
   auto state = std::unique_ptr<StreamState, std::function<void(StreamState*)>>(
       new StreamState(), [](StreamState* state) {
@@ -22,12 +22,18 @@
 
 #include <trim_left.h>
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 bool TrimLeft::evaluate(std::string_view data, std::string& result) const {
   return trimLeft(data, result);
 }
 
+bool TrimLeft::mayChange(std::string_view data) const {
+  return !data.empty() && Common::Simd::isWhitespace(data.front(), false);
+}
+
 std::unique_ptr<StreamState, std::function<void(StreamState*)>> TrimLeft::newStream() const {
   return trimLeftNewStream();
 }
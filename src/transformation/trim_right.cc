@@ -22,12 +22,18 @@
 
 #include <trim_right.h>
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 bool TrimRight::evaluate(std::string_view data, std::string& result) const {
   return trimRight(data, result);
 }
 
+bool TrimRight::mayChange(std::string_view data) const {
+  return !data.empty() && Common::Simd::isWhitespace(data.back(), false);
+}
+
 std::unique_ptr<StreamState, std::function<void(StreamState*)>> TrimRight::newStream() const {
   return trimRightNewStream();
 }
@@ -20,10 +20,13 @@
  */
 #pragma once
 
+#include <cstring>
 #include <string>
 
 #include "transform_base.h"
 
+#include "../common/simd/byte_kernel.h"
+
 namespace Wge {
 namespace Transformation {
 class UpperCase final : public TransformBase {
@@ -31,8 +34,20 @@ class UpperCase final : public TransformBase {
 
 public:
   bool evaluate(std::string_view data, std::string& result) const override {
-    assert(false);
-    throw "Not implemted!";
+    result.clear();
+    size_t pos = Common::Simd::findInRange(data, 'a', 'z');
+    if (pos == std::string_view::npos) {
+      return false;
+    }
+
+    result.resize(data.size());
+    ::memcpy(result.data(), data.data(), pos);
+    Common::Simd::flipCase(data.data() + pos, data.size() - pos, result.data() + pos, 'a', 'z');
+    return true;
+  }
+
+  bool mayChange(std::string_view data) const override {
+    return Common::Simd::findInRange(data, 'a', 'z') != std::string_view::npos;
   }
 };
 } // namespace Transformation
@@ -154,6 +154,23 @@ public:
 
   bool isRegex() const { return !std::holds_alternative<std::monostate>(regex_accept_scanner_); }
 
+  /**
+   * Collect the hyperscan databases of the regex sub names, e.g. to save them to a snapshot.
+   * @param databases the collected databases are appended to it.
+   */
+  void collectDatabases(std::vector<const Common::Hyperscan::HsDataBase*>& databases) const {
+    auto collect = [&](const Scanner& scanner) {
+      auto hyperscan = std::get_if<std::unique_ptr<Common::Hyperscan::Scanner>>(&scanner);
+      if (hyperscan && *hyperscan) {
+        databases.emplace_back(&(*hyperscan)->database());
+      }
+    };
+    collect(regex_accept_scanner_);
+    for (auto& scanner : regex_except_scanners_) {
+      collect(scanner);
+    }
+  }
+
   bool match(std::string_view subject) const {
     bool match = false;
     std::visit(
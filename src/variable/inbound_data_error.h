@@ -31,6 +31,23 @@ public:
   InboundDataError(std::string&& sub_name, bool is_not, bool is_counter,
                    std::string_view curr_rule_file_path)
       : VariableBase(std::move(sub_name), is_not, is_counter) {}
+
+protected:
+  void evaluateCollectionCounter(Transaction& t, Common::EvaluateResults& result) const override {
+    result.emplace_back(t.getInboundDataError() ? 1 : 0);
+  }
+
+  void evaluateSpecifyCounter(Transaction& t, Common::EvaluateResults& result) const override {
+    evaluateCollectionCounter(t, result);
+  }
+
+  void evaluateCollection(Transaction& t, Common::EvaluateResults& result) const override {
+    result.emplace_back(t.getInboundDataError() ? 1 : 0);
+  }
+
+  void evaluateSpecify(Transaction& t, Common::EvaluateResults& result) const override {
+    evaluateCollection(t, result);
+  }
 };
 } // namespace Variable
 } // namespace Wge
\ No newline at end of file
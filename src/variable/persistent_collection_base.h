@@ -46,20 +46,27 @@ public:
     }
   }
 
+  // The values are interned into the transaction, since the values of the collection may be
+  // reassigned by the other transactions concurrently.
   void travel(Transaction& t,
               std::function<bool(const std::string&, const Common::Variant&)> func) const {
     std::string_view collection_name = t.getPersistentStorageKey(type_);
     auto collection = t.getEngine().storage().collection(type_, collection_name);
     if (collection) {
-      collection->travel(func);
+      collection->travel([&](const std::string& key, const Common::Variant& value) {
+        if (IS_STRING_VIEW_VARIANT(value)) {
+          return func(key, t.internString(std::get<std::string_view>(value)));
+        }
+        return func(key, value);
+      });
     }
   }
 
-  const Common::Variant& get(Transaction& t, const std::string& key) const {
+  Common::Variant get(Transaction& t, const std::string& key) const {
     std::string_view collection_name = t.getPersistentStorageKey(type_);
     auto collection = t.getEngine().storage().collection(type_, collection_name);
     if (collection) {
-      return collection->get(key);
+      return collection->get(key, [&](std::string_view value) { return t.internString(value); });
     } else {
       return EMPTY_VARIANT;
     }
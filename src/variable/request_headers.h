@@ -32,12 +32,11 @@ public:
 
 protected:
   void evaluateCollectionCounter(Transaction& t, Common::EvaluateResults& result) const override {
-    result.emplace_back(static_cast<int64_t>(t.httpExtractor().request_header_count_));
+    result.emplace_back(static_cast<int64_t>(t.httpExtractor().request_headers_.size()));
   }
 
   void evaluateSpecifyCounter(Transaction& t, Common::EvaluateResults& result) const override {
-    result.emplace_back(
-        static_cast<int64_t>(t.httpExtractor().request_header_find_(sub_name_).size()));
+    result.emplace_back(static_cast<int64_t>(t.httpExtractor().request_headers_.count(sub_name_)));
   }
 };
 
@@ -51,7 +50,7 @@ public:
 
 protected:
   void evaluateCollection(Transaction& t, Common::EvaluateResults& result) const override {
-    t.httpExtractor().request_header_traversal_([&](std::string_view key, std::string_view value) {
+    t.httpExtractor().request_headers_.traverse([&](std::string_view key, std::string_view value) {
       if (!hasExceptVariable(t, main_name_, key))
         [[likely]] { result.emplace_back(value, key); }
       return true;
@@ -61,13 +60,11 @@ protected:
   void evaluateSpecify(Transaction& t, Common::EvaluateResults& result) const override {
     if (!isRegex())
       [[likely]] {
-        std::vector<std::string_view> values = t.httpExtractor().request_header_find_(sub_name_);
-        for (auto& value : values) {
-          result.emplace_back(value, sub_name_);
-        }
+        t.httpExtractor().request_headers_.find(
+            sub_name_, [&](std::string_view value) { result.emplace_back(value, sub_name_); });
       }
     else {
-      t.httpExtractor().request_header_traversal_(
+      t.httpExtractor().request_headers_.traverse(
           [&](std::string_view key, std::string_view value) {
             if (!hasExceptVariable(t, main_name_, key))
               [[likely]] {
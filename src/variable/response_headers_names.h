@@ -34,7 +34,7 @@ public:
 
 protected:
   void evaluateCollection(Transaction& t, Common::EvaluateResults& result) const override {
-    t.httpExtractor().response_header_traversal_([&](std::string_view key, std::string_view value) {
+    t.httpExtractor().response_headers_.traverse([&](std::string_view key, std::string_view value) {
       if (!hasExceptVariable(t, main_name_, key))
         [[likely]] { result.emplace_back(key, key); }
       return true;
@@ -44,13 +44,13 @@ protected:
   void evaluateSpecify(Transaction& t, Common::EvaluateResults& result) const override {
     if (!isRegex())
       [[likely]] {
-        std::vector<std::string_view> values = t.httpExtractor().response_header_find_(sub_name_);
-        for (size_t i = 0; i < values.size(); ++i) {
+        size_t count = t.httpExtractor().response_headers_.count(sub_name_);
+        for (size_t i = 0; i < count; ++i) {
           result.emplace_back(sub_name_);
         }
       }
     else {
-      t.httpExtractor().response_header_traversal_(
+      t.httpExtractor().response_headers_.traverse(
           [&](std::string_view key, std::string_view value) {
             if (!hasExceptVariable(t, main_name_, key))
               [[likely]] {
@@ -39,7 +39,7 @@ protected:
   }
 
   void evaluateSpecifyCounter(Transaction& t, Common::EvaluateResults& result) const override {
-    auto& value = get(t, sub_name_);
+    auto value = get(t, sub_name_);
     result.emplace_back(IS_EMPTY_VARIANT(value) ? 0 : 1);
   }
 
@@ -54,7 +54,7 @@ protected:
   void evaluateSpecify(Transaction& t, Common::EvaluateResults& result) const override {
     if (!isRegex())
       [[likely]] {
-        auto& value = get(t, sub_name_);
+        auto value = get(t, sub_name_);
         if (!IS_EMPTY_VARIANT(value))
           [[likely]] { result.emplace_back(value); }
       }
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/bounded_queue.hpp"
+
+TEST(BoundedQueueTest, pushPop) {
+  Wge::Common::BoundedQueue<int> queue(3);
+  EXPECT_EQ(queue.capacity(), 4);
+
+  int value;
+  EXPECT_FALSE(queue.pop(value));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.push(i));
+  }
+  EXPECT_FALSE(queue.push(4));
+
+  // First in first out, and the cells are reused after they are popped
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_TRUE(queue.pop(value));
+      EXPECT_EQ(value, i);
+      EXPECT_TRUE(queue.push(i));
+    }
+  }
+}
+
+TEST(BoundedQueueTest, concurrency) {
+  constexpr int producer_count = 4;
+  constexpr int count = 100000;
+  Wge::Common::BoundedQueue<int> queue(64);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producer_count; ++p) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < count; ++i) {
+        while (!queue.push(p * count + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // The elements of each producer are popped in order
+  std::vector<int> next(producer_count, 0);
+  for (int popped = 0; popped < producer_count * count;) {
+    int value;
+    if (!queue.pop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ++popped;
+    int p = value / count;
+    EXPECT_EQ(value % count, next[p]);
+    next[p] = value % count + 1;
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  for (int p = 0; p < producer_count; ++p) {
+    EXPECT_EQ(next[p], count);
+  }
+}
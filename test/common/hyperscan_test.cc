@@ -59,6 +59,53 @@ TEST(HyperscanTest, greedy) {
   result.get();
 }
 
+TEST(HyperscanTest, vectorScan) {
+  std::vector<std::string_view> patterns{"foo", "bar"};
+  Wge::Common::Hyperscan::Scanner scanner(std::make_shared<Wge::Common::Hyperscan::HsDataBase>(
+      patterns, true, true, true, false, false));
+  ASSERT_TRUE(scanner.vectorScanSupported());
+
+  // The same expression matches several elements, and the empty elements are not matched
+  std::vector<std::string_view> data{"hello", "", "xxFOO",  "foo",   "world",
+                                     "",      "", "abarfoo", "hello", "bar"};
+  std::vector<std::pair<size_t, size_t>> expected(data.size(), {0, 0});
+  std::pair<size_t, size_t> first_match;
+  scanner.registMatchCallback(
+      [](uint64_t id, unsigned long long from, unsigned long long to, unsigned int flags,
+         void* user_data) -> int {
+        *static_cast<std::pair<size_t, size_t>*>(user_data) = {from, to};
+        return 1;
+      },
+      &first_match);
+  for (size_t i = 0; i < data.size(); ++i) {
+    first_match = {0, 0};
+    scanner.blockScan(data[i]);
+    expected[i] = first_match;
+  }
+
+  std::vector<std::pair<size_t, size_t>> actual(data.size(), {0, 0});
+  scanner.vectorScan(
+      data,
+      [](size_t index, uint64_t id, unsigned long long from, unsigned long long to,
+         void* user_data) -> int {
+        auto& actual = *static_cast<std::vector<std::pair<size_t, size_t>>*>(user_data);
+        EXPECT_EQ(actual[index], std::make_pair(size_t(0), size_t(0)));
+        actual[index] = {from, to};
+        return 0;
+      },
+      &actual);
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(actual[2], std::make_pair(size_t(2), size_t(5)));
+  EXPECT_EQ(actual[3], std::make_pair(size_t(0), size_t(3)));
+  EXPECT_EQ(actual[7], std::make_pair(size_t(1), size_t(4)));
+  EXPECT_EQ(actual[9], std::make_pair(size_t(0), size_t(3)));
+
+  // The regular expression may match across the elements
+  Wge::Common::Hyperscan::Scanner rx_scanner(
+      std::make_shared<Wge::Common::Hyperscan::HsDataBase>("a+", false, false, true, false, false));
+  EXPECT_FALSE(rx_scanner.vectorScanSupported());
+}
+
 TEST(HyperscanTest, serialize) {
   const char* serialize_dir = "/tmp/HyperscanTest";
   Wge::Common::Hyperscan::Scanner scanner(std::make_shared<Wge::Common::Hyperscan::HsDataBase>(
@@ -84,7 +84,7 @@ protected:
     ]
 })";
 
-  std::forward_list<std::string> buffer_;
+  std::pmr::forward_list<std::pmr::string> buffer_;
 };
 
 TEST_F(JsonTest, BlockParse) {
@@ -0,0 +1,407 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "persistent_storage/storage.h"
+
+using Type = Wge::PersistentStorage::Storage::Type;
+
+namespace {
+// The string values are copied out of the collections into the buffer of the test
+thread_local std::string copy_buffer;
+std::string_view copyString(std::string_view value) {
+  copy_buffer = value;
+  return copy_buffer;
+}
+} // namespace
+
+TEST(PersistentStorageTest, initCollection) {
+  Wge::PersistentStorage::Storage storage;
+  EXPECT_EQ(storage.collection(Type::IP, "127.0.0.1"), nullptr);
+
+  // The name is owned by the storage
+  std::string name = "127.0.0.1";
+  storage.initCollection(Type::IP, name);
+  storage.initCollection(Type::IP, name);
+  name = "foo";
+
+  auto collection = storage.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(collection, nullptr);
+  EXPECT_EQ(collection->key(), "127.0.0.1");
+  EXPECT_EQ(collection->timeout(), 3600);
+  EXPECT_TRUE(collection->isNew());
+  EXPECT_EQ(storage.collection(Type::SESSION, "127.0.0.1"), nullptr);
+  EXPECT_EQ(storage.liveCount(), 1);
+
+  collection->set("count", 1);
+  EXPECT_EQ(std::get<int64_t>(collection->get("count", copyString)), 1);
+  EXPECT_EQ(collection->updateCounter(), 1);
+}
+
+TEST(PersistentStorageTest, expire) {
+  Wge::PersistentStorage::Storage storage;
+  storage.collectionTimeout(0);
+
+  // The expired collection is evicted lazily
+  storage.initCollection(Type::IP, "127.0.0.1");
+  auto collection = storage.collection(Type::IP, "127.0.0.1");
+  EXPECT_EQ(collection, nullptr);
+  EXPECT_EQ(storage.liveCount(), 0);
+  EXPECT_EQ(storage.evictionCount(), 1);
+
+  // The expired collection is swept
+  for (size_t i = 0; i < 100; ++i) {
+    storage.initCollection(Type::SESSION, std::to_string(i));
+  }
+  storage.sweep();
+  EXPECT_EQ(storage.liveCount(), 0);
+  EXPECT_EQ(storage.evictionCount(), 101);
+
+  // The new timeout applies to the collections that are created later
+  storage.collectionTimeout(3600);
+  storage.initCollection(Type::IP, "127.0.0.1");
+  EXPECT_NE(storage.collection(Type::IP, "127.0.0.1"), nullptr);
+  EXPECT_EQ(storage.sweep(), 0);
+  EXPECT_EQ(storage.liveCount(), 1);
+}
+
+TEST(PersistentStorageTest, concurrency) {
+  Wge::PersistentStorage::Storage storage;
+  constexpr size_t thread_count = 4;
+  constexpr size_t collection_count = 1000;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&]() {
+      for (size_t j = 0; j < collection_count; ++j) {
+        std::string name = std::to_string(j);
+        storage.initCollection(Type::IP, name);
+        auto collection = storage.collection(Type::IP, name);
+        ASSERT_NE(collection, nullptr);
+        collection->set("count", static_cast<int64_t>(j));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(storage.liveCount(), collection_count);
+  EXPECT_EQ(storage.evictionCount(), 0);
+  EXPECT_EQ(storage.collection(Type::IP, "10")->updateCounter(), thread_count);
+}
+
+TEST(PersistentStorageTest, snapshot) {
+  std::string file =
+      (std::filesystem::temp_directory_path() / "wge_persistent_storage_test.snapshot").string();
+
+  {
+    Wge::PersistentStorage::Storage storage;
+    storage.initCollection(Type::IP, "127.0.0.1");
+    storage.collection(Type::IP, "127.0.0.1")->set("count", 10);
+    storage.initCollection(Type::SESSION, "abc");
+    storage.collection(Type::SESSION, "abc")->set("user", std::string_view("admin"));
+    storage.collectionTimeout(0);
+    storage.initCollection(Type::IP, "expired");
+    ASSERT_TRUE(storage.storeToFile(file).has_value());
+
+    // Only the updated shard is serialized again
+    storage.collection(Type::IP, "127.0.0.1")->set("count", 11);
+    ASSERT_TRUE(storage.storeToFile(file).has_value());
+  }
+
+  Wge::PersistentStorage::Storage storage;
+  auto result = storage.loadFromFile(file);
+  ASSERT_TRUE(result.has_value()) << result.error();
+  EXPECT_EQ(storage.liveCount(), 2);
+  auto ip = storage.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(ip, nullptr);
+  EXPECT_FALSE(ip->isNew());
+  EXPECT_EQ(ip->updateCounter(), 2);
+  EXPECT_EQ(std::get<int64_t>(ip->get("count", copyString)), 11);
+  auto session = storage.collection(Type::SESSION, "abc");
+  ASSERT_NE(session, nullptr);
+  EXPECT_EQ(std::get<std::string_view>(session->get("user", copyString)), "admin");
+  EXPECT_EQ(storage.collection(Type::IP, "expired"), nullptr);
+
+  // The corrupted snapshot is rejected
+  {
+    std::fstream fs(file, std::ios::in | std::ios::out | std::ios::binary);
+    fs.seekp(-1, std::ios::end);
+    fs.put('x');
+  }
+  Wge::PersistentStorage::Storage corrupted_storage;
+  EXPECT_FALSE(corrupted_storage.loadFromFile(file).has_value());
+  EXPECT_EQ(corrupted_storage.liveCount(), 0);
+
+  std::filesystem::remove(file);
+}
+
+TEST(PersistentStorageTest, snapshotThread) {
+  std::string file =
+      (std::filesystem::temp_directory_path() / "wge_persistent_storage_thread_test.snapshot")
+          .string();
+  std::filesystem::remove(file);
+
+  {
+    Wge::PersistentStorage::Storage storage;
+    storage.startSnapshot(file, std::chrono::seconds(3600));
+    EXPECT_EQ(storage.snapshotFile(), file);
+    storage.initCollection(Type::IP, "127.0.0.1");
+
+    // The last snapshot is saved when the thread is stopped
+  }
+
+  Wge::PersistentStorage::Storage storage;
+  ASSERT_TRUE(storage.loadFromFile(file).has_value());
+  EXPECT_NE(storage.collection(Type::IP, "127.0.0.1"), nullptr);
+  std::filesystem::remove(file);
+}
+
+TEST(PersistentStorageTest, sharedMemory) {
+  std::string name = "wge_shared_storage_test_" + std::to_string(::getpid());
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+
+  // The storages attach the same segment, e.g. the storages of the different processes
+  Wge::PersistentStorage::Storage storage1;
+  Wge::PersistentStorage::Storage storage2;
+  ASSERT_TRUE(storage1.useSharedMemory(name, 1024).has_value());
+  ASSERT_TRUE(storage2.useSharedMemory(name, 1024).has_value());
+  EXPECT_EQ(storage1.sharedMemoryName(), name);
+
+  storage1.initCollection(Type::IP, "127.0.0.1");
+  auto collection = storage2.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(collection, nullptr);
+  EXPECT_EQ(storage2.collection(Type::SESSION, "127.0.0.1"), nullptr);
+  EXPECT_EQ(storage2.liveCount(), 1);
+
+  // The values are written through to the shared memory
+  collection->set("count", 1);
+  collection->set("user", std::string_view("foo"));
+  collection = storage1.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(collection, nullptr);
+  EXPECT_EQ(std::get<int64_t>(collection->get("count", copyString)), 1);
+  EXPECT_EQ(std::get<std::string_view>(collection->get("user", copyString)), "foo");
+  EXPECT_EQ(collection->updateCounter(), 2);
+
+  // The value that exceeds the limits is dropped
+  collection->set(std::string(100, 'k'), 1);
+  EXPECT_EQ(storage2.collection(Type::IP, "127.0.0.1")->size(), 2);
+
+  // The snapshot isn't supported
+  EXPECT_FALSE(storage1.storeToFile("wge_shared_storage_test.snapshot").has_value());
+
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+}
+
+TEST(PersistentStorageTest, sharedMemoryProcess) {
+  std::string name = "wge_shared_storage_process_test_" + std::to_string(::getpid());
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+
+  pid_t pid = ::fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    Wge::PersistentStorage::Storage storage;
+    if (!storage.useSharedMemory(name, 1024).has_value()) {
+      ::_exit(1);
+    }
+    for (size_t i = 0; i < 100; ++i) {
+      storage.initCollection(Type::IP, std::to_string(i));
+      storage.collection(Type::IP, std::to_string(i))->set("pid", ::getpid());
+    }
+    ::_exit(0);
+  }
+
+  Wge::PersistentStorage::Storage storage;
+  ASSERT_TRUE(storage.useSharedMemory(name, 1024).has_value());
+  int status;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+
+  EXPECT_EQ(storage.liveCount(), 100);
+  for (size_t i = 0; i < 100; ++i) {
+    auto collection = storage.collection(Type::IP, std::to_string(i));
+    ASSERT_NE(collection, nullptr);
+    EXPECT_EQ(std::get<int64_t>(collection->get("pid", copyString)), pid);
+  }
+
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+}
+
+TEST(PersistentStorageTest, sharedMemoryExpire) {
+  std::string name = "wge_shared_storage_expire_test_" + std::to_string(::getpid());
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+
+  Wge::PersistentStorage::Storage storage;
+  ASSERT_TRUE(storage.useSharedMemory(name, 8).has_value());
+  storage.collectionTimeout(0);
+  storage.initCollection(Type::IP, "127.0.0.1");
+  EXPECT_EQ(storage.collection(Type::IP, "127.0.0.1"), nullptr);
+  EXPECT_EQ(storage.liveCount(), 0);
+  EXPECT_EQ(storage.evictionCount(), 1);
+
+  for (size_t i = 0; i < 8; ++i) {
+    storage.initCollection(Type::SESSION, std::to_string(i));
+  }
+  EXPECT_EQ(storage.sweep(), 8);
+  EXPECT_EQ(storage.liveCount(), 0);
+
+  // The least recently updated collection is evicted if the bucket is full
+  storage.collectionTimeout(3600);
+  for (size_t i = 0; i < 9; ++i) {
+    storage.initCollection(Type::SESSION, std::to_string(i));
+  }
+  EXPECT_EQ(storage.liveCount(), 8);
+  EXPECT_EQ(storage.evictionCount(), 10);
+
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+}
+
+TEST(PersistentStorageTest, getWhileSet) {
+  Wge::PersistentStorage::Storage storage;
+  storage.initCollection(Type::IP, "127.0.0.1");
+  auto collection = storage.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(collection, nullptr);
+
+  // The value that is got is a copy, so it isn't freed by the concurrent set
+  const std::string short_value = "foo";
+  const std::string long_value(4096, 'x');
+  collection->set("user", std::string_view(short_value));
+  std::thread setter([&]() {
+    for (size_t i = 0; i < 10000; ++i) {
+      collection->set("user", std::string_view(i % 2 ? short_value : long_value));
+    }
+  });
+  for (size_t i = 0; i < 10000; ++i) {
+    auto value = std::get<std::string_view>(collection->get("user", copyString));
+    EXPECT_TRUE(value == short_value || value == long_value);
+  }
+  setter.join();
+}
+
+TEST(PersistentStorageTest, increase) {
+  Wge::PersistentStorage::Storage storage;
+  storage.initCollection(Type::IP, "127.0.0.1");
+  auto collection = storage.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(collection, nullptr);
+
+  collection->increase("count", 2);
+  collection->increase("count", -1);
+  EXPECT_EQ(std::get<int64_t>(collection->get("count", copyString)), 1);
+
+  // The string value isn't increased
+  collection->set("user", std::string_view("foo"));
+  collection->increase("user", 1);
+  EXPECT_EQ(std::get<std::string_view>(collection->get("user", copyString)), "foo");
+
+  // The concurrent increments aren't lost
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (size_t j = 0; j < 1000; ++j) {
+        collection->increase("count", 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(std::get<int64_t>(collection->get("count", copyString)), 4001);
+}
+
+TEST(PersistentStorageTest, sharedMemoryIncrease) {
+  std::string name = "wge_shared_storage_increase_test_" + std::to_string(::getpid());
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+
+  Wge::PersistentStorage::Storage storage;
+  ASSERT_TRUE(storage.useSharedMemory(name, 1024).has_value());
+  storage.initCollection(Type::IP, "127.0.0.1");
+
+  // The copies of the collection in the processes increase the same value in the shared memory
+  pid_t pid = ::fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    Wge::PersistentStorage::Storage storage;
+    if (!storage.useSharedMemory(name, 1024).has_value()) {
+      ::_exit(1);
+    }
+    auto collection = storage.collection(Type::IP, "127.0.0.1");
+    if (!collection) {
+      ::_exit(1);
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+      collection->increase("count", 1);
+    }
+    ::_exit(0);
+  }
+
+  auto collection = storage.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(collection, nullptr);
+  for (size_t i = 0; i < 1000; ++i) {
+    collection->increase("count", 1);
+  }
+  int status;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+
+  collection = storage.collection(Type::IP, "127.0.0.1");
+  ASSERT_NE(collection, nullptr);
+  EXPECT_EQ(std::get<int64_t>(collection->get("count", copyString)), 2000);
+
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+}
+
+TEST(PersistentStorageTest, sharedMemoryCreatorDied) {
+  std::string name = "wge_shared_storage_creator_test_" + std::to_string(::getpid());
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+
+  // The creator dies after creating the segment and before initializing it
+  pid_t pid = ::fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    boost::interprocess::shared_memory_object shm(boost::interprocess::create_only, name.c_str(),
+                                                  boost::interprocess::read_write);
+    ::_exit(0);
+  }
+  int status;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+
+  // The segment is initialized by the process that attaches it
+  Wge::PersistentStorage::Storage storage;
+  auto result = storage.useSharedMemory(name, 1024);
+  ASSERT_TRUE(result.has_value()) << result.error();
+  storage.initCollection(Type::IP, "127.0.0.1");
+  EXPECT_NE(storage.collection(Type::IP, "127.0.0.1"), nullptr);
+
+  Wge::PersistentStorage::SharedMemoryTable::remove(name);
+}
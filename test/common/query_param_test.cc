@@ -23,7 +23,7 @@
 #include "common/ragel/query_param.h"
 
 TEST(Common, queryParam) {
-  std::forward_list<std::string> buffer;
+  std::pmr::forward_list<std::pmr::string> buffer;
   {
     Wge::Common::Ragel::QueryParam query_param;
     query_param.init("a=1&b=2&c=3", buffer);
@@ -110,4 +110,18 @@ TEST(Common, queryParam) {
     EXPECT_EQ(linked[2].first, "b");
     EXPECT_EQ(linked[2].second, "=c=3");
   }
+
+  // Test for max count
+  {
+    Wge::Common::Ragel::QueryParam query_param;
+    query_param.init("a=1&b=2&c=3", buffer, 3);
+    EXPECT_EQ(query_param.getLinked().size(), 3);
+    EXPECT_FALSE(query_param.truncated());
+
+    query_param.init("a=1&b=2&c=3", buffer, 2);
+    EXPECT_EQ(query_param.get().size(), 2);
+    EXPECT_EQ(query_param.getLinked().size(), 2);
+    EXPECT_EQ(query_param.getLinked()[1].first, "b");
+    EXPECT_TRUE(query_param.truncated());
+  }
 }
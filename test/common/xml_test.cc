@@ -62,7 +62,7 @@ protected:
     </params>
 </methodCall>)";
 
-  std::forward_list<std::string> buffer_;
+  std::pmr::forward_list<std::pmr::string> buffer_;
 };
 
 TEST_F(XmlTest, ragle) {
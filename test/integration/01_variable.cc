@@ -270,7 +270,54 @@ TEST_F(VariableTest, HIGHEST_SEVERITY) {
 }
 
 TEST_F(VariableTest, INBOUND_DATA_ERROR) {
-  // TODO(zhouyu 2025-03-27): add the test cast
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecRequestBodyLimit 10
+        SecRequestBodyLimitAction ProcessPartial
+        SecRule INBOUND_DATA_ERROR "@eq 1" "id:1,phase:2,setvar:tx.inbound_data_error")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(request_header_find_, request_header_traversal_,
+                             request_headers_.size(), nullptr);
+    EXPECT_TRUE(t->processRequestBody("0123456789"));
+    EXPECT_FALSE(t->hasVariable("", "inbound_data_error"));
+    EXPECT_EQ(t->getRequestBody(), "0123456789");
+  }
+
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(request_header_find_, request_header_traversal_,
+                             request_headers_.size(), nullptr);
+    EXPECT_TRUE(t->processRequestBody("0123456789abc"));
+    EXPECT_TRUE(t->hasVariable("", "inbound_data_error"));
+    EXPECT_EQ(t->getRequestBody(), "0123456789");
+  }
+
+  // Test for reject action
+  {
+    const std::string directive = R"(
+        SecRuleEngine On
+        SecRequestBodyLimit 10
+        SecRequestBodyLimitAction Reject)";
+
+    Engine engine(spdlog::level::off);
+    auto result = engine.load(directive);
+    engine.init();
+    ASSERT_TRUE(result.has_value());
+
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(request_header_find_, request_header_traversal_,
+                             request_headers_.size(), nullptr);
+    EXPECT_FALSE(t->processRequestBody("0123456789abc"));
+    EXPECT_TRUE(t->getInboundDataError());
+    EXPECT_EQ(t->getBodyLimitStatus(), "413");
+  }
 }
 
 TEST_F(VariableTest, MATCHED_VAR_NAME) {
@@ -366,7 +413,29 @@ TEST_F(VariableTest, MULTIPART_UNMATCHED_BOUNDARY) {
 }
 
 TEST_F(VariableTest, OUTBOUND_DATA_ERROR) {
-  // TODO(zhouyu 2025-03-27): add the test cast
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecResponseBodyLimit 10
+        SecResponseBodyLimitAction ProcessPartial
+        SecRule OUTBOUND_DATA_ERROR "@eq 1" "id:1,phase:4,setvar:tx.outbound_data_error")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  {
+    auto t = engine.makeTransaction();
+    EXPECT_TRUE(t->processResponseBody("0123456789"));
+    EXPECT_FALSE(t->hasVariable("", "outbound_data_error"));
+  }
+
+  {
+    auto t = engine.makeTransaction();
+    EXPECT_TRUE(t->processResponseBody("0123456789abc"));
+    EXPECT_TRUE(t->hasVariable("", "outbound_data_error"));
+    EXPECT_EQ(t->getResponseBody(), "0123456789");
+  }
 }
 
 TEST_F(VariableTest, PATH_INFO) {
@@ -398,7 +467,46 @@ TEST_F(VariableTest, REQBODY_ERROR_MSG) {
 }
 
 TEST_F(VariableTest, REQBODY_ERROR) {
-  // TODO(zhouyu 2025-03-27): add the test cast
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecArgumentsLimit 2
+        SecAction "id:100,phase:1,ctl:requestBodyProcessor=URLENCODED"
+        SecRule REQBODY_ERROR "@eq 1" "id:1,phase:2,setvar:tx.reqbody_error"
+        SecRule ARGS_POST:c "@streq 3" "id:2,phase:2,setvar:tx.arg_c")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(request_header_find_, request_header_traversal_,
+                             request_headers_.size(), nullptr);
+    EXPECT_TRUE(t->processRequestBody("a=1&b=2"));
+    EXPECT_FALSE(t->hasVariable("", "reqbody_error"));
+  }
+
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(request_header_find_, request_header_traversal_,
+                             request_headers_.size(), nullptr);
+    EXPECT_TRUE(t->processRequestBody("a=1&b=2&c=3"));
+    EXPECT_TRUE(t->hasVariable("", "reqbody_error"));
+    EXPECT_FALSE(t->hasVariable("", "arg_c"));
+    EXPECT_EQ(t->getBodyQueryParam().getLinked().size(), 2);
+  }
+
+  // The query arguments are limited too
+  {
+    auto t = engine.makeTransaction();
+    t->processUri("/?a=1&b=2&c=3", "GET", "1.1");
+    t->processRequestHeaders(request_header_find_, request_header_traversal_,
+                             request_headers_.size(), nullptr);
+    EXPECT_TRUE(t->processRequestBody("d=4"));
+    EXPECT_TRUE(t->hasVariable("", "reqbody_error"));
+    EXPECT_EQ(t->getRequestLineInfo().query_params_.getLinked().size(), 2);
+  }
 }
 
 TEST_F(VariableTest, REQBODY_PROCESSOR_ERROR) {
@@ -154,6 +154,53 @@ TEST_F(RuleOperatorTest, detect_sqli) {
   EXPECT_TRUE(t->hasVariable("", "v1"));
 }
 
+TEST_F(RuleOperatorTest, detectCache) {
+  // The same values are checked by several rules, and each value is detected once per operator
+  const std::string directive =
+      R"(SecAction "phase:1,setvar:tx.foo=raw(admin' OR 1=1 --)raw, \
+    setvar:tx.bar=<script>alert(1)</script>"
+  SecRule TX:foo|TX:bar "@detectSqli" "id:1,phase:1,setvar:'tx.sqli1=+1'"
+  SecRule TX:foo|TX:bar "@detectSqli" "id:2,phase:1,setvar:'tx.sqli2=+1'"
+  SecRule TX:foo|TX:bar "@detectXSS" "id:3,phase:1,setvar:'tx.xss1=+1'"
+  SecRule TX:foo|TX:bar "@detectXSS" "id:4,phase:1,setvar:'tx.xss2=+1'")";
+
+  auto result = engine_.load(directive);
+  engine_.init();
+  auto t = engine_.makeTransaction();
+  ASSERT_TRUE(result.has_value());
+
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "sqli1")), 1);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "sqli2")), 1);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "xss1")), 1);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "xss2")), 1);
+  EXPECT_EQ(t->getLibinjectionCacheStatistics().miss_count_, 4);
+  EXPECT_EQ(t->getLibinjectionCacheStatistics().hit_count_, 4);
+}
+
+TEST_F(RuleOperatorTest, detectCacheArenaGrowth) {
+  // The transformed value is owned by the transaction, so the cache key of the detection refers to
+  // it rather than a copy of it
+  const std::string directive =
+      R"(SecRule REQUEST_BODY "@detectSqli" "id:1,phase:2,t:lowercase,setvar:'tx.sqli'"
+  SecRule REQUEST_BODY "@detectXSS" "id:2,phase:2,t:lowercase,setvar:'tx.xss'")";
+
+  auto result = engine_.load(directive);
+  engine_.init();
+  auto t = engine_.makeTransaction();
+  ASSERT_TRUE(result.has_value());
+
+  std::string body(256 * 1024, 'A');
+  EXPECT_TRUE(t->processRequestBody(body));
+  EXPECT_FALSE(t->hasVariable("", "sqli"));
+  EXPECT_FALSE(t->hasVariable("", "xss"));
+  EXPECT_EQ(t->getLibinjectionCacheStatistics().miss_count_, 2);
+
+  // The body is kept by the key of the transformation cache, and the lowercase output is kept by
+  // the value of it
+  EXPECT_LE(t->arenaAllocatedSize(), 2 * body.size() + 64 * 1024);
+}
+
 TEST_F(RuleOperatorTest, ipMatch) {
   const std::string directive =
       R"(SecAction "phase:1,setvar:tx.ipv4=192.168.1.1"
@@ -256,6 +303,51 @@ TEST_F(RuleOperatorTest, withinWithMacro) {
   EXPECT_FALSE(t->hasVariable("", "false2"));
 }
 
+TEST_F(RuleOperatorTest, withinBatch) {
+  // The values of the collection are more than the batch threshold, so they are scanned as a batch
+  const std::string directive =
+      R"(SecAction "phase:1,setvar:tx.v0=abc,setvar:tx.v1=abc,setvar:tx.v2=helloworld, \
+        setvar:tx.v3=abc,setvar:tx.v4=abc,setvar:tx.v5=hello,setvar:tx.v6=abc,setvar:tx.v7=abc, \
+        setvar:tx.v8=xworld,setvar:tx.v9=abc"
+      SecRule TX:/^v/ "@within hello world" "id:1,phase:1,setvar:'tx.matched=+1'"
+      SecRule TX:/^v/ "!@within hello world" "id:2,phase:1,setvar:'tx.unmatched=+1'"
+      SecRule TX:/^v/ "@within hello world" \
+        "id:3,phase:1,capture,setvar:'tx.first=%{tx.0}',firstMatch"
+      SecRule TX:/^v/ "@within hello1" "id:4,phase:1,setvar:'tx.false'")";
+
+  auto result = engine_.load(directive);
+  engine_.init();
+  auto t = engine_.makeTransaction();
+  ASSERT_TRUE(result.has_value());
+
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "matched")), 3);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "unmatched")), 7);
+  EXPECT_EQ(std::get<std::string_view>(t->getVariable("", "first")), "hello");
+  EXPECT_FALSE(t->hasVariable("", "false"));
+}
+
+TEST_F(RuleOperatorTest, withinBatchMultiChain) {
+  // The chained rule is scanned as a batch within the batch of the top rule, so the values of the
+  // top rule are kept while the chained rule is evaluated
+  const std::string directive =
+      R"(SecAction "phase:1,setvar:tx.v0=abc,setvar:tx.v1=abc,setvar:tx.v2=helloworld, \
+        setvar:tx.v3=abc,setvar:tx.v4=abc,setvar:tx.v5=hello,setvar:tx.v6=abc,setvar:tx.v7=abc, \
+        setvar:tx.v8=xworld,setvar:tx.v9=abc"
+      SecAction "phase:1,setvar:tx.w0=abc,setvar:tx.w1=foo,setvar:tx.w2=abc,setvar:tx.w3=abc, \
+        setvar:tx.w4=abc,setvar:tx.w5=abc,setvar:tx.w6=bar,setvar:tx.w7=abc"
+      SecRule TX:/^v/ "@within hello world" "id:1,phase:1,multiChain"
+        SecRule TX:/^w/ "@within foo bar" "setvar:'tx.matched=+1'")";
+
+  auto result = engine_.load(directive);
+  engine_.init();
+  auto t = engine_.makeTransaction();
+  ASSERT_TRUE(result.has_value());
+
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "matched")), 6);
+}
+
 TEST_F(RuleOperatorTest, rx) {
   const std::string directive =
       R"(SecAction "phase:1,setvar:tx.foo=helloworld123helloworld"
@@ -363,8 +455,10 @@ TEST_F(RuleOperatorTest, streqWithMacro) {
 TEST_F(RuleOperatorTest, validateUrlEncoding) {
   const std::string directive =
       R"(SecAction "phase:1,setvar:tx.foo=/asdf%20%ab,setvar:tx.bar=/asdf%20%ag"
+  SecAction "phase:1,setvar:tx.baz=/asdf%2"
   SecRule TX:foo "@validateUrlEncoding" "id:1,phase:1,setvar:'tx.false'"
-  SecRule TX:bar "@validateUrlEncoding" "id:2,phase:1,setvar:'tx.true'")";
+  SecRule TX:bar "@validateUrlEncoding" "id:2,phase:1,setvar:'tx.true'"
+  SecRule TX:baz "@validateUrlEncoding" "id:3,phase:1,setvar:'tx.true2'")";
 
   auto result = engine_.load(directive);
   engine_.init();
@@ -374,6 +468,7 @@ TEST_F(RuleOperatorTest, validateUrlEncoding) {
   t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
   EXPECT_FALSE(t->hasVariable("", "false"));
   EXPECT_TRUE(t->hasVariable("", "true"));
+  EXPECT_TRUE(t->hasVariable("", "true2"));
 }
 
 TEST_F(RuleOperatorTest, contains) {
@@ -424,6 +519,48 @@ SecRule TX:bar "@validateByteRange 65,66-68" "id:2,phase:1,setvar:'tx.false'")";
   EXPECT_FALSE(t->hasVariable("", "false"));
 }
 
+TEST_F(RuleOperatorTest, validateByteRangeLongValue) {
+  const std::string directive =
+      R"(SecRule REQUEST_URI "@validateByteRange 47,97-122" "id:1,phase:1,setvar:'tx.false'"
+SecRule REQUEST_URI "@validateByteRange 47,97-121" "id:2,phase:1,setvar:'tx.true'")";
+
+  auto result = engine_.load(directive);
+  engine_.init();
+  auto t = engine_.makeTransaction();
+  ASSERT_TRUE(result.has_value());
+
+  // The invalid byte is beyond the first 32 bytes
+  t->processUri("/abcdefghijklmnopqrstuvwxyz/abcdefghijklmnopqrstuvwxyz", "GET", "HTTP/1.1");
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  EXPECT_TRUE(t->hasVariable("", "true"));
+  EXPECT_FALSE(t->hasVariable("", "false"));
+}
+
+TEST_F(RuleOperatorTest, validateUtf8Encoding) {
+  const std::string directive =
+      R"(SecRule REQUEST_URI "@validateUtf8Encoding" "id:1,phase:1,setvar:'tx.invalid'")";
+
+  auto result = engine_.load(directive);
+  engine_.init();
+  ASSERT_TRUE(result.has_value());
+
+  const std::vector<std::pair<std::string, bool>> test_cases = {
+      {"/index.html", true},
+      {"/caf\xc3\xa9/\xe4\xbd\xa0\xe5\xa5\xbd/\xf0\x9f\x98\x80", true},
+      {"/caf\xc3", false},
+      {"/caf\xc3\x28", false},
+      {"/\xc0\xaf", false},
+      {"/\xed\xa0\x80", false},
+      {"/\xf4\x90\x80\x80", false},
+      {"/abcdefghijklmnopqrstuvwxyz/abcdefghijklmnopqrstuvwxyz\xff", false}};
+  for (auto& [uri, valid] : test_cases) {
+    auto t = engine_.makeTransaction();
+    t->processUri(uri, "GET", "HTTP/1.1");
+    t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+    EXPECT_EQ(t->hasVariable("", "invalid"), !valid) << uri;
+  }
+}
+
 TEST_F(RuleOperatorTest, xor) {
   const std::string directive =
       R"(SecAction "phase:1,setvar:tx.foo=1,setvar:tx.bar=0"
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "engine.h"
+
+namespace Wge {
+namespace Integration {
+TEST(RulePrefilterTest, prefilter) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "phase:1,setvar:tx.foo=bar"
+        SecRule ARGS "@rx ^hello[0-9]+" "id:1,phase:1,pass,t:none,t:lowercase,setvar:tx.rule1=1"
+        SecRule ARGS "@pm world admin" "id:2,phase:1,pass,t:none,t:lowercase,setvar:tx.rule2=1"
+        SecRule ARGS "@rx nothing_to_match" "id:3,phase:1,pass,t:none,setvar:tx.rule3=1"
+        SecRule ARGS:p1 "@rx ^v1$" "id:4,phase:1,pass,t:none,setvar:tx.rule4=1"
+        SecRule ARGS|!ARGS:p2 "@rx ^v2$" "id:5,phase:1,pass,t:none,setvar:tx.rule5=1"
+        SecRule TX:foo "@rx bar" "id:6,phase:1,pass,t:none,setvar:tx.rule6=1"
+        SecRule ARGS "!@rx hello" "id:7,phase:1,pass,t:none,setvar:tx.rule7=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  ASSERT_TRUE(result.has_value());
+  engine.init();
+
+  // Only the rules that target the stable variables with a single rx/pm operator are indexed.
+  const RulePrefilter& prefilter = engine.rulePrefilter(1);
+  EXPECT_TRUE(prefilter.enabled());
+  std::unordered_map<uint64_t, RuleIndexType> rule_indexes;
+  for (const Rule& rule : engine.rules(1)) {
+    rule_indexes[rule.id()] = rule.index();
+  }
+  EXPECT_TRUE(prefilter.isIndexed(rule_indexes[1]));
+  EXPECT_TRUE(prefilter.isIndexed(rule_indexes[2]));
+  EXPECT_TRUE(prefilter.isIndexed(rule_indexes[3]));
+  EXPECT_TRUE(prefilter.isIndexed(rule_indexes[4]));
+  EXPECT_TRUE(prefilter.isIndexed(rule_indexes[5]));
+  EXPECT_FALSE(prefilter.isIndexed(rule_indexes[6]));
+  EXPECT_FALSE(prefilter.isIndexed(rule_indexes[7]));
+
+  // The result of the evaluation must be the same as without the prefilter.
+  auto t = engine.makeTransaction();
+  t->processUri("/?p1=v1&p2=v2&p3=HELLO123&p4=Admin", "GET", "1.1");
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule1")), 1);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule2")), 1);
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule3")));
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule4")), 1);
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule5")));
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule6")), 1);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule7")), 1);
+}
+} // namespace Integration
+} // namespace Wge
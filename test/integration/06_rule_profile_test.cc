@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "engine.h"
+
+namespace Wge {
+namespace Integration {
+class RuleProfileTest : public testing::Test {
+public:
+  RuleProfileTest() : engine_(spdlog::level::off) {}
+
+  void SetUp() override {
+    const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:1,phase:1,pass,setvar:tx.foo=bar"
+        SecRule TX:foo "@streq bar" "id:2,phase:1,pass,t:none,t:lowercase,setvar:tx.rule2=1"
+        SecRule TX:foo "@streq baz" "id:3,phase:1,pass,t:none,setvar:tx.rule3=1")";
+    auto result = engine_.load(directive);
+    ASSERT_TRUE(result.has_value());
+    engine_.init();
+  }
+
+  void process() {
+    auto t = engine_.makeTransaction();
+    t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  }
+
+public:
+  Engine engine_;
+};
+
+TEST_F(RuleProfileTest, disabled) {
+  EXPECT_FALSE(engine_.isProfileEnabled());
+  process();
+  EXPECT_EQ(engine_.dumpProfile(), R"({"rules":[],"operators":[]})");
+}
+
+TEST_F(RuleProfileTest, enabled) {
+  engine_.enableProfile(true);
+  EXPECT_TRUE(engine_.isProfileEnabled());
+
+  // Each thread counts into its own shard, and the shards are merged by the dump
+  process();
+  std::thread thread([this]() { process(); });
+  thread.join();
+
+  std::string profile = engine_.dumpProfile();
+  EXPECT_NE(profile.find(R"({"id":1,"phase":1,)"), std::string::npos);
+  EXPECT_NE(profile.find(R"("operator":"streq","evaluate_count":2,"matched_count":2,)"),
+            std::string::npos);
+  EXPECT_NE(profile.find(R"("operator":"streq","evaluate_count":2,"matched_count":0,)"),
+            std::string::npos);
+  EXPECT_NE(profile.find(R"("operators":[{"name":"streq","evaluate_count":4,)"),
+            std::string::npos);
+
+  // The counting stops after the profiling is disabled
+  engine_.enableProfile(false);
+  process();
+  EXPECT_EQ(engine_.dumpProfile(), profile);
+
+  engine_.resetProfile();
+  EXPECT_EQ(engine_.dumpProfile(), R"({"rules":[],"operators":[]})");
+}
+} // namespace Integration
+} // namespace Wge
@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine.h"
+
+namespace Wge {
+namespace Integration {
+class StartupTest : public testing::Test {
+public:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() / "wge_startup_test";
+    std::filesystem::create_directories(dir_);
+
+    std::string pmf_path = std::filesystem::absolute("test/test_data/pmf_test.data").string();
+    writeFile("1.conf", R"(SecRuleEngine On
+SecAction "id:1,phase:1,pass,nolog,setvar:tx.foo=select * from users,setvar:tx.bar=apc.enabled"
+SecRule TX:foo "@pm insert select" "id:2,phase:1,pass,nolog,setvar:tx.pm=1"
+SecRule TX:bar "@within apc.enabled apc.enable_cli" "id:3,phase:2,pass,nolog,setvar:tx.within=1")");
+    writeFile("2.conf", "SecRule TX:bar \"@pmFromFile " + pmf_path +
+                            "\" \"id:4,phase:1,pass,nolog,setvar:tx.pmf=1\"\n" +
+                            R"(SecRule TX:foo "@rx users$" "id:5,phase:1,pass,nolog,chain"
+  SecRule TX:foo "@rx ^select" "setvar:tx.chain=1"
+SecRule TX:foo "@rx ^(select)\s" "id:6,phase:1,pass,nolog,capture,setvar:tx.rx=1")");
+  }
+
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+public:
+  std::vector<std::string> files() const {
+    return {(dir_ / "1.conf").string(), (dir_ / "2.conf").string()};
+  }
+
+  static std::vector<uint64_t> ruleIds(const Engine& engine) {
+    std::vector<uint64_t> ids;
+    for (RulePhaseType phase = 1; phase <= PHASE_TOTAL; ++phase) {
+      for (auto& rule : engine.rules(phase)) {
+        ids.emplace_back(rule.id());
+      }
+    }
+    return ids;
+  }
+
+protected:
+  void writeFile(const std::string& name, const std::string& content) {
+    std::ofstream ofs(dir_ / name);
+    ofs << content;
+  }
+
+protected:
+  std::filesystem::path dir_;
+};
+
+TEST_F(StartupTest, loadFromFiles) {
+  Engine sequential(spdlog::level::off);
+  for (auto& file : files()) {
+    ASSERT_TRUE(sequential.loadFromFile(file).has_value());
+  }
+  sequential.init(1);
+
+  Engine parallel(spdlog::level::off);
+  ASSERT_TRUE(parallel.loadFromFiles(files(), 2).has_value());
+  parallel.init(4);
+
+  // The rules are the same as loading the files one by one
+  EXPECT_EQ(ruleIds(parallel), ruleIds(sequential));
+  EXPECT_EQ(parallel.startupStats().operator_count_, sequential.startupStats().operator_count_);
+  EXPECT_EQ(parallel.startupStats().operator_count_, 6);
+  EXPECT_EQ(sequential.startupStats().compile_concurrency_, 1);
+}
+
+TEST_F(StartupTest, loadFromFilesError) {
+  Engine engine(spdlog::level::off);
+  std::vector<std::string> file_paths = files();
+  file_paths.emplace_back("not_exists.conf");
+  auto result = engine.loadFromFiles(file_paths);
+  ASSERT_FALSE(result.has_value());
+  EXPECT_EQ(result.error(), "open file not_exists.conf failed");
+}
+
+TEST_F(StartupTest, compile) {
+  Engine engine(spdlog::level::off);
+  ASSERT_TRUE(engine.loadFromFiles(files()).has_value());
+  engine.init();
+
+  // The operators that are compiled by the init method work as well as before
+  auto t = engine.makeTransaction();
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  EXPECT_TRUE(t->hasVariable("", "pm"));
+  EXPECT_TRUE(t->hasVariable("", "pmf"));
+  EXPECT_TRUE(t->hasVariable("", "chain"));
+  EXPECT_TRUE(t->hasVariable("", "rx"));
+  EXPECT_EQ(t->getCapture(1), "select");
+
+  t->processRequestBody("");
+  EXPECT_TRUE(t->hasVariable("", "within"));
+}
+
+TEST_F(StartupTest, snapshot) {
+  std::string snapshot_path = (dir_ / "rules.snapshot").string();
+  std::string other_snapshot_path = (dir_ / "other.snapshot").string();
+  {
+    Engine engine(spdlog::level::off);
+    ASSERT_TRUE(engine.loadFromFiles(files()).has_value());
+    engine.init();
+    EXPECT_EQ(engine.startupStats().snapshot_deserialized_count_, 0);
+    auto result = engine.saveSnapshot(snapshot_path);
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    // The databases of the other engine (e.g. the predecessor during a reload) are not saved
+    writeFile("3.conf", R"(SecRule TX:foo "@pm other engine" "id:7,phase:1,pass,nolog")");
+    Engine other_engine(spdlog::level::off);
+    ASSERT_TRUE(other_engine.loadFromFile((dir_ / "3.conf").string()).has_value());
+    other_engine.init();
+    result = engine.saveSnapshot(other_snapshot_path);
+    ASSERT_TRUE(result.has_value()) << result.error();
+  }
+
+  Engine other_engine(spdlog::level::off);
+  ASSERT_TRUE(other_engine.loadFromFiles(files()).has_value());
+  ASSERT_TRUE(other_engine.loadSnapshot(other_snapshot_path).has_value());
+
+  Engine engine(spdlog::level::off);
+  ASSERT_TRUE(engine.loadFromFiles(files()).has_value());
+  auto result = engine.loadSnapshot(snapshot_path);
+  ASSERT_TRUE(result.has_value()) << result.error();
+  EXPECT_GT(engine.startupStats().snapshot_database_count_, 0);
+  EXPECT_EQ(engine.startupStats().snapshot_database_count_,
+            other_engine.startupStats().snapshot_database_count_);
+  engine.init();
+
+  // The databases that are cached by the operators of the first engine are reused rather than
+  // deserialized, but the prefilters are built by each engine, so they must be deserialized.
+  EXPECT_GT(engine.startupStats().snapshot_deserialized_count_, 0);
+  EXPECT_LE(engine.startupStats().snapshot_deserialized_count_,
+            engine.startupStats().snapshot_database_count_);
+
+  auto t = engine.makeTransaction();
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  EXPECT_TRUE(t->hasVariable("", "pm"));
+  EXPECT_TRUE(t->hasVariable("", "pmf"));
+}
+
+TEST_F(StartupTest, snapshotOfOtherRuleSet) {
+  std::string snapshot_path = (dir_ / "rules.snapshot").string();
+  {
+    Engine engine(spdlog::level::off);
+    ASSERT_TRUE(engine.loadFromFiles(files()).has_value());
+    engine.init();
+    ASSERT_TRUE(engine.saveSnapshot(snapshot_path).has_value());
+  }
+
+  Engine engine(spdlog::level::off);
+  ASSERT_TRUE(engine.loadFromFile(files().front()).has_value());
+  EXPECT_FALSE(engine.loadSnapshot(snapshot_path).has_value());
+  EXPECT_FALSE(engine.loadSnapshot((dir_ / "not_exists.snapshot").string()).has_value());
+}
+} // namespace Integration
+} // namespace Wge
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "reloadable_engine.h"
+
+namespace Wge {
+namespace Integration {
+class ReloadTest : public testing::Test {
+public:
+  ReloadTest()
+      : rule_file_((std::filesystem::temp_directory_path() / "wge_reload_test.conf").string()),
+        engine_([this](Engine& engine) { return engine.loadFromFile(rule_file_); },
+                spdlog::level::off) {}
+
+  void TearDown() override { std::filesystem::remove(rule_file_); }
+
+public:
+  void writeRules(const std::string& value) {
+    std::ofstream ofs(rule_file_, std::ios::trunc);
+    ofs << "SecRuleEngine On\n"
+        << R"(SecAction "id:1,phase:1,pass,nolog,setvar:tx.foo=)" << value << "\"\n"
+        << R"(SecRule TX:foo "@rx ^v2$" "id:2,phase:1,pass,nolog,setvar:tx.v2=1")" << "\n";
+  }
+
+  bool isV2(Transaction& t) {
+    t.processRequestHeaders(nullptr, nullptr, 0, nullptr);
+    return t.hasVariable("", "v2");
+  }
+
+public:
+  std::string rule_file_;
+  ReloadableEngine engine_;
+};
+
+TEST_F(ReloadTest, reload) {
+  writeRules("v1");
+  ASSERT_TRUE(engine_.init().has_value());
+  EXPECT_EQ(engine_.version(), 1);
+
+  // The in-flight transaction keeps the old engine
+  auto old_t = engine_.makeTransaction();
+  std::weak_ptr<const Engine> old_engine = engine_.engine();
+  const PersistentStorage::Storage* old_storage = &engine_.engine()->storage();
+
+  writeRules("v2");
+  auto result = engine_.reload().get();
+  ASSERT_TRUE(result.has_value()) << result.error();
+  EXPECT_EQ(result.value(), 2);
+  EXPECT_EQ(engine_.version(), 2);
+
+  auto new_t = engine_.makeTransaction();
+  EXPECT_TRUE(isV2(*new_t));
+  EXPECT_FALSE(old_engine.expired());
+  EXPECT_FALSE(isV2(*old_t));
+
+  // The old engine is destroyed after its last transaction
+  old_t.reset();
+  EXPECT_TRUE(old_engine.expired());
+
+  // The persistent storage is shared by the successor
+  EXPECT_EQ(&engine_.engine()->storage(), old_storage);
+}
+
+TEST_F(ReloadTest, reloadFailed) {
+  writeRules("v1");
+  ASSERT_TRUE(engine_.init().has_value());
+
+  std::ofstream(rule_file_, std::ios::trunc) << "SecRule TX:foo \"@rx";
+  auto result = engine_.reload().get();
+  EXPECT_FALSE(result.has_value());
+
+  // The current engine keeps serving
+  EXPECT_EQ(engine_.version(), 1);
+  auto t = engine_.makeTransaction();
+  EXPECT_FALSE(isV2(*t));
+}
+
+TEST_F(ReloadTest, reloadWhileProcessing) {
+  writeRules("v1");
+  ASSERT_TRUE(engine_.init().has_value());
+
+  std::atomic_bool stop{false};
+  std::atomic<size_t> count{0};
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < 4; ++i) {
+    workers.emplace_back([&]() {
+      while (!stop) {
+        auto t = engine_.makeTransaction();
+        isV2(*t);
+        ++count;
+      }
+    });
+  }
+
+  writeRules("v2");
+  for (size_t i = 0; i < 3; ++i) {
+    auto result = engine_.reload().get();
+    EXPECT_TRUE(result.has_value());
+  }
+  stop = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  EXPECT_EQ(engine_.version(), 4);
+  EXPECT_GT(count, 0);
+  auto t = engine_.makeTransaction();
+  EXPECT_TRUE(isV2(*t));
+}
+
+TEST_F(ReloadTest, reloadGrowsScratch) {
+  writeRules("v1");
+  ASSERT_TRUE(engine_.init().has_value());
+
+  // The worker scratch space of this thread is cloned from the main scratch space by the first
+  // scan
+  auto t = engine_.makeTransaction();
+  EXPECT_FALSE(isV2(*t));
+
+  // The successor compiles the bigger databases, which grow the main scratch space
+  std::string pmf_file = rule_file_ + ".data";
+  std::string pm_tokens;
+  {
+    std::ofstream ofs(pmf_file, std::ios::trunc);
+    for (size_t i = 0; i < 1000; ++i) {
+      ofs << "pmf_token_" << i << "\n";
+      pm_tokens += " pm_token_" + std::to_string(i);
+    }
+  }
+  {
+    std::ofstream ofs(rule_file_, std::ios::trunc);
+    ofs << "SecRuleEngine On\n"
+        << R"(SecAction "id:1,phase:1,pass,nolog,setvar:tx.foo=pm_token_999 pmf_token_999")"
+        << "\n"
+        << R"(SecRule TX:foo "@pm)" << pm_tokens << R"(" "id:2,phase:1,pass,nolog,setvar:tx.pm=1")"
+        << "\n"
+        << R"(SecRule TX:foo "@pmFromFile )" << pmf_file
+        << R"(" "id:3,phase:1,pass,nolog,setvar:tx.pmf=1")" << "\n"
+        << R"(SecRule TX:foo "@rx (?:\w+_){2,16}\d{3}\s+pmf" )"
+        << R"("id:4,phase:1,pass,nolog,setvar:tx.rx=1")" << "\n";
+  }
+  auto result = engine_.reload().get();
+  std::filesystem::remove(pmf_file);
+  ASSERT_TRUE(result.has_value()) << result.error();
+
+  // The stale worker scratch space of this thread is cloned again before scanning the new
+  // databases
+  auto scan = [&]() {
+    auto t = engine_.makeTransaction();
+    t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+    EXPECT_TRUE(t->hasVariable("", "pm"));
+    EXPECT_TRUE(t->hasVariable("", "pmf"));
+    EXPECT_TRUE(t->hasVariable("", "rx"));
+  };
+  scan();
+  std::thread(scan).join();
+}
+
+TEST_F(ReloadTest, reloadStopsAuditLog) {
+  std::string log_file = rule_file_ + ".log";
+  std::filesystem::remove(log_file);
+  std::ofstream(rule_file_, std::ios::trunc) << "SecRuleEngine On\n"
+                                             << "SecAuditEngine On\n"
+                                             << "SecAuditLogType Serial\n"
+                                             << "SecAuditLog " << log_file << "\n"
+                                             << "SecAuditLogParts AZ\n";
+  ASSERT_TRUE(engine_.init().has_value());
+  ASSERT_NE(engine_.engine()->auditLog(), nullptr);
+
+  auto old_t = engine_.makeTransaction();
+  std::weak_ptr<const Engine> old_engine = engine_.engine();
+  auto result = engine_.reload().get();
+  ASSERT_TRUE(result.has_value()) << result.error();
+
+  // The in-flight transaction logs to the audit log of the old engine, and the old engine is
+  // destroyed by a worker thread
+  const std::string unique_id(old_t->getUniqueId());
+  old_t->processLogging();
+  std::thread([&]() { old_t.reset(); }).join();
+  EXPECT_TRUE(old_engine.expired());
+
+  // The next reload stops the audit log of the destroyed engine, which writes the pending records
+  result = engine_.reload().get();
+  ASSERT_TRUE(result.has_value()) << result.error();
+  std::ifstream ifs(log_file);
+  std::string log((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  EXPECT_NE(log.find(unique_id), std::string::npos);
+  std::filesystem::remove(log_file);
+}
+} // namespace Integration
+} // namespace Wge
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "engine.h"
+
+namespace Wge {
+namespace Integration {
+TEST(RuleInputFilterTest, inputFilter) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecRule REQUEST_BODY "@rx ." "id:1,phase:2,pass,setvar:tx.rule1=1"
+        SecRule ARGS_POST|REQUEST_COOKIES "@rx ." "id:2,phase:2,pass,setvar:tx.rule2=1"
+        SecRule XML:/* "@rx ." "id:3,phase:2,pass,setvar:tx.rule3=1"
+        SecRule REQUEST_HEADERS|REQUEST_BODY "@rx ." "id:4,phase:2,pass,setvar:tx.rule4=1"
+        SecRule &REQUEST_BODY "@eq 0" "id:5,phase:2,pass,setvar:tx.rule5=1"
+        SecRule RESPONSE_BODY "@rx ." "id:6,phase:2,pass,setvar:tx.rule6=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  ASSERT_TRUE(result.has_value());
+  engine.init();
+
+  using InputSource = RuleInputFilter::InputSource;
+  auto bit = [](InputSource source) -> RuleInputFilter::Inputs {
+    return 1 << static_cast<size_t>(source);
+  };
+
+  // The rules that read the headers or the counters can't be skipped
+  auto& rules = engine.rules(2);
+  ASSERT_EQ(rules.size(), 6);
+  EXPECT_EQ(RuleInputFilter::requiredInputs(rules[0]), bit(InputSource::RequestBody));
+  EXPECT_EQ(RuleInputFilter::requiredInputs(rules[1]),
+            bit(InputSource::RequestBody) | bit(InputSource::RequestCookies));
+  EXPECT_EQ(RuleInputFilter::requiredInputs(rules[2]), bit(InputSource::Xml));
+  EXPECT_EQ(RuleInputFilter::requiredInputs(rules[3]), 0);
+  EXPECT_EQ(RuleInputFilter::requiredInputs(rules[4]), 0);
+  EXPECT_EQ(RuleInputFilter::requiredInputs(rules[5]), bit(InputSource::ResponseBody));
+
+  // The consecutive rules are jumped over at once
+  const RuleInputFilter& filter = engine.ruleInputFilter(2);
+  EXPECT_TRUE(filter.enabled());
+  EXPECT_EQ(filter.nextCandidate(0, 0), 3);
+  EXPECT_EQ(filter.nextCandidate(0, 5), 6);
+  EXPECT_EQ(filter.nextCandidate(bit(InputSource::RequestCookies), 0), 1);
+  EXPECT_EQ(filter.nextCandidate(bit(InputSource::ResponseBody), 5), 5);
+
+  // The result of the evaluation must be the same as without the filter
+  auto t = engine.makeTransaction();
+  t->processUri("/", "GET", "1.1");
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  t->processRequestBody("");
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule1")));
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule2")));
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule3")));
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule4")));
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule5")), 1);
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule6")));
+
+  t = engine.makeTransaction();
+  t->processUri("/", "POST", "1.1");
+  t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+  t->processRequestBody("hello");
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule1")), 1);
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule3")));
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "rule4")), 1);
+  EXPECT_TRUE(IS_EMPTY_VARIANT(t->getVariable("", "rule5")));
+}
+} // namespace Integration
+} // namespace Wge
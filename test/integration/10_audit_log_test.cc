@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "audit_log.h"
+#include "engine.h"
+
+namespace Wge {
+namespace Integration {
+namespace {
+std::string readFile(const std::filesystem::path& file) {
+  std::ifstream ifs(file);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  return ss.str();
+}
+} // namespace
+
+TEST(AuditLogTest, serial) {
+  std::filesystem::path file = std::filesystem::temp_directory_path() / "wge_audit_log_test.log";
+  std::filesystem::remove(file);
+
+  {
+    const std::string directive = std::format(R"(
+        SecRuleEngine On
+        SecAuditEngine RelevantOnly
+        SecAuditLogType Serial
+        SecAuditLog {}
+        SecAuditLogParts ABHZ
+        SecRule REQUEST_URI "@streq /attack" "id:1,phase:1,pass,log,msg:'attack detected'")",
+                                              file.string());
+
+    Engine engine(spdlog::level::off);
+    auto result = engine.load(directive);
+    ASSERT_TRUE(result.has_value());
+    engine.init();
+    ASSERT_NE(engine.auditLog(), nullptr);
+
+    // Only the relevant transaction is logged
+    for (auto uri : {"/attack", "/normal"}) {
+      auto t = engine.makeTransaction();
+      t->processConnection("192.168.1.1", 12345, "10.0.0.1", 80);
+      t->processUri(uri, "GET", "1.1");
+      t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+      t->processLogging();
+    }
+
+    // The pending records are written when the engine is destroyed
+  }
+
+  std::string log = readFile(file);
+  EXPECT_NE(log.find("GET /attack HTTP/1.1"), std::string::npos);
+  EXPECT_NE(log.find("[id \"1\"] [msg \"attack detected\"]"), std::string::npos);
+  EXPECT_NE(log.find("192.168.1.1 12345 10.0.0.1 80"), std::string::npos);
+  EXPECT_EQ(log.find("/normal"), std::string::npos);
+  std::filesystem::remove(file);
+}
+
+TEST(AuditLogTest, concurrentJson) {
+  std::filesystem::path dir = std::filesystem::temp_directory_path() / "wge_audit_log_test";
+  std::filesystem::path index = dir / "index.log";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  {
+    const std::string directive = std::format(R"(
+        SecRuleEngine On
+        SecAuditEngine On
+        SecAuditLogType Concurrent
+        SecAuditLogFormat JSON
+        SecAuditLog {}
+        SecAuditLogStorageDir "{}"
+        SecRule REQUEST_URI "@streq /private" "id:1,phase:1,pass,nolog,ctl:auditEngine=Off"
+        SecRule REQUEST_URI "@streq /secret" "id:2,phase:1,pass,nolog,ctl:auditLogParts=-C")",
+                                              index.string(), dir.string());
+
+    Engine engine(spdlog::level::off);
+    auto result = engine.load(directive);
+    ASSERT_TRUE(result.has_value());
+    engine.init();
+
+    for (auto uri : {"/public", "/private", "/secret"}) {
+      auto t = engine.makeTransaction();
+      t->processUri(uri, "POST", "1.1");
+      t->processRequestHeaders(nullptr, nullptr, 0, nullptr);
+      t->processRequestBody("password=123");
+      t->processLogging();
+    }
+  }
+
+  // Each record is written to its own file, and indexed by the index file
+  std::vector<std::string> records;
+  for (auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
+    if (entry.is_regular_file() && entry.path() != index) {
+      records.emplace_back(readFile(entry.path()));
+    }
+  }
+  ASSERT_EQ(records.size(), 2);
+  auto public_record = std::find_if(records.begin(), records.end(), [](const std::string& record) {
+    return record.find("\"uri\":\"/public\"") != std::string::npos;
+  });
+  ASSERT_NE(public_record, records.end());
+  EXPECT_NE(public_record->find("\"body\":\"password=123\""), std::string::npos);
+  auto secret_record = std::find_if(records.begin(), records.end(), [](const std::string& record) {
+    return record.find("\"uri\":\"/secret\"") != std::string::npos;
+  });
+  ASSERT_NE(secret_record, records.end());
+  EXPECT_EQ(secret_record->find("password=123"), std::string::npos);
+
+  std::string index_log = readFile(index);
+  EXPECT_EQ(std::count(index_log.begin(), index_log.end(), '\n'), 2);
+  std::filesystem::remove_all(dir);
+}
+} // namespace Integration
+} // namespace Wge
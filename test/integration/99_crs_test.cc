@@ -31,10 +31,8 @@ class CrsTest : public testing::Test {
 public:
   CrsTest() : engine_(spdlog::level::trace) {}
 
-public:
-  void SetUp() override {
-    std::expected<bool, std::string> result;
-    std::vector<std::string> rule_files = {
+  static const std::vector<std::string>& ruleFiles() {
+    static const std::vector<std::string> rule_files = {
         "test/test_data/engin-setup.conf",
         "test/test_data/crs-setup.conf",
         "test/test_data/coreruleset/rules/REQUEST-901-INITIALIZATION.conf",
@@ -64,6 +62,11 @@ public:
         "test/test_data/coreruleset/rules/RESPONSE-959-BLOCKING-EVALUATION.conf",
         "test/test_data/coreruleset/rules/RESPONSE-980-CORRELATION.conf",
     };
+    return rule_files;
+  }
+
+  void SetUp() override {
+    std::expected<bool, std::string> result;
 
     // Set the blocking_paranoia_level
     result = engine_.load(
@@ -73,12 +76,10 @@ public:
       return;
     }
 
-    for (auto& rule_file : rule_files) {
-      result = engine_.loadFromFile(rule_file);
-      if (!result.has_value()) {
-        std::cout << "Load rules error: " << result.error() << std::endl;
-        return;
-      }
+    result = engine_.loadFromFiles(ruleFiles());
+    if (!result.has_value()) {
+      std::cout << "Load rules error: " << result.error() << std::endl;
+      return;
     }
 
     engine_.init();
@@ -176,5 +177,37 @@ TEST_F(CrsTest, crs) {
   });
   result.get();
 }
+
+TEST_F(CrsTest, loadFromFile) {
+  // Loading the files one by one gets the same rules as loading them concurrently
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(
+      R"(SecAction "id:205, phase:1,nolog,pass,t:none,setvar:tx.blocking_paranoia_level=4")");
+  ASSERT_TRUE(result.has_value());
+  for (auto& rule_file : ruleFiles()) {
+    result = engine.loadFromFile(rule_file);
+    ASSERT_TRUE(result.has_value()) << result.error();
+  }
+  engine.init();
+
+  for (RulePhaseType phase = 1; phase <= PHASE_TOTAL; ++phase) {
+    auto& rules = engine.rules(phase);
+    auto& expected_rules = engine_.rules(phase);
+    ASSERT_EQ(rules.size(), expected_rules.size());
+    for (size_t i = 0; i < rules.size(); ++i) {
+      EXPECT_EQ(rules[i].id(), expected_rules[i].id());
+    }
+  }
+
+  std::future<void> future = std::async(std::launch::async, [&]() {
+    auto t = engine.makeTransaction();
+    t->processConnection(downstream_ip_, downstream_port_, upstream_ip_, upstream_port_);
+    t->processUri(uri_, method_, version_);
+    t->processRequestHeaders(request_header_find_, request_header_traversal_,
+                             request_headers_.size(), nullptr);
+    t->processRequestBody(request_body_, nullptr);
+  });
+  future.get();
+}
 } // namespace Integration
 } // namespace Wge
\ No newline at end of file
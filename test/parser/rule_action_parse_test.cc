@@ -830,6 +830,28 @@ TEST_F(RuleActionParseTest, ActionInitCol) {
   }
 }
 
+TEST_F(RuleActionParseTest, ActionSetPersistentVar) {
+  const std::string rule_directive =
+      R"(SecRule ARGS:aaa "foo" "id:1,phase:1,initcol:ip=%{remote_addr},setvar:ip.count=+5,setvar:'IP.count=-2'")";
+
+  Antlr4::Parser parser;
+  auto result = parser.load(rule_directive);
+  ASSERT_TRUE(result.has_value()) << result.error();
+  auto& actions = parser.rules()[0].back().actions();
+  ASSERT_EQ(actions.size(), 3);
+  auto increase = dynamic_cast<const Action::SetPersistentVar*>(actions[1].get());
+  ASSERT_NE(increase, nullptr);
+  EXPECT_EQ(increase->key(), "count");
+  EXPECT_EQ(increase->delta(), 5);
+  auto decrease = dynamic_cast<const Action::SetPersistentVar*>(actions[2].get());
+  ASSERT_NE(decrease, nullptr);
+  EXPECT_EQ(decrease->delta(), -2);
+
+  // Only the integer increment of the persistent collections is supported
+  EXPECT_FALSE(parser.load(R"(SecAction "id:2,phase:1,setvar:foo.count=+1")").has_value());
+  EXPECT_FALSE(parser.load(R"(SecAction "id:3,phase:1,setvar:ip.count=+a")").has_value());
+}
+
 TEST_F(RuleActionParseTest, ActionSkipAfter) {
   const std::string rule_directive =
       R"(SecRule ARGS:aaa|ARGS:bbb "foo" "id:1,phase:1,skipAfter:hi,msg:'aaa'")";
@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "engine.h"
+
+namespace Wge {
+TEST(AppendBodyTest, UrlEncoded) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:100,phase:1,ctl:requestBodyProcessor=URLENCODED"
+        SecRule ARGS_POST:foo "@streq bar" "id:1,phase:2,setvar:tx.foo=%{MATCHED_VAR}"
+        SecRule ARGS_POST:evil "@streq payload" "id:2,phase:2,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The argument that spans multiple chunks is inspected once it is complete
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(nullptr, nullptr, 0);
+    std::string chunk1 = "a=1&fo";
+    std::string chunk2 = "o=ba";
+    std::string chunk3 = "r&b=2";
+    EXPECT_TRUE(t->appendRequestBody(chunk1, false));
+    EXPECT_FALSE(t->hasVariable("", "foo"));
+    EXPECT_TRUE(t->appendRequestBody(chunk2, false));
+    EXPECT_FALSE(t->hasVariable("", "foo"));
+    EXPECT_TRUE(t->appendRequestBody(chunk3, true));
+    EXPECT_TRUE(t->hasVariable("", "foo"));
+
+    // The value must be still valid after the chunks are released
+    chunk1.assign(chunk1.size(), 'x');
+    chunk2.assign(chunk2.size(), 'x');
+    chunk3.assign(chunk3.size(), 'x');
+    EXPECT_EQ(std::get<std::string_view>(t->getVariable("", "foo")), "bar");
+  }
+
+  // The request is denied before the end of the stream
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(nullptr, nullptr, 0);
+    EXPECT_TRUE(t->appendRequestBody("a=1&evil=pay", false));
+    EXPECT_FALSE(t->appendRequestBody("load&b=2", false));
+    EXPECT_FALSE(t->appendRequestBody("&c=3", true));
+  }
+}
+
+TEST(AppendBodyTest, Json) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:100,phase:1,ctl:requestBodyProcessor=JSON"
+        SecRule ARGS_POST:foo "@streq bar" "id:1,phase:2,setvar:tx.foo_count=+1"
+        SecRule ARGS_POST:evil "@streq payload" "id:2,phase:2,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(nullptr, nullptr, 0);
+    EXPECT_TRUE(t->appendRequestBody(R"({"a":"1","fo)", false));
+    EXPECT_TRUE(t->appendRequestBody(R"(o":"ba)", false));
+    EXPECT_TRUE(t->appendRequestBody(R"(r","b":"2"})", true));
+    EXPECT_EQ(std::get<int64_t>(t->getVariable("", "foo_count")), 1);
+  }
+
+  {
+    auto t = engine.makeTransaction();
+    t->processRequestHeaders(nullptr, nullptr, 0);
+    EXPECT_TRUE(t->appendRequestBody(R"({"a":"1",)", false));
+    EXPECT_FALSE(t->appendRequestBody(R"("evil":"payload",)", false));
+  }
+}
+
+TEST(AppendBodyTest, ResponseBody) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecResponseBodyAccess On
+        SecRule RESPONSE_BODY "@contains secret" "id:1,phase:4,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  auto t = engine.makeTransaction();
+  EXPECT_TRUE(t->appendResponseBody("hello ", false));
+  EXPECT_FALSE(t->appendResponseBody("secret world", false));
+  EXPECT_FALSE(t->appendResponseBody("!", true));
+}
+
+TEST(AppendBodyTest, PatternSpansChunks) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecResponseBodyAccess On
+        SecRule REQUEST_BODY "@contains payload" "id:1,phase:2,deny"
+        SecRule RESPONSE_BODY "@contains secret" "id:2,phase:4,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The tail of the previous window is inspected with the next chunk
+  auto t = engine.makeTransaction();
+  t->processRequestHeaders(nullptr, nullptr, 0);
+  EXPECT_TRUE(t->appendRequestBody("a=1&evil=pay", false));
+  EXPECT_FALSE(t->appendRequestBody("load&b=2", true));
+  EXPECT_TRUE(t->appendResponseBody("hello sec", false));
+  EXPECT_FALSE(t->appendResponseBody("ret world", true));
+}
+
+TEST(AppendBodyTest, RulesOfWindow) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:100,phase:1,ctl:requestBodyProcessor=URLENCODED"
+        SecAction "id:1,phase:2,setvar:tx.action_count=+1"
+        SecRule ARGS_POST "@rx ^bar" "id:2,phase:2,setvar:tx.bar_count=+1"
+        SecRule ARGS_POST:evil "@streq payload" "id:3,phase:2,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The rules that don't read the body are evaluated once by the last window, and the matched
+  // body rule is not evaluated again by the rest of the windows
+  auto t = engine.makeTransaction();
+  t->processRequestHeaders(nullptr, nullptr, 0);
+  EXPECT_TRUE(t->appendRequestBody("a=bar1&", false));
+  EXPECT_FALSE(t->hasVariable("", "action_count"));
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "bar_count")), 1);
+  EXPECT_TRUE(t->appendRequestBody("b=bar2&", false));
+  EXPECT_TRUE(t->appendRequestBody("c=bar3", true));
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "action_count")), 1);
+  EXPECT_EQ(std::get<int64_t>(t->getVariable("", "bar_count")), 1);
+}
+
+TEST(AppendBodyTest, InMemoryLimit) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecRequestBodyInMemoryLimit 16
+        SecAction "id:100,phase:1,ctl:requestBodyProcessor=URLENCODED"
+        SecRule REQBODY_ERROR "!@eq 0" "id:1,phase:2,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The argument that is carried over to the next chunk exceeds the limit
+  auto t = engine.makeTransaction();
+  t->processRequestHeaders(nullptr, nullptr, 0);
+  EXPECT_TRUE(t->appendRequestBody("a=0123456789", false));
+  EXPECT_FALSE(t->appendRequestBody("0123456789", false));
+  EXPECT_FALSE(t->getReqBodyErrorMsg().empty());
+}
+
+TEST(AppendBodyTest, InvalidJson) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:100,phase:1,ctl:requestBodyProcessor=JSON"
+        SecRule REQBODY_ERROR "!@eq 0" "id:1,phase:2,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  auto t = engine.makeTransaction();
+  t->processRequestHeaders(nullptr, nullptr, 0);
+  EXPECT_FALSE(t->appendRequestBody(R"({"a":"1"}x)", true));
+  EXPECT_FALSE(t->getReqBodyErrorMsg().empty());
+}
+} // namespace Wge
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <format>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine.h"
+#include "http_extractor.h"
+
+namespace Wge {
+TEST(HeaderSpanTest, index) {
+  // Enough headers to make the probe sequences of the index collide
+  std::vector<std::string> storage;
+  storage.reserve(200);
+  std::vector<Header> headers;
+  for (size_t i = 0; i < 100; ++i) {
+    storage.emplace_back(std::format("x-header-{}", i % 50));
+    storage.emplace_back(std::format("value-{}", i));
+    headers.emplace_back(storage[storage.size() - 2], storage.back());
+  }
+
+  HttpHeaders http_headers;
+  http_headers.set(headers);
+  EXPECT_TRUE(http_headers.provided());
+  EXPECT_EQ(http_headers.size(), 100);
+  for (size_t i = 0; i < 50; ++i) {
+    std::string key = std::format("x-header-{}", i);
+    EXPECT_EQ(http_headers.count(key), 2);
+    EXPECT_EQ(http_headers.front(key), std::format("value-{}", i));
+
+    // The values of a key are in the order that they are provided
+    std::vector<std::string_view> values;
+    http_headers.find(key, [&](std::string_view value) { values.emplace_back(value); });
+    ASSERT_EQ(values.size(), 2);
+    EXPECT_EQ(values[0], std::format("value-{}", i));
+    EXPECT_EQ(values[1], std::format("value-{}", i + 50));
+  }
+  EXPECT_EQ(http_headers.count("x-header-50"), 0);
+  EXPECT_EQ(http_headers.front("x-header"), "");
+
+  // The traversal stops when the callback returns false
+  size_t traversed = 0;
+  http_headers.traverse([&](std::string_view key, std::string_view value) {
+    EXPECT_EQ(key, headers[traversed].first);
+    EXPECT_EQ(value, headers[traversed].second);
+    return ++traversed < 10;
+  });
+  EXPECT_EQ(traversed, 10);
+
+  http_headers.clear();
+  EXPECT_FALSE(http_headers.provided());
+  EXPECT_EQ(http_headers.size(), 0);
+  EXPECT_EQ(http_headers.count("x-header-0"), 0);
+}
+
+TEST(HeaderSpanTest, process) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecRequestBodyAccess On
+        SecRule REQUEST_HEADERS:host "@streq localhost" "id:1,phase:1,setvar:tx.host=%{MATCHED_VAR}"
+        SecRule &REQUEST_HEADERS:accept "@eq 2" "id:2,phase:1,setvar:tx.accept=1"
+        SecRule &REQUEST_HEADERS "@eq 6" "id:3,phase:1,setvar:tx.count=1"
+        SecRule REQUEST_COOKIES:foo "@streq bar" "id:4,phase:1,setvar:tx.cookie=1"
+        SecRule REQUEST_HEADERS_NAMES "@streq x-evil" "id:5,phase:1,setvar:tx.name=1"
+        SecRule REQUEST_HEADERS:/^x-/ "@streq 1" "id:6,phase:1,setvar:tx.regex=1"
+        SecRule ARGS_POST:foo "@streq bar" "id:7,phase:2,setvar:tx.post=1"
+        SecRule RESPONSE_HEADERS:content-type "@contains html" "id:8,phase:3,setvar:tx.html=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  const std::vector<Header> request_headers = {
+      {"host", "localhost"},
+      {"accept", "text/html"},
+      {"cookie", "foo=bar; baz=qux"},
+      {"accept", "*/*"},
+      {"x-evil", "1"},
+      {"content-type", "application/x-www-form-urlencoded"},
+  };
+  const std::vector<Header> response_headers = {{"content-type", "text/html; charset=UTF-8"}};
+
+  auto t = engine.makeTransaction();
+  t->processUri("/", "POST", "1.1");
+  t->processRequestHeaders(request_headers);
+  t->processRequestBody("foo=bar");
+  t->processResponseHeaders("200", "HTTP/1.1", response_headers);
+  EXPECT_EQ(std::get<std::string_view>(t->getVariable("", "host")), "localhost");
+  EXPECT_TRUE(t->hasVariable("", "accept"));
+  EXPECT_TRUE(t->hasVariable("", "count"));
+  EXPECT_TRUE(t->hasVariable("", "cookie"));
+  EXPECT_TRUE(t->hasVariable("", "name"));
+  EXPECT_TRUE(t->hasVariable("", "regex"));
+  EXPECT_TRUE(t->hasVariable("", "post"));
+  EXPECT_TRUE(t->hasVariable("", "html"));
+}
+} // namespace Wge
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "engine.h"
+
+namespace Wge {
+TEST(ProcessBatchTest, phase) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecRule ARGS:skip "@streq 1" "id:1,phase:1,skip:1,setvar:tx.skipped=1"
+        SecAction "id:2,phase:1,setvar:tx.a=1"
+        SecRule ARGS:evil "@streq payload" "id:3,phase:1,deny"
+        SecRule ARGS:foo "@streq bar" "id:4,phase:1,setvar:tx.foo=%{MATCHED_VAR}"
+        SecAction "id:5,phase:1,setvar:tx.b=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  const std::vector<std::string> uris{"/?foo=bar", "/?evil=payload&foo=bar", "/?skip=1&foo=baz",
+                                      "/"};
+  std::vector<TransactionPtr> transactions;
+  std::vector<Transaction*> batch;
+  for (const auto& uri : uris) {
+    auto& t = transactions.emplace_back(engine.makeTransaction());
+    t->deferEvaluation(true);
+    t->processUri(uri, "GET", "1.1");
+
+    // The evaluation is deferred to the batch
+    EXPECT_TRUE(t->processRequestHeaders(nullptr, nullptr, 0));
+    EXPECT_TRUE(t->isSuspended());
+    EXPECT_FALSE(t->hasVariable("", "a"));
+    batch.emplace_back(t.get());
+  }
+
+  // The transaction that isn't deferred is ignored
+  auto ignored = engine.makeTransaction();
+  batch.emplace_back(ignored.get());
+
+  std::vector<bool> results = engine.processBatch(batch, 1);
+  EXPECT_EQ(results, std::vector<bool>({true, false, true, true, true}));
+  for (auto& t : transactions) {
+    EXPECT_FALSE(t->isSuspended());
+  }
+
+  EXPECT_TRUE(transactions[0]->hasVariable("", "a"));
+  EXPECT_EQ(std::get<std::string_view>(transactions[0]->getVariable("", "foo")), "bar");
+  EXPECT_TRUE(transactions[0]->hasVariable("", "b"));
+
+  EXPECT_TRUE(transactions[1]->hasVariable("", "a"));
+  EXPECT_FALSE(transactions[1]->hasVariable("", "foo"));
+  EXPECT_FALSE(transactions[1]->hasVariable("", "b"));
+
+  EXPECT_TRUE(transactions[2]->hasVariable("", "skipped"));
+  EXPECT_FALSE(transactions[2]->hasVariable("", "a"));
+  EXPECT_FALSE(transactions[2]->hasVariable("", "foo"));
+  EXPECT_TRUE(transactions[2]->hasVariable("", "b"));
+
+  EXPECT_TRUE(transactions[3]->hasVariable("", "a"));
+  EXPECT_FALSE(transactions[3]->hasVariable("", "foo"));
+  EXPECT_TRUE(transactions[3]->hasVariable("", "b"));
+
+  EXPECT_FALSE(ignored->hasVariable("", "a"));
+}
+
+TEST(ProcessBatchTest, resume) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:1,phase:1,setvar:tx.a=1"
+        SecAction "id:2,phase:1,setvar:tx.b=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The deferred evaluation can be done without the batch
+  auto t = engine.makeTransaction();
+  t->deferEvaluation(true);
+  EXPECT_TRUE(t->processRequestHeaders(nullptr, nullptr, 0));
+  EXPECT_TRUE(t->isSuspended());
+  EXPECT_EQ(t->resume(), Transaction::ProcessResult::Allow);
+  EXPECT_FALSE(t->isSuspended());
+  EXPECT_TRUE(t->hasVariable("", "a"));
+  EXPECT_TRUE(t->hasVariable("", "b"));
+}
+} // namespace Wge
@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine.h"
+#include "http_extractor.h"
+
+namespace Wge {
+TEST(ProcessBudgetTest, ruleBudget) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:1,phase:1,setvar:tx.a=1"
+        SecAction "id:2,phase:1,setvar:tx.b=1"
+        SecAction "id:3,phase:1,setvar:tx.c=1"
+        SecRule TX:a "@eq 1" "id:4,phase:1,setvar:tx.d=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // Each call evaluates two rules at most
+  auto t = engine.makeTransaction();
+  t->setProcessBudget(std::chrono::nanoseconds(0), 2);
+  EXPECT_TRUE(t->processRequestHeaders(nullptr, nullptr, 0));
+  EXPECT_TRUE(t->isSuspended());
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Suspended);
+  EXPECT_TRUE(t->hasVariable("", "b"));
+  EXPECT_FALSE(t->hasVariable("", "c"));
+
+  EXPECT_EQ(t->resume(), Transaction::ProcessResult::Allow);
+  EXPECT_FALSE(t->isSuspended());
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Allow);
+  EXPECT_TRUE(t->hasVariable("", "c"));
+  EXPECT_TRUE(t->hasVariable("", "d"));
+
+  // Nothing to resume
+  EXPECT_EQ(t->resume(), Transaction::ProcessResult::Allow);
+  EXPECT_FALSE(t->isSuspended());
+
+  // The budget is cleared when the transaction is reused
+  auto t2 = engine.makeTransaction();
+  EXPECT_TRUE(t2->processRequestHeaders(nullptr, nullptr, 0));
+  EXPECT_FALSE(t2->isSuspended());
+  EXPECT_TRUE(t2->hasVariable("", "d"));
+}
+
+TEST(ProcessBudgetTest, timeBudget) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:1,phase:1,setvar:tx.a=1"
+        SecAction "id:2,phase:1,setvar:tx.b=1"
+        SecAction "id:3,phase:1,setvar:tx.c=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The budget is exhausted by each rule, but at least one rule is evaluated per call
+  auto t = engine.makeTransaction();
+  t->setProcessBudget(std::chrono::nanoseconds(1));
+  size_t call_count = 1;
+  EXPECT_TRUE(t->processRequestHeaders(nullptr, nullptr, 0));
+  while (t->isSuspended()) {
+    EXPECT_NE(t->resume(), Transaction::ProcessResult::Deny);
+    ++call_count;
+  }
+  EXPECT_LE(call_count, 3);
+  EXPECT_TRUE(t->hasVariable("", "a"));
+  EXPECT_TRUE(t->hasVariable("", "b"));
+  EXPECT_TRUE(t->hasVariable("", "c"));
+}
+
+TEST(ProcessBudgetTest, denyAfterResume) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:1,phase:1,setvar:tx.a=1"
+        SecAction "id:2,phase:1,setvar:tx.b=1"
+        SecRule TX:a "@eq 1" "id:3,phase:1,deny,msg:'denied',log"
+        SecAction "id:4,phase:1,setvar:tx.c=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The callbacks of the suspended call are used by the resumed evaluation
+  auto t = engine.makeTransaction();
+  t->setProcessBudget(std::chrono::nanoseconds(0), 1);
+  int log_count = 0;
+  EXPECT_TRUE(t->processRequestHeaders(
+      nullptr, nullptr, 0,
+      [](const Rule& rule, void* user_data) { ++*static_cast<int*>(user_data); }, &log_count));
+  EXPECT_TRUE(t->isSuspended());
+  EXPECT_EQ(t->resume(), Transaction::ProcessResult::Suspended);
+  EXPECT_TRUE(t->isSuspended());
+  EXPECT_EQ(t->resume(), Transaction::ProcessResult::Deny);
+  EXPECT_FALSE(t->isSuspended());
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Deny);
+  EXPECT_EQ(log_count, 1);
+  EXPECT_FALSE(t->hasVariable("", "c"));
+}
+
+TEST(ProcessBudgetTest, appendRequestBody) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:100,phase:1,ctl:requestBodyProcessor=URLENCODED"
+        SecAction "id:1,phase:2,setvar:tx.a=1"
+        SecRule ARGS_POST:evil "@streq payload" "id:2,phase:2,deny")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The result of the stream is updated by the resumed evaluation
+  auto t = engine.makeTransaction();
+  EXPECT_TRUE(t->processRequestHeaders(nullptr, nullptr, 0));
+  t->setProcessBudget(std::chrono::nanoseconds(0), 1);
+  EXPECT_TRUE(t->appendRequestBody("a=1&evil=payload&", false));
+  EXPECT_TRUE(t->isSuspended());
+  EXPECT_EQ(t->resume(), Transaction::ProcessResult::Deny);
+  EXPECT_FALSE(t->appendRequestBody("b=2", true));
+}
+
+TEST(ProcessBudgetTest, rejectWhileSuspended) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecAction "id:1,phase:1,setvar:tx.a=1"
+        SecRule REQUEST_HEADERS:host "@streq example.com" "id:2,phase:1,setvar:tx.host=1"
+        SecRule REQUEST_BODY "@rx ." "id:3,phase:1,setvar:tx.body=1"
+        SecAction "id:4,phase:2,setvar:tx.c=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  // The process methods that are called while the evaluation is suspended are rejected before they
+  // change anything, and the suspended evaluation is kept
+  auto t = engine.makeTransaction();
+  t->setProcessBudget(std::chrono::nanoseconds(0), 1);
+  std::vector<Header> headers{{"host", "example.com"}};
+  EXPECT_TRUE(t->processRequestHeaders(headers));
+  EXPECT_TRUE(t->isSuspended());
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Suspended);
+
+  std::vector<Header> other_headers{{"host", "other.com"}};
+  EXPECT_FALSE(t->processRequestBody("a=1"));
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Suspended);
+  EXPECT_FALSE(t->appendRequestBody("a=1", true));
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Suspended);
+  EXPECT_FALSE(t->processRequestHeaders(other_headers));
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Suspended);
+  EXPECT_TRUE(t->isSuspended());
+  EXPECT_FALSE(t->hasVariable("", "c"));
+
+  // The resumed phase sees the original headers and body
+  while (t->isSuspended()) {
+    EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Suspended);
+    EXPECT_NE(t->resume(), Transaction::ProcessResult::Deny);
+  }
+  EXPECT_EQ(t->processResult(), Transaction::ProcessResult::Allow);
+  EXPECT_TRUE(t->hasVariable("", "host"));
+  EXPECT_FALSE(t->hasVariable("", "body"));
+  EXPECT_FALSE(t->hasVariable("", "c"));
+}
+} // namespace Wge
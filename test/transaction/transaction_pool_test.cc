@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "engine.h"
+#include "transaction_pool.h"
+
+namespace Wge {
+TEST(TransactionPoolTest, recycle) {
+  const std::string directive = R"(
+        SecRuleEngine On
+        SecRule ARGS:foo "@streq bar" "id:1,phase:1,setvar:tx.foo=%{MATCHED_VAR},ctl:ruleRemoveById=2"
+        SecRule ARGS:qux "@streq 1" "id:2,phase:2,setvar:tx.qux=1")";
+
+  Engine engine(spdlog::level::off);
+  auto result = engine.load(directive);
+  engine.init();
+  ASSERT_TRUE(result.has_value());
+
+  TransactionPool pool(engine, 1);
+  Transaction* first = nullptr;
+  {
+    auto t = pool.acquire();
+    first = t.get();
+    t->processUri("/?foo=bar&qux=1", "GET", "1.1");
+    t->processRequestHeaders(nullptr, nullptr, 0);
+    t->processRequestBody("");
+    EXPECT_EQ(std::get<std::string_view>(t->getVariable("", "foo")), "bar");
+    EXPECT_FALSE(t->hasVariable("", "qux"));
+  }
+  EXPECT_EQ(pool.idleSize(), 1);
+
+  // The recycled transaction doesn't inherit any state of the previous request
+  {
+    auto t = pool.acquire();
+    EXPECT_EQ(t.get(), first);
+    EXPECT_EQ(pool.idleSize(), 0);
+    EXPECT_FALSE(t->hasVariable("", "foo"));
+    EXPECT_TRUE(t->getRequestLine().empty());
+    EXPECT_TRUE(t->getRequestLineInfo().query_params_.getLinked().empty());
+
+    t->processUri("/?foo=bar&qux=1", "GET", "1.1");
+    t->processRequestHeaders(nullptr, nullptr, 0);
+    t->processRequestBody("");
+    EXPECT_EQ(std::get<std::string_view>(t->getVariable("", "foo")), "bar");
+    EXPECT_FALSE(t->hasVariable("", "qux"));
+
+    // The pool keeps at most max_idle_size transactions
+    auto t2 = pool.acquire();
+    EXPECT_NE(t2.get(), first);
+  }
+  EXPECT_EQ(pool.idleSize(), 1);
+
+  // The rule that was removed by the ctl action of the previous request is evaluated again
+  {
+    auto t = pool.acquire();
+    t->processUri("/?qux=1", "GET", "1.1");
+    t->processRequestHeaders(nullptr, nullptr, 0);
+    t->processRequestBody("");
+    EXPECT_FALSE(t->hasVariable("", "foo"));
+    EXPECT_TRUE(t->hasVariable("", "qux"));
+  }
+}
+} // namespace Wge
@@ -60,6 +60,107 @@ TEST_F(CacheTest, hit) {
   EXPECT_EQ(result.data(), result2.data());
 }
 
+TEST_F(CacheTest, contentAddressed) {
+  std::vector<std::unique_ptr<Transformation::TransformBase>> trans;
+  trans.push_back(std::make_unique<UrlDecode>());
+  trans.push_back(std::make_unique<LowerCase>());
+
+  // The same content that is held by different string objects
+  std::string test_data1 = "%3CScript%3EAlert(1)%3C/Script%3E";
+  std::string test_data2 = test_data1;
+  ASSERT_NE(test_data1.data(), test_data2.data());
+
+  Variable::Args variable1(std::string("test"), false, false, "");
+  Variable::Tx variable2("", std::string("test"), std::nullopt, false, false, "");
+
+  Common::Variant data1 = std::string_view(test_data1);
+  Common::EvaluateElement transform_buffer1(data1, "");
+  for (const auto& tran : trans) {
+    EXPECT_TRUE(tran->evaluate(*t_, &variable1, transform_buffer1, transform_buffer1));
+  }
+  EXPECT_EQ(t_->getTransformCacheStatistics().hit_count_, 0);
+  EXPECT_EQ(t_->getTransformCacheStatistics().miss_count_, 2);
+
+  Common::Variant data2 = std::string_view(test_data2);
+  Common::EvaluateElement transform_buffer2(data2, "");
+  for (const auto& tran : trans) {
+    EXPECT_TRUE(tran->evaluate(*t_, &variable2, transform_buffer2, transform_buffer2));
+  }
+  EXPECT_EQ(t_->getTransformCacheStatistics().hit_count_, 2);
+  EXPECT_EQ(t_->getTransformCacheStatistics().miss_count_, 2);
+
+  std::string_view result1 = std::get<std::string_view>(transform_buffer1.variant_);
+  std::string_view result2 = std::get<std::string_view>(transform_buffer2.variant_);
+  EXPECT_EQ(result1, "<script>alert(1)</script>");
+  EXPECT_EQ(result1.data(), result2.data());
+
+  // The different content doesn't hit
+  std::string test_data3 = "%3CScript%3EAlert(2)%3C/Script%3E";
+  Common::Variant data3 = std::string_view(test_data3);
+  Common::EvaluateElement transform_buffer3(data3, "");
+  for (const auto& tran : trans) {
+    EXPECT_TRUE(tran->evaluate(*t_, &variable1, transform_buffer3, transform_buffer3));
+  }
+  EXPECT_EQ(std::get<std::string_view>(transform_buffer3.variant_), "<script>alert(2)</script>");
+  EXPECT_EQ(t_->getTransformCacheStatistics().miss_count_, 4);
+}
+
+TEST_F(CacheTest, inputOverwritten) {
+  std::unique_ptr<Transformation::TransformBase> trans = std::make_unique<LowerCase>();
+  Variable::Tx variable("", std::string("test"), std::nullopt, false, false, "");
+
+  std::string test_data = "Hello, World!";
+  Common::Variant data1 = std::string_view(test_data);
+  Common::EvaluateElement transform_buffer1(data1, "");
+  EXPECT_TRUE(trans->evaluate(*t_, &variable, transform_buffer1, transform_buffer1));
+  EXPECT_EQ(std::get<std::string_view>(transform_buffer1.variant_), "hello, world!");
+
+  // The memory of the input is reused by a different value of the same size, the cache must not
+  // refer to it
+  test_data.assign("Hello, Earth!");
+  Common::Variant data2 = std::string_view(test_data);
+  Common::EvaluateElement transform_buffer2(data2, "");
+  EXPECT_TRUE(trans->evaluate(*t_, &variable, transform_buffer2, transform_buffer2));
+  EXPECT_EQ(std::get<std::string_view>(transform_buffer2.variant_), "hello, earth!");
+  EXPECT_EQ(t_->getTransformCacheStatistics().miss_count_, 2);
+
+  // The original value still hits
+  std::string test_data3 = "Hello, World!";
+  Common::Variant data3 = std::string_view(test_data3);
+  Common::EvaluateElement transform_buffer3(data3, "");
+  EXPECT_TRUE(trans->evaluate(*t_, &variable, transform_buffer3, transform_buffer3));
+  EXPECT_EQ(std::get<std::string_view>(transform_buffer3.variant_), "hello, world!");
+  EXPECT_EQ(t_->getTransformCacheStatistics().hit_count_, 1);
+}
+
+TEST_F(CacheTest, chainArenaGrowth) {
+  std::vector<std::unique_ptr<Transformation::TransformBase>> trans;
+  trans.push_back(std::make_unique<UrlDecode>());
+  trans.push_back(std::make_unique<LowerCase>());
+  trans.push_back(std::make_unique<HtmlEntityDecode>());
+  Variable::Tx variable("", std::string("test"), std::nullopt, false, false, "");
+
+  // A large body that is changed by each transformation
+  std::string test_data;
+  for (size_t i = 0; i < 100000; ++i) {
+    test_data += "%41Ab&amp;";
+  }
+
+  // Only the input that isn't owned by the transaction is copied into the arena, the input of the
+  // following transformations is the output of the previous one, which is owned by the arena
+  size_t expected_size = test_data.size() + 1;
+  Common::Variant data = std::string_view(test_data);
+  Common::EvaluateElement transform_buffer(data, "");
+  for (const auto& tran : trans) {
+    EXPECT_TRUE(tran->evaluate(*t_, &variable, transform_buffer, transform_buffer));
+    std::string_view output = std::get<std::string_view>(transform_buffer.variant_);
+    EXPECT_TRUE(t_->ownsString(output));
+    expected_size += output.size() + 1;
+  }
+  EXPECT_EQ(std::get<std::string_view>(transform_buffer.variant_).substr(0, 8), "aab&aab&");
+  EXPECT_LE(t_->arenaAllocatedSize(), expected_size + 64 * 1024);
+}
+
 // Issues #24
 TEST_F(CacheTest, getDuplicateArgsCache) {
   std::unique_ptr<Transformation::TransformBase> url_trans = std::make_unique<UrlDecode>();
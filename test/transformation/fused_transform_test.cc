@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2024-2025 Stone Rhino and contributors.
+ *
+ * MIT License (http://opensource.org/licenses/MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "engine.h"
+#include "transformation/compress_whitespace.h"
+#include "transformation/fused_transform.h"
+#include "transformation/lowercase.h"
+#include "transformation/remove_nulls.h"
+#include "transformation/remove_whitespace.h"
+#include "transformation/replace_nulls.h"
+#include "transformation/url_decode.h"
+#include "variable/tx.h"
+
+namespace Wge {
+namespace Transformation {
+class FusedTransformTest : public ::testing::Test {
+protected:
+  void SetUp() override { engine_.init(); }
+
+  // Evaluate the chain and return whether any transformation is applied and the final value
+  std::pair<bool, std::string> evaluate(const std::vector<const TransformBase*>& transforms,
+                                        std::string_view data) {
+    auto t = engine_.makeTransaction();
+    Variable::Tx variable("", std::string("test"), std::nullopt, false, false, "");
+    Common::Variant variant = data;
+    Common::EvaluateElement input(variant, "");
+    Common::EvaluateElement output;
+    const Common::EvaluateElement* p_input = &input;
+    bool transformed = false;
+    for (auto transform : transforms) {
+      if (transform->evaluate(*t, &variable, *p_input, output)) {
+        transformed = true;
+        p_input = &output;
+      }
+    }
+    return {transformed, std::string(std::get<std::string_view>(p_input->variant_))};
+  }
+
+  void expectSame(const std::vector<const TransformBase*>& transforms, size_t expect_fused_size) {
+    std::vector<std::unique_ptr<TransformBase>> holder;
+    auto fused = FusedTransform::fuse(transforms, holder);
+    ASSERT_EQ(fused.size(), expect_fused_size);
+
+    static constexpr std::string_view inputs[] = {
+        "",
+        "already clean",
+        "Hello,  World!",
+        std::string_view("A\0B\0\0C", 6),
+        std::string_view("\0\0 \t\n\0Mixed\r\n\0CASE \xA0 end\0", 25),
+        "   leading and trailing   ",
+        "%41%00%42 %20 X",
+    };
+    for (auto data : inputs) {
+      auto expect = evaluate(transforms, data);
+      auto actual = evaluate(fused, data);
+      EXPECT_EQ(actual.first, expect.first);
+      EXPECT_EQ(actual.second, expect.second);
+    }
+  }
+
+protected:
+  Engine engine_;
+  LowerCase lowercase_;
+  RemoveNulls remove_nulls_;
+  ReplaceNulls replace_nulls_;
+  RemoveWhitespace remove_whitespace_;
+  CompressWhiteSpace compress_whitespace_;
+  UrlDecode url_decode_;
+};
+
+TEST_F(FusedTransformTest, notFused) {
+  std::vector<std::unique_ptr<TransformBase>> holder;
+  EXPECT_TRUE(FusedTransform::fuse({}, holder).empty());
+  EXPECT_TRUE(FusedTransform::fuse({&lowercase_}, holder).empty());
+  EXPECT_TRUE(FusedTransform::fuse({&lowercase_, &url_decode_, &remove_nulls_}, holder).empty());
+  EXPECT_TRUE(holder.empty());
+}
+
+TEST_F(FusedTransformTest, sameAsStepwise) {
+  expectSame({&lowercase_, &remove_nulls_}, 1);
+  expectSame({&replace_nulls_, &compress_whitespace_, &lowercase_}, 1);
+  expectSame({&remove_nulls_, &remove_whitespace_, &lowercase_}, 1);
+  expectSame({&compress_whitespace_, &replace_nulls_, &compress_whitespace_}, 1);
+  expectSame({&url_decode_, &lowercase_, &replace_nulls_, &url_decode_}, 3);
+  expectSame({&lowercase_, &compress_whitespace_, &url_decode_, &remove_nulls_, &lowercase_}, 3);
+}
+
+TEST_F(FusedTransformTest, sharedName) {
+  std::vector<std::unique_ptr<TransformBase>> holder;
+  auto fused1 = FusedTransform::fuse({&lowercase_, &remove_nulls_}, holder);
+  auto fused2 = FusedTransform::fuse({&lowercase_, &remove_nulls_}, holder);
+  ASSERT_EQ(fused1.size(), 1);
+  ASSERT_EQ(fused2.size(), 1);
+  EXPECT_NE(fused1.front(), fused2.front());
+  EXPECT_EQ(fused1.front()->name(), fused2.front()->name());
+  EXPECT_STREQ(fused1.front()->name(), "lowercase,removeNulls");
+}
+} // namespace Transformation
+} // namespace Wge
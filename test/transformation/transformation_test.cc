@@ -213,7 +213,11 @@ TEST_F(TransformationTest, hexDecode) {
 
 TEST_F(TransformationTest, hexEncode) {
   const std::vector<TestCase> test_cases = {
-      {true, "This is a test", "5468697320697320612074657374"}};
+      {true, "This is a test", "5468697320697320612074657374"},
+      {true, "\x80\xff\x7f", "80ff7f"},
+      {true, "This is a long test that is longer than 32 bytes\xfe",
+       "546869732069732061206c6f6e672074657374207468617420"
+       "6973206c6f6e676572207468616e203332206279746573fe"}};
 
   evaluate<Wge::Transformation::HexEncode>(test_cases);
 }
@@ -272,7 +276,9 @@ TEST_F(TransformationTest, lowercase) {
   const std::vector<TestCase> test_cases = {
       {false, "this is a test", "this is a test"},
       {true, "THIS IS A TEST", "this is a test"},
-      {true, R"(ThiS iS A TeSt~!@#$%^&*()_+)", "this is a test~!@#$%^&*()_+"}};
+      {true, R"(ThiS iS A TeSt~!@#$%^&*()_+)", "this is a test~!@#$%^&*()_+"},
+      {true, "this is a long test that is longer than 32 bytes, THIS IS A LONG TEST",
+       "this is a long test that is longer than 32 bytes, this is a long test"}};
 
   evaluate<Wge::Transformation::LowerCase>(test_cases);
   evaluateStream<Wge::Transformation::LowerCase>(test_cases);
@@ -412,15 +418,35 @@ TEST_F(TransformationTest, normalisePath) {
 }
 
 TEST_F(TransformationTest, parityEven7Bit) {
-  // TODO(zhouyu 2025-03-21): Implement this test
+  const std::vector<TestCase> test_cases = {
+      {false, "", ""},
+      {false, "\xd4\xe8i\xf3", "\xd4\xe8i\xf3"},
+      {true, "This is a test", "\xd4\xe8i\xf3\xa0i\xf3\xa0\xe1\xa0te\xf3t"},
+      {true, "This is a test, This is a test, This is a test",
+       "\xd4\xe8i\xf3\xa0i\xf3\xa0\xe1\xa0te\xf3t\xac\xa0\xd4\xe8i\xf3\xa0i\xf3"
+       "\xa0\xe1\xa0te\xf3t\xac\xa0\xd4\xe8i\xf3\xa0i\xf3\xa0\xe1\xa0te\xf3t"}};
+
+  evaluate<Wge::Transformation::ParityEven7Bit>(test_cases);
 }
 
 TEST_F(TransformationTest, parityOdd7Bit) {
-  // TODO(zhouyu 2025-03-21): Implement this test
+  const std::vector<TestCase> test_cases = {
+      {false, "", ""},
+      {false, "Th\xe9s", "Th\xe9s"},
+      {true, "This is a test", "Th\xe9s \xe9s a \xf4\xe5s\xf4"},
+      {true, "\xd4\xe8is", "Th\xe9s"}};
+
+  evaluate<Wge::Transformation::ParityOdd7Bit>(test_cases);
 }
 
 TEST_F(TransformationTest, ParityZero7Bit) {
-  // TODO(zhouyu 2025-03-21): Implement this test
+  const std::vector<TestCase> test_cases = {
+      {false, "This is a test", "This is a test"},
+      {true, "\xd4\xe8is", "This"},
+      {true, "This is a test\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0\xa0",
+       "This is a test                "}};
+
+  evaluate<Wge::Transformation::ParityZero7Bit>(test_cases);
 }
 
 TEST_F(TransformationTest, removeComments) {
@@ -538,11 +564,39 @@ TEST_F(TransformationTest, trim) {
       {true, "\t\n\r\f\v\x20 ", ""}};
 
   evaluate<Wge::Transformation::Trim>(test_cases);
+
+  const std::vector<TestCase> test2_cases = {{true, " This is a test", "This is a test"},
+                                             {true, "This is a test ", "This is a test"}};
+  evaluate<Wge::Transformation::Trim>(test2_cases);
   evaluateStream<Wge::Transformation::Trim>(test_cases);
 }
 
 TEST_F(TransformationTest, upperCase) {
-  // TODO(zhouyu 2025-03-21): Implement this test
+  const std::vector<TestCase> test_cases = {
+      {false, "THIS IS A TEST", "THIS IS A TEST"},
+      {true, "this is a test", "THIS IS A TEST"},
+      {true, R"(ThiS iS A TeSt~!@#$%^&*()_+)", "THIS IS A TEST~!@#$%^&*()_+"},
+      {true, "THIS IS A LONG TEST THAT IS LONGER THAN 32 BYTES, this is a long test",
+       "THIS IS A LONG TEST THAT IS LONGER THAN 32 BYTES, THIS IS A LONG TEST"}};
+
+  evaluate<Wge::Transformation::UpperCase>(test_cases);
+}
+
+TEST_F(TransformationTest, mayChange) {
+  EXPECT_FALSE(Wge::Transformation::LowerCase().mayChange("this is a test"));
+  EXPECT_TRUE(Wge::Transformation::LowerCase().mayChange("this is a Test"));
+  EXPECT_FALSE(Wge::Transformation::RemoveNulls().mayChange("this is a test"));
+  EXPECT_TRUE(Wge::Transformation::RemoveNulls().mayChange({"this is a test\0", 15}));
+  EXPECT_FALSE(Wge::Transformation::RemoveNulls().mayChange(std::string_view()));
+  EXPECT_FALSE(Wge::Transformation::ReplaceNulls().mayChange(std::string_view()));
+  EXPECT_FALSE(Wge::Transformation::CompressWhiteSpace().mayChange("this is a test"));
+  EXPECT_TRUE(Wge::Transformation::CompressWhiteSpace().mayChange("this is a  test"));
+  EXPECT_TRUE(Wge::Transformation::CompressWhiteSpace().mayChange("this is a\ttest"));
+  EXPECT_FALSE(Wge::Transformation::RemoveWhitespace().mayChange("thisisatest"));
+  EXPECT_TRUE(Wge::Transformation::RemoveWhitespace().mayChange("thisisatest\xa0"));
+  EXPECT_FALSE(Wge::Transformation::Trim().mayChange("this is a test"));
+  EXPECT_TRUE(Wge::Transformation::Trim().mayChange("this is a test\n"));
+  EXPECT_FALSE(Wge::Transformation::ParityZero7Bit().mayChange("this is a test"));
 }
 
 TEST_F(TransformationTest, urlDecodeUni) {